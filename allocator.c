@@ -0,0 +1,132 @@
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+
+#define NEVER_FAIL 0
+
+const Allocator* allocatorDefault();
+void* allocatorAllocate(const Allocator* allocator, size_t size);
+void* allocatorReallocate(const Allocator* allocator, void* pointer, size_t size);
+void allocatorDeallocate(const Allocator* allocator, void* pointer);
+void countingAllocatorInit(CountingAllocator* counting, const Allocator* underlying);
+void countingAllocatorFailAt(CountingAllocator* counting, long long fail_at);
+static void* libcAllocate(void* context, size_t size);
+static void* libcReallocate(void* context, void* pointer, size_t size);
+static void libcDeallocate(void* context, void* pointer);
+static void* countingAllocate(void* context, size_t size);
+static void* countingReallocate(void* context, void* pointer, size_t size);
+static void countingDeallocate(void* context, void* pointer);
+static bool shouldFail(CountingAllocator* counting);
+
+static const Allocator libc_allocator = { libcAllocate, libcReallocate, libcDeallocate, NULL };
+
+const Allocator* allocatorDefault()
+{
+    return &libc_allocator;
+}
+
+void* allocatorAllocate(const Allocator* allocator, size_t size)
+{
+    assert(allocator != NULL);
+    return allocator->allocate(allocator->context, size);
+}
+
+void* allocatorReallocate(const Allocator* allocator, void* pointer, size_t size)
+{
+    assert(allocator != NULL);
+    return allocator->reallocate(allocator->context, pointer, size);
+}
+
+void allocatorDeallocate(const Allocator* allocator, void* pointer)
+{
+    assert(allocator != NULL);
+    if (pointer != NULL)
+    {
+        allocator->deallocate(allocator->context, pointer);
+    }
+}
+
+void countingAllocatorInit(CountingAllocator* counting, const Allocator* underlying)
+{
+    assert(counting != NULL);
+    counting->allocator.allocate = countingAllocate;
+    counting->allocator.reallocate = countingReallocate;
+    counting->allocator.deallocate = countingDeallocate;
+    counting->allocator.context = counting;
+    counting->underlying = underlying != NULL ? underlying : allocatorDefault();
+    counting->allocations = 0;
+    counting->reallocations = 0;
+    counting->deallocations = 0;
+    counting->failures = 0;
+    counting->fail_at = NEVER_FAIL;
+}
+
+void countingAllocatorFailAt(CountingAllocator* counting, long long fail_at)
+{
+    assert(counting != NULL && fail_at >= 0);
+    counting->fail_at = fail_at;
+}
+
+static void* libcAllocate(void* context, size_t size)
+{
+    return malloc(size);
+}
+
+static void* libcReallocate(void* context, void* pointer, size_t size)
+{
+    return realloc(pointer, size);
+}
+
+static void libcDeallocate(void* context, void* pointer)
+{
+    free(pointer);
+}
+
+static void* countingAllocate(void* context, size_t size)
+{
+    CountingAllocator* counting = context;
+    if (shouldFail(counting))
+    {
+        return NULL;
+    }
+    counting->allocations++;
+    return allocatorAllocate(counting->underlying, size);
+}
+
+static void* countingReallocate(void* context, void* pointer, size_t size)
+{
+    CountingAllocator* counting = context;
+    if (shouldFail(counting))
+    {
+        return NULL;
+    }
+    counting->reallocations++;
+    return allocatorReallocate(counting->underlying, pointer, size);
+}
+
+static void countingDeallocate(void* context, void* pointer)
+{
+    CountingAllocator* counting = context;
+    counting->deallocations++;
+    allocatorDeallocate(counting->underlying, pointer);
+}
+
+/*
+counts down to the call that should fail, return true for that call
+*/
+static bool shouldFail(CountingAllocator* counting)
+{
+    if (counting->fail_at == NEVER_FAIL)
+    {
+        return false;
+    }
+    counting->fail_at--;
+    if (counting->fail_at == NEVER_FAIL)
+    {
+        counting->failures++;
+        return true;
+    }
+    return false;
+}
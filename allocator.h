@@ -0,0 +1,63 @@
+#ifndef MTM_ALLOCATOR_H
+#define MTM_ALLOCATOR_H
+
+#include <stddef.h>
+/**
+* Allocator
+* Implements a table of memory functions that all the allocations of the library go through.
+* Every function gets the context of the allocator, so one set of functions can serve many
+* arenas or pools.
+* An allocator has to stay valid until every object that was created with it is destroyed.
+**/
+
+/** Type for defining an Allocator */
+typedef struct Allocator_t
+{
+    void* (*allocate)(void* context, size_t size);
+    void* (*reallocate)(void* context, void* pointer, size_t size);
+    void (*deallocate)(void* context, void* pointer);
+    void* context;
+} Allocator;
+
+/** Type for an allocator that counts the calls to another allocator and can fail them */
+typedef struct CountingAllocator_t
+{
+    Allocator allocator;
+    const Allocator* underlying;
+    long long allocations;
+    long long reallocations;
+    long long deallocations;
+    long long failures;
+    long long fail_at;
+} CountingAllocator;
+
+/*
+*allocatorDefault: return the allocator of the C library (malloc, realloc and free)
+*/
+const Allocator* allocatorDefault();
+/*
+*allocatorAllocate: allocates size bytes with the given allocator
+*@return NULL if allocation failed
+*/
+void* allocatorAllocate(const Allocator* allocator, size_t size);
+/*
+*allocatorReallocate: changes the size of the given block, like realloc
+*@return NULL if allocation failed, the block is unchanged in that case
+*/
+void* allocatorReallocate(const Allocator* allocator, void* pointer, size_t size);
+/*
+*allocatorDeallocate: deallocates the given block, if pointer is NULL nothing will be done
+*/
+void allocatorDeallocate(const Allocator* allocator, void* pointer);
+/*
+*countingAllocatorInit: initializes a counting allocator over the given allocator, or over the
+*default allocator if underlying is NULL. &counting->allocator is the allocator to pass
+*/
+void countingAllocatorInit(CountingAllocator* counting, const Allocator* underlying);
+/*
+*countingAllocatorFailAt: the call number fail_at to allocate or reallocate from now on fails
+*and returns NULL without allocating, the calls after it succeed again. 0 fails no call
+*/
+void countingAllocatorFailAt(CountingAllocator* counting, long long fail_at);
+
+#endif //MTM_ALLOCATOR_H
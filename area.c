@@ -1,28 +1,89 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "mtm_map/map.h"
+#include "mtm_map/map_ext.h"
 #include "area.h"
 #include "assist.h"
 #include "tribe.h"
+#include "idmap.h"
+#include "skiplist.h"
+#include "region.h"
+#include "seats.h"
+#include "scheduler.h"
+#include "epoch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
 
 
-#define UNDEFINED_ID -1
+#define INITIAL_CAPACITY 4
+#define GROWTH_FACTOR 2
+#define PREFETCH_DISTANCE 8
+#define WINNERS_GRAIN 1024
+#define REMOVE_TRIBES_GRAIN 256
+#define CONDITION_GRAIN 16
+#define POSITION_TO_VALUE(position) ((void*)(intptr_t)((position) + 1))
+#define VALUE_TO_POSITION(value) ((int)(intptr_t)(value) - 1)
 
 
-struct area_t
+/*
+one area of the list, region is the id of the region of the area or ELECTION_NO_REGION
+*/
+typedef struct AreaRecord_t
 {
     int id;
+    int region;
     char* name;
     Tribe tribe;
-    Area next;
+} AreaRecord;
+
+/*
+the areas of the list are records in one array, in the order they were added, so walking the areas
+reads the array in order and only the tribe tables of the areas are elsewhere.
+totals keeps the votes of every tribe in all the areas, it keeps the tribes when the list has no areas.
+regions keeps the vote totals of the regions, it is created when the first area is put in a region.
+overflow is the policy of the list for votes that would overflow an int64_t.
+scheduler runs the loops over all the areas on many threads, it is NULL if they run on the calling thread.
+epoch is NULL unless other threads read the list (see areaSetEpoch), then the arrays and tables the list
+stops using are retired to it and removing areas copies the kept ones to a new array. sequence guards
+records and capacity, a new area is added after the others.
+index maps the ids to their positions in the array plus one and order keeps them sorted for range
+queries the same way, order is only created by the first range query so lists that are never queried
+by range don't keep it up to date. all the records and their tables are allocated with the allocator of the list
+*/
+struct area_t
+{
+    const Allocator* allocator;
+    AreaRecord* records;
+    int size;
+    int capacity;
+    IdMap index;
+    SkipList order;
+    RegionSet regions;
+    Tribe totals;
+    ElectionOverflowPolicy overflow;
+    Scheduler scheduler;
+    Epoch epoch;
+    unsigned sequence;
 };
 
-Area areaCreate();
+/*
+the arguments of a loop the scheduler runs over the records of a list, only the ones of its body are set
+*/
+typedef struct AreaLoop_t
+{
+    Area area;
+    const int* sorted_ids;
+    int count;
+    AreaConditionFunction condition;
+    bool* removed;
+    AreaTribePair* pairs;
+} AreaLoop;
+
+Area areaCreate(const Allocator* allocator);
 void areaDestroy(Area area);
 AreaResult areaAddTribe(Area area, int tribe_id, const char* tribe_name);
 AreaResult areaAdd(Area area, int area_id, const char* area_name);
@@ -31,16 +92,45 @@ AreaResult areaAddVote(Area area, int area_id, int tribe_id, int num_of_votes);
 AreaResult areaRemoveVote(Area area, int area_id, int tribe_id, int num_of_votes);
 AreaResult areaSetTribeName(Area area, int tribe_id, const char* tribe_name);
 AreaResult areaRemoveTribe(Area area, int tribe_id);
+AreaResult areaRemoveTribes(Area area, const int* tribe_ids, int count);
+AreaResult areaRemoveTribesOfLists(Area* lists, int list_count, const int* tribe_ids, int count);
 AreaResult areaRemove(Area area, AreaConditionFunction should_delete_area);
 Map areaComputeAreasToTribesMapping(Area area);
-static void areaElementsDelete(Area area);
+Map areaComputeAreasToTribesMappingInRange(Area area, int from_area_id, int to_area_id);
+Map areaComputeAreasToTribesMappingInRangeOfLists(Area* lists, int list_count, int from_area_id, int to_area_id);
+AreaTribePair* areaComputeAreasToTribesArray(Area area, int* size);
+AreaResult areaSetRegion(Area area, int area_id, int region_id);
+Map areaComputeRegionsToTribesMapping(Area area);
+Map areaComputeRegionsToTribesMappingOfLists(Area* lists, int list_count);
+Map areaComputeSeats(Area area, ElectionSeatMethod method, int seats, double threshold);
+Map areaComputeSeatsOfLists(Area* lists, int list_count, ElectionSeatMethod method, int seats, double threshold);
+Map areaComputeRegionSeats(Area area, int region_id, ElectionSeatMethod method, int seats, double threshold);
+Map areaComputeRegionSeatsOfLists(Area* lists, int list_count, int region_id, ElectionSeatMethod method, int seats,
+                                  double threshold);
+void areaSetOverflowPolicy(Area area, ElectionOverflowPolicy policy);
+void areaSetScheduler(Area area, Scheduler scheduler);
+void areaSetEpoch(Area area, Epoch epoch);
+AreaTribePair* areaReadAreasToTribesArray(Area* lists, int list_count, int* size);
+char* areaReadTribeName(Area area, int tribe_id);
+bool areaVisitResults(Area* lists, int list_count, ElectionResultVisitor visitor, void* context);
+AreaResult areaFreeze(Area area, int area_id);
+AreaResult areaGetVotes(Area area, int area_id, int tribe_id, int64_t* votes);
+static void recordDelete(Area area, AreaRecord* record);
 static AreaResult handleResult(TribeResult result);
-static Area getAreaById(Area area, int area_id);
-static bool areaPutElemtnes(Area area, int area_id, const char* area_name);
+static AreaRecord* getAreaById(Area area, int area_id);
+static bool recordPutElements(Area area, AreaRecord* record, int area_id, const char* area_name);
 AreaResult areaUpdateVote(Area area, int area_id, int tribe_id, int num_of_votes, UpdateVotesCondition condition);
-static void swapArea(Area area1, Area area2);
-static void removeNodeArea(Area area);
-static Area getFormerAreaNode(Area area, int area_id);
+static void subtractArea(Area area, AreaRecord* removed);
+static bool growRecords(Area area);
+static void prefetchRecords(Area area, int position);
+static bool indexArea(Area area, int position);
+static bool createOrder(Area area);
+static int compareIds(const void* id1, const void* id2);
+static bool putRange(Area area, Map map, int from_area_id, int to_area_id);
+static Tribe mergeTotals(Area* lists, int list_count, int region_id);
+static void removeTribesInRange(int begin, int end, void* argument);
+static void checkConditionInRange(int begin, int end, void* argument);
+static void findWinnersInRange(int begin, int end, void* argument);
 bool areaContains(Area area, int area_id);
 bool areaTribeContains(Area area, int tribe_id);
 
@@ -50,7 +140,7 @@ bool areaTribeContains(Area area, int tribe_id)
     {
         return false;
     }
-    return tribeContains(area->tribe, tribe_id);
+    return tribeSchemaContains(area->totals, tribe_id);//every table of the election has the same tribes
 }
 
 bool areaContains(Area area, int area_id)
@@ -63,51 +153,74 @@ bool areaContains(Area area, int area_id)
 
 }
 
-Area areaCreate()
+Area areaCreate(const Allocator* allocator)
 {
-    Area area = malloc(sizeof(*area));
+    Area area = allocatorAllocate(allocator, sizeof(*area));
     if (area == NULL)
     {
         return NULL;//allocation failed
     }
-    area->tribe = tribeCreate();
-    if (area->tribe == NULL)
+    area->totals = tribeCreate(allocator);
+    area->index = idMapCreate(allocator);
+    if (area->totals == NULL || area->index == NULL)
     {
-        free(area);
+        tribeDestroy(area->totals);
+        idMapDestroy(area->index);
+        allocatorDeallocate(allocator, area);
         return NULL;//allocation failed
     }
-    area->id = UNDEFINED_ID;
-    area->name = NULL;
-    area->next = NULL;
+    area->allocator = allocator;
+    area->records = NULL;
+    area->size = 0;
+    area->capacity = 0;
+    area->order = NULL;
+    area->regions = NULL;
+    area->overflow = ELECTION_OVERFLOW_ERROR;
+    area->scheduler = NULL;
+    area->epoch = NULL;
+    area->sequence = 0;
     return area;
 }
 
 void areaDestroy(Area area)
 {
-    while (area != NULL)//if the id is undefined the area elements are already NULL
+    if (area == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < area->size; i++)
     {
-        Area area_to_Delete = area;
-        area = area->next;
-        areaElementsDelete(area_to_Delete);
-        free(area_to_Delete);
+        prefetchRecords(area, i);
+        recordDelete(area, &area->records[i]);
     }
+    allocatorDeallocate(area->allocator, area->records);
+    idMapDestroy(area->index);
+    skipListDestroy(area->order);
+    regionSetDestroy(area->regions);
+    tribeDestroy(area->totals);
+    allocatorDeallocate(area->allocator, area);
 }
 
 AreaResult areaAddTribe(Area area, int tribe_id, const char* tribe_name)
 {
     assert(area != NULL && tribe_name != NULL);
     assert(tribe_id >= 0);
-    TribeResult result;
-    while (area != NULL)
+    if (areaTribeContains(area, tribe_id))//the only lookup, the tables are known not to have the tribe
     {
-        result = tribeAdd(area->tribe, tribe_id, tribe_name);
-        if (result != TRIBE_SUCCESS)
-        {
-            return handleResult(result);
-        }
-        area = area->next;
+        return AREA_TRIBE_ALREADY_EXIST;
     }
-    return handleResult(result);
+    //the tables of the areas are sparse, a new tribe has no votes in them so they don't change
+    TribeResult result = tribeAppend(area->totals, tribe_id, tribe_name);
+    if (result != TRIBE_SUCCESS)
+    {
+        return handleResult(result);
+    }
+    if (area->regions != NULL && regionSetAddTribe(area->regions, tribe_id, tribe_name) != REGION_SUCCESS)
+    {
+        tribeRemove(area->totals, tribe_id);
+        return AREA_OUT_OF_MEMORY;
+    }
+    return AREA_SUCCESS;
 }
 
 AreaResult areaAdd(Area area, int area_id, const char* area_name)
@@ -118,240 +231,573 @@ AreaResult areaAdd(Area area, int area_id, const char* area_name)
     {
         return AREA_ALREADY_EXIST;
     }
-    if (area->id == UNDEFINED_ID) //only one empty area
+    if (area->size == area->capacity && !growRecords(area))
     {
-        if (!areaPutElemtnes(area, area_id, area_name))
-        {
-            return AREA_OUT_OF_MEMORY;
-        }
-        tribeSetAllVotesToZero(area->tribe);
+        return AREA_OUT_OF_MEMORY;
     }
-    else
+    AreaRecord* new_area = &area->records[area->size];
+    if (!recordPutElements(area, new_area, area_id, area_name))
     {
-        Area new_area = areaCreate();
-        if (new_area == NULL)
-        {
-            return AREA_OUT_OF_MEMORY;
-        }
-        tribeDestroy(new_area->tribe);
-        destroyString(new_area->name);
-        new_area->tribe = tribeCopy(area->tribe);//copy the tribe 
-        if (new_area->tribe == NULL)//check if copying tribe failed
-        {
-            return AREA_OUT_OF_MEMORY;
-        }
-        if (!areaPutElemtnes(new_area, area_id, area_name))
-        {
-            areaDestroy(new_area);
-            return AREA_OUT_OF_MEMORY;
-        }
-        tribeSetAllVotesToZero(new_area->tribe);
-        while (area->next != NULL)
-        {
-            area = area->next;
-        }
-        area->next = new_area;
+        return AREA_OUT_OF_MEMORY;
+    }
+    if (!indexArea(area, area->size))
+    {
+        recordDelete(area, new_area);
+        return AREA_OUT_OF_MEMORY;
     }
+    __atomic_store_n(&area->size, area->size + 1, __ATOMIC_RELEASE);//a reader that sees the area sees all its record
     return AREA_SUCCESS;
 }
 
 char* areaGetTribeName(Area area, int tribe_id)
 {
-    if (area == NULL || area->tribe == NULL)
+    if (area == NULL || area->totals == NULL)
     {
         return NULL;
     }
-    return tribeGetName(area->tribe, tribe_id);
+    return tribeGetName(area->totals, tribe_id);//the totals have all the tribes of the areas
 }
 
 AreaResult areaUpdateVote(Area area, int area_id, int tribe_id, int num_of_votes, UpdateVotesCondition condition)
 {
     TribeResult result;
-    assert(area != NULL && area->tribe != NULL && area_id >= 0 && tribe_id >= 0 && num_of_votes >= 0);
-    Area area_to_update = getAreaById(area, area_id);//look for the area with the given id
+    assert(area != NULL && area->totals != NULL && area_id >= 0 && tribe_id >= 0 && num_of_votes >= 0);
+    AreaRecord* area_to_update = getAreaById(area, area_id);//look for the area with the given id
     if (area_to_update == NULL)
     {
         return AREA_NOT_EXIST;
     }
-    result = tribeUpdateVote(area_to_update->tribe, tribe_id, num_of_votes, condition);
+    int64_t change;//the totals follow the area, a region total is at most the total so it can't overflow
+    result = tribeUpdateVote(area_to_update->tribe, area->totals, tribe_id, num_of_votes, condition,
+                             area->overflow == ELECTION_OVERFLOW_SATURATE, &change);
+    if (result != TRIBE_SUCCESS)
+    {
+        return handleResult(result);
+    }
+    if (area_to_update->region != ELECTION_NO_REGION)
+    {
+        regionSetAddVotes(area->regions, area_to_update->region, tribe_id, change);
+    }
     return handleResult(result);
 }
 
 AreaResult areaSetTribeName(Area area, int tribe_id, const char* tribe_name)
 {
     assert(area != NULL && tribe_id >= 0 && tribe_name != NULL);
-    TribeResult result;
-    while (area != NULL)
-    {//run on all area nodes, need to change the name in all the areas since each one has a tribe map
-        result = tribeSetName(area->tribe, tribe_id, tribe_name);
-        if (result != TRIBE_SUCCESS)
-        {
-            return handleResult(result);
-        }
-        area = area->next;
-    }
-    return handleResult(result);
+    //the names are kept in the schema all the areas share, so setting it through the totals is enough
+    return handleResult(tribeSetName(area->totals, tribe_id, tribe_name));
 }
 
 AreaResult areaRemoveTribe(Area area, int tribe_id)
 {
     assert(area != NULL && tribe_id >= 0);
-    TribeResult result;
-    while (area != NULL)// need to remove from all the area since each area has a tribe map of itself
+    if (!areaTribeContains(area, tribe_id))
+    {
+        return AREA_TRIBE_NOT_EXIST;
+    }
+    return areaRemoveTribes(area, &tribe_id, 1);
+}
+
+AreaResult areaRemoveTribes(Area area, const int* tribe_ids, int count)
+{
+    return areaRemoveTribesOfLists(&area, 1, tribe_ids, count);
+}
+
+AreaResult areaRemoveTribesOfLists(Area* lists, int list_count, const int* tribe_ids, int count)
+{
+    assert(lists != NULL && list_count > 0 && tribe_ids != NULL && count >= 0);
+    const int* sorted_ids = tribe_ids;//one id is sorted already, so removing one tribe doesn't allocate
+    int* copied_ids = NULL;
+    if (count > 1)
     {
-        if (area->tribe != NULL) {
-            result = tribeRemove(area->tribe, tribe_id);
+        copied_ids = allocatorAllocate(lists[0]->allocator, count * sizeof(int));
+        if (copied_ids == NULL)
+        {
+            return AREA_OUT_OF_MEMORY;
         }
-        if (result != TRIBE_SUCCESS)
+        memcpy(copied_ids, tribe_ids, count * sizeof(int));
+        qsort(copied_ids, count, sizeof(int), compareIds);//sorted once for all the areas of all the lists
+        sorted_ids = copied_ids;
+    }
+    for (int list = 0; list < list_count; list++)
+    {
+        Area area = lists[list];
+        AreaLoop loop = {.area = area, .sorted_ids = sorted_ids, .count = count};
+        schedulerFor(area->scheduler, area->size, REMOVE_TRIBES_GRAIN, removeTribesInRange, &loop);
+        tribeRemoveSorted(area->totals, sorted_ids, count);//the tables of the areas leave the schema to the totals
+        if (area->regions != NULL)
         {
-            return handleResult(result);
+            regionSetRemoveTribes(area->regions, sorted_ids, count);
         }
-        area = area->next;
     }
-    return handleResult(result);
+    allocatorDeallocate(lists[0]->allocator, copied_ids);
+    return AREA_SUCCESS;
 }
 
 AreaResult areaRemove(Area area, AreaConditionFunction should_delete_area)
 {
-    assert(area != NULL);
-    if (area->next == NULL) //first and only node
+    assert(area != NULL && area->index != NULL);
+    AreaLoop loop = {.area = area, .condition = should_delete_area, .removed = NULL};
+    AreaRecord* old_records = area->records;
+    AreaRecord* kept_records = old_records;//the kept areas are copied to a new array while readers may read the old one
+    if (area->epoch != NULL && area->size > 0)
     {
-        if (should_delete_area(area->id))//need to delete the only area in the list
+        kept_records = allocatorAllocate(area->allocator, area->capacity * sizeof(*kept_records));
+        if (kept_records == NULL)
         {
-            areaElementsDelete(area);//only delete  the node elements, don't delete the list itself
+            return AREA_OUT_OF_MEMORY;
+        }
+    }
+    if (area->scheduler != NULL && area->size > CONDITION_GRAIN)
+    {//the condition is checked for all the areas at once first, without the scheduler or memory it is checked in the loop
+        loop.removed = allocatorAllocate(area->allocator, area->size * sizeof(*loop.removed));
+        if (loop.removed != NULL)
+        {
+            schedulerFor(area->scheduler, area->size, CONDITION_GRAIN, checkConditionInRange, &loop);
         }
-        return AREA_SUCCESS;
     }
-    Area tmp = area;
-    while (tmp != NULL)
+    int kept = 0;
+    for (int i = 0; i < area->size; i++)//the kept areas move back over the removed ones, keeping their order
     {
-        Area formerNode = getFormerAreaNode(area, tmp->id);
-        if (should_delete_area(tmp->id))
+        prefetchRecords(area, i);
+        AreaRecord* current = &area->records[i];
+        if (loop.removed != NULL ? loop.removed[i] : should_delete_area(current->id))
         {
-            if (tmp->next == NULL)
+            idMapRemove(area->index, current->id);
+            if (area->order != NULL)
             {
-                if (formerNode == NULL)//only one node exsits in the list and we want to delete it
-                {
-                    areaElementsDelete(tmp);//keep an empty list
-                    tmp->tribe = NULL;
-                }
-                else
-                {
-                    formerNode->next = NULL;//we need to delete the last node in the list
-                    areaElementsDelete(tmp);
-                    free(tmp);
-                }
-                return AREA_SUCCESS;
+                skipListRemove(area->order, current->id);
             }
-            if (formerNode == NULL)//need to delete the first node, but its not the only node in the list
+            subtractArea(area, current);
+            if (kept_records == old_records)
             {
-                swapArea(tmp, tmp->next);//swap and deletes the second node 
-                removeNodeArea(tmp);
+                recordDelete(area, current);
             }
-            else
+            continue;
+        }
+        if (kept != i || kept_records != old_records)
+        {
+            kept_records[kept] = *current;
+        }
+        if (kept != i)
+        {
+            idMapSet(area->index, current->id, POSITION_TO_VALUE(kept));//the id is mapped so this doesn't allocate
+            if (area->order != NULL)
             {
-                Area toDelete = tmp;
-                formerNode->next = tmp->next;//remove a note from the middle of the list
-                tmp = tmp->next;
-                areaElementsDelete(toDelete);
-                free(toDelete);
+                skipListSet(area->order, current->id, POSITION_TO_VALUE(kept));//the id is in the order too
             }
         }
-        else // progress in the list only if we dont need to delete this node
+        kept++;
+    }
+    int old_size = area->size;
+    epochBeginChange(&area->sequence);
+    __atomic_store_n(&area->records, kept_records, __ATOMIC_RELEASE);
+    __atomic_store_n(&area->size, kept, __ATOMIC_RELEASE);
+    epochEndChange(&area->sequence);
+    if (kept_records != old_records)
+    {//no reader that starts now finds the removed areas, the kept ones are in the same order in both arrays
+        for (int i = 0, j = 0; i < old_size; i++)
         {
-            tmp = tmp->next;
+            if (j < kept && kept_records[j].id == old_records[i].id)
+            {
+                j++;
+                continue;
+            }
+            tribeDestroy(old_records[i].tribe);//not recordDelete, the retired array is read as it is
+            destroyString(area->allocator, old_records[i].name);
         }
+        epochRetireBlock(area->epoch, area->allocator, old_records);
     }
+    allocatorDeallocate(area->allocator, loop.removed);
     return AREA_SUCCESS;
 }
 
 Map areaComputeAreasToTribesMapping(Area area)
 {
-    char* string_area_id, * tribe_max_vote_id;
-    Map map_of_max = mapCreate();//create the map of the mapped areas to tribes
+    char string_area_id[INT_STRING_SIZE], string_tribe_id[INT_STRING_SIZE];
+    if (area == NULL)
+    {
+        return mapCreate();
+    }
+    if (area->size == 0)//there are no areas
+    {
+        return mapCreateWithAllocator(area->allocator);
+    }
+    if (tribeGetMaxVotesForArea(area->totals) < 0)//there are no tribes, all areas have the same tribes
+    {
+        return mapCreateWithAllocator(area->allocator);
+    }
+    Map map_of_max = mapCreateWithCapacity(area->allocator, area->size);//create the map of the mapped areas to tribes
     if (map_of_max == NULL)
     {
         return NULL;
     }
-    if (area == NULL)
-    {
-        return map_of_max;
+    AreaLoop loop = {.area = area, .pairs = NULL};
+    if (area->scheduler != NULL && area->size > WINNERS_GRAIN)
+    {//the winners are found on all the threads first, without the scheduler or memory they are found in the loop
+        loop.pairs = allocatorAllocate(area->allocator, area->size * sizeof(*loop.pairs));
+        if (loop.pairs != NULL)
+        {
+            schedulerFor(area->scheduler, area->size, WINNERS_GRAIN, findWinnersInRange, &loop);
+        }
     }
-    MapResult result;
-    while (area != NULL)//do for all areas in the list
+    for (int i = 0; i < area->size; i++)//do for all areas in the list
     {
-        string_area_id = intToString(area->id);
-        tribe_max_vote_id = tribeGetMaxVotesForArea(area->tribe);// map the tribe with the most votes to the area
-        if (tribe_max_vote_id == NULL)
+        writeIntToString(area->records[i].id, string_area_id);
+        if (loop.pairs != NULL)
+        {
+            writeIntToString(loop.pairs[i].tribe_id, string_tribe_id);
+        }
+        else
         {
-            destroyString(string_area_id);
-            return map_of_max;
+            prefetchRecords(area, i);
+            writeIntToString(tribeGetMaxVotesForArea(area->records[i].tribe), string_tribe_id);// map the tribe with the most votes to the area
         }
-        result = mapPut(map_of_max, (const char*)string_area_id, (const char*)tribe_max_vote_id);
-        destroyString(string_area_id);
-        if (result != MAP_SUCCESS)//allocation failed
+        if (mapAppend(map_of_max, string_area_id, string_tribe_id) != MAP_SUCCESS)//area ids are unique
+        {
+            mapDestroy(map_of_max);
+            map_of_max = NULL;
+            break;
+        }
+    }
+    allocatorDeallocate(area->allocator, loop.pairs);
+    return map_of_max;
+}
+
+Map areaComputeAreasToTribesMappingInRange(Area area, int from_area_id, int to_area_id)
+{
+    return areaComputeAreasToTribesMappingInRangeOfLists(&area, 1, from_area_id, to_area_id);
+}
+
+Map areaComputeAreasToTribesMappingInRangeOfLists(Area* lists, int list_count, int from_area_id, int to_area_id)
+{
+    assert(lists != NULL && list_count > 0);
+    Map map_of_max = mapCreateOrdered(lists[0]->allocator);
+    if (map_of_max == NULL || tribeGetMaxVotesForArea(lists[0]->totals) < 0)//there are no tribes
+    {
+        return map_of_max;
+    }
+    for (int list = 0; list < list_count; list++)//the ordered map puts the areas of all the lists in order
+    {
+        if (!putRange(lists[list], map_of_max, from_area_id, to_area_id))
         {
             mapDestroy(map_of_max);
             return NULL;
         }
-        area = area->next;
+    }
+    return map_of_max;
+}
 
+AreaResult areaSetRegion(Area area, int area_id, int region_id)
+{
+    assert(area != NULL && area->index != NULL);
+    AreaRecord* area_to_set = getAreaById(area, area_id);
+    if (area_to_set == NULL)
+    {
+        return AREA_NOT_EXIST;
+    }
+    if (area_to_set->region == region_id)
+    {
+        return AREA_SUCCESS;
     }
+    if (area->regions == NULL)
+    {
+        area->regions = regionSetCreate(area->allocator, area->totals);
+        if (area->regions == NULL)
+        {
+            return AREA_OUT_OF_MEMORY;
+        }
+    }
+    if (region_id != ELECTION_NO_REGION &&
+        regionSetAddArea(area->regions, region_id, area_to_set->tribe) != REGION_SUCCESS)//the only step that allocates
+    {
+        return AREA_OUT_OF_MEMORY;
+    }
+    if (area_to_set->region != ELECTION_NO_REGION)
+    {
+        regionSetRemoveArea(area->regions, area_to_set->region, area_to_set->tribe);
+    }
+    area_to_set->region = region_id;
+    return AREA_SUCCESS;
+}
+
+Map areaComputeRegionsToTribesMapping(Area area)
+{
+    return areaComputeRegionsToTribesMappingOfLists(&area, 1);
+}
+
+Map areaComputeRegionsToTribesMappingOfLists(Area* lists, int list_count)
+{
+    assert(lists != NULL && list_count > 0 && lists[0]->index != NULL);
+    if (list_count == 1)
+    {
+        if (lists[0]->regions == NULL)//no area was ever put in a region
+        {
+            return mapCreateWithAllocator(lists[0]->allocator);
+        }
+        return regionSetComputeMapping(lists[0]->regions);
+    }
+    RegionSet merged = regionSetCreate(lists[0]->allocator, lists[0]->totals);
+    if (merged == NULL)
+    {
+        return NULL;
+    }
+    for (int list = 0; list < list_count; list++)//a region may have areas in many lists
+    {
+        if (lists[list]->regions != NULL && regionSetMerge(merged, lists[list]->regions) != REGION_SUCCESS)
+        {
+            regionSetDestroy(merged);
+            return NULL;
+        }
+    }
+    Map map_of_max = regionSetComputeMapping(merged);
+    regionSetDestroy(merged);
     return map_of_max;
 }
 
-/*
-getAreaById: get a pointer to the areas list and return a pointer to the area with the given id
-if no area with the specified id exists return NULL
-*/
-static Area getAreaById(Area area, int area_id)
+Map areaComputeSeats(Area area, ElectionSeatMethod method, int seats, double threshold)
 {
-    if (area == NULL)
+    return areaComputeSeatsOfLists(&area, 1, method, seats, threshold);
+}
+
+Map areaComputeSeatsOfLists(Area* lists, int list_count, ElectionSeatMethod method, int seats, double threshold)
+{
+    assert(lists != NULL && list_count > 0 && lists[0]->totals != NULL);
+    if (list_count == 1)
+    {
+        return seatsAllocate(lists[0]->allocator, lists[0]->totals, method, seats, threshold);
+    }
+    return areaComputeRegionSeatsOfLists(lists, list_count, ELECTION_NO_REGION, method, seats, threshold);
+}
+
+Map areaComputeRegionSeats(Area area, int region_id, ElectionSeatMethod method, int seats, double threshold)
+{
+    return areaComputeRegionSeatsOfLists(&area, 1, region_id, method, seats, threshold);
+}
+
+Map areaComputeRegionSeatsOfLists(Area* lists, int list_count, int region_id, ElectionSeatMethod method, int seats,
+                                  double threshold)
+{
+    assert(lists != NULL && list_count > 0 && lists[0]->index != NULL);
+    if (list_count == 1)
+    {
+        Tribe totals = lists[0]->regions == NULL ? NULL : regionSetGetTotals(lists[0]->regions, region_id);
+        if (totals == NULL)//the region has no areas
+        {
+            return mapCreateWithAllocator(lists[0]->allocator);
+        }
+        return seatsAllocate(lists[0]->allocator, totals, method, seats, threshold);
+    }
+    bool has_areas = region_id == ELECTION_NO_REGION;
+    for (int list = 0; list < list_count && !has_areas; list++)
+    {
+        has_areas = lists[list]->regions != NULL && regionSetGetTotals(lists[list]->regions, region_id) != NULL;
+    }
+    if (!has_areas)//the region has no areas in any of the lists
+    {
+        return mapCreateWithAllocator(lists[0]->allocator);
+    }
+    Tribe totals = mergeTotals(lists, list_count, region_id);
+    if (totals == NULL)
     {
         return NULL;
     }
-    Area tmp = area;
-    while (tmp != NULL)//run on all the areas
+    Map seats_map = seatsAllocate(lists[0]->allocator, totals, method, seats, threshold);
+    tribeDestroy(totals);
+    return seats_map;
+}
+
+void areaSetOverflowPolicy(Area area, ElectionOverflowPolicy policy)
+{
+    assert(area != NULL && area->index != NULL);
+    area->overflow = policy;
+}
+
+void areaSetScheduler(Area area, Scheduler scheduler)
+{
+    assert(area != NULL && area->index != NULL);
+    area->scheduler = scheduler;
+}
+
+void areaSetEpoch(Area area, Epoch epoch)
+{
+    assert(area != NULL && area->index != NULL);
+    area->epoch = epoch;
+    tribeSetEpoch(area->totals, epoch);//all the tables of the list, the regions too, are of the schema of the totals
+}
+
+AreaTribePair* areaReadAreasToTribesArray(Area* lists, int list_count, int* size)
+{
+    assert(lists != NULL && list_count > 0 && size != NULL);
+    *size = 0;
+    AreaTribePair* pairs = malloc(sizeof(*pairs));//the caller frees it with free
+    for (int list = 0; list < list_count && pairs != NULL; list++)
+    {
+        Area area = lists[list];
+        AreaRecord* records;
+        int count;
+        for (;;)//read again if the array changed while the array and its size were read
+        {
+            unsigned start = epochReadBegin(&area->sequence);
+            records = __atomic_load_n(&area->records, __ATOMIC_ACQUIRE);
+            count = __atomic_load_n(&area->size, __ATOMIC_ACQUIRE);
+            if (!epochReadRetry(&area->sequence, start))
+            {
+                break;
+            }
+        }
+        AreaTribePair* new_pairs = realloc(pairs, (*size + count + 1) * sizeof(*pairs));
+        if (new_pairs == NULL)
+        {
+            free(pairs);
+            *size = 0;
+            return NULL;
+        }
+        pairs = new_pairs;
+        //the records of the array don't change, a removal copies the kept ones and retires the array
+        for (int i = 0; i < count; i++)
+        {
+            int winner = tribeReadWinner(records[i].tribe);
+            if (winner >= 0)//a negative winner means there are no tribes
+            {
+                pairs[*size].area_id = records[i].id;
+                pairs[*size].tribe_id = winner;
+                (*size)++;
+            }
+        }
+    }
+    return pairs;
+}
+
+char* areaReadTribeName(Area area, int tribe_id)
+{
+    assert(area != NULL && area->index != NULL);
+    return tribeReadName(area->totals, tribe_id);//the totals have all the tribes of the areas
+}
+
+bool areaVisitResults(Area* lists, int list_count, ElectionResultVisitor visitor, void* context)
+{
+    assert(lists != NULL && list_count > 0 && visitor != NULL);
+    if (tribeGetMaxVotesForArea(lists[0]->totals) < 0)//there are no tribes, all the lists have the same tribes
+    {
+        return true;
+    }
+    ElectionAreaResult result;
+    for (int list = 0; list < list_count; list++)
     {
-        if (tmp->id == area_id)
+        Area area = lists[list];
+        for (int i = 0; i < area->size; i++)
         {
-            return tmp;
+            prefetchRecords(area, i);
+            AreaRecord* record = &area->records[i];
+            result.area_id = record->id;
+            result.area_name = record->name;
+            result.tribe_id = tribeGetMaxVotesForArea(record->tribe);
+            result.tribe_name = tribeFindName(area->totals, result.tribe_id);
+            result.votes = tribeGetVotes(record->tribe, result.tribe_id);
+            if (!visitor(&result, context))
+            {
+                return false;
+            }
         }
-        tmp = tmp->next;
     }
-    return NULL;
+    return true;
+}
+
+AreaResult areaFreeze(Area area, int area_id)
+{
+    assert(area != NULL && area->index != NULL);
+    AreaRecord* area_to_freeze = getAreaById(area, area_id);
+    if (area_to_freeze == NULL)
+    {
+        return AREA_NOT_EXIST;
+    }
+    return handleResult(tribeFreeze(area_to_freeze->tribe));
+}
+
+AreaResult areaGetVotes(Area area, int area_id, int tribe_id, int64_t* votes)
+{
+    assert(area != NULL && area->index != NULL && votes != NULL);
+    AreaRecord* record = getAreaById(area, area_id);
+    if (record == NULL)
+    {
+        return AREA_NOT_EXIST;
+    }
+    if (!tribeSchemaContains(area->totals, tribe_id))
+    {
+        return AREA_TRIBE_NOT_EXIST;
+    }
+    *votes = tribeGetVotes(record->tribe, tribe_id);//a tribe the table doesn't have has no votes in the area
+    return AREA_SUCCESS;
+}
+
+AreaTribePair* areaComputeAreasToTribesArray(Area area, int* size)
+{
+    assert(size != NULL);
+    *size = 0;
+    bool has_tribes = area != NULL && tribeGetMaxVotesForArea(area->totals) >= 0;
+    int count = has_tribes ? area->size : 0;
+    //one allocation for all the areas, with malloc since the caller frees it with free
+    AreaTribePair* pairs = malloc((count > 0 ? count : 1) * sizeof(*pairs));
+    if (pairs == NULL || count == 0)
+    {
+        return pairs;
+    }
+    AreaLoop loop = {.area = area, .pairs = pairs};
+    schedulerFor(area->scheduler, count, WINNERS_GRAIN, findWinnersInRange, &loop);
+    *size = count;
+    return pairs;
 }
 
 /*
-areaPutElemtnes: get an initialized area and update its elements by copying the given
-varibels (by value) if any memeory allocation failed return false otherwise true
+getAreaById: get a pointer to the areas list and return a pointer to the record of the area with the given id
+if no area with the specified id exists return NULL. the pointer is valid until an area is added or removed
 */
-static bool areaPutElemtnes(Area new_area, int area_id, const char* area_name)
+static AreaRecord* getAreaById(Area area, int area_id)
 {
-    new_area->id = area_id;
-    new_area->name = createString(strlen(area_name));//allocate memory for the area name
-    if (new_area->name == NULL)//check if allocation failed
+    if (area == NULL)
     {
-        return false;
+        return NULL;
     }
-    strcpy(new_area->name, area_name);//copy the name
-    return true;
+    assert(area->index != NULL);
+    void* position = idMapGet(area->index, area_id);
+    return position == NULL ? NULL : &area->records[VALUE_TO_POSITION(position)];
 }
 
 /*
-get a pointer to a area and free all of the area varibels and afterwards set them to NULL
+recordPutElements: fills the given record with the given id, a copy of the given name and an empty sparse
+table of the tribes of the list, in no region. if any memeory allocation failed return false
+and nothing is left allocated, otherwise true
 */
-static void areaElementsDelete(Area area)
+static bool recordPutElements(Area area, AreaRecord* record, int area_id, const char* area_name)
 {
-    assert(area != NULL);
-    if (area->tribe != NULL)
+    record->tribe = tribeCopyEmpty(area->totals);//no votes yet, so no tribes in the sparse table
+    if (record->tribe == NULL)
+    {
+        return false;
+    }
+    record->name = createString(area->allocator, strlen(area_name));//allocate memory for the area name
+    if (record->name == NULL)//check if allocation failed
     {
-        tribeDestroy(area->tribe);
+        tribeDestroy(record->tribe);
+        return false;
     }
-    area->next = NULL;
-    destroyString(area->name);
-    area->name = NULL;
-    area->id = UNDEFINED_ID;
+    strcpy(record->name, area_name);//copy the name
+    record->id = area_id;
+    record->region = ELECTION_NO_REGION;
+    return true;
+}
+
+/*
+frees the name and tribe table of the given record of the list
+*/
+static void recordDelete(Area area, AreaRecord* record)
+{
+    assert(record != NULL);
+    tribeDestroy(record->tribe);
+    destroyString(area->allocator, record->name);
+    record->tribe = NULL;
+    record->name = NULL;
 }
 
 /*
@@ -371,72 +817,203 @@ static AreaResult handleResult(TribeResult result)
         return AREA_TRIBE_ALREADY_EXIST;
     case TRIBE_ITEM_DOES_NOT_EXIST:
         return AREA_TRIBE_NOT_EXIST;
+    case TRIBE_VOTES_OVERFLOW:
+    case TRIBE_FROZEN:
+        return AREA_INVALID_VOTES;
     default:
         return AREA_SUCCESS;
     }
 }
 /*
-getFormerAreaNode get an area id and return a pointer to the node before the node with this id
-if there is no node with the given id, return NULL
+subtracts the votes of the removed area from the totals of the list and of its region
 */
-static Area getFormerAreaNode(Area area, int area_id)
+static void subtractArea(Area area, AreaRecord* removed)
 {
-    if (area == NULL || area->next == NULL)
+    tribeAddAllVotes(area->totals, removed->tribe, -1);
+    if (removed->region != ELECTION_NO_REGION)
     {
-        return NULL;
+        regionSetRemoveArea(area->regions, removed->region, removed->tribe);
     }
-    if (area->id == area_id)
+}
+/*
+growRecords: makes room for more records in the array of the list
+return false if allocation failed, the array is unchanged in that case
+*/
+static bool growRecords(Area area)
+{
+    int new_capacity = area->capacity == 0 ? INITIAL_CAPACITY : area->capacity * GROWTH_FACTOR;
+    AreaRecord* old_records = area->records;
+    AreaRecord* new_records = epochReallocate(area->epoch, area->allocator, old_records,
+                                              area->size * sizeof(*new_records), new_capacity * sizeof(*new_records));
+    if (new_records == NULL)
     {
-        return NULL;
+        return false;
+    }
+    epochBeginChange(&area->sequence);
+    __atomic_store_n(&area->records, new_records, __ATOMIC_RELEASE);
+    area->capacity = new_capacity;
+    epochEndChange(&area->sequence);
+    if (area->epoch != NULL)
+    {
+        epochRetireBlock(area->epoch, area->allocator, old_records);
+    }
+    return true;
+}
+/*
+prefetchRecords: called before the record in the given position is visited, so the tables of the areas
+ahead of it are in the cache when they are visited. the records are in order in the array, but the table
+of every area is elsewhere and is found through its record, so the table records are fetched two distances
+ahead and their votes one distance ahead, when their record is already in the cache
+*/
+static void prefetchRecords(Area area, int position)
+{
+    if (position + 2 * PREFETCH_DISTANCE < area->size)
+    {
+        tribePrefetch(area->records[position + 2 * PREFETCH_DISTANCE].tribe);
+    }
+    if (position + PREFETCH_DISTANCE < area->size)
+    {
+        tribePrefetchVotes(area->records[position + PREFETCH_DISTANCE].tribe);
+    }
+}
+/*
+compareIds: compare function of two ids for qsort and bsearch
+*/
+static int compareIds(const void* id1, const void* id2)
+{
+    int first = *(const int*)id1, second = *(const int*)id2;
+    return (first > second) - (first < second);
+}
+/*
+indexArea: adds the area in the given position of the list to the index and order of the list
+return false if allocation failed, the area isn't in either of them in that case
+*/
+static bool indexArea(Area area, int position)
+{
+    int area_id = area->records[position].id;
+    if (idMapPut(area->index, area_id, POSITION_TO_VALUE(position)) != ID_MAP_SUCCESS)
+    {
+        return false;
+    }
+    if (area->order != NULL && skipListPut(area->order, area_id, POSITION_TO_VALUE(position)) != SKIP_LIST_SUCCESS)
+    {
+        idMapRemove(area->index, area_id);
+        return false;
     }
-    while (area->next != NULL)
+    return true;
+}
+/*
+createOrder: creates the order of the list with all its areas
+return false if allocation failed, the list has no order in that case
+*/
+static bool createOrder(Area area)
+{
+    SkipList order = skipListCreate(area->allocator);
+    if (order == NULL)
     {
-        if (area->next->id == area_id)
+        return false;
+    }
+    for (int i = 0; i < area->size; i++)
+    {
+        if (skipListPut(order, area->records[i].id, POSITION_TO_VALUE(i)) != SKIP_LIST_SUCCESS)
         {
-            return area;
+            skipListDestroy(order);
+            return false;
         }
-        area = area->next;
     }
-    return NULL;
-    /*
-     if (area != NULL && area->next != NULL && area->id == undef)
+    area->order = order;
+    return true;
+}
+
+/*
+puts the areas of the list with ids in [from_area_id, to_area_id) and the tribes with most of their votes
+in the ordered map, the list is sorted by id by its first range query
+return false if allocation failed
+*/
+static bool putRange(Area area, Map map, int from_area_id, int to_area_id)
+{
+    char string_area_id[INT_STRING_SIZE], string_tribe_id[INT_STRING_SIZE];
+    if (area->order == NULL && !createOrder(area))
     {
-        while (area->next != NULL)
+        return false;
+    }
+    for (SkipListCursor cursor = skipListLowerBound(area->order, from_area_id);
+         cursor != NULL && skipListCursorKey(cursor) < to_area_id; cursor = skipListNext(cursor))
+    {//only the areas in the range are visited, in ascending order of their ids
+        AreaRecord* current = &area->records[VALUE_TO_POSITION(skipListCursorValue(cursor))];
+        writeIntToString(current->id, string_area_id);
+        writeIntToString(tribeGetMaxVotesForArea(current->tribe), string_tribe_id);
+        if (mapPut(map, string_area_id, string_tribe_id) != MAP_SUCCESS)
         {
-            if (area->next->id == area_id)
-            {
-                return area;
-            }
+            return false;
         }
     }
-    return NULL;
-    */
+    return true;
 }
+
 /*
-removeNodeArea: gets a pointer to the node before the node we want to remove from the list
-disconnect the node from the list and disallocates its elenents
+return a table with the sums of the totals of all the lists, or of the totals of the region with the
+given id in them unless it is ELECTION_NO_REGION. the table is of the schema of the first list and the
+sums stop at INT64_MAX, a region without areas has zero votes in it
+return NULL if allocation failed
 */
-static void removeNodeArea(Area area)
+static Tribe mergeTotals(Area* lists, int list_count, int region_id)
 {
-    Area toDelete = area->next;
-    area->next = area->next->next;//go over the node we want to delete
-    areaElementsDelete(toDelete);//free the node elements
-    free(toDelete);
+    Tribe merged = tribeCopyWithZeroVotes(lists[0]->totals);
+    if (merged == NULL)
+    {
+        return NULL;
+    }
+    for (int list = 0; list < list_count; list++)
+    {
+        Tribe totals = lists[list]->totals;
+        if (region_id != ELECTION_NO_REGION)
+        {
+            totals = lists[list]->regions == NULL ? NULL : regionSetGetTotals(lists[list]->regions, region_id);
+        }
+        if (totals != NULL)
+        {
+            tribeMergeTotals(merged, totals);
+        }
+    }
+    return merged;
 }
+
 /*
-swapArea: swaps between two area elements
+the body of the loop of areaRemoveTribesOfLists, removes the tribes from the tables of the areas in the range
 */
-static void swapArea(Area area1, Area area2)
+static void removeTribesInRange(int begin, int end, void* argument)
 {
-    char* tmp = area1->name;
-    area1->name = area2->name;
-    area2->name = tmp;
-    int tmp2 = area1->id;
-    area1->id = area2->id;
-    area2->id = tmp2;
-    Tribe tmp3 = area1->tribe;
-    area1->tribe = area2->tribe;
-    area2->tribe = tmp3;
+    AreaLoop* loop = argument;
+    for (int i = begin; i < end; i++)// each area has a tribe table of itself, it is compacted once for all the batch
+    {
+        prefetchRecords(loop->area, i);
+        tribeRemoveSortedEntries(loop->area->records[i].tribe, loop->sorted_ids, loop->count);
+    }
 }
 
+/*
+the body of the loop of areaRemove, checks the condition for the areas in the range
+*/
+static void checkConditionInRange(int begin, int end, void* argument)
+{
+    AreaLoop* loop = argument;
+    for (int i = begin; i < end; i++)
+    {
+        loop->removed[i] = loop->condition(loop->area->records[i].id);
+    }
+}
 
+/*
+the body of the loops that map the areas to their winners, finds the winners of the areas in the range
+*/
+static void findWinnersInRange(int begin, int end, void* argument)
+{
+    AreaLoop* loop = argument;
+    for (int i = begin; i < end; i++)
+    {
+        prefetchRecords(loop->area, i);
+        loop->pairs[i].area_id = loop->area->records[i].id;
+        loop->pairs[i].tribe_id = tribeGetMaxVotesForArea(loop->area->records[i].tribe);
+    }
+}
@@ -2,12 +2,16 @@
 #define MTM_AREA_H
 
 #include "election.h"
+#include "election_ext.h"
 #include "assist.h"
 #include "mtm_map/map.h"
+#include "scheduler.h"
+#include "epoch.h"
 
 /**
-*Implements an Area type as a list. area is a pointer of node with 3 elements,
-*area_id (int) and area_name (char*) and next(area)- a pointer to the next node.
+*Implements an Area type as a list. the areas are records of area_id (int), area_name (char*) and
+*a sparse tribe table of the tribes the area gave votes to, kept in one array in the order they were
+*added. area is a pointer to the list.
 *tribe_id is a positive number
 **/
 
@@ -28,12 +32,13 @@ typedef enum AreaResult_t {
 } AreaResult;
 
 /*
-*areaCreate: Allocates a new empty map.
+*areaCreate: Allocates a new empty map, the areas, tribes and maps of the list
+*are allocated with the given allocator, which has to outlive them
 *@return
 * 	NULL - if allocations failed.
 * 	A new Area in case of success.
 */
-Area areaCreate();
+Area areaCreate(const Allocator* allocator);
 /*
 * areaDestroy: Deallocates an existing area. Clears all elements.
 * @param area - Target area to be deallocated. If area is NULL nothing will be
@@ -50,7 +55,7 @@ void areaDestroy(Area area);
 AreaResult areaAddTribe(Area area, int tribe_id, const char* tribe_name);
 /*
 *areaAdd: add a new area to the area list.
-*to the added area a copy of the tribe map is created and initialized with zero vodts
+*the added area gets an empty table, where all the tribes have zero votes
 *@return
 *AREA_ALREADY_EXIST if an area with the same id exsits in the list
 *AREA_OUT_OF_MEMORY if any memory allocation failed
@@ -71,12 +76,14 @@ char* areaGetTribeName(Area area, int tribe_id);
 *@return
 *AREA_NOT_EXIST if there is no area with the given id in the areas list
 *AREA_TRIBE_NOT_EXIST if there is no tribe with the given id in the tribes map
+*AREA_INVALID_VOTES if the total votes of the tribe would overflow and the policy isn't to saturate,
+*or the area is frozen
 *AREA_OUT_OF_MEMORY if any memory allocation failed
 *AREA_SUCCESS if an area was succsessfully added to the list
 */
 AreaResult areaUpdateVote(Area area, int area_id, int tribe_id, int num_of_votes, UpdateVotesCondition condition);
-/*areaSetTribeName change the name of the tribe with the specified id, update the change is all the
-*areas since each one has its own tribes map
+/*areaSetTribeName change the name of the tribe with the specified id, the names are shared by all
+*the areas so no area is changed
 *name conssists only spaces and low letter case
 *@return
 *AREA_TRIBE_DOES_NOT_EXIST if there is no tribe with the give is the tribe map
@@ -92,9 +99,26 @@ AreaResult areaSetTribeName(Area area, int tribe_id, const char* tribe_name);
 */
 AreaResult areaRemoveTribe(Area area, int tribe_id);
 /*
-*areaRemove: removes areas from the list that thier id AreaConditionFunction return true for
+*areaRemoveTribes:
+*remove all the tribes with the given ids from all of the areas in the list, the tribe table of
+*every area is changed once for all the given ids. all the ids must be of existing tribes
 *@return
 *AREA_OUT_OF_MEMORY if any memory allocation failed
+*AREA_SUCCSESS if went well
+*/
+AreaResult areaRemoveTribes(Area area, const int* tribe_ids, int count);
+/*
+*areaRemoveTribesOfLists: like areaRemoveTribes but from every one of the given lists, which have the
+*same tribes, the ids are sorted once for all of them. removing one tribe doesn't allocate so it can't fail
+*@return
+*AREA_OUT_OF_MEMORY if any memory allocation failed, no tribe is removed in that case
+*AREA_SUCCSESS if went well
+*/
+AreaResult areaRemoveTribesOfLists(Area* lists, int list_count, const int* tribe_ids, int count);
+/*
+*areaRemove: removes areas from the list that thier id AreaConditionFunction return true for
+*@return
+*AREA_OUT_OF_MEMORY if any memory allocation failed, with an epoch (see areaSetEpoch) no area is removed then
 *AREA_SUCCSES otherwise
 */
 AreaResult areaRemove(Area area, AreaConditionFunction should_delete_area);
@@ -107,6 +131,134 @@ AreaResult areaRemove(Area area, AreaConditionFunction should_delete_area);
 */
 Map areaComputeAreasToTribesMapping(Area area);
 /*
+*areaComputeAreasToTribesMappingInRange:
+*like areaComputeAreasToTribesMapping but only for the areas with from_area_id <= id < to_area_id,
+*the result is an ordered map (see mapCreateOrdered). the first range query sorts the areas once,
+*from then on the order is kept up to date, the range is found in O(log n) and only the areas in it
+*are visited
+*in case of memory allocation fail return null
+*/
+Map areaComputeAreasToTribesMappingInRange(Area area, int from_area_id, int to_area_id);
+/*
+*areaComputeAreasToTribesMappingInRangeOfLists:
+*like areaComputeAreasToTribesMappingInRange but for the areas of all the given lists, which have the
+*same tribes, in one ordered map allocated with the allocator of the first list
+*in case of memory allocation fail return null
+*/
+Map areaComputeAreasToTribesMappingInRangeOfLists(Area* lists, int list_count, int from_area_id, int to_area_id);
+/*
+*areaComputeAreasToTribesArray:
+*like areaComputeAreasToTribesMapping but the result is an array of area id and tribe id pairs
+*in the order of the areas list, allocated at once. size is set to the number of pairs
+*in case of memory allocation fail return NULL
+*/
+AreaTribePair* areaComputeAreasToTribesArray(Area area, int* size);
+/*
+*areaSetRegion: puts the area with the given id in the region with the given id, or in no region if
+*region_id is ELECTION_NO_REGION. the votes of the area move from the totals of its old region to the
+*totals of the new one
+*@return
+*AREA_NOT_EXIST if there is no area with the given id
+*AREA_OUT_OF_MEMORY if allocation failed, the area stays in its region in that case
+*AREA_SUCCESS otherwise
+*/
+AreaResult areaSetRegion(Area area, int area_id, int region_id);
+/*
+*areaComputeRegionsToTribesMapping: return a map from the id of every region that has areas to the id of
+*the tribe with most votes in its areas, the lower tribe id in case of a tie. the totals of the regions are
+*kept up to date with every vote, so this is O(regions) and doesn't visit the areas
+*in case of memory allocation fail return null. if threre are no regions or tribes retuen an empty map
+*/
+Map areaComputeRegionsToTribesMapping(Area area);
+/*
+*areaComputeRegionsToTribesMappingOfLists: like areaComputeRegionsToTribesMapping but for the regions of
+*all the given lists, which have the same tribes. a region may have areas in many lists, its totals are
+*the sums of its totals in the lists, stopping at INT64_MAX. the map is allocated with the allocator of
+*the first list
+*in case of memory allocation fail return null
+*/
+Map areaComputeRegionsToTribesMappingOfLists(Area* lists, int list_count);
+/*
+*areaComputeSeats: return a map from every tribe id to its seats out of the given number of seats by the
+*given method, from the total votes of all the areas, see seatsAllocate in seats.h
+*in case of memory allocation fail return null. if threre are no tribes retuen an empty map
+*/
+Map areaComputeSeats(Area area, ElectionSeatMethod method, int seats, double threshold);
+/*
+*areaComputeSeatsOfLists: like areaComputeSeats but from the sums of the totals of all the given lists,
+*which have the same tribes, stopping at INT64_MAX. the map is allocated with the allocator of the first list
+*in case of memory allocation fail return null
+*/
+Map areaComputeSeatsOfLists(Area* lists, int list_count, ElectionSeatMethod method, int seats, double threshold);
+/*
+*areaComputeRegionSeats: like areaComputeSeats but from the total votes of the areas of the given region
+*in case of memory allocation fail return null. if threre are no tribes or the region has no areas
+*retuen an empty map
+*/
+Map areaComputeRegionSeats(Area area, int region_id, ElectionSeatMethod method, int seats, double threshold);
+/*
+*areaComputeRegionSeatsOfLists: like areaComputeRegionSeats but from the sums of the totals of the region
+*in all the given lists, see areaComputeSeatsOfLists
+*in case of memory allocation fail return null. if there are no tribes or the region has no areas in any
+*list retuen an empty map
+*/
+Map areaComputeRegionSeatsOfLists(Area* lists, int list_count, int region_id, ElectionSeatMethod method, int seats,
+                                  double threshold);
+/*
+*areaSetOverflowPolicy: sets what updating votes does when the total votes of a tribe in all the areas
+*would overflow an int64_t, areaUpdateVote returns AREA_INVALID_VOTES by default
+*/
+void areaSetOverflowPolicy(Area area, ElectionOverflowPolicy policy);
+/*
+*areaSetScheduler: sets the scheduler that runs the loops over all the areas of the list on its threads:
+*finding the winners of the areas, removing tribes from their tables and checking the condition of
+*areaRemove, which has to be thread safe then. NULL runs them on the calling thread, as by default
+*/
+void areaSetScheduler(Area area, Scheduler scheduler);
+/*
+*areaSetEpoch: sets the epoch of the readers of the list, other threads that call areaReadAreasToTribesArray
+*and areaReadTribeName as readers of the epoch while this thread changes the list. the arrays, tables and
+*tribe names the list stops using are retired to the epoch then, and areaRemove copies the kept areas to a
+*new array. NULL, the default, is for a list that only this thread reads
+*/
+void areaSetEpoch(Area area, Epoch epoch);
+/*
+*areaReadAreasToTribesArray: like areaComputeAreasToTribesArray of all the given lists, the areas of every list
+*after the areas of the lists before it, for a reader of the epoch of the lists while another thread changes
+*them. every list is read as it was at some moment during the call, and the winner of every area as it was
+*when it was read. it runs on the calling thread and allocates with malloc
+*in case of memory allocation fail return NULL
+*/
+AreaTribePair* areaReadAreasToTribesArray(Area* lists, int list_count, int* size);
+/*
+*areaReadTribeName: like areaGetTribeName, for a reader of the epoch of the list while another thread changes it
+*/
+char* areaReadTribeName(Area area, int tribe_id);
+/*
+*areaVisitResults: calls the visitor with the winner of every area of all the given lists, the areas of
+*every list after the areas of the lists before it, with the names of the area and the tribe from its list
+*@return
+*false if the visitor stopped the visit, true otherwise
+*/
+bool areaVisitResults(Area* lists, int list_count, ElectionResultVisitor visitor, void* context);
+/*
+*areaFreeze: packs the votes of the area with the given id into a compact block that can't be changed,
+*see tribeFreeze. the area is read as before, but updating its votes returns AREA_INVALID_VOTES
+*@return
+*AREA_NOT_EXIST if there is no area with the given id
+*AREA_OUT_OF_MEMORY if allocation failed, the area isn't frozen in that case
+*AREA_SUCCESS otherwise, also if the area was already frozen
+*/
+AreaResult areaFreeze(Area area, int area_id);
+/*
+*areaGetVotes: sets votes to the votes the tribe with the given id has in the area with the given id
+*@return
+*AREA_NOT_EXIST if there is no area with the given id
+*AREA_TRIBE_NOT_EXIST if there is no tribe with the given id
+*AREA_SUCCESS otherwise
+*/
+AreaResult areaGetVotes(Area area, int area_id, int tribe_id, int64_t* votes);
+/*
 get a list of areas and return true if an area with the given exists, otherwise return false
 */
 bool areaContains(Area area, int area_id);
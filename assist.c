@@ -1,77 +1,111 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "assist.h"
+#include "stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <string.h>
 #define END_OF_STRING '\0'
 #define BASE_TEN 10
 
-void destroyString(char *str);
-char *createString(int length);
-int addVotes(int votes, int votes_to_add);
-int removeVotes(int votes, int votes_to_remove);
-char *intToString(int number);
-int stringToInt(const char *str);
+void destroyString(const Allocator *allocator, char *str);
+char *createString(const Allocator *allocator, int length);
+bool addVotes(int64_t votes, int64_t votes_to_add, int64_t* result);
+bool removeVotes(int64_t votes, int64_t votes_to_remove, int64_t* result);
+char *intToString(const Allocator *allocator, int number);
+int writeIntToString(int number, char *buffer);
+int writeInt64ToString(int64_t number, char *buffer);
+int64_t stringToInt(const char *str);
 
-void destroyString(char *str)
+void destroyString(const Allocator *allocator, char *str)
 {
     if (str != NULL)
     {
-        free(str);
+        allocatorDeallocate(allocator, str);
+        STATS_FREE();
     }
     str = NULL;
 }
 
-char *createString(int length)
+char *createString(const Allocator *allocator, int length)
 {
-    char *new_str = malloc(length + 1);
+    char *new_str = allocatorAllocate(allocator, length + 1);
     if (new_str == NULL)
     {
         return NULL;
     }
+    STATS_ALLOC(STATS_SITE_CREATE_STRING, length + 1);
     new_str[length] = END_OF_STRING; //add '\0' in the last cell
     return new_str;
 }
 
-int addVotes(int votes, int votes_to_add)
+bool addVotes(int64_t votes, int64_t votes_to_add, int64_t* result)
 {
-    return votes + votes_to_add;
+    if (__builtin_add_overflow(votes, votes_to_add, result)) //one add and a jump on the overflow flag
+    {
+        *result = INT64_MAX;
+        return false;
+    }
+    return true;
 }
 
-int removeVotes(int votes, int votes_to_remove)
+bool removeVotes(int64_t votes, int64_t votes_to_remove, int64_t* result)
 {
-    return (votes - votes_to_remove) > 0 ? (votes - votes_to_remove) : 0;
+    *result = votes > votes_to_remove ? votes - votes_to_remove : 0; //both are not negative
+    return true;
 }
 
-char *intToString(int number)
+char *intToString(const Allocator *allocator, int number)
 {
-    int tmp = number, digits_num = 0, reverse = 0;
-    while (tmp > 0) //calculate the number of digits and reverse the number
+    char buffer[INT_STRING_SIZE];
+    int length = writeIntToString(number, buffer);
+    char *str = createString(allocator, length); //alloc a string in the size of the number
+    if (str == NULL)
     {
-        reverse *= BASE_TEN;
-        reverse += tmp % BASE_TEN;
-        digits_num++;
-        tmp /= BASE_TEN;
-    }
-    char *str = createString(digits_num); //alloc a string in the size of the number
-    int i=0;
-    while(i<digits_num){
-        str[i] = (reverse % BASE_TEN) + '0';
-        reverse /= BASE_TEN;
-        i++;
+        return NULL;
     }
+    strcpy(str, buffer);
     return str;
 }
 
-int stringToInt(const char *str)
+int writeIntToString(int number, char *buffer)
+{
+    return writeInt64ToString(number, buffer); //an int has at most INT_STRING_SIZE - 1 chars
+}
+
+int writeInt64ToString(int64_t number, char *buffer)
+{
+    uint64_t tmp = number < 0 ? -(uint64_t)number : (uint64_t)number;
+    char reverse[INT64_STRING_SIZE];
+    int first = INT64_STRING_SIZE - 1;
+    reverse[first] = END_OF_STRING;
+    do //calculate the digits from the end of the string, zero has one digit
+    {
+        reverse[--first] = (tmp % BASE_TEN) + '0';
+        tmp /= BASE_TEN;
+    } while (tmp > 0);
+    if (number < 0)
+    {
+        reverse[--first] = '-';
+    }
+    int length = INT64_STRING_SIZE - 1 - first;
+    memcpy(buffer, reverse + first, length + 1);
+    return length;
+}
+
+int64_t stringToInt(const char *str)
 {
-    int int_from_str = 0, cou = 0;
+    int64_t int_from_str = 0;
+    int cou = 0;
     assert(str != NULL);
     while (str[cou])
     {
-        int_from_str *= BASE_TEN;
-        int_from_str += (str[cou] - '0'); //value is in ASCII
+        if (__builtin_mul_overflow(int_from_str, BASE_TEN, &int_from_str) ||
+            __builtin_add_overflow(int_from_str, str[cou] - '0', &int_from_str)) //value is in ASCII
+        {
+            return INT64_MAX;
+        }
         cou++;
     }
     return int_from_str;
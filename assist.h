@@ -1,35 +1,59 @@
 #ifndef MTM_ASSIST_H
 #define MTM_ASSIST_H
+
+#include "allocator.h"
+#include <stdbool.h>
+#include <stdint.h>
+/*
+size of a string that can hold any int, including the sign and '\0'
+*/
+#define INT_STRING_SIZE 12
+/*
+size of a string that can hold any int64_t, including the sign and '\0'
+*/
+#define INT64_STRING_SIZE 21
 /*
-typdef for votes update operation (adding or removing)
+typdef for votes update operation (adding or removing), sets result to the updated votes
+and return false if they overflowed, result is the saturated votes in that case
 */
-typedef int (*UpdateVotesCondition)(int, int);
+typedef bool (*UpdateVotesCondition)(int64_t votes, int64_t num_of_votes, int64_t* result);
 /*
-gets a pointer to a string and disallocates it
+gets a pointer to a string and disallocates it with the allocator it was allocated with
 */
-void destroyString(char *str);
+void destroyString(const Allocator *allocator, char *str);
 /*
-allocates a string in the length+1 of the given int also add '\0' in the last cell
+allocates a string in the length+1 of the given int with the given allocator also add '\0' in the last cell
 return a pointer to the string if allocation failed return NULL
 */
-char *createString(int length);
+char *createString(const Allocator *allocator, int length);
 /*
 get the number of votes and add the given number
+return false if the sum overflowed, result is INT64_MAX in that case
 */
-int addVotes(int votes, int votes_to_add);
+bool addVotes(int64_t votes, int64_t votes_to_add, int64_t* result);
 /*
 get the number of votes and remove the given number if votes
-became a negative number return 0
+became a negative number the result is 0, removing never overflows
+*/
+bool removeVotes(int64_t votes, int64_t votes_to_remove, int64_t* result);
+/*
+get a number and return a string of the number allocated with the given allocator
+if allocation failed return NULL
+*/
+char *intToString(const Allocator *allocator, int number);
+/*
+write the given number as a string to the given buffer of at least INT_STRING_SIZE chars
+return the length of the string without the '\0'
 */
-int removeVotes(int votes, int votes_to_remove);
+int writeIntToString(int number, char *buffer);
 /*
-get a number and return a string of the number if allocation failed return NULL
+like writeIntToString but for an int64_t and a buffer of at least INT64_STRING_SIZE chars
 */
-char *intToString(int number);
+int writeInt64ToString(int64_t number, char *buffer);
 /*
-gets a string that contains only numbers and return an int
+gets a string that contains only numbers and return an int64_t, INT64_MAX if it is higher
 */
-int stringToInt(const char *str);
+int64_t stringToInt(const char *str);
 
 #endif //MTM_ASSIST_H
 
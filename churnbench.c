@@ -0,0 +1,103 @@
+#include "election.h"
+#include "election_ext.h"
+#include "allocator.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define DEFAULT_AREAS 1000000
+#define DEFAULT_BATCH 10000
+#define TRIBES 10
+#define NANOSECONDS_IN_MILLISECOND 1e6
+
+int main(int argc, char** argv);
+static bool parseCount(const char* value, int* count);
+static bool churn(Election election, int areas, int batch);
+static bool isAnyArea(int area_id);
+
+/*
+times adding and removing many areas in batches, so the area and tribe records are created and destroyed
+again and again, and counts the calls to the allocator that it takes
+*/
+int main(int argc, char** argv)
+{
+    int areas = DEFAULT_AREAS;
+    int batch = DEFAULT_BATCH;
+    if (argc > 3 || (argc > 1 && !parseCount(argv[1], &areas)) || (argc > 2 && !parseCount(argv[2], &batch)))
+    {
+        fprintf(stderr, "usage: %s [areas] [batch]\n"
+                "       adds the areas in batches and removes every batch before adding the next one,\n"
+                "       the defaults are %d areas in batches of %d\n", argv[0], DEFAULT_AREAS, DEFAULT_BATCH);
+        return EXIT_FAILURE;
+    }
+    CountingAllocator counting;
+    countingAllocatorInit(&counting, NULL);
+    Election election = electionCreateWithAllocator(&counting.allocator);
+    bool churned = election != NULL;
+    for (int tribe_id = 0; tribe_id < TRIBES && churned; tribe_id++)
+    {
+        churned = electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS;
+    }
+    long long allocations = counting.allocations + counting.reallocations;
+    long long started = statsNow();
+    churned = churned && churn(election, areas, batch);
+    long long elapsed = statsNow() - started;
+    allocations = counting.allocations + counting.reallocations - allocations;
+    electionDestroy(election);
+    if (!churned)
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    printf("%d areas added and removed in batches of %d, %d tribes\n", areas, batch, TRIBES);
+    printf("time: %.3f ms\n", elapsed / NANOSECONDS_IN_MILLISECOND);
+    printf("allocator calls: %lld (%.3f per area)\n", allocations, (double)allocations / areas);
+    return EXIT_SUCCESS;
+}
+
+/*
+sets count to the positive number in value, return false if value isn't one
+*/
+static bool parseCount(const char* value, int* count)
+{
+    char* end;
+    long parsed = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || parsed <= 0 || parsed > INT_MAX)
+    {
+        return false;
+    }
+    *count = (int)parsed;
+    return true;
+}
+
+/*
+adds the areas with ids 0 to areas - 1 a batch at a time, with a vote in every area, and removes all the
+areas of a batch before adding the next one. return false if memory allocation failed
+*/
+static bool churn(Election election, int areas, int batch)
+{
+    for (int first = 0; first < areas; first += batch)
+    {
+        int last = areas - first < batch ? areas : first + batch;
+        for (int area_id = first; area_id < last; area_id++)
+        {
+            if (electionAddArea(election, area_id, "area") != ELECTION_SUCCESS ||
+                electionAddVote(election, area_id, area_id % TRIBES, 1) != ELECTION_SUCCESS)
+            {
+                return false;
+            }
+        }
+        if (electionRemoveAreas(election, isAnyArea) != ELECTION_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool isAnyArea(int area_id)
+{
+    return true;
+}
@@ -1,33 +1,103 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include "mtm_map/map.h"         
+#include "mtm_map/map_ext.h"
 #include "election.h"
+#include "election_ext.h"
 #include "area.h"
 #include "assist.h"
 #include "tribe.h"
+#include "stats.h"
+#include "trace.h"
+#include "shard.h"
+#include "scheduler.h"
+#include "epoch.h"
+#include "export.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NAME_BLOCK_SIZE 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NAME_BLOCK_SIZE 16
+#endif
 
 
 #define SPACE ' '
 #define FIRST_LETTER 'a'
 #define LAST_LETTER 'z'
 
+/*
+the areas are split between the area lists of the shards by id, the area with id i is in the list of
+shard i % shard_count. every list has all the tribes, so anything about the tribes is read from the
+first one. workers has a worker for every shard, it is NULL if there is one shard.
+heaps has the heap of every shard that was given no allocator (see electionCreateSharded), the others are
+NULL. it is NULL if there is one shard.
+scheduler runs the loops over the areas of every shard on its threads, it is NULL if they run on the
+calling thread, see electionSetThreads.
+epoch is NULL while the election has no readers, reader_count is the number of its readers (see
+electionReaderCreate), the lists of all the shards retire to it what they stop using.
+trace is NULL unless the calls are traced, trace_start is the time the trace started
+removed_area_ids keeps the ids of the areas electionRemoveAreas removed while it is traced,
+removed_count is -1 if they didn't fit
+*/
 struct election_t
 {
-    Area area_list;
+    Area* shards;
+    int shard_count;
+    ShardHeap* heaps;
+    ShardPool workers;
+    Scheduler scheduler;
+    Epoch epoch;
+    int reader_count;
+    const Allocator* allocator;
+    TraceWriter trace;
+    long long trace_start;
+    int* removed_area_ids;
+    int removed_count;
+    int removed_capacity;
+};
+
+/*
+the election that electionRemoveAreas is tracing in this thread and the condition it was given,
+the condition function gets only an area id so they can't be passed to it
+*/
+static __thread Election traced_election;
+static __thread AreaConditionFunction traced_condition;
+
+/*
+a thread that reads the election while another thread changes it, reader is its place in the epoch
+*/
+struct election_reader_t
+{
+    Election election;
+    EpochReader reader;
 };
+
+/*
+the winners of the areas of every shard, computed by the workers
+*/
+typedef struct ShardWinners_t
+{
+    Election election;
+    AreaTribePair** pairs;
+    int* sizes;
+} ShardWinners;
 /**
 * Implements an Election type.
-* Election has a list of Areas each, Area has name (string) and id (id) and a map of tirbes
-*each tribe in the map has tribe id as a key and name+votes as one string
-*each area has a copy of all the existing tribes in the election systeme that keeps a record of the votes they got
-*from each tribe
+* The areas are split by id between the area lists of the shards, every list keeps its areas as records
+* in one array, each with its id, its name and a sparse tribe table of the votes it got, only the tribes
+* with votes are in the table.
+* The ids and names of the tribes are kept once in the schema of every list (see tribe.h), which all the
+* tables of the list share, and the totals of the list keep the votes of every tribe in all its areas.
 **/
 Election electionCreate();
+Election electionCreateWithAllocator(const Allocator* allocator);
+Election electionCreateSharded(int shards, const Allocator* const* allocators);
 void electionDestroy(Election election);
 ElectionResult electionAddTribe(Election election, int tribe_id, const char* tribe_name);
 ElectionResult electionAddArea(Election election, int area_id, const char* area_name);
@@ -38,25 +108,119 @@ ElectionResult electionSetTribeName(Election election, int tribe_id, const char*
 ElectionResult electionRemoveTribe(Election election, int tribe_id);
 ElectionResult electionRemoveAreas(Election election, AreaConditionFunction should_delete_area);
 Map electionComputeAreasToTribesMapping(Election election);
+ElectionResult electionRemoveTribes(Election election, const int* tribe_ids, int count);
+ElectionResult electionSetTribeNames(Election election, const TribeNamePair* pairs, int count);
+AreaTribePair* electionComputeAreasToTribesArray(Election election, int* size);
+Map electionComputeAreasToTribesMappingInRange(Election election, int from_area_id, int to_area_id);
+ElectionResult electionGetStats(Election election, ElectionStats* stats);
+ElectionResult electionSetAreaRegion(Election election, int area_id, int region_id);
+Map electionComputeRegionsToTribesMapping(Election election);
+Map electionComputeSeats(Election election, ElectionSeatMethod method, int seats, double threshold);
+Map electionComputeRegionSeats(Election election, int region_id, ElectionSeatMethod method, int seats,
+                               double threshold);
+ElectionResult electionSetOverflowPolicy(Election election, ElectionOverflowPolicy policy);
+ElectionResult electionFreezeArea(Election election, int area_id);
+ElectionResult electionGetVotes(Election election, int area_id, int tribe_id, int64_t* votes);
+ElectionResult electionSetThreads(Election election, int threads);
+ElectionResult electionStartTrace(Election election, FILE* stream);
+ElectionResult electionStopTrace(Election election);
+ElectionReader electionReaderCreate(Election election);
+void electionReaderDestroy(ElectionReader reader);
+char* electionReaderGetTribeName(ElectionReader reader, int tribe_id);
+Map electionReaderComputeAreasToTribesMapping(ElectionReader reader);
+ElectionResult electionVisitResults(Election election, ElectionResultVisitor visitor, void* context);
+ElectionExportResult electionExportResults(Election election, ElectionExportFormat format, FILE* stream);
+static ElectionResult addTribe(Election election, int tribe_id, const char* tribe_name);
+static ElectionResult addArea(Election election, int area_id, const char* area_name);
+static ElectionResult updateVote(Election election, int area_id, int tribe_id, int num_of_votes,
+                                 UpdateVotesCondition condition);
+static ElectionResult setTribeName(Election election, int tribe_id, const char* tribe_name);
+static ElectionResult removeTribe(Election election, int tribe_id);
+static ElectionResult removeAreas(Election election, AreaConditionFunction should_delete_area);
+static const Allocator* shardAllocator(const Allocator* const* allocators, int shard);
+static bool createShard(Election election, int shard, int nodes, const Allocator* const* allocators);
+static void destroyShardHeaps(Election election);
+static Area shardOf(Election election, int area_id);
+static void setShardsScheduler(Election election, Scheduler scheduler);
+static void setShardsEpoch(Election election, Epoch epoch);
+static void stopReaders(Election election);
+static AreaResult setNameInShards(Election election, int tribe_id, const char* tribe_name);
+static bool computeWinners(Election election, ShardWinners* winners);
+static void computeShardWinners(int shard, void* argument);
+static void destroyWinners(Election election, ShardWinners* winners);
+static Map computeShardedMapping(Election election);
+static AreaTribePair* computeShardedArray(Election election, int* size);
+static bool isTracing(Election election);
+static long long traceNow(Election election);
+static void traceCall(Election election, TraceRecord* record, long long started);
+static bool traceRemovedArea(int area_id);
 static bool isValidVotes(int num_of_votes);
+static bool isValidSeatRule(ElectionSeatMethod method, int seats, double threshold);
 static bool isValidId(int id);
 static bool isValidName(const char* name);
+#ifdef NAME_BLOCK_SIZE
+static bool isValidNameBlock(const char* block);
+#endif
 static ElectionResult isAddArgumentsValid(Election election, int id, const char* name);
 static ElectionResult handleResult(AreaResult result);
 
 Election electionCreate()
 {
-    Election election = malloc(sizeof(*election));
+    return electionCreateWithAllocator(NULL);
+}
+
+Election electionCreateWithAllocator(const Allocator* allocator)
+{
+    return electionCreateSharded(1, &allocator);
+}
+
+Election electionCreateSharded(int shards, const Allocator* const* allocators)
+{
+    if (shards <= 0)
+    {
+        return NULL;
+    }
+    const Allocator* allocator = shardAllocator(allocators, 0);
+    Election election = allocatorAllocate(allocator, sizeof(*election));
     if (election == NULL)
     {
         return NULL;
     }
-    election->area_list = areaCreate();
-    if (election->area_list == NULL)
+    election->allocator = allocator;
+    election->shard_count = 0;
+    election->workers = NULL;
+    election->scheduler = NULL;
+    election->epoch = NULL;
+    election->reader_count = 0;
+    election->trace = NULL;
+    election->removed_area_ids = NULL;
+    election->removed_capacity = 0;
+    election->heaps = NULL;
+    election->shards = allocatorAllocate(allocator, shards * sizeof(*election->shards));
+    if (election->shards == NULL ||
+        (shards > 1 && (election->heaps = allocatorAllocate(allocator, shards * sizeof(*election->heaps))) == NULL))
     {
-        free(election);
+        electionDestroy(election);
         return NULL;
     }
+    int nodes = shards > 1 ? shardNodeCount() : 1;
+    for (; election->shard_count < shards; election->shard_count++)
+    {
+        if (!createShard(election, election->shard_count, nodes, allocators))
+        {
+            electionDestroy(election);
+            return NULL;
+        }
+    }
+    if (shards > 1)
+    {
+        election->workers = shardPoolCreate(shards, allocator);
+        if (election->workers == NULL)
+        {
+            electionDestroy(election);
+            return NULL;
+        }
+    }
     return election;
 }
 
@@ -64,77 +228,212 @@ void electionDestroy(Election election)
 {
     if (election != NULL)
     {
-        areaDestroy(election->area_list);
-        free(election);
+        electionStopTrace(election);
+        shardPoolDestroy(election->workers);
+        schedulerDestroy(election->scheduler);
+        assert(election->reader_count == 0);
+        stopReaders(election);//before the lists, what they retired is released with their schemas
+        for (int i = 0; i < election->shard_count; i++)
+        {
+            areaDestroy(election->shards[i]);
+        }
+        destroyShardHeaps(election);//after the lists, their memory is in the heaps
+        allocatorDeallocate(election->allocator, election->shards);
+        allocatorDeallocate(election->allocator, election);
     }
 }
 
 ElectionResult electionAddTribe(Election election, int tribe_id, const char* tribe_name)
+{
+    STATS_TIMER_START(timer);
+    long long started = traceNow(election);
+    ElectionResult result = addTribe(election, tribe_id, tribe_name);
+    STATS_TIMER_STOP(STATS_ADD_TRIBE, timer);
+    if (isTracing(election))
+    {
+        TraceRecord record = {.operation = TRACE_ADD_TRIBE, .result = result, .tribe_id = tribe_id,
+                              .name = tribe_name};
+        traceCall(election, &record, started);
+    }
+    return result;
+}
+
+ElectionResult electionAddArea(Election election, int area_id, const char* area_name)
+{
+    STATS_TIMER_START(timer);
+    long long started = traceNow(election);
+    ElectionResult result = addArea(election, area_id, area_name);
+    STATS_TIMER_STOP(STATS_ADD_AREA, timer);
+    if (isTracing(election))
+    {
+        TraceRecord record = {.operation = TRACE_ADD_AREA, .result = result, .area_id = area_id,
+                              .name = area_name};
+        traceCall(election, &record, started);
+    }
+    return result;
+}
+
+/*
+adds a tribe to all the areas, electionAddTribe without the timing
+*/
+static ElectionResult addTribe(Election election, int tribe_id, const char* tribe_name)
 {
     ElectionResult result_arguments_valid = isAddArgumentsValid(election, tribe_id, tribe_name);
     if (result_arguments_valid == ELECTION_NULL_ARGUMENT || result_arguments_valid == ELECTION_INVALID_ID)
     {
         return result_arguments_valid;
     }
-    if (areaTribeContains(election->area_list, tribe_id))
+    if (result_arguments_valid != ELECTION_SUCCESS)//an existing tribe is reported before an invalid name
     {
-        return ELECTION_TRIBE_ALREADY_EXIST;
+        return areaTribeContains(election->shards[0], tribe_id) ? ELECTION_TRIBE_ALREADY_EXIST :
+               result_arguments_valid;
     }
-    if (result_arguments_valid != ELECTION_SUCCESS)
+    for (int i = 0; i < election->shard_count; i++)//every shard has all the tribes
     {
-        return result_arguments_valid;
+        AreaResult result = areaAddTribe(election->shards[i], tribe_id, tribe_name);//looks for the tribe once
+        if (result != AREA_SUCCESS)
+        {
+            if (i > 0)
+            {
+                areaRemoveTribesOfLists(election->shards, i, &tribe_id, 1);//one tribe, so it doesn't fail
+            }
+            return handleResult(result);
+        }
     }
-    AreaResult result = areaAddTribe(election->area_list, tribe_id, tribe_name);
-    return handleResult(result);
+    return ELECTION_SUCCESS;
 }
 
-ElectionResult electionAddArea(Election election, int area_id, const char* area_name)
+/*
+adds an area to the list, electionAddArea without the timing
+*/
+static ElectionResult addArea(Election election, int area_id, const char* area_name)
 {
     ElectionResult result_arguments_valid = isAddArgumentsValid(election, area_id, area_name);
     if (result_arguments_valid == ELECTION_NULL_ARGUMENT || result_arguments_valid == ELECTION_INVALID_ID)
     {
         return result_arguments_valid;
     }
-    if (areaContains(election->area_list, area_id))
+    if (result_arguments_valid != ELECTION_SUCCESS)//an existing area is reported before an invalid name
     {
-        return ELECTION_AREA_ALREADY_EXIST;
+        return areaContains(shardOf(election, area_id), area_id) ? ELECTION_AREA_ALREADY_EXIST :
+               result_arguments_valid;
     }
-    if (result_arguments_valid != ELECTION_SUCCESS)
-    {
-        return result_arguments_valid;
-    }
-    AreaResult result = areaAdd(election->area_list, area_id, area_name);
+    AreaResult result = areaAdd(shardOf(election, area_id), area_id, area_name);//looks for the area once
     return handleResult(result);
 }
 
 char* electionGetTribeName(Election election, int tribe_id)
 {
-    if (election == NULL || !isValidId(tribe_id))
+    if (election == NULL)
     {
         return NULL;
     }
-    return areaGetTribeName(election->area_list, tribe_id);
+    long long started = traceNow(election);
+    char* name = isValidId(tribe_id) ? areaGetTribeName(election->shards[0], tribe_id) : NULL;
+    if (isTracing(election))
+    {
+        TraceRecord record = {.operation = TRACE_GET_TRIBE_NAME, .tribe_id = tribe_id,
+                              .result = name != NULL ? ELECTION_SUCCESS : ELECTION_TRIBE_NOT_EXIST};
+        traceCall(election, &record, started);
+    }
+    return name;
 }
 
 ElectionResult electionAddVote(Election election, int area_id, int tribe_id, int num_of_votes)
 {
-    if (election == NULL)
+    STATS_TIMER_START(timer);
+    long long started = traceNow(election);
+    ElectionResult result = updateVote(election, area_id, tribe_id, num_of_votes, addVotes);
+    STATS_TIMER_STOP(STATS_ADD_VOTE, timer);
+    if (isTracing(election))
     {
-        return ELECTION_NULL_ARGUMENT;
+        TraceRecord record = {.operation = TRACE_ADD_VOTE, .result = result, .area_id = area_id,
+                              .tribe_id = tribe_id, .num_of_votes = num_of_votes};
+        traceCall(election, &record, started);
     }
-    if (!isValidId(area_id) || !isValidId(tribe_id))
+    return result;
+}
+
+ElectionResult electionRemoveVote(Election election, int area_id, int tribe_id, int num_of_votes)
+{
+    long long started = traceNow(election);
+    ElectionResult result = updateVote(election, area_id, tribe_id, num_of_votes, removeVotes);
+    if (isTracing(election))
     {
-        return ELECTION_INVALID_ID;
+        TraceRecord record = {.operation = TRACE_REMOVE_VOTE, .result = result, .area_id = area_id,
+                              .tribe_id = tribe_id, .num_of_votes = num_of_votes};
+        traceCall(election, &record, started);
     }
-    if (!isValidVotes(num_of_votes))
+    return result;
+}
+
+/*
+return true if the calls to the election are traced
+*/
+static bool isTracing(Election election)
+{
+    return election != NULL && election->trace != NULL;
+}
+
+/*
+return the time for the timestamp of a call, only read if the calls are traced
+*/
+static long long traceNow(Election election)
+{
+    return isTracing(election) ? statsNow() : 0;
+}
+
+/*
+writes the record of a call that started at the given time to the trace
+a record that can't be written or an electionRemoveAreas whose areas didn't fit stops the trace,
+so a trace never has gaps
+*/
+static void traceCall(Election election, TraceRecord* record, long long started)
+{
+    record->timestamp_ns = started - election->trace_start;
+    if ((record->operation == TRACE_REMOVE_AREAS && record->area_count < 0) ||
+        traceWrite(election->trace, record) != TRACE_SUCCESS)
     {
-        return ELECTION_INVALID_VOTES;
+        electionStopTrace(election);
     }
-    AreaResult result = areaUpdateVote(election->area_list, area_id, tribe_id, num_of_votes, addVotes);
-    return handleResult(result);
 }
 
-ElectionResult electionRemoveVote(Election election, int area_id, int tribe_id, int num_of_votes)
+/*
+the condition electionRemoveAreas gives the areas while it is traced, calls the condition it was given
+and keeps the ids of the areas that are removed
+*/
+static bool traceRemovedArea(int area_id)
+{
+    Election election = traced_election;
+    if (!traced_condition(area_id))
+    {
+        return false;
+    }
+    if (election->removed_count < 0)
+    {
+        return true;
+    }
+    if (election->removed_count == election->removed_capacity)
+    {
+        int capacity = election->removed_capacity > 0 ? 2 * election->removed_capacity : 1;
+        int* ids = allocatorReallocate(election->allocator, election->removed_area_ids, capacity * sizeof(*ids));
+        if (ids == NULL)
+        {
+            election->removed_count = -1;
+            return true;
+        }
+        election->removed_area_ids = ids;
+        election->removed_capacity = capacity;
+    }
+    election->removed_area_ids[election->removed_count++] = area_id;
+    return true;
+}
+
+/*
+validates the arguments of adding or removing votes and updates the votes by the given condition
+*/
+static ElectionResult updateVote(Election election, int area_id, int tribe_id, int num_of_votes,
+                                 UpdateVotesCondition condition)
 {
     if (election == NULL)
     {
@@ -148,30 +447,57 @@ ElectionResult electionRemoveVote(Election election, int area_id, int tribe_id,
     {
         return ELECTION_INVALID_VOTES;
     }
-    AreaResult result = areaUpdateVote(election->area_list, area_id, tribe_id, num_of_votes, removeVotes);
+    AreaResult result = areaUpdateVote(shardOf(election, area_id), area_id, tribe_id, num_of_votes, condition);
     return handleResult(result);
 }
 
 ElectionResult electionSetTribeName(Election election, int tribe_id, const char* tribe_name)
+{
+    long long started = traceNow(election);
+    ElectionResult result = setTribeName(election, tribe_id, tribe_name);
+    if (isTracing(election))
+    {
+        TraceRecord record = {.operation = TRACE_SET_TRIBE_NAME, .result = result, .tribe_id = tribe_id,
+                              .name = tribe_name};
+        traceCall(election, &record, started);
+    }
+    return result;
+}
+
+/*
+sets the name of a tribe, electionSetTribeName without the tracing
+*/
+static ElectionResult setTribeName(Election election, int tribe_id, const char* tribe_name)
 {
     ElectionResult result_arguments_valid = isAddArgumentsValid(election, tribe_id, tribe_name);
     if (result_arguments_valid == ELECTION_NULL_ARGUMENT || result_arguments_valid == ELECTION_INVALID_ID)
     {
         return result_arguments_valid;
     }
-    if (!areaTribeContains(election->area_list, tribe_id))
+    if (result_arguments_valid != ELECTION_SUCCESS)//a missing tribe is reported before an invalid name
     {
-        return ELECTION_TRIBE_NOT_EXIST;
+        return areaTribeContains(election->shards[0], tribe_id) ? result_arguments_valid :
+               ELECTION_TRIBE_NOT_EXIST;
     }
-    if (result_arguments_valid != ELECTION_SUCCESS)
+    return handleResult(setNameInShards(election, tribe_id, tribe_name));
+}
+
+ElectionResult electionRemoveTribe(Election election, int tribe_id)
+{
+    long long started = traceNow(election);
+    ElectionResult result = removeTribe(election, tribe_id);
+    if (isTracing(election))
     {
-        return result_arguments_valid;
+        TraceRecord record = {.operation = TRACE_REMOVE_TRIBE, .result = result, .tribe_id = tribe_id};
+        traceCall(election, &record, started);
     }
-    AreaResult result = areaSetTribeName(election->area_list, tribe_id, tribe_name);
-    return handleResult(result);
+    return result;
 }
 
-ElectionResult electionRemoveTribe(Election election, int tribe_id)
+/*
+removes a tribe from all the areas, electionRemoveTribe without the tracing
+*/
+static ElectionResult removeTribe(Election election, int tribe_id)
 {
     if (election == NULL)
     {
@@ -181,7 +507,11 @@ ElectionResult electionRemoveTribe(Election election, int tribe_id)
     {
         return ELECTION_INVALID_ID;
     }
-    AreaResult result = areaRemoveTribe(election->area_list, tribe_id);
+    if (!areaTribeContains(election->shards[0], tribe_id))
+    {
+        return ELECTION_TRIBE_NOT_EXIST;
+    }
+    AreaResult result = areaRemoveTribesOfLists(election->shards, election->shard_count, &tribe_id, 1);
     return handleResult(result);
 }
 
@@ -191,8 +521,273 @@ ElectionResult electionRemoveAreas(Election election, AreaConditionFunction shou
     {
         return ELECTION_NULL_ARGUMENT;
     }
-    AreaResult result = areaRemove(election->area_list, should_delete_area);
-    return handleResult(result);
+    STATS_TIMER_START(timer);
+    long long started = traceNow(election);
+    ElectionResult result;
+    if (isTracing(election) && should_delete_area != NULL)
+    {
+        traced_election = election;
+        traced_condition = should_delete_area;
+        election->removed_count = 0;
+        setShardsScheduler(election, NULL);//traceRemovedArea keeps the ids in this thread
+        result = removeAreas(election, traceRemovedArea);
+        setShardsScheduler(election, election->scheduler);
+        traced_election = NULL;
+        TraceRecord record = {.operation = TRACE_REMOVE_AREAS, .result = result,
+                              .area_ids = election->removed_area_ids, .area_count = election->removed_count};
+        traceCall(election, &record, started);
+    }
+    else
+    {
+        result = removeAreas(election, should_delete_area);
+    }
+    STATS_TIMER_STOP(STATS_REMOVE_AREAS, timer);
+    return result;
+}
+
+/*
+removes the areas the condition holds for, electionRemoveAreas without the timing and the tracing
+*/
+static ElectionResult removeAreas(Election election, AreaConditionFunction should_delete_area)
+{
+    for (int i = 0; i < election->shard_count; i++)//one shard after the other, the condition may not be thread safe
+    {
+        AreaResult result = areaRemove(election->shards[i], should_delete_area);
+        if (result != AREA_SUCCESS)
+        {
+            return handleResult(result);
+        }
+    }
+    return ELECTION_SUCCESS;
+}
+
+/*
+return the allocator of the given shard, the default allocator if there is none
+*/
+static const Allocator* shardAllocator(const Allocator* const* allocators, int shard)
+{
+    if (allocators == NULL || allocators[shard] == NULL)
+    {
+        return allocatorDefault();
+    }
+    return allocators[shard];
+}
+
+/*
+creates the list of the given shard out of the given number of nodes. a shard of an election with heaps
+that has no allocator of its own gets a heap of the memory of node shard % nodes for its list
+return false if memory allocation failed, nothing of the shard is left allocated in that case
+*/
+static bool createShard(Election election, int shard, int nodes, const Allocator* const* allocators)
+{
+    const Allocator* allocator = shardAllocator(allocators, shard);
+    if (election->heaps != NULL)
+    {
+        bool own = allocators == NULL || allocators[shard] == NULL;
+        election->heaps[shard] = own ? shardHeapCreate(shard % nodes, election->allocator) : NULL;
+        if (own && election->heaps[shard] == NULL)
+        {
+            return false;
+        }
+        allocator = own ? shardHeapAllocator(election->heaps[shard]) : allocator;
+    }
+    election->shards[shard] = areaCreate(allocator);
+    if (election->shards[shard] == NULL && election->heaps != NULL)
+    {
+        shardHeapDestroy(election->heaps[shard]);
+    }
+    return election->shards[shard] != NULL;
+}
+
+/*
+destroys the heaps of the shards, every shard list has to be destroyed first
+*/
+static void destroyShardHeaps(Election election)
+{
+    if (election->heaps == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        shardHeapDestroy(election->heaps[i]);
+    }
+    allocatorDeallocate(election->allocator, election->heaps);
+}
+
+/*
+return the list of the shard that has the area with the given id, which isn't negative
+*/
+static Area shardOf(Election election, int area_id)
+{
+    return election->shards[area_id % election->shard_count];
+}
+
+/*
+sets the scheduler of the lists of all the shards
+*/
+static void setShardsScheduler(Election election, Scheduler scheduler)
+{
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        areaSetScheduler(election->shards[i], scheduler);
+    }
+}
+
+/*
+sets the epoch of the lists of all the shards
+*/
+static void setShardsEpoch(Election election, Epoch epoch)
+{
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        areaSetEpoch(election->shards[i], epoch);
+    }
+}
+
+/*
+called when the election has no readers, the lists deallocate what they stop using right away again
+and the epoch is destroyed with everything that was retired to it
+*/
+static void stopReaders(Election election)
+{
+    setShardsEpoch(election, NULL);
+    epochDestroy(election->epoch);
+    election->epoch = NULL;
+}
+
+/*
+sets the name of the tribe in every shard, the first shard last since the names are read from it,
+so if it fails the name that is read doesn't change
+*/
+static AreaResult setNameInShards(Election election, int tribe_id, const char* tribe_name)
+{
+    for (int i = election->shard_count - 1; i >= 0; i--)
+    {
+        AreaResult result = areaSetTribeName(election->shards[i], tribe_id, tribe_name);
+        if (result != AREA_SUCCESS)
+        {
+            return result;
+        }
+    }
+    return AREA_SUCCESS;
+}
+
+/*
+has the workers compute the winners of the areas of all the shards at once, every shard on the node
+of its memory
+return false if allocation failed, nothing is left allocated in that case
+*/
+static bool computeWinners(Election election, ShardWinners* winners)
+{
+    winners->election = election;
+    winners->pairs = allocatorAllocate(election->allocator, election->shard_count * sizeof(*winners->pairs));
+    winners->sizes = allocatorAllocate(election->allocator, election->shard_count * sizeof(*winners->sizes));
+    if (winners->pairs == NULL || winners->sizes == NULL)
+    {
+        allocatorDeallocate(election->allocator, winners->pairs);
+        allocatorDeallocate(election->allocator, winners->sizes);
+        return false;
+    }
+    shardPoolRun(election->workers, computeShardWinners, winners);
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        if (winners->pairs[i] == NULL)
+        {
+            destroyWinners(election, winners);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+the task of the worker of a shard, computes the winners of the areas of the shard
+*/
+static void computeShardWinners(int shard, void* argument)
+{
+    ShardWinners* winners = argument;
+    winners->pairs[shard] = areaComputeAreasToTribesArray(winners->election->shards[shard], &winners->sizes[shard]);
+}
+
+/*
+deallocates the winners of the shards
+*/
+static void destroyWinners(Election election, ShardWinners* winners)
+{
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        free(winners->pairs[i]);//allocated with malloc, see areaComputeAreasToTribesArray
+    }
+    allocatorDeallocate(election->allocator, winners->pairs);
+    allocatorDeallocate(election->allocator, winners->sizes);
+}
+
+/*
+electionComputeAreasToTribesMapping of an election with more than one shard, the winners of the
+shards are computed at once and merged into one map, the areas of every shard after the areas of the
+shards before it
+*/
+static Map computeShardedMapping(Election election)
+{
+    char string_area_id[INT_STRING_SIZE], string_tribe_id[INT_STRING_SIZE];
+    ShardWinners winners;
+    if (!computeWinners(election, &winners))
+    {
+        return NULL;
+    }
+    int size = 0;
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        size += winners.sizes[i];
+    }
+    Map map_of_max = size > 0 ? mapCreateWithCapacity(election->allocator, size) :
+                     mapCreateWithAllocator(election->allocator);
+    for (int i = 0; i < election->shard_count && map_of_max != NULL; i++)
+    {
+        for (int j = 0; j < winners.sizes[i]; j++)
+        {
+            writeIntToString(winners.pairs[i][j].area_id, string_area_id);
+            writeIntToString(winners.pairs[i][j].tribe_id, string_tribe_id);
+            if (mapAppend(map_of_max, string_area_id, string_tribe_id) != MAP_SUCCESS)//the shards have other areas
+            {
+                mapDestroy(map_of_max);
+                map_of_max = NULL;
+                break;
+            }
+        }
+    }
+    destroyWinners(election, &winners);
+    return map_of_max;
+}
+
+/*
+electionComputeAreasToTribesArray of an election with more than one shard, like computeShardedMapping
+*/
+static AreaTribePair* computeShardedArray(Election election, int* size)
+{
+    ShardWinners winners;
+    *size = 0;
+    if (!computeWinners(election, &winners))
+    {
+        return NULL;
+    }
+    int count = 0;
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        count += winners.sizes[i];
+    }
+    AreaTribePair* pairs = malloc((count > 0 ? count : 1) * sizeof(*pairs));//the caller frees it with free
+    if (pairs != NULL)
+    {
+        for (int i = 0; i < election->shard_count; i++)
+        {
+            memcpy(pairs + *size, winners.pairs[i], winners.sizes[i] * sizeof(*pairs));
+            *size += winners.sizes[i];
+        }
+    }
+    destroyWinners(election, &winners);
+    return pairs;
 }
 
 Map electionComputeAreasToTribesMapping(Election election)
@@ -201,8 +796,370 @@ Map electionComputeAreasToTribesMapping(Election election)
     {
         return NULL;
     }
-    return areaComputeAreasToTribesMapping(election->area_list);
+    STATS_TIMER_START(timer);
+    long long started = traceNow(election);
+    Map map = election->shard_count == 1 ? areaComputeAreasToTribesMapping(election->shards[0]) :
+              computeShardedMapping(election);
+    STATS_TIMER_STOP(STATS_COMPUTE_MAPPING, timer);
+    if (isTracing(election))
+    {
+        TraceRecord record = {.operation = TRACE_COMPUTE_MAPPING,
+                              .result = map != NULL ? ELECTION_SUCCESS : ELECTION_OUT_OF_MEMORY};
+        traceCall(election, &record, started);
+    }
+    return map;
+}
+
+ElectionResult electionGetStats(Election election, ElectionStats* stats)
+{
+    if (election == NULL || stats == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    statsGet(stats);
+    return ELECTION_SUCCESS;
+}
+
+AreaTribePair* electionComputeAreasToTribesArray(Election election, int* size)
+{
+    if (election == NULL || size == NULL)
+    {
+        return NULL;
+    }
+    if (election->shard_count == 1)
+    {
+        return areaComputeAreasToTribesArray(election->shards[0], size);
+    }
+    return computeShardedArray(election, size);
+}
+
+Map electionComputeAreasToTribesMappingInRange(Election election, int from_area_id, int to_area_id)
+{
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    return areaComputeAreasToTribesMappingInRangeOfLists(election->shards, election->shard_count, from_area_id,
+                                                         to_area_id);
+}
+
+ElectionResult electionSetAreaRegion(Election election, int area_id, int region_id)
+{
+    if (election == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    if (!isValidId(area_id) || (!isValidId(region_id) && region_id != ELECTION_NO_REGION))
+    {
+        return ELECTION_INVALID_ID;
+    }
+    AreaResult result = areaSetRegion(shardOf(election, area_id), area_id, region_id);
+    return handleResult(result);
+}
+
+Map electionComputeRegionsToTribesMapping(Election election)
+{
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    return areaComputeRegionsToTribesMappingOfLists(election->shards, election->shard_count);
+}
+
+Map electionComputeSeats(Election election, ElectionSeatMethod method, int seats, double threshold)
+{
+    if (election == NULL || !isValidSeatRule(method, seats, threshold))
+    {
+        return NULL;
+    }
+    return areaComputeSeatsOfLists(election->shards, election->shard_count, method, seats, threshold);
+}
+
+Map electionComputeRegionSeats(Election election, int region_id, ElectionSeatMethod method, int seats,
+                               double threshold)
+{
+    if (election == NULL || !isValidId(region_id) || !isValidSeatRule(method, seats, threshold))
+    {
+        return NULL;
+    }
+    return areaComputeRegionSeatsOfLists(election->shards, election->shard_count, region_id, method, seats,
+                                         threshold);
+}
+
+ElectionResult electionSetOverflowPolicy(Election election, ElectionOverflowPolicy policy)
+{
+    if (election == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < election->shard_count; i++)
+    {
+        areaSetOverflowPolicy(election->shards[i], policy);
+    }
+    return ELECTION_SUCCESS;
+}
+
+ElectionResult electionFreezeArea(Election election, int area_id)
+{
+    if (election == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    if (!isValidId(area_id))
+    {
+        return ELECTION_INVALID_ID;
+    }
+    return handleResult(areaFreeze(shardOf(election, area_id), area_id));
+}
+
+ElectionResult electionGetVotes(Election election, int area_id, int tribe_id, int64_t* votes)
+{
+    if (election == NULL || votes == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    if (!isValidId(area_id) || !isValidId(tribe_id))
+    {
+        return ELECTION_INVALID_ID;
+    }
+    return handleResult(areaGetVotes(shardOf(election, area_id), area_id, tribe_id, votes));
+}
+
+ElectionResult electionSetThreads(Election election, int threads)
+{
+    if (election == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    Scheduler scheduler = NULL;
+    if (threads > 1)
+    {
+        scheduler = schedulerCreate(threads, election->allocator);
+        if (scheduler == NULL)
+        {
+            return ELECTION_OUT_OF_MEMORY;
+        }
+    }
+    setShardsScheduler(election, scheduler);
+    schedulerDestroy(election->scheduler);
+    election->scheduler = scheduler;
+    return ELECTION_SUCCESS;
+}
+
+ElectionResult electionStartTrace(Election election, FILE* stream)
+{
+    if (election == NULL || stream == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    electionStopTrace(election);
+    election->trace = traceWriterCreate(stream, election->allocator);
+    if (election->trace == NULL)
+    {
+        return ELECTION_OUT_OF_MEMORY;
+    }
+    election->trace_start = statsNow();
+    return ELECTION_SUCCESS;
+}
+
+ElectionResult electionStopTrace(Election election)
+{
+    if (election == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    traceWriterDestroy(election->trace);
+    election->trace = NULL;
+    allocatorDeallocate(election->allocator, election->removed_area_ids);
+    election->removed_area_ids = NULL;
+    election->removed_capacity = 0;
+    return ELECTION_SUCCESS;
+}
+
+ElectionResult electionRemoveTribes(Election election, const int* tribe_ids, int count)
+{
+    if (election == NULL || tribe_ids == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < count; i++)//validate all the batch before removing anything
+    {
+        if (!isValidId(tribe_ids[i]))
+        {
+            return ELECTION_INVALID_ID;
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        if (!areaTribeContains(election->shards[0], tribe_ids[i]))
+        {
+            return ELECTION_TRIBE_NOT_EXIST;
+        }
+    }
+    AreaResult result = areaRemoveTribesOfLists(election->shards, election->shard_count, tribe_ids, count);
+    return handleResult(result);
+}
+
+ElectionResult electionSetTribeNames(Election election, const TribeNamePair* pairs, int count)
+{
+    if (election == NULL || pairs == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    for (int i = 0; i < count; i++)//validate all the batch before setting anything
+    {
+        ElectionResult result_arguments_valid = isAddArgumentsValid(election, pairs[i].tribe_id, pairs[i].tribe_name);
+        if (result_arguments_valid == ELECTION_NULL_ARGUMENT || result_arguments_valid == ELECTION_INVALID_ID)
+        {
+            return result_arguments_valid;
+        }
+        if (!areaTribeContains(election->shards[0], pairs[i].tribe_id))
+        {
+            return ELECTION_TRIBE_NOT_EXIST;
+        }
+        if (result_arguments_valid != ELECTION_SUCCESS)
+        {
+            return result_arguments_valid;
+        }
+    }
+    for (int i = 0; i < count; i++)
+    {
+        AreaResult result = setNameInShards(election, pairs[i].tribe_id, pairs[i].tribe_name);
+        if (result != AREA_SUCCESS)
+        {
+            return handleResult(result);
+        }
+    }
+    return ELECTION_SUCCESS;
+}
+
+ElectionReader electionReaderCreate(Election election)
+{
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    ElectionReader reader = allocatorAllocate(election->allocator, sizeof(*reader));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    if (election->epoch == NULL)//the first reader, from now on the lists keep what they stop using for the readers
+    {
+        election->epoch = epochCreate(election->allocator);
+        if (election->epoch == NULL)
+        {
+            allocatorDeallocate(election->allocator, reader);
+            return NULL;
+        }
+        setShardsEpoch(election, election->epoch);
+    }
+    reader->election = election;
+    reader->reader = epochReaderCreate(election->epoch);
+    if (reader->reader == NULL)
+    {
+        allocatorDeallocate(election->allocator, reader);
+        if (election->reader_count == 0)
+        {
+            stopReaders(election);
+        }
+        return NULL;
+    }
+    election->reader_count++;
+    return reader;
 }
+
+void electionReaderDestroy(ElectionReader reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    Election election = reader->election;
+    epochReaderDestroy(reader->reader);
+    allocatorDeallocate(election->allocator, reader);
+    election->reader_count--;
+    if (election->reader_count == 0)
+    {
+        stopReaders(election);
+    }
+}
+
+char* electionReaderGetTribeName(ElectionReader reader, int tribe_id)
+{
+    if (reader == NULL || !isValidId(tribe_id))
+    {
+        return NULL;
+    }
+    epochEnter(reader->reader);
+    char* name = areaReadTribeName(reader->election->shards[0], tribe_id);
+    epochExit(reader->reader);
+    return name;
+}
+
+Map electionReaderComputeAreasToTribesMapping(ElectionReader reader)
+{
+    char string_area_id[INT_STRING_SIZE], string_tribe_id[INT_STRING_SIZE];
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    Election election = reader->election;
+    int size;
+    epochEnter(reader->reader);
+    AreaTribePair* pairs = areaReadAreasToTribesArray(election->shards, election->shard_count, &size);
+    epochExit(reader->reader);
+    if (pairs == NULL)
+    {
+        return NULL;
+    }
+    //the allocator of the election is used by the thread that changes it, so the map is allocated with malloc
+    Map map_of_max = size > 0 ? mapCreateWithCapacity(allocatorDefault(), size) : mapCreate();
+    for (int i = 0; i < size && map_of_max != NULL; i++)
+    {
+        writeIntToString(pairs[i].area_id, string_area_id);
+        writeIntToString(pairs[i].tribe_id, string_tribe_id);
+        if (mapAppend(map_of_max, string_area_id, string_tribe_id) != MAP_SUCCESS)//the shards have other areas
+        {
+            mapDestroy(map_of_max);
+            map_of_max = NULL;
+        }
+    }
+    free(pairs);
+    return map_of_max;
+}
+
+ElectionResult electionVisitResults(Election election, ElectionResultVisitor visitor, void* context)
+{
+    if (election == NULL || visitor == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    areaVisitResults(election->shards, election->shard_count, visitor, context);
+    return ELECTION_SUCCESS;
+}
+
+ElectionExportResult electionExportResults(Election election, ElectionExportFormat format, FILE* stream)
+{
+    if (election == NULL || stream == NULL)
+    {
+        return ELECTION_EXPORT_NULL_ARGUMENT;
+    }
+    if (format != ELECTION_EXPORT_CSV && format != ELECTION_EXPORT_JSON && format != ELECTION_EXPORT_BINARY)
+    {
+        return ELECTION_EXPORT_INVALID_FORMAT;
+    }
+    ExportWriter writer = exportWriterCreate(stream, format, election->allocator);
+    if (writer == NULL)
+    {
+        return ELECTION_EXPORT_OUT_OF_MEMORY;
+    }
+    areaVisitResults(election->shards, election->shard_count, exportWriterWrite, writer);//stops if a write fails
+    bool written = exportWriterFinish(writer);
+    exportWriterDestroy(writer);
+    return written ? ELECTION_EXPORT_SUCCESS : ELECTION_EXPORT_WRITE_FAILED;
+}
+
 /*
 validates the given arguments and return the matched error to to the argument
 if all arguments are valid returns ELECTION_SUCCSESS
@@ -235,6 +1192,17 @@ static bool isValidVotes(int num_of_votes)
     return true;
 }
 /*
+validates the method is known, the number of seats isn't negative and the threshold is a fraction
+*/
+static bool isValidSeatRule(ElectionSeatMethod method, int seats, double threshold)
+{
+    if (method != ELECTION_DHONDT && method != ELECTION_SAINTE_LAGUE && method != ELECTION_LARGEST_REMAINDER)
+    {
+        return false;
+    }
+    return seats >= 0 && threshold >= 0 && threshold <= 1;//false for a NaN threshold too
+}
+/*
 validets the id  is a positive bumber
 */
 static bool isValidId(int id)
@@ -247,19 +1215,52 @@ static bool isValidId(int id)
 }
 /*
 validets the name consists only low letter case and spaces
+the length is found first so no block is read past the name, then the name is checked NAME_BLOCK_SIZE
+bytes at a time when the target has SSE2 or AVX2 and the bytes after the last block one by one
 */
 static bool isValidName(const char* name)
 {
-    while (*name)
+    size_t length = strlen(name), checked = 0;
+#ifdef NAME_BLOCK_SIZE
+    for (; checked + NAME_BLOCK_SIZE <= length; checked += NAME_BLOCK_SIZE)
     {
-        if (*name != SPACE && (*name > LAST_LETTER || *name < FIRST_LETTER))
+        if (!isValidNameBlock(name + checked))
+        {
+            return false;
+        }
+    }
+#endif
+    for (; checked < length; checked++)
+    {
+        if (name[checked] != SPACE && (name[checked] > LAST_LETTER || name[checked] < FIRST_LETTER))
         {
             return false;
         }
-        name++;
     }
     return true;
 }
+#ifdef NAME_BLOCK_SIZE
+/*
+return true if the NAME_BLOCK_SIZE bytes of the block are all low letters or spaces, the bytes are
+compared as signed so bytes above 127 are below the letters
+*/
+static bool isValidNameBlock(const char* block)
+{
+#if NAME_BLOCK_SIZE == 32
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)block);
+    __m256i letters = _mm256_and_si256(_mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(FIRST_LETTER - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8(LAST_LETTER + 1), bytes));
+    __m256i valid = _mm256_or_si256(letters, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(SPACE)));
+    return _mm256_movemask_epi8(valid) == -1;
+#else
+    __m128i bytes = _mm_loadu_si128((const __m128i*)block);
+    __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(FIRST_LETTER - 1)),
+                                    _mm_cmpgt_epi8(_mm_set1_epi8(LAST_LETTER + 1), bytes));
+    __m128i valid = _mm_or_si128(letters, _mm_cmpeq_epi8(bytes, _mm_set1_epi8(SPACE)));
+    return _mm_movemask_epi8(valid) == 0xffff;
+#endif
+}
+#endif
 /*
 handle the results from tribe
 */
@@ -281,7 +1282,9 @@ static ElectionResult handleResult(AreaResult result)
         return ELECTION_TRIBE_NOT_EXIST;
     case AREA_TRIBE_ALREADY_EXIST:
         return ELECTION_TRIBE_ALREADY_EXIST;
+    case AREA_INVALID_VOTES:
+        return ELECTION_INVALID_VOTES;
     default:
         return ELECTION_SUCCESS;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,338 @@
+#ifndef MTM_ELECTION_EXT_H
+#define MTM_ELECTION_EXT_H
+
+#include "election.h"
+#include "allocator.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+/**
+* Functions of the Election type beyond the ones declared in election.h
+**/
+
+/** The region of an area that wasn't put in a region */
+#define ELECTION_NO_REGION -1
+
+/** The methods of allocating seats proportionally to votes */
+typedef enum ElectionSeatMethod_t
+{
+    ELECTION_DHONDT,
+    ELECTION_SAINTE_LAGUE,
+    ELECTION_LARGEST_REMAINDER
+} ElectionSeatMethod;
+
+/** What adding votes does when the total votes of a tribe in all the areas would overflow an int64_t */
+typedef enum ElectionOverflowPolicy_t
+{
+    ELECTION_OVERFLOW_ERROR,
+    ELECTION_OVERFLOW_SATURATE
+} ElectionOverflowPolicy;
+
+/** Type for a tribe id and the name to give it */
+typedef struct TribeNamePair_t
+{
+    int tribe_id;
+    const char* tribe_name;
+} TribeNamePair;
+
+/** Type for defining a thread that reads an election while another thread changes it */
+typedef struct election_reader_t* ElectionReader;
+
+/** Type for an area id and the id of the tribe that got most of its votes */
+typedef struct AreaTribePair_t
+{
+    int area_id;
+    int tribe_id;
+} AreaTribePair;
+
+/** Type for the winner of an area, the names are valid while the visitor that gets it runs */
+typedef struct ElectionAreaResult_t
+{
+    int area_id;
+    const char* area_name;
+    int tribe_id;
+    const char* tribe_name;
+    int64_t votes;
+} ElectionAreaResult;
+
+/** Type of the function that gets the winner of every area, it returns false to stop the visit */
+typedef bool (*ElectionResultVisitor)(const ElectionAreaResult* result, void* context);
+
+/** The formats that electionExportResults writes */
+typedef enum ElectionExportFormat_t
+{
+    ELECTION_EXPORT_CSV,
+    ELECTION_EXPORT_JSON,
+    ELECTION_EXPORT_BINARY
+} ElectionExportFormat;
+
+/** The results of electionExportResults */
+typedef enum ElectionExportResult_t
+{
+    ELECTION_EXPORT_SUCCESS,
+    ELECTION_EXPORT_NULL_ARGUMENT,
+    ELECTION_EXPORT_INVALID_FORMAT,
+    ELECTION_EXPORT_OUT_OF_MEMORY,
+    ELECTION_EXPORT_WRITE_FAILED
+} ElectionExportResult;
+
+/*
+*electionCreateWithAllocator: like electionCreate but the election, its areas and tribes and the maps
+*computed from it are allocated with the given allocator, or with the default allocator if it is NULL.
+*the allocator has to stay valid until the election and every map computed from it are destroyed.
+*names returned by electionGetTribeName and arrays returned by electionComputeAreasToTribesArray
+*are still allocated with malloc, since the caller frees them with free
+*@return
+*NULL if memory allocation failed
+*/
+Election electionCreateWithAllocator(const Allocator* allocator);
+/*
+*electionCreateSharded: like electionCreateWithAllocator but the areas are split between the given number
+*of shards, the area with id i is in shard i % shards. every shard is an area list of its own allocated
+*with allocators[i]. if allocators or allocators[i] is NULL and there is more than one shard, the list is
+*allocated from a heap of the memory of NUMA node i % nodes (see shard.h), so its areas are in the memory
+*of the node of its worker whichever thread changes them.
+*every shard has a worker thread pinned to the CPUs of NUMA node i % nodes (see shard.h), the winners of
+*the areas of all the shards are computed by their workers at once and merged, and the regions and the
+*seats sum the totals of the shards. the other functions go to the shard of the area, or to all the shards
+*for the tribes. the election and the maps computed from it are allocated with the allocator of shard 0.
+*the overflow policy applies to the totals of every shard, their sums stop at INT64_MAX.
+*electionComputeAreasToTribesArray has the areas of every shard after the areas of the shards before it.
+*with one shard it is the same as electionCreateWithAllocator.
+*the areas are changed on the thread that calls the functions and the winners are computed on the pinned
+*workers, a shard given an allocator that isn't local to a node has its areas wherever that allocator puts them
+*@return
+*NULL if shards isn't positive, memory allocation failed or a worker thread couldn't start
+*/
+Election electionCreateSharded(int shards, const Allocator* const* allocators);
+
+/*
+*electionRemoveTribes: removes all the tribes with the given ids, the tribes of every area are
+*changed once for all the batch. an id may appear more than once
+*nothing is removed if one of the ids is invalid or of a tribe that doesn't exist
+*@return
+*ELECTION_NULL_ARGUMENT if election or tribe_ids is NULL
+*ELECTION_INVALID_ID if one of the ids is negative
+*ELECTION_TRIBE_NOT_EXIST if one of the ids isn't of an existing tribe
+*ELECTION_OUT_OF_MEMORY if any memory allocation failed
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionRemoveTribes(Election election, const int* tribe_ids, int count);
+/*
+*electionSetTribeNames: sets the name of every tribe in the given pairs, tribe names are shared by
+*all the areas so no area is changed. if an id appears more than once the last name is kept
+*no name is set if one of the pairs is invalid
+*@return
+*ELECTION_NULL_ARGUMENT if election, pairs or one of the names is NULL
+*ELECTION_INVALID_ID if one of the ids is negative
+*ELECTION_TRIBE_NOT_EXIST if one of the ids isn't of an existing tribe
+*ELECTION_INVALID_NAME if one of the names isn't only low letter case and spaces
+*ELECTION_OUT_OF_MEMORY if any memory allocation failed, the names before it were set
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionSetTribeNames(Election election, const TribeNamePair* pairs, int count);
+
+/*
+*electionComputeAreasToTribesMappingInRange: like electionComputeAreasToTribesMapping but only for the
+*areas with ids in [from_area_id, to_area_id). the result is an ordered map (see mapCreateOrdered in
+*mtm_map/map_ext.h) that is iterated in ascending order of the area ids and supports mapLowerBound
+*the first call sorts the areas once, later calls find the range without going over the other areas
+*@return
+*NULL if election is NULL or memory allocation failed
+*an empty map if there are no tribes or no areas in the range
+*/
+Map electionComputeAreasToTribesMappingInRange(Election election, int from_area_id, int to_area_id);
+
+/*
+*electionSetAreaRegion: puts the area with the given id in the region with the given id, or takes it out
+*of its region if region_id is ELECTION_NO_REGION. a region exists while it has areas, areas start
+*in no region. the votes of the areas are summed per region as they change
+*@return
+*ELECTION_NULL_ARGUMENT if election is NULL
+*ELECTION_INVALID_ID if area_id is negative or region_id is negative and not ELECTION_NO_REGION
+*ELECTION_AREA_NOT_EXIST if there is no area with the given id
+*ELECTION_OUT_OF_MEMORY if any memory allocation failed, the area stays in its region in that case
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionSetAreaRegion(Election election, int area_id, int region_id);
+/*
+*electionComputeRegionsToTribesMapping: like electionComputeAreasToTribesMapping but from the id of every
+*region to the id of the tribe with most votes in all its areas, the lower tribe id in case of a tie.
+*the totals of the regions are kept as the votes change so this doesn't go over the areas
+*@return
+*NULL if election is NULL or memory allocation failed
+*an empty map if there are no tribes or no regions
+*/
+Map electionComputeRegionsToTribesMapping(Election election);
+/*
+*electionComputeSeats: return a map from the id of every tribe to the number of seats it gets out of the
+*given number of seats, by the given method, from the votes of all the areas. tribes with less than
+*threshold (a fraction between 0 and 1) of all the votes get no seats, a tie goes to the lower tribe id.
+*the totals of the tribes are kept as the votes change, so D'Hondt and Sainte-Lague take
+*O((T + S) log T) for T tribes and S seats and don't go over the areas
+*@return
+*NULL if election is NULL, the method is unknown, seats is negative, threshold isn't between 0 and 1
+*or memory allocation failed
+*an empty map if there are no tribes
+*/
+Map electionComputeSeats(Election election, ElectionSeatMethod method, int seats, double threshold);
+/*
+*electionComputeRegionSeats: like electionComputeSeats but from the votes of the areas of the region
+*with the given id, the threshold is of the votes of the region
+*@return
+*NULL if election is NULL, region_id is negative, one of the other arguments is invalid as in
+*electionComputeSeats or memory allocation failed
+*an empty map if there are no tribes or the region has no areas
+*/
+Map electionComputeRegionSeats(Election election, int region_id, ElectionSeatMethod method, int seats,
+                               double threshold);
+/*
+*electionSetOverflowPolicy: sets what electionAddVote does when the total votes of the tribe in all the
+*areas would overflow an int64_t. with ELECTION_OVERFLOW_ERROR, the default, it returns
+*ELECTION_INVALID_VOTES and no votes are added. with ELECTION_OVERFLOW_SATURATE only the votes that fit
+*are added, so the total stops at INT64_MAX. the votes of every area and region are never more than
+*the total so they never overflow
+*@return
+*ELECTION_NULL_ARGUMENT if election is NULL
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionSetOverflowPolicy(Election election, ElectionOverflowPolicy policy);
+/*
+*electionFreezeArea: marks the count of the area with the given id as final. its votes are packed into
+*a compact block, sorted by tribe id with the winner found once, so a frozen area takes a fraction of
+*the memory. the mappings, regions and seats read it as before and removing the area or a tribe still
+*works, but electionAddVote and electionRemoveVote on it return ELECTION_INVALID_VOTES. an area can't
+*be unfrozen
+*@return
+*ELECTION_NULL_ARGUMENT if election is NULL
+*ELECTION_INVALID_ID if area_id is negative
+*ELECTION_AREA_NOT_EXIST if there is no area with the given id
+*ELECTION_OUT_OF_MEMORY if memory allocation failed, the area isn't frozen in that case
+*ELECTION_SUCCESS otherwise, also if the area was already frozen
+*/
+ElectionResult electionFreezeArea(Election election, int area_id);
+/*
+*electionGetVotes: sets votes to the number of votes the tribe with the given id got in the area with the
+*given id, zero if it got none
+*@return
+*ELECTION_NULL_ARGUMENT if election or votes is NULL
+*ELECTION_INVALID_ID if area_id or tribe_id is negative
+*ELECTION_AREA_NOT_EXIST if there is no area with the given id
+*ELECTION_TRIBE_NOT_EXIST if there is no tribe with the given id
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionGetVotes(Election election, int area_id, int tribe_id, int64_t* votes);
+/*
+*electionSetThreads: sets the number of threads that the functions going over all the areas run on,
+*counting the thread that calls them: finding the winners of electionComputeAreasToTribesMapping and
+*electionComputeAreasToTribesArray, removing tribes from the areas and checking the condition of
+*electionRemoveAreas. the areas are split between the threads by work stealing, so areas that take longer
+*don't hold up the others. the threads are started once and kept until the next call or electionDestroy.
+*1 or less runs everything on the calling thread, as by default. with more threads the condition given to
+*electionRemoveAreas is called from many threads at once so it has to be thread safe, unless the calls
+*are traced. in a sharded election one shard at a time uses the threads, the others run on their workers
+*@return
+*ELECTION_NULL_ARGUMENT if election is NULL
+*ELECTION_OUT_OF_MEMORY if memory allocation failed or a thread couldn't start, the threads are as
+*they were in that case
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionSetThreads(Election election, int threads);
+/*
+*electionReaderCreate: creates a reader of the election, for a thread that reads the election with the
+*electionReader functions while the thread that calls the rest of the functions changes it. the readers never
+*take a lock or wait for that thread, and it never waits for them: while the election has readers, the areas,
+*tables and names it stops using are kept until no reader can be reading them (epoch based reclamation, see
+*epoch.h), so the election takes more memory and removing areas copies the areas that are kept.
+*a reader is used by one thread at a time. it is created and destroyed by the thread that changes the
+*election, like its other functions, and all the readers are destroyed before the election
+*@return
+*NULL if election is NULL or memory allocation failed
+*/
+ElectionReader electionReaderCreate(Election election);
+/*
+*electionReaderDestroy: destroys the reader, with the last reader the election deallocates what it stops
+*using right away again. If reader is NULL nothing will be done
+*/
+void electionReaderDestroy(ElectionReader reader);
+/*
+*electionReaderGetTribeName: like electionGetTribeName, on the thread of the reader. the name is the name
+*of the tribe at some moment during the call
+*@return
+*NULL if reader is NULL, tribe_id is invalid, there is no tribe with this id or memory allocation failed
+*/
+char* electionReaderGetTribeName(ElectionReader reader, int tribe_id);
+/*
+*electionReaderComputeAreasToTribesMapping: like electionComputeAreasToTribesMapping, on the thread of the
+*reader. the areas of every shard are the ones it had at some moment during the call, and the winner of
+*every area is of its votes when it was read, so votes that change during the call may be counted for some
+*areas and not for others. the map is allocated with malloc, not with the allocator of the election
+*@return
+*NULL if reader is NULL or memory allocation failed
+*an empty map if there are no tribes or no areas
+*/
+Map electionReaderComputeAreasToTribesMapping(ElectionReader reader);
+/*
+*electionStartTrace: writes every call to the functions of election.h on this election, with its
+*arguments, result and time, to the given stream as a binary trace (see trace.h) until electionStopTrace
+*or electionDestroy. the stream isn't closed. a trace started right after electionCreate replays to the
+*same results. if a record can't be written the trace stops, so a trace has no gaps
+*@return
+*ELECTION_NULL_ARGUMENT if election or stream is NULL
+*ELECTION_OUT_OF_MEMORY if memory allocation failed or the stream couldn't be written
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionStartTrace(Election election, FILE* stream);
+/*
+*electionStopTrace: stops tracing the calls and flushes the stream, nothing is done if they aren't traced
+*@return
+*ELECTION_NULL_ARGUMENT if election is NULL
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionStopTrace(Election election);
+
+/*
+*electionComputeAreasToTribesArray: like electionComputeAreasToTribesMapping but the result is an
+*array of {area id, tribe id} pairs, allocated at once and freed by the caller with free
+*size is set to the number of pairs, zero if there are no areas or no tribes
+*@return
+*NULL if election or size is NULL or memory allocation failed
+*/
+AreaTribePair* electionComputeAreasToTribesArray(Election election, int* size);
+
+/*
+*electionVisitResults: calls the visitor with the winner of every area, like electionComputeAreasToTribesMapping,
+*with the names of the area and the tribe and the votes the tribe got in the area, without keeping the
+*results in a map. the areas come in the order of electionComputeAreasToTribesArray and the visitor isn't
+*called if there are no tribes. the visitor gets the given context and mustn't change the election
+*@return
+*ELECTION_NULL_ARGUMENT if election or visitor is NULL
+*ELECTION_SUCCESS otherwise, also if the visitor stopped the visit
+*/
+ElectionResult electionVisitResults(Election election, ElectionResultVisitor visitor, void* context);
+/*
+*electionExportResults: writes the winner of every area, as electionVisitResults visits it, to the given
+*stream in the given format (see export.h) as it goes, the stream is flushed but isn't closed. a buffer
+*of the caller is written with a stream of fmemopen and a file descriptor with a stream of fdopen
+*@return
+*ELECTION_EXPORT_NULL_ARGUMENT if election or stream is NULL
+*ELECTION_EXPORT_INVALID_FORMAT if the format isn't one of ElectionExportFormat
+*ELECTION_EXPORT_OUT_OF_MEMORY if memory allocation failed, nothing is written in that case
+*ELECTION_EXPORT_WRITE_FAILED if the stream couldn't be written or flushed, what was written before that
+*stays in the stream
+*ELECTION_EXPORT_SUCCESS otherwise
+*/
+ElectionExportResult electionExportResults(Election election, ElectionExportFormat format, FILE* stream);
+
+/*
+*electionGetStats: copies the allocation counters and the latency histograms of the library to
+*the given stats, see stats.h. statsPrintJson writes them as JSON
+*all the stats are zero unless the library is compiled with ELECTION_STATS defined
+*@return
+*ELECTION_NULL_ARGUMENT if election or stats is NULL
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult electionGetStats(Election election, ElectionStats* stats);
+
+#endif //MTM_ELECTION_EXT_H
@@ -0,0 +1,322 @@
+#define _POSIX_C_SOURCE 200809L
+#include "epoch.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+
+#define CACHE_LINE_SIZE 64
+#define INITIAL_CAPACITY 4
+#define GROWTH_FACTOR 2
+#define RECLAIM_BATCH 64
+#define OUTSIDE 0
+
+/*
+epoch is the epoch the reader announced when it entered, OUTSIDE when it isn't reading. every reader
+is on cache lines of its own, so entering doesn't slow down the other readers
+*/
+struct epoch_reader_t
+{
+    char before_line[CACHE_LINE_SIZE];
+    Epoch domain;
+    unsigned long epoch;
+    char after_line[CACHE_LINE_SIZE];
+};
+
+/*
+a block that waits for the readers, retired in the given epoch
+*/
+struct epoch_retired_t
+{
+    EpochRelease release;
+    void* context;
+    void* pointer;
+    unsigned long epoch;
+};
+
+/*
+global is the current epoch, it starts at 1 and only grows, so it is never OUTSIDE. readers has all the
+readers of the epoch and retired the blocks that weren't released yet, in the order they were retired.
+the retired blocks are released when there are reclaim_at of them, which doubles with the blocks that
+are kept, so readers that stay inside for long don't make every retire go over all the blocks
+*/
+struct epoch_t
+{
+    const Allocator* allocator;
+    unsigned long global;
+    EpochReader* readers;
+    int reader_count;
+    int reader_capacity;
+    struct epoch_retired_t* retired;
+    int retired_count;
+    int retired_capacity;
+    int reclaim_at;
+};
+
+Epoch epochCreate(const Allocator* allocator);
+void epochDestroy(Epoch epoch);
+EpochReader epochReaderCreate(Epoch epoch);
+void epochReaderDestroy(EpochReader reader);
+void epochEnter(EpochReader reader);
+void epochExit(EpochReader reader);
+void epochRetire(Epoch epoch, EpochRelease release, void* context, void* pointer);
+void epochRetireBlock(Epoch epoch, const Allocator* allocator, void* pointer);
+void* epochReallocate(Epoch epoch, const Allocator* allocator, void* pointer, size_t size, size_t new_size);
+void epochBeginChange(unsigned* sequence);
+void epochEndChange(unsigned* sequence);
+unsigned epochReadBegin(const unsigned* sequence);
+bool epochReadRetry(const unsigned* sequence, unsigned start);
+static void reclaim(Epoch epoch);
+static unsigned long oldestEpoch(Epoch epoch);
+static void synchronize(Epoch epoch);
+static void releaseBlock(void* allocator, void* pointer);
+
+Epoch epochCreate(const Allocator* allocator)
+{
+    assert(allocator != NULL);
+    Epoch epoch = allocatorAllocate(allocator, sizeof(*epoch));
+    if (epoch == NULL)
+    {
+        return NULL;
+    }
+    epoch->allocator = allocator;
+    epoch->global = OUTSIDE + 1;
+    epoch->readers = NULL;
+    epoch->reader_count = 0;
+    epoch->reader_capacity = 0;
+    epoch->retired = NULL;
+    epoch->retired_count = 0;
+    epoch->retired_capacity = 0;
+    epoch->reclaim_at = RECLAIM_BATCH;
+    return epoch;
+}
+
+void epochDestroy(Epoch epoch)
+{
+    if (epoch == NULL)
+    {
+        return;
+    }
+    assert(epoch->reader_count == 0);
+    for (int i = 0; i < epoch->retired_count; i++)
+    {
+        epoch->retired[i].release(epoch->retired[i].context, epoch->retired[i].pointer);
+    }
+    allocatorDeallocate(epoch->allocator, epoch->retired);
+    allocatorDeallocate(epoch->allocator, epoch->readers);
+    allocatorDeallocate(epoch->allocator, epoch);
+}
+
+EpochReader epochReaderCreate(Epoch epoch)
+{
+    assert(epoch != NULL);
+    if (epoch->reader_count == epoch->reader_capacity)
+    {
+        int new_capacity = epoch->reader_capacity == 0 ? INITIAL_CAPACITY : epoch->reader_capacity * GROWTH_FACTOR;
+        EpochReader* new_readers = allocatorReallocate(epoch->allocator, epoch->readers,
+                                                       new_capacity * sizeof(*new_readers));
+        if (new_readers == NULL)
+        {
+            return NULL;
+        }
+        epoch->readers = new_readers;
+        epoch->reader_capacity = new_capacity;
+    }
+    EpochReader reader = allocatorAllocate(epoch->allocator, sizeof(*reader));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    reader->domain = epoch;
+    reader->epoch = OUTSIDE;
+    epoch->readers[epoch->reader_count++] = reader;
+    return reader;
+}
+
+void epochReaderDestroy(EpochReader reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    assert(reader->epoch == OUTSIDE);
+    Epoch epoch = reader->domain;
+    for (int i = 0; i < epoch->reader_count; i++)
+    {
+        if (epoch->readers[i] == reader)
+        {
+            epoch->readers[i] = epoch->readers[--epoch->reader_count];
+            break;
+        }
+    }
+    allocatorDeallocate(epoch->allocator, reader);
+    reclaim(epoch);//the blocks the reader held back may be released now
+}
+
+void epochEnter(EpochReader reader)
+{
+    assert(reader != NULL && reader->epoch == OUTSIDE);
+    unsigned long epoch = __atomic_load_n(&reader->domain->global, __ATOMIC_SEQ_CST);
+    for (;;)//announced, and then checked that the writer didn't move on before it could see the announcement
+    {
+        __atomic_store_n(&reader->epoch, epoch, __ATOMIC_SEQ_CST);
+        unsigned long current = __atomic_load_n(&reader->domain->global, __ATOMIC_SEQ_CST);
+        if (current == epoch)
+        {
+            return;
+        }
+        epoch = current;
+    }
+}
+
+void epochExit(EpochReader reader)
+{
+    assert(reader != NULL && reader->epoch != OUTSIDE);
+    __atomic_store_n(&reader->epoch, OUTSIDE, __ATOMIC_RELEASE);
+}
+
+void epochRetire(Epoch epoch, EpochRelease release, void* context, void* pointer)
+{
+    assert(release != NULL);
+    if (pointer == NULL)
+    {
+        return;
+    }
+    if (epoch == NULL)
+    {
+        release(context, pointer);
+        return;
+    }
+    if (epoch->retired_count == epoch->retired_capacity)
+    {
+        int new_capacity = epoch->retired_capacity == 0 ? RECLAIM_BATCH : epoch->retired_capacity * GROWTH_FACTOR;
+        struct epoch_retired_t* new_retired = allocatorReallocate(epoch->allocator, epoch->retired,
+                                                                  new_capacity * sizeof(*new_retired));
+        if (new_retired == NULL)//without room to keep it, the block is released once the readers are out
+        {
+            synchronize(epoch);
+            release(context, pointer);
+            return;
+        }
+        epoch->retired = new_retired;
+        epoch->retired_capacity = new_capacity;
+    }
+    struct epoch_retired_t* retired = &epoch->retired[epoch->retired_count++];
+    retired->release = release;
+    retired->context = context;
+    retired->pointer = pointer;
+    retired->epoch = epoch->global;//only the writer changes it
+    if (epoch->retired_count >= epoch->reclaim_at)
+    {
+        reclaim(epoch);
+    }
+}
+
+void epochRetireBlock(Epoch epoch, const Allocator* allocator, void* pointer)
+{
+    epochRetire(epoch, releaseBlock, (void*)allocator, pointer);
+}
+
+void* epochReallocate(Epoch epoch, const Allocator* allocator, void* pointer, size_t size, size_t new_size)
+{
+    if (epoch == NULL)
+    {
+        return allocatorReallocate(allocator, pointer, new_size);
+    }
+    void* block = allocatorAllocate(allocator, new_size);
+    if (block != NULL && pointer != NULL)
+    {
+        memcpy(block, pointer, size < new_size ? size : new_size);
+    }
+    return block;
+}
+
+void epochBeginChange(unsigned* sequence)
+{
+    //odd while the fields change, a reader that loads a field stored after it also sees it
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELAXED);
+}
+
+void epochEndChange(unsigned* sequence)
+{
+    __atomic_store_n(sequence, *sequence + 1, __ATOMIC_RELEASE);//ordered after the changes
+}
+
+unsigned epochReadBegin(const unsigned* sequence)
+{
+    unsigned start = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+    while (start % 2 != 0)
+    {
+        sched_yield();
+        start = __atomic_load_n(sequence, __ATOMIC_ACQUIRE);
+    }
+    return start;
+}
+
+bool epochReadRetry(const unsigned* sequence, unsigned start)
+{
+    //the acquire loads of the fields keep this load after them
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) != start;
+}
+
+/*
+moves the epoch on and releases the retired blocks that no reader inside can read, the rest keep their order
+*/
+static void reclaim(Epoch epoch)
+{
+    __atomic_add_fetch(&epoch->global, 1, __ATOMIC_SEQ_CST);//readers that enter from now on can't reach the blocks
+    unsigned long oldest = oldestEpoch(epoch);
+    int kept = 0;
+    for (int i = 0; i < epoch->retired_count; i++)
+    {
+        struct epoch_retired_t* retired = &epoch->retired[i];
+        if (retired->epoch < oldest)//every reader that was inside when it was retired exited
+        {
+            retired->release(retired->context, retired->pointer);
+            continue;
+        }
+        epoch->retired[kept++] = *retired;
+    }
+    epoch->retired_count = kept;
+    epoch->reclaim_at = kept * GROWTH_FACTOR > RECLAIM_BATCH ? kept * GROWTH_FACTOR : RECLAIM_BATCH;
+}
+
+/*
+return the oldest epoch that a reader inside announced, or the current epoch if no reader is inside
+*/
+static unsigned long oldestEpoch(Epoch epoch)
+{
+    unsigned long oldest = __atomic_load_n(&epoch->global, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < epoch->reader_count; i++)
+    {
+        unsigned long announced = __atomic_load_n(&epoch->readers[i]->epoch, __ATOMIC_SEQ_CST);
+        if (announced != OUTSIDE && announced < oldest)
+        {
+            oldest = announced;
+        }
+    }
+    return oldest;
+}
+
+/*
+moves the epoch on and waits until every reader that is inside entered after that
+*/
+static void synchronize(Epoch epoch)
+{
+    unsigned long current = __atomic_add_fetch(&epoch->global, 1, __ATOMIC_SEQ_CST);
+    while (oldestEpoch(epoch) < current)
+    {
+        sched_yield();
+    }
+}
+
+/*
+the release of a block of an allocator
+*/
+static void releaseBlock(void* allocator, void* pointer)
+{
+    allocatorDeallocate(allocator, pointer);
+}
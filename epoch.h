@@ -0,0 +1,97 @@
+#ifndef MTM_EPOCH_H
+#define MTM_EPOCH_H
+
+#include "allocator.h"
+#include <stdbool.h>
+/**
+* Epoch
+* Implements epoch based reclamation, so threads can read a structure while one writer thread changes it
+* without taking a lock.
+* A reader calls epochEnter before it reads and epochExit after it. The writer unlinks a block first,
+* so no reader that enters from then on can reach it, and then retires it with epochRetire instead of
+* deallocating it. A retired block is released once every reader that was inside when it was retired
+* has exited, so a reader never reads a block that was deallocated. The writer never waits for readers.
+* A sequence count tells a reader that the fields it read changed while it read them: the writer calls
+* epochBeginChange and epochEndChange around a change, and the reader reads between epochReadBegin and
+* epochReadRetry, and reads again if epochReadRetry returns true. Between them the writer stores the
+* fields with release stores and the reader loads them with acquire loads, so a reader that sees any
+* store of a change also sees the count of that change, without a standalone fence.
+* Everything but epochEnter, epochExit, epochReadBegin and epochReadRetry is called by the writer thread.
+**/
+
+/** Type for defining an Epoch */
+typedef struct epoch_t* Epoch;
+
+/** Type for defining a reader of an Epoch */
+typedef struct epoch_reader_t* EpochReader;
+
+/** Type of the function that releases a retired block, it gets the context it was retired with */
+typedef void (*EpochRelease)(void* context, void* pointer);
+
+/*
+*epochCreate: creates an epoch without readers, allocated with the given allocator
+*@return
+*NULL if memory allocation failed
+*/
+Epoch epochCreate(const Allocator* allocator);
+/*
+*epochDestroy: releases every retired block and deallocates the epoch, all its readers have to be
+*destroyed first. If epoch is NULL nothing will be done
+*/
+void epochDestroy(Epoch epoch);
+/*
+*epochReaderCreate: adds a reader to the epoch, the reader is then used by one thread at a time
+*@return
+*NULL if memory allocation failed
+*/
+EpochReader epochReaderCreate(Epoch epoch);
+/*
+*epochReaderDestroy: removes the reader from its epoch, the reader has to be outside. If reader is NULL
+*nothing will be done
+*/
+void epochReaderDestroy(EpochReader reader);
+/*
+*epochEnter: the reader starts reading, the blocks it can reach aren't released until epochExit
+*/
+void epochEnter(EpochReader reader);
+/*
+*epochExit: the reader stops reading
+*/
+void epochExit(EpochReader reader);
+/*
+*epochRetire: calls release(context, pointer) once no reader can read the block, right away if epoch
+*is NULL. if the block can't be kept for lack of memory the writer waits for the readers that are
+*inside to exit. If pointer is NULL nothing will be done
+*/
+void epochRetire(Epoch epoch, EpochRelease release, void* context, void* pointer);
+/*
+*epochRetireBlock: like epochRetire for a block that is deallocated with the given allocator
+*/
+void epochRetireBlock(Epoch epoch, const Allocator* allocator, void* pointer);
+/*
+*epochReallocate: like allocatorReallocate, but if epoch isn't NULL the block is copied into a new block
+*and left as it is for the readers that still read it, the caller retires it after it publishes the new one
+*@return
+*NULL if allocation failed, the block is unchanged in that case
+*/
+void* epochReallocate(Epoch epoch, const Allocator* allocator, void* pointer, size_t size, size_t new_size);
+/*
+*epochBeginChange: the writer starts changing the fields that the given sequence count guards
+*/
+void epochBeginChange(unsigned* sequence);
+/*
+*epochEndChange: the writer finished changing the fields that the given sequence count guards
+*/
+void epochEndChange(unsigned* sequence);
+/*
+*epochReadBegin: waits until the writer isn't changing the fields the given sequence count guards
+*@return the count to give epochReadRetry
+*/
+unsigned epochReadBegin(const unsigned* sequence);
+/*
+*epochReadRetry: return true if the fields that the given sequence count guards changed since
+*epochReadBegin returned start, so what was read from them has to be read again
+*/
+bool epochReadRetry(const unsigned* sequence, unsigned start);
+
+#endif //MTM_EPOCH_H
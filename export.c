@@ -0,0 +1,265 @@
+#include "export.h"
+#include "allocator.h"
+#include "election_ext.h"
+#include "assist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EXPORT_MAGIC "ELRESLT"
+#define EXPORT_VERSION 1
+#define HEADER_SIZE 8
+#define BUFFER_SIZE 4096
+#define MAX_VARINT_SIZE 10
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7f
+#define CSV_HEADER "area_id,area_name,tribe_id,tribe_name,votes\n"
+#define JSON_BEGIN "["
+#define JSON_END "\n]\n"
+
+/*
+buffer has the records that weren't written to the stream yet, the first used bytes of it.
+count is the number of records added, failed is set once the stream couldn't be written
+*/
+struct export_writer_t
+{
+    const Allocator* allocator;
+    FILE* stream;
+    ElectionExportFormat format;
+    long long count;
+    bool failed;
+    int used;
+    char buffer[BUFFER_SIZE];
+};
+
+ExportWriter exportWriterCreate(FILE* stream, ElectionExportFormat format, const Allocator* allocator);
+void exportWriterDestroy(ExportWriter writer);
+bool exportWriterWrite(const ElectionAreaResult* result, void* writer);
+bool exportWriterFinish(ExportWriter writer);
+static void writeCsv(ExportWriter writer, const ElectionAreaResult* result);
+static void writeJson(ExportWriter writer, const ElectionAreaResult* result);
+static void writeBinary(ExportWriter writer, const ElectionAreaResult* result);
+static void put(ExportWriter writer, const void* bytes, size_t size);
+static void putText(ExportWriter writer, const char* text);
+static void putInt(ExportWriter writer, int value);
+static void putInt64(ExportWriter writer, int64_t value);
+static void putVarint(ExportWriter writer, uint64_t value);
+static void flushBuffer(ExportWriter writer);
+
+ExportWriter exportWriterCreate(FILE* stream, ElectionExportFormat format, const Allocator* allocator)
+{
+    if (stream == NULL || (format != ELECTION_EXPORT_CSV && format != ELECTION_EXPORT_JSON &&
+                           format != ELECTION_EXPORT_BINARY))
+    {
+        return NULL;
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    ExportWriter writer = allocatorAllocate(allocator, sizeof(*writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    writer->allocator = allocator;
+    writer->stream = stream;
+    writer->format = format;
+    writer->count = 0;
+    writer->failed = false;
+    writer->used = 0;
+    switch (format)//the header waits in the buffer with the first records
+    {
+    case ELECTION_EXPORT_CSV:
+        putText(writer, CSV_HEADER);
+        break;
+    case ELECTION_EXPORT_JSON:
+        putText(writer, JSON_BEGIN);
+        break;
+    case ELECTION_EXPORT_BINARY:
+        put(writer, EXPORT_MAGIC, HEADER_SIZE - 1);
+        putVarint(writer, EXPORT_VERSION);
+        break;
+    }
+    return writer;
+}
+
+void exportWriterDestroy(ExportWriter writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    allocatorDeallocate(writer->allocator, writer);
+}
+
+bool exportWriterWrite(const ElectionAreaResult* result, void* writer)
+{
+    assert(result != NULL && writer != NULL);
+    ExportWriter export_writer = writer;
+    switch (export_writer->format)
+    {
+    case ELECTION_EXPORT_CSV:
+        writeCsv(export_writer, result);
+        break;
+    case ELECTION_EXPORT_JSON:
+        writeJson(export_writer, result);
+        break;
+    case ELECTION_EXPORT_BINARY:
+        writeBinary(export_writer, result);
+        break;
+    }
+    export_writer->count++;
+    return !export_writer->failed;
+}
+
+bool exportWriterFinish(ExportWriter writer)
+{
+    assert(writer != NULL);
+    if (writer->format == ELECTION_EXPORT_JSON)
+    {
+        putText(writer, JSON_END);
+    }
+    flushBuffer(writer);
+    if (!writer->failed && fflush(writer->stream) != 0)
+    {
+        writer->failed = true;
+    }
+    return !writer->failed;
+}
+
+/*
+writes the record as a line of comma separated values
+*/
+static void writeCsv(ExportWriter writer, const ElectionAreaResult* result)
+{
+    putInt(writer, result->area_id);
+    putText(writer, ",");
+    putText(writer, result->area_name);
+    putText(writer, ",");
+    putInt(writer, result->tribe_id);
+    putText(writer, ",");
+    putText(writer, result->tribe_name);
+    putText(writer, ",");
+    putInt64(writer, result->votes);
+    putText(writer, "\n");
+}
+
+/*
+writes the record as an object of the array, after a comma if it isn't the first
+*/
+static void writeJson(ExportWriter writer, const ElectionAreaResult* result)
+{
+    putText(writer, writer->count == 0 ? "\n{\"area_id\":" : ",\n{\"area_id\":");
+    putInt(writer, result->area_id);
+    putText(writer, ",\"area_name\":\"");
+    putText(writer, result->area_name);
+    putText(writer, "\",\"tribe_id\":");
+    putInt(writer, result->tribe_id);
+    putText(writer, ",\"tribe_name\":\"");
+    putText(writer, result->tribe_name);
+    putText(writer, "\",\"votes\":");
+    putInt64(writer, result->votes);
+    putText(writer, "}");
+}
+
+/*
+writes the record as varints, every name after its length
+*/
+static void writeBinary(ExportWriter writer, const ElectionAreaResult* result)
+{
+    size_t area_name_length = strlen(result->area_name);
+    size_t tribe_name_length = strlen(result->tribe_name);
+    putVarint(writer, (uint64_t)result->area_id);//ids and votes aren't negative
+    putVarint(writer, area_name_length);
+    put(writer, result->area_name, area_name_length);
+    putVarint(writer, (uint64_t)result->tribe_id);
+    putVarint(writer, tribe_name_length);
+    put(writer, result->tribe_name, tribe_name_length);
+    putVarint(writer, (uint64_t)result->votes);
+}
+
+/*
+adds the bytes to the buffer, writing the buffer to the stream first if they don't fit. bytes that
+are longer than the buffer are written to the stream as they are. nothing is added once a write failed
+*/
+static void put(ExportWriter writer, const void* bytes, size_t size)
+{
+    if (writer->failed)
+    {
+        return;
+    }
+    if (size > (size_t)(BUFFER_SIZE - writer->used))
+    {
+        flushBuffer(writer);
+        if (size > BUFFER_SIZE)
+        {
+            if (!writer->failed && fwrite(bytes, 1, size, writer->stream) != size)
+            {
+                writer->failed = true;
+            }
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->used, bytes, size);
+    writer->used += (int)size;
+}
+
+/*
+adds the characters of the string, without its terminator
+*/
+static void putText(ExportWriter writer, const char* text)
+{
+    put(writer, text, strlen(text));
+}
+
+/*
+adds the decimal digits of the value
+*/
+static void putInt(ExportWriter writer, int value)
+{
+    char string[INT_STRING_SIZE];
+    put(writer, string, writeIntToString(value, string));
+}
+
+/*
+adds the decimal digits of the value
+*/
+static void putInt64(ExportWriter writer, int64_t value)
+{
+    char string[INT64_STRING_SIZE];
+    put(writer, string, writeInt64ToString(value, string));
+}
+
+/*
+adds the value seven bits at a time, the lowest first, with the highest bit of every byte but the last set
+*/
+static void putVarint(ExportWriter writer, uint64_t value)
+{
+    unsigned char buffer[MAX_VARINT_SIZE];
+    int size = 0;
+    while (value > VARINT_MASK)
+    {
+        buffer[size++] = (unsigned char)(value & VARINT_MASK) | VARINT_MORE;
+        value >>= VARINT_BITS;
+    }
+    buffer[size++] = (unsigned char)value;
+    put(writer, buffer, size);
+}
+
+/*
+writes the buffer to the stream and empties it
+*/
+static void flushBuffer(ExportWriter writer)
+{
+    if (!writer->failed && writer->used > 0 &&
+        fwrite(writer->buffer, 1, writer->used, writer->stream) != (size_t)writer->used)
+    {
+        writer->failed = true;
+    }
+    writer->used = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef MTM_EXPORT_H
+#define MTM_EXPORT_H
+
+#include "allocator.h"
+#include "election_ext.h"
+#include <stdio.h>
+#include <stdbool.h>
+/**
+* Export
+* Implements writing the winner of every area to a stream as it is found, in one of the formats of
+* ElectionExportFormat, so the results of an election don't have to be kept in a map first.
+* The records are gathered in a buffer of the writer and written to the stream a few kilobytes at a time.
+* CSV has a header line and a line per area, JSON is an array with an object per area, with the same
+* names as the CSV columns. Names are only low case letters and spaces, so they are written as they are.
+* The binary format starts with the 7 bytes "ELRESLT" and a version byte, and every record is the area id,
+* the length and characters of the area name, the tribe id, the length and characters of the tribe name
+* and the votes, every number a variable length integer as in trace.h.
+**/
+
+/** Type for defining an ExportWriter */
+typedef struct export_writer_t* ExportWriter;
+
+/*
+*exportWriterCreate: creates a writer of records in the given format to the given stream, which it doesn't
+*close. the writer is allocated with the given allocator, or with the default allocator if it is NULL
+*@return
+*NULL if stream is NULL, the format is unknown or memory allocation failed
+*/
+ExportWriter exportWriterCreate(FILE* stream, ElectionExportFormat format, const Allocator* allocator);
+/*
+*exportWriterDestroy: deallocates the writer, records that weren't written by exportWriterFinish are lost.
+*If writer is NULL nothing will be done
+*/
+void exportWriterDestroy(ExportWriter writer);
+/*
+*exportWriterWrite: adds the record of one area, it is an ElectionResultVisitor with the writer as its
+*context, so it can be given to electionVisitResults as it is
+*@return
+*false if the stream couldn't be written, the records after that aren't written
+*/
+bool exportWriterWrite(const ElectionAreaResult* result, void* writer);
+/*
+*exportWriterFinish: ends the records, writes what is left in the buffer and flushes the stream
+*@return
+*false if the stream couldn't be written, now or by an earlier record
+*/
+bool exportWriterFinish(ExportWriter writer);
+
+#endif //MTM_EXPORT_H
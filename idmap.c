@@ -0,0 +1,229 @@
+#include "idmap.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define INITIAL_CAPACITY 16
+#define EMPTY_ID -1
+#define DELETED_ID -2
+#define NOT_FOUND -1
+#define HASH_BITS 32
+#define HASH_MULTIPLIER 2654435761u
+
+/*
+capacity is a power of two, used counts the deleted slots too so a lookup always ends
+*/
+struct id_map_t
+{
+    const Allocator* allocator;
+    int capacity;
+    int shift;
+    int used;
+    int* ids;
+    void** values;
+};
+
+IdMap idMapCreate(const Allocator* allocator);
+void idMapDestroy(IdMap id_map);
+IdMapResult idMapPut(IdMap id_map, int id, void* value);
+IdMapResult idMapSet(IdMap id_map, int id, void* value);
+void* idMapGet(IdMap id_map, int id);
+IdMapResult idMapRemove(IdMap id_map, int id);
+void idMapClear(IdMap id_map);
+static bool allocTable(IdMap id_map, int capacity);
+static bool growTable(IdMap id_map);
+static int findSlot(IdMap id_map, int id);
+static int hashId(IdMap id_map, int id);
+
+IdMap idMapCreate(const Allocator* allocator)
+{
+    IdMap id_map = allocatorAllocate(allocator, sizeof(*id_map));
+    if (id_map == NULL)
+    {
+        return NULL;
+    }
+    id_map->allocator = allocator;
+    if (!allocTable(id_map, INITIAL_CAPACITY))
+    {
+        allocatorDeallocate(allocator, id_map);
+        return NULL;
+    }
+    return id_map;
+}
+
+void idMapDestroy(IdMap id_map)
+{
+    if (id_map != NULL)
+    {
+        allocatorDeallocate(id_map->allocator, id_map->ids);
+        allocatorDeallocate(id_map->allocator, id_map->values);
+        allocatorDeallocate(id_map->allocator, id_map);
+    }
+}
+
+IdMapResult idMapPut(IdMap id_map, int id, void* value)
+{
+    assert(id_map != NULL && id >= 0);
+    if (findSlot(id_map, id) != NOT_FOUND)
+    {
+        return ID_MAP_ITEM_ALREADY_EXISTS;
+    }
+    return idMapSet(id_map, id, value);
+}
+
+IdMapResult idMapSet(IdMap id_map, int id, void* value)
+{
+    assert(id_map != NULL && id >= 0);
+    int slot = findSlot(id_map, id);
+    if (slot != NOT_FOUND)
+    {
+        id_map->values[slot] = value;
+        return ID_MAP_SUCCESS;
+    }
+    if (2 * (id_map->used + 1) > id_map->capacity && !growTable(id_map))//keep the table at most half full
+    {
+        return ID_MAP_OUT_OF_MEMORY;
+    }
+    slot = hashId(id_map, id);
+    while (id_map->ids[slot] != EMPTY_ID && id_map->ids[slot] != DELETED_ID)
+    {
+        slot = (slot + 1) & (id_map->capacity - 1);
+    }
+    if (id_map->ids[slot] == EMPTY_ID)
+    {
+        id_map->used++;
+    }
+    id_map->ids[slot] = id;
+    id_map->values[slot] = value;
+    return ID_MAP_SUCCESS;
+}
+
+void* idMapGet(IdMap id_map, int id)
+{
+    assert(id_map != NULL);
+    int slot = findSlot(id_map, id);
+    if (slot == NOT_FOUND)
+    {
+        return NULL;
+    }
+    return id_map->values[slot];
+}
+
+IdMapResult idMapRemove(IdMap id_map, int id)
+{
+    assert(id_map != NULL);
+    int slot = findSlot(id_map, id);
+    if (slot == NOT_FOUND)
+    {
+        return ID_MAP_ITEM_DOES_NOT_EXIST;
+    }
+    id_map->ids[slot] = DELETED_ID;//the slot still counts as used so later ids are found
+    id_map->values[slot] = NULL;
+    return ID_MAP_SUCCESS;
+}
+
+void idMapClear(IdMap id_map)
+{
+    assert(id_map != NULL);
+    for (int i = 0; i < id_map->capacity; i++)
+    {
+        id_map->ids[i] = EMPTY_ID;
+        id_map->values[i] = NULL;
+    }
+    id_map->used = 0;
+}
+
+/*
+allocates an empty table in the given capacity, return false if allocation failed
+*/
+static bool allocTable(IdMap id_map, int capacity)
+{
+    id_map->ids = allocatorAllocate(id_map->allocator, capacity * sizeof(int));
+    id_map->values = allocatorAllocate(id_map->allocator, capacity * sizeof(void*));
+    if (id_map->ids == NULL || id_map->values == NULL)
+    {
+        allocatorDeallocate(id_map->allocator, id_map->ids);
+        allocatorDeallocate(id_map->allocator, id_map->values);
+        return false;
+    }
+    id_map->capacity = capacity;
+    id_map->shift = HASH_BITS;
+    while (capacity > 1)//capacity is 2^(HASH_BITS - shift)
+    {
+        id_map->shift--;
+        capacity /= 2;
+    }
+    idMapClear(id_map);
+    return true;
+}
+
+/*
+moves all the ids to a table twice as big (or the same size if most of the slots are deleted)
+return false if allocation failed, the map is unchanged in that case
+*/
+static bool growTable(IdMap id_map)
+{
+    int old_capacity = id_map->capacity, live = 0;
+    int* old_ids = id_map->ids;
+    void** old_values = id_map->values;
+    for (int i = 0; i < old_capacity; i++)
+    {
+        if (old_ids[i] >= 0)
+        {
+            live++;
+        }
+    }
+    int new_capacity = 4 * live >= old_capacity ? 2 * old_capacity : old_capacity;
+    if (!allocTable(id_map, new_capacity))
+    {
+        id_map->ids = old_ids;
+        id_map->values = old_values;
+        return false;
+    }
+    for (int i = 0; i < old_capacity; i++)
+    {
+        if (old_ids[i] >= 0)
+        {
+            int slot = hashId(id_map, old_ids[i]);
+            while (id_map->ids[slot] != EMPTY_ID)
+            {
+                slot = (slot + 1) & (new_capacity - 1);
+            }
+            id_map->ids[slot] = old_ids[i];
+            id_map->values[slot] = old_values[i];
+            id_map->used++;
+        }
+    }
+    allocatorDeallocate(id_map->allocator, old_ids);
+    allocatorDeallocate(id_map->allocator, old_values);
+    return true;
+}
+
+/*
+return the slot of the given id or NOT_FOUND if the id isn't mapped
+*/
+static int findSlot(IdMap id_map, int id)
+{
+    int slot = hashId(id_map, id);
+    while (id_map->ids[slot] != EMPTY_ID)
+    {
+        if (id_map->ids[slot] == id)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & (id_map->capacity - 1);
+    }
+    return NOT_FOUND;
+}
+
+/*
+multiplicative hashing, takes the high bits of the product so ids with a common stride
+are spread over the table too
+*/
+static int hashId(IdMap id_map, int id)
+{
+    return (int)(((uint64_t)((uint32_t)id * HASH_MULTIPLIER)) >> id_map->shift);
+}
@@ -0,0 +1,68 @@
+#ifndef MTM_IDMAP_H
+#define MTM_IDMAP_H
+
+#include "allocator.h"
+#include <stdbool.h>
+/**
+* IdMap
+* Implements a hash table from a non negative id to a pointer.
+* The table does not own the pointers it keeps, destroying the table does not
+* deallocate them.
+* The table uses open addressing, so a lookup is one probe in the common case.
+**/
+
+/** Type for defining an IdMap */
+typedef struct id_map_t* IdMap;
+
+/** Type used for returning error codes from id map functions */
+typedef enum IdMapResult_t
+{
+    ID_MAP_SUCCESS,
+    ID_MAP_OUT_OF_MEMORY,
+    ID_MAP_ITEM_ALREADY_EXISTS,
+    ID_MAP_ITEM_DOES_NOT_EXIST
+} IdMapResult;
+
+/*
+*idMapCreate: Allocates a new empty id map, the map allocates its table with the given allocator
+*@return
+* 	NULL - if allocations failed.
+* 	A new IdMap in case of success.
+*/
+IdMap idMapCreate(const Allocator* allocator);
+/*
+*idMapDestroy: Deallocates an existing id map. If id_map is NULL nothing will be done
+*/
+void idMapDestroy(IdMap id_map);
+/*
+*idMapPut: maps the given id to the given value
+*@return
+*ID_MAP_ITEM_ALREADY_EXISTS if the id is already mapped, the value is not changed
+*ID_MAP_OUT_OF_MEMORY if the table had to grow and allocation failed
+*ID_MAP_SUCCESS otherwise
+*/
+IdMapResult idMapPut(IdMap id_map, int id, void* value);
+/*
+*idMapSet: maps the given id to the given value, overriding the value if the id is mapped
+*@return
+*ID_MAP_OUT_OF_MEMORY if the table had to grow and allocation failed
+*ID_MAP_SUCCESS otherwise
+*/
+IdMapResult idMapSet(IdMap id_map, int id, void* value);
+/*
+*idMapGet: return the value mapped to the given id or NULL if the id isn't mapped
+*/
+void* idMapGet(IdMap id_map, int id);
+/*
+*idMapRemove: removes the given id from the map
+*@return
+*ID_MAP_ITEM_DOES_NOT_EXIST if the id isn't mapped
+*ID_MAP_SUCCESS otherwise
+*/
+IdMapResult idMapRemove(IdMap id_map, int id);
+/*
+*idMapClear: removes all the ids from the map, keeps the allocated table
+*/
+void idMapClear(IdMap id_map);
+
+#endif //MTM_IDMAP_H
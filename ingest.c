@@ -0,0 +1,360 @@
+#define _POSIX_C_SOURCE 200809L
+#include "ingest.h"
+#include "election.h"
+#include "allocator.h"
+#include "votebuffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include <pthread.h>
+
+#define CACHE_LINE_SIZE 64
+#define BATCH_SIZE 256
+
+/*
+change is positive for votes to add and negative for votes to remove
+*/
+struct vote_record_t
+{
+    int area_id;
+    int tribe_id;
+    int change;
+};
+
+/*
+a cell is free for the push of position when its sequence is position, and holds the record of
+position when its sequence is position + 1
+*/
+struct cell_t
+{
+    size_t sequence;
+    struct vote_record_t record;
+};
+
+/*
+the producers only write enqueue_position and the cells, the applier only writes dequeue_position,
+they are on different cache lines so pushing doesn't slow down draining
+lock guards sleeping, stopping, applied and rejected, election_lock is held by the applier while it
+applies a batch. buffer merges the votes of a batch
+*/
+struct ingest_t
+{
+    const Allocator* allocator;
+    Election election;
+    struct cell_t* cells;
+    size_t mask;
+    char producers_line[CACHE_LINE_SIZE];
+    size_t enqueue_position;
+    char applier_line[CACHE_LINE_SIZE];
+    size_t dequeue_position;
+    size_t applied;
+    int rejected;
+    bool sleeping;
+    bool stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+    pthread_mutex_t election_lock;
+    pthread_t applier;
+    VoteBuffer buffer;
+};
+
+Ingest ingestCreate(Election election, int capacity, const Allocator* allocator);
+void ingestDestroy(Ingest ingest);
+IngestResult ingestAddVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes);
+IngestResult ingestRemoveVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes);
+IngestResult ingestFlush(Ingest ingest, int* rejected);
+void ingestLockElection(Ingest ingest);
+void ingestUnlockElection(Ingest ingest);
+static IngestResult pushVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes, int sign);
+static bool enqueue(Ingest ingest, const struct vote_record_t* record);
+static bool dequeue(Ingest ingest, struct vote_record_t* record);
+static bool isQueueEmpty(Ingest ingest);
+static void* applyVotes(void* argument);
+static bool waitForVotes(Ingest ingest);
+static int applyBatch(Ingest ingest);
+
+Ingest ingestCreate(Election election, int capacity, const Allocator* allocator)
+{
+    if (election == NULL || capacity <= 0 || capacity > INT_MAX / 2)
+    {
+        return NULL;
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    size_t size = 1;
+    while (size < (size_t)capacity)//a power of two so a position is turned into a cell with a mask
+    {
+        size *= 2;
+    }
+    Ingest ingest = allocatorAllocate(allocator, sizeof(*ingest));
+    if (ingest == NULL)
+    {
+        return NULL;
+    }
+    ingest->cells = allocatorAllocate(allocator, size * sizeof(*ingest->cells));
+    ingest->buffer = voteBufferCreate(election, BATCH_SIZE, allocator);
+    if (ingest->cells == NULL || ingest->buffer == NULL)
+    {
+        allocatorDeallocate(allocator, ingest->cells);
+        voteBufferDestroy(ingest->buffer);
+        allocatorDeallocate(allocator, ingest);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        ingest->cells[i].sequence = i;
+    }
+    ingest->allocator = allocator;
+    ingest->election = election;
+    ingest->mask = size - 1;
+    ingest->enqueue_position = 0;
+    ingest->dequeue_position = 0;
+    ingest->applied = 0;
+    ingest->rejected = 0;
+    ingest->sleeping = false;
+    ingest->stopping = false;
+    pthread_mutex_init(&ingest->lock, NULL);
+    pthread_cond_init(&ingest->work, NULL);
+    pthread_cond_init(&ingest->done, NULL);
+    pthread_mutex_init(&ingest->election_lock, NULL);
+    if (pthread_create(&ingest->applier, NULL, applyVotes, ingest) != 0)
+    {
+        pthread_mutex_destroy(&ingest->lock);
+        pthread_cond_destroy(&ingest->work);
+        pthread_cond_destroy(&ingest->done);
+        pthread_mutex_destroy(&ingest->election_lock);
+        voteBufferDestroy(ingest->buffer);
+        allocatorDeallocate(allocator, ingest->cells);
+        allocatorDeallocate(allocator, ingest);
+        return NULL;
+    }
+    return ingest;
+}
+
+void ingestDestroy(Ingest ingest)
+{
+    if (ingest == NULL)
+    {
+        return;
+    }
+    pthread_mutex_lock(&ingest->lock);
+    ingest->stopping = true;//the applier drains the queue before it stops
+    pthread_cond_signal(&ingest->work);
+    pthread_mutex_unlock(&ingest->lock);
+    pthread_join(ingest->applier, NULL);
+    pthread_mutex_destroy(&ingest->lock);
+    pthread_cond_destroy(&ingest->work);
+    pthread_cond_destroy(&ingest->done);
+    pthread_mutex_destroy(&ingest->election_lock);
+    voteBufferDestroy(ingest->buffer);//empty, the applier flushed it
+    allocatorDeallocate(ingest->allocator, ingest->cells);
+    allocatorDeallocate(ingest->allocator, ingest);
+}
+
+IngestResult ingestAddVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes)
+{
+    return pushVote(ingest, area_id, tribe_id, num_of_votes, 1);
+}
+
+IngestResult ingestRemoveVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes)
+{
+    return pushVote(ingest, area_id, tribe_id, num_of_votes, -1);
+}
+
+IngestResult ingestFlush(Ingest ingest, int* rejected)
+{
+    if (ingest == NULL)
+    {
+        return INGEST_NULL_ARGUMENT;
+    }
+    //every push that returned before the call took a position below the current one
+    size_t target = __atomic_load_n(&ingest->enqueue_position, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&ingest->lock);
+    while (ingest->applied < target)
+    {
+        pthread_cond_wait(&ingest->done, &ingest->lock);
+    }
+    if (rejected != NULL)
+    {
+        *rejected = ingest->rejected;
+    }
+    ingest->rejected = 0;
+    pthread_mutex_unlock(&ingest->lock);
+    return INGEST_SUCCESS;
+}
+
+void ingestLockElection(Ingest ingest)
+{
+    assert(ingest != NULL);
+    pthread_mutex_lock(&ingest->election_lock);
+}
+
+void ingestUnlockElection(Ingest ingest)
+{
+    assert(ingest != NULL);
+    pthread_mutex_unlock(&ingest->election_lock);
+}
+
+/*
+validates the vote and pushes it with the given sign, wakes the applier if it sleeps
+*/
+static IngestResult pushVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes, int sign)
+{
+    if (ingest == NULL)
+    {
+        return INGEST_NULL_ARGUMENT;
+    }
+    if (area_id < 0 || tribe_id < 0)
+    {
+        return INGEST_INVALID_ID;
+    }
+    if (num_of_votes <= 0)
+    {
+        return INGEST_INVALID_VOTES;
+    }
+    struct vote_record_t record = {area_id, tribe_id, sign * num_of_votes};
+    if (!enqueue(ingest, &record))
+    {
+        return INGEST_QUEUE_FULL;
+    }
+    if (__atomic_load_n(&ingest->sleeping, __ATOMIC_SEQ_CST))//the applier sets it before it checks the queue
+    {
+        pthread_mutex_lock(&ingest->lock);
+        pthread_cond_signal(&ingest->work);
+        pthread_mutex_unlock(&ingest->lock);
+    }
+    return INGEST_SUCCESS;
+}
+
+/*
+takes the next position and writes the record to its cell, many threads may push at once
+return false if the queue is full
+*/
+static bool enqueue(Ingest ingest, const struct vote_record_t* record)
+{
+    size_t position = __atomic_load_n(&ingest->enqueue_position, __ATOMIC_RELAXED);
+    while (true)
+    {
+        struct cell_t* cell = &ingest->cells[position & ingest->mask];
+        size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0)
+        {
+            if (__atomic_compare_exchange_n(&ingest->enqueue_position, &position, position + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                cell->record = *record;
+                __atomic_store_n(&cell->sequence, position + 1, __ATOMIC_SEQ_CST);//ordered before loading sleeping
+                return true;
+            }
+        }//a failed exchange sets position to the current one
+        else if (difference < 0)//the cell still holds the record of the previous round
+        {
+            return false;
+        }
+        else
+        {
+            position = __atomic_load_n(&ingest->enqueue_position, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/*
+takes the next record out of the queue, only the applier calls it
+return false if the next record wasn't written yet
+*/
+static bool dequeue(Ingest ingest, struct vote_record_t* record)
+{
+    size_t position = ingest->dequeue_position;
+    struct cell_t* cell = &ingest->cells[position & ingest->mask];
+    if (__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) != position + 1)
+    {
+        return false;
+    }
+    *record = cell->record;
+    __atomic_store_n(&cell->sequence, position + ingest->mask + 1, __ATOMIC_RELEASE);//free for the next round
+    ingest->dequeue_position = position + 1;
+    return true;
+}
+
+/*
+return true if the next record wasn't written yet
+*/
+static bool isQueueEmpty(Ingest ingest)
+{
+    size_t position = ingest->dequeue_position;
+    struct cell_t* cell = &ingest->cells[position & ingest->mask];
+    return __atomic_load_n(&cell->sequence, __ATOMIC_SEQ_CST) != position + 1;
+}
+
+/*
+the applier thread, applies batches until the ingest is destroyed and the queue is empty
+*/
+static void* applyVotes(void* argument)
+{
+    Ingest ingest = argument;
+    while (waitForVotes(ingest))
+    {
+        pthread_mutex_lock(&ingest->election_lock);
+        int rejected = applyBatch(ingest);
+        pthread_mutex_unlock(&ingest->election_lock);
+        pthread_mutex_lock(&ingest->lock);
+        ingest->applied = ingest->dequeue_position;
+        ingest->rejected += rejected;
+        pthread_cond_broadcast(&ingest->done);
+        pthread_mutex_unlock(&ingest->lock);
+    }
+    return NULL;
+}
+
+/*
+sleeps until the queue has a record or the ingest is destroyed
+return false if the ingest is destroyed and the queue is empty
+*/
+static bool waitForVotes(Ingest ingest)
+{
+    if (!isQueueEmpty(ingest))
+    {
+        return true;
+    }
+    pthread_mutex_lock(&ingest->lock);
+    __atomic_store_n(&ingest->sleeping, true, __ATOMIC_SEQ_CST);//a push the check misses sees it and signals
+    while (isQueueEmpty(ingest) && !ingest->stopping)
+    {
+        pthread_cond_wait(&ingest->work, &ingest->lock);
+    }
+    __atomic_store_n(&ingest->sleeping, false, __ATOMIC_SEQ_CST);
+    bool has_votes = !isQueueEmpty(ingest);
+    pthread_mutex_unlock(&ingest->lock);
+    return has_votes;
+}
+
+/*
+takes up to BATCH_SIZE records out of the queue, merges them in the buffer and applies them
+return the number of merged updates the election rejected
+*/
+static int applyBatch(Ingest ingest)
+{
+    struct vote_record_t record;
+    int rejected;
+    for (int i = 0; i < BATCH_SIZE && dequeue(ingest, &record); i++)//the records were validated when pushed
+    {
+        if (record.change > 0)
+        {
+            voteBufferAddVote(ingest->buffer, record.area_id, record.tribe_id, record.change);
+        }
+        else
+        {
+            voteBufferRemoveVote(ingest->buffer, record.area_id, record.tribe_id, -record.change);
+        }
+    }
+    voteBufferFlush(ingest->buffer, &rejected);
+    return rejected;
+}
@@ -0,0 +1,78 @@
+#ifndef MTM_INGEST_H
+#define MTM_INGEST_H
+
+#include "election.h"
+#include "allocator.h"
+/**
+* Ingest
+* Implements an asynchronous front door to an Election.
+* Any number of threads push votes into a bounded lock-free queue without waiting for the election.
+* One applier thread drains the queue in batches, merges the votes of the same (area, tribe) in a
+* batch into one update and applies the batch to the election. Merging keeps the result of removing
+* votes exactly as if every vote was applied on its own, including votes that never drop below zero.
+* While an Ingest exists the applier changes the election, so any other use of the election has to
+* be between ingestLockElection and ingestUnlockElection.
+**/
+
+/** Type for defining an Ingest */
+typedef struct ingest_t* Ingest;
+
+/** Type used for returning error codes from ingest functions */
+typedef enum IngestResult_t
+{
+    INGEST_SUCCESS,
+    INGEST_NULL_ARGUMENT,
+    INGEST_INVALID_ID,
+    INGEST_INVALID_VOTES,
+    INGEST_QUEUE_FULL
+} IngestResult;
+
+/*
+*ingestCreate: creates a queue of at least the given capacity of votes for the given election and starts
+*its applier thread. the queue is allocated with the given allocator, or with the default allocator if
+*it is NULL
+*@return
+*NULL if election is NULL, capacity isn't positive, memory allocation failed or the thread couldn't start
+*/
+Ingest ingestCreate(Election election, int capacity, const Allocator* allocator);
+/*
+*ingestDestroy: applies all the votes in the queue, stops the applier thread and deallocates the queue.
+*the election isn't destroyed. no thread may push votes during or after the call.
+*If ingest is NULL nothing will be done
+*/
+void ingestDestroy(Ingest ingest);
+/*
+*ingestAddVote: pushes votes to add to the queue without waiting for them to be applied, like
+*electionAddVote. votes of areas or tribes that don't exist when they are applied are rejected
+*@return
+*INGEST_NULL_ARGUMENT if ingest is NULL
+*INGEST_INVALID_ID if area_id or tribe_id is negative
+*INGEST_INVALID_VOTES if num_of_votes isn't positive
+*INGEST_QUEUE_FULL if the queue is full, the applier is behind and the caller should push again later
+*INGEST_SUCCESS otherwise
+*/
+IngestResult ingestAddVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes);
+/*
+*ingestRemoveVote: like ingestAddVote but for votes to remove, like electionRemoveVote
+*/
+IngestResult ingestRemoveVote(Ingest ingest, int area_id, int tribe_id, int num_of_votes);
+/*
+*ingestFlush: waits until all the votes that were pushed before the call are applied to the election.
+*rejected is set to the number of merged updates the election rejected since the previous flush,
+*if it isn't NULL
+*@return
+*INGEST_NULL_ARGUMENT if ingest is NULL
+*INGEST_SUCCESS otherwise
+*/
+IngestResult ingestFlush(Ingest ingest, int* rejected);
+/*
+*ingestLockElection: waits until the applier is between batches and keeps it from applying votes
+*until ingestUnlockElection, so the election can be read or changed
+*/
+void ingestLockElection(Ingest ingest);
+/*
+*ingestUnlockElection: lets the applier apply votes again
+*/
+void ingestUnlockElection(Ingest ingest);
+
+#endif //MTM_INGEST_H
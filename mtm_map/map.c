@@ -1,11 +1,15 @@
 #include "map.h"
+#include "map_ext.h"
 #include "node.h"
+#include "../allocator.h"
+#include "../skiplist.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
 
 #define NULL_MAP -1
+#define MAX_KEY_DIGITS 18
 
 Map mapCreate();
 void mapDestroy(Map map);
@@ -18,30 +22,103 @@ MapResult mapRemove(Map map, const char *key);
 char *mapGetFirst(Map map);
 char *mapGetNext(Map map);
 MapResult mapClear(Map map);
-char *mapGetFirst(Map map);
-char *mapGetNext(Map map);
+Map mapCreateWithAllocator(const Allocator *allocator);
+Map mapCreateWithCapacity(const Allocator *allocator, int capacity);
+MapResult mapAppend(Map map, const char *key, const char *data);
+Map mapCreateOrdered(const Allocator *allocator);
+char *mapLowerBound(Map map, const char *key);
+static Node getLastNode(Map map);
+static bool parseKey(const char *key, long long *number);
+static Node getOrderedNode(Map map, const char *key);
+static MapResult orderedPut(Map map, const char *key, const char *data);
+static MapResult orderedRemove(Map map, const char *key);
+static void orderedClear(Map map);
+static Map orderedCopy(Map map);
+static char *getCursorKey(SkipListCursor cursor);
 
+/*
+last is the last node of the list or NULL if it has to be found again,
+block is the block the nodes were allocated in by mapCreateWithCapacity and spare
+are the nodes of the block that are not used yet.
+all the nodes and strings of the map are allocated with allocator
+ordered is NULL unless the map was created by mapCreateOrdered, then it maps the number of every
+key to a node of its own that keeps the key and data, node stays empty and ordered_iterator is
+the iterator
+*/
 struct Map_t
 {
+    const Allocator *allocator;
     Node node;
-    char*  iterator;
+    Node iterator;
+    Node last;
+    Node block;
+    Node spare;
+    SkipList ordered;
+    SkipListCursor ordered_iterator;
 };
 
 Map mapCreate()
 {
-    Map map = malloc(sizeof(*map));
+    return mapCreateWithAllocator(NULL);
+}
+
+Map mapCreateWithAllocator(const Allocator *allocator)
+{
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    Map map = allocatorAllocate(allocator, sizeof(*map));
     if (map == NULL)
     {
         return NULL;
     }
-    Node new_node = nodeCreate();
+    Node new_node = nodeCreate(allocator);
     if (new_node == NULL)
     {
-        free(map);
+        allocatorDeallocate(allocator, map);
         return NULL;
     }
+    map->allocator = allocator;
+    map->ordered = NULL;
+    map->ordered_iterator = NULL;
     map->iterator=NULL;
     map->node = new_node;
+    map->last = NULL;
+    map->block = NULL;
+    map->spare = NULL;
+    return map;
+}
+
+Map mapCreateWithCapacity(const Allocator *allocator, int capacity)
+{
+    if (capacity <= 0)
+    {
+        return mapCreateWithAllocator(allocator);
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    Map map = allocatorAllocate(allocator, sizeof(*map));
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->block = nodeCreateBlock(allocator, capacity);
+    if (map->block == NULL)
+    {
+        allocatorDeallocate(allocator, map);
+        return NULL;
+    }
+    map->allocator = allocator;
+    map->ordered = NULL;
+    map->ordered_iterator = NULL;
+    map->node = map->block;//the first node of the block is the first node of the list
+    map->spare = nodeGetNext(map->block);
+    nodeSetNext(map->node, NULL);
+    map->iterator = NULL;
+    map->last = NULL;
     return map;
 }
 
@@ -49,8 +126,14 @@ void mapDestroy(Map map)
 {
     if (map != NULL)
     {
-        nodeDestroy(map->node);
-        free(map);
+        if (map->ordered != NULL)
+        {
+            orderedClear(map);
+            skipListDestroy(map->ordered);
+        }
+        nodeDestroy(map->node, map->allocator);
+        nodeDestroyBlock(map->block, map->allocator);
+        allocatorDeallocate(map->allocator, map);
     }
 }
 
@@ -60,18 +143,22 @@ Map mapCopy(Map map)
     {
         return NULL;
     }
-    Map map_copy = mapCreate();
+    if (map->ordered != NULL)
+    {
+        return orderedCopy(map);
+    }
+    Map map_copy = mapCreateWithAllocator(map->allocator);
     if (map_copy == NULL)
     {
         return NULL;
     }
-    Node node_copy = nodeCopy(map->node);
+    Node node_copy = nodeCopy(map->node, map->allocator);
     if (node_copy == NULL)
     {
         mapDestroy(map_copy);
         return NULL;
     }
-    free(map_copy->node);
+    nodeDestroy(map_copy->node, map_copy->allocator);
     map_copy->node = node_copy;
     map_copy->iterator=NULL;
     return map_copy;
@@ -82,6 +169,10 @@ int mapGetSize(Map map)
     {
         return NULL_MAP;
     }
+    if (map->ordered != NULL)
+    {
+        return skipListGetSize(map->ordered);
+    }
     if(nodeGetKey(map->node)==NULL)
     {
         return 0;
@@ -95,6 +186,10 @@ bool mapContains(Map map, const char *key)
     {
         return false;
     }
+    if (map->ordered != NULL)
+    {
+        return getOrderedNode(map, key) != NULL;
+    }
     return nodeContains(map->node,key);
 }
 
@@ -105,21 +200,69 @@ MapResult mapPut(Map map, const char *key, const char *data)
         return MAP_NULL_ARGUMENT;
     }
     assert(map->node != NULL);//assums node cant be NULL if map not NULL
-    NodeResult result = nodePut(map->node,key,data);
+    if (map->ordered != NULL)
+    {
+        return orderedPut(map, key, data);
+    }
+    map->last = NULL;
+    NodeResult result = nodePut(map->node,key,data, map->allocator);
     if (result == NODE_OUT_OF_MEMORY)
     {
-        mapDestroy(map);
         return MAP_OUT_OF_MEMORY;
     }
     return MAP_SUCCESS;
 }
 
+MapResult mapAppend(Map map, const char *key, const char *data)
+{
+    if (map == NULL || key == NULL || data == NULL)
+    {
+        return MAP_NULL_ARGUMENT;
+    }
+    if (map->ordered != NULL)//the place of the key is found by its number anyway
+    {
+        return orderedPut(map, key, data);
+    }
+    if (nodeGetKey(map->node) == NULL)//the map is empty
+    {
+        map->last = NULL;
+        return nodePut(map->node, key, data, map->allocator) == NODE_SUCCESS ? MAP_SUCCESS : MAP_OUT_OF_MEMORY;
+    }
+    Node new_node = map->spare;
+    if (new_node != NULL)
+    {
+        map->spare = nodeGetNext(new_node);
+        nodeSetNext(new_node, NULL);
+    }
+    else
+    {
+        new_node = nodeCreate(map->allocator);
+        if (new_node == NULL)
+        {
+            return MAP_OUT_OF_MEMORY;
+        }
+    }
+    Node last = getLastNode(map);
+    if (nodePutAfter(last, new_node, key, data, map->allocator) != NODE_SUCCESS)
+    {
+        nodeSetNext(new_node, map->spare);//a node of the block goes back to the spare nodes
+        map->spare = new_node;
+        return MAP_OUT_OF_MEMORY;
+    }
+    map->last = new_node;
+    return MAP_SUCCESS;
+}
+
 char* mapGet(Map map, const char *key)
 {
     if (map == NULL || key == NULL)
     {
         return NULL;
     }
+    if (map->ordered != NULL)
+    {
+        return nodeGetData(getOrderedNode(map, key));
+    }
     return nodeGet(map->node, key);
 }
 
@@ -130,7 +273,12 @@ MapResult mapRemove(Map map, const char *key)
         return MAP_NULL_ARGUMENT;
     }
     assert(map->node != NULL);
-    NodeResult result = nodeRemove(map->node,key);
+    if (map->ordered != NULL)
+    {
+        return orderedRemove(map, key);
+    }
+    map->last = NULL;
+    NodeResult result = nodeRemove(map->node,key, map->allocator);
     if (result == NODE_ITEM_DOES_NOT_EXIST)
     {
         return MAP_ITEM_DOES_NOT_EXIST;
@@ -144,7 +292,13 @@ MapResult mapClear(Map map)
         return MAP_NULL_ARGUMENT;
     }
     assert(map->node != NULL);
-    nodeClear(map->node);
+    if (map->ordered != NULL)
+    {
+        orderedClear(map);
+        return MAP_SUCCESS;
+    }
+    map->last = NULL;
+    nodeClear(map->node, map->allocator);
     return MAP_SUCCESS;
 }
 
@@ -154,21 +308,208 @@ char* mapGetFirst(Map map)
     {
         return NULL;
     }
-    map->iterator = nodeGetKey(map->node);
-    return map->iterator;
+    if (map->ordered != NULL)
+    {
+        map->ordered_iterator = skipListFirst(map->ordered);
+        return getCursorKey(map->ordered_iterator);
+    }
+    map->iterator = nodeGetKey(map->node) != NULL ? map->node : NULL;
+    return nodeGetKey(map->iterator);
 }
 
 char* mapGetNext(Map map)
 {
-    if (map == NULL || map->iterator == NULL)
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    if (map->ordered != NULL)
+    {
+        if (map->ordered_iterator == NULL)
+        {
+            return NULL;
+        }
+        map->ordered_iterator = skipListNext(map->ordered_iterator);
+        return getCursorKey(map->ordered_iterator);
+    }
+    if (map->iterator == NULL)
+    {
+        return NULL;
+    }
+    map->iterator = nodeGetNext(map->iterator);//the iterator is a node so advancing it is O(1)
+    return nodeGetKey(map->iterator);
+}
+
+/*
+return the last node of the map list, walks the list only if the last node isn't known
+*/
+static Node getLastNode(Map map)
+{
+    if (map->last == NULL)
+    {
+        Node node = map->node;
+        while (nodeGetNext(node) != NULL)
+        {
+            node = nodeGetNext(node);
+        }
+        map->last = node;
+    }
+    return map->last;
+}
+
+Map mapCreateOrdered(const Allocator *allocator)
+{
+    Map map = mapCreateWithAllocator(allocator);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->ordered = skipListCreate(map->allocator);
+    if (map->ordered == NULL)
+    {
+        mapDestroy(map);
+        return NULL;
+    }
+    return map;
+}
+
+char *mapLowerBound(Map map, const char *key)
+{
+    long long number;
+    if (map == NULL || key == NULL || map->ordered == NULL || !parseKey(key, &number))
+    {
+        return NULL;
+    }
+    map->ordered_iterator = skipListLowerBound(map->ordered, number);
+    return getCursorKey(map->ordered_iterator);
+}
+
+/*
+parses a key of an ordered map, a key is a number in decimal without leading zeros
+return false if the key isn't such a number
+*/
+static bool parseKey(const char *key, long long *number)
+{
+    bool negative = key[0] == '-';
+    const char *digit = negative ? key + 1 : key;
+    if (*digit == '\0' || (*digit == '0' && (digit[1] != '\0' || negative)))
+    {
+        return false;
+    }
+    long long value = 0;
+    for (int i = 0; digit[i] != '\0'; i++)
+    {
+        if (digit[i] < '0' || digit[i] > '9' || i >= MAX_KEY_DIGITS)
+        {
+            return false;
+        }
+        value = value * 10 + (digit[i] - '0');
+    }
+    *number = negative ? -value : value;
+    return true;
+}
+
+/*
+return the node of the given key in an ordered map or NULL if the map doesn't have it
+*/
+static Node getOrderedNode(Map map, const char *key)
+{
+    long long number;
+    if (!parseKey(key, &number))
+    {
+        return NULL;
+    }
+    return skipListGet(map->ordered, number);
+}
+
+/*
+mapPut of an ordered map
+*/
+static MapResult orderedPut(Map map, const char *key, const char *data)
+{
+    long long number;
+    if (!parseKey(key, &number))
+    {
+        return MAP_ERROR;
+    }
+    Node node = skipListGet(map->ordered, number);
+    if (node != NULL)//the node has only this key so nodePut overrides its data
+    {
+        return nodePut(node, key, data, map->allocator) == NODE_SUCCESS ? MAP_SUCCESS : MAP_OUT_OF_MEMORY;
+    }
+    node = nodeCreate(map->allocator);
+    if (node == NULL)
+    {
+        return MAP_OUT_OF_MEMORY;
+    }
+    if (nodePut(node, key, data, map->allocator) != NODE_SUCCESS ||
+        skipListPut(map->ordered, number, node) != SKIP_LIST_SUCCESS)
+    {
+        nodeDestroy(node, map->allocator);
+        return MAP_OUT_OF_MEMORY;
+    }
+    return MAP_SUCCESS;
+}
+
+/*
+mapRemove of an ordered map
+*/
+static MapResult orderedRemove(Map map, const char *key)
+{
+    long long number;
+    Node node = parseKey(key, &number) ? skipListGet(map->ordered, number) : NULL;
+    if (node == NULL)
+    {
+        return MAP_ITEM_DOES_NOT_EXIST;
+    }
+    skipListRemove(map->ordered, number);
+    nodeDestroy(node, map->allocator);
+    return MAP_SUCCESS;
+}
+
+/*
+deallocates all the nodes of an ordered map and removes their keys
+*/
+static void orderedClear(Map map)
+{
+    for (SkipListCursor cursor = skipListFirst(map->ordered); cursor != NULL; cursor = skipListNext(cursor))
+    {
+        nodeDestroy(skipListCursorValue(cursor), map->allocator);
+    }
+    skipListClear(map->ordered);
+    map->ordered_iterator = NULL;
+}
+
+/*
+mapCopy of an ordered map
+*/
+static Map orderedCopy(Map map)
+{
+    Map map_copy = mapCreateOrdered(map->allocator);
+    if (map_copy == NULL)
     {
         return NULL;
     }
-    Node current_node=getNodeByKey(map->node,map->iterator);
-    if(current_node==NULL || nodeGetNext(current_node)==NULL)
+    for (SkipListCursor cursor = skipListFirst(map->ordered); cursor != NULL; cursor = skipListNext(cursor))
+    {
+        Node node = skipListCursorValue(cursor);
+        if (orderedPut(map_copy, nodeGetKey(node), nodeGetData(node)) != MAP_SUCCESS)
+        {
+            mapDestroy(map_copy);
+            return NULL;
+        }
+    }
+    return map_copy;
+}
+
+/*
+return the key at the given position of an ordered map, NULL after the last key
+*/
+static char *getCursorKey(SkipListCursor cursor)
+{
+    if (cursor == NULL)
     {
         return NULL;
     }
-    map->iterator=nodeGetKey(nodeGetNext(current_node));
-    return map->iterator;
+    return nodeGetKey(skipListCursorValue(cursor));
 }
@@ -0,0 +1,84 @@
+#ifndef MAP_EXT_H_
+#define MAP_EXT_H_
+
+#include "map.h"
+#include "../allocator.h"
+/**
+* Functions of the Map container beyond the ones declared in map.h
+*
+*   mapCreateWithAllocator	- Creates a new empty map that allocates with a given allocator
+*   mapCreateWithCapacity	- Creates a new empty map with room for a given
+*   				  number of elements allocated at once
+*   mapAppend		- Adds a key which is known not to be in the map
+*   				  to the end of the map without searching for it.
+*   mapCreateOrdered	- Creates a new empty map that is kept sorted by the
+*   				  numbers of its keys
+*   mapLowerBound	- Sets the iterator of an ordered map to the first key
+*   				  that is not lower than a given key, for range scans.
+*/
+
+/**
+* mapCreateWithAllocator: Allocates a new empty map, the map and all its elements are
+* allocated with the given allocator, and so are the maps copied from it.
+*
+* @param allocator - The allocator of the map, the default allocator if NULL.
+* 	It has to stay valid until the map is destroyed.
+* @return
+* 	NULL - if allocations failed.
+* 	A new Map in case of success.
+*/
+Map mapCreateWithAllocator(const Allocator* allocator);
+
+/**
+* mapCreateWithCapacity: Allocates a new empty map, the nodes of the first capacity
+* elements are allocated in one block.
+*
+* @param allocator - The allocator of the map, the default allocator if NULL.
+* @param capacity - The number of elements the map is expected to have.
+* 	If it is not positive the map is created like mapCreate.
+* @return
+* 	NULL - if allocations failed.
+* 	A new Map in case of success.
+*/
+Map mapCreateWithCapacity(const Allocator* allocator, int capacity);
+
+/**
+*	mapAppend: Adds a copy of the key and data to the end of the map in O(1).
+*  The key must not be in the map already, it is not searched for.
+*  Iterator's value is undefined after this operation.
+*
+* @return
+* 	MAP_NULL_ARGUMENT if one of the params is NULL
+* 	MAP_OUT_OF_MEMORY if an allocation failed, the map is unchanged
+* 	MAP_SUCCESS the paired elements had been inserted successfully
+*/
+MapResult mapAppend(Map map, const char* key, const char* data);
+
+/**
+* mapCreateOrdered: Allocates a new empty ordered map. The keys of an ordered map are numbers
+* in decimal without leading zeros (like the ids of the election), the map is iterated in
+* ascending order of the numbers and finding, adding and removing a key is O(log n).
+* Every function of map.h works on an ordered map, mapPut returns MAP_ERROR for a key that
+* isn't such a number and mapAppend is like mapPut.
+*
+* @param allocator - The allocator of the map, the default allocator if NULL.
+* @return
+* 	NULL - if allocations failed.
+* 	A new Map in case of success.
+*/
+Map mapCreateOrdered(const Allocator* allocator);
+
+/**
+*	mapLowerBound: Sets the internal iterator of an ordered map to the lowest key that is not
+*  lower than the given key, which doesn't have to be in the map, and returns it. mapGetNext
+*  continues from it in ascending order, so the keys in [X,Y) are visited by starting at X
+*  and stopping at the first key that is not lower than Y.
+*
+* @return
+* 	NULL if a NULL pointer was sent, the map isn't ordered, the key isn't a number
+* 	or no key of the map is not lower than it.
+* 	The found key otherwise.
+*/
+char* mapLowerBound(Map map, const char* key);
+
+#endif /* MAP_EXT_H_ */
@@ -1,85 +1,150 @@
 #include "node.h"
+#include "../stats.h"
+#include "../allocator.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <stdint.h>
 
+#define INLINE_STRING_LENGTH 23
+#define NO_STRING -1
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME 16777619u
+
+/*
+a string of up to INLINE_STRING_LENGTH chars is kept inside the node, a longer one is allocated
+on its own and the node keeps a pointer to it. the length of the string tells which one is used
+*/
+typedef union NodeString_t
+{
+    char *allocated;
+    char chars[INLINE_STRING_LENGTH + 1];
+} NodeString;
+
+/*
+key_length and data_length are NO_STRING if the node is empty, key_hash is compared before the
+key itself so a lookup only reads the key of the node it finds
+in_block is true for nodes allocated together by nodeCreateBlock, they are deallocated with the block
+*/
 struct Node_t
 {
-    char *key;
-    char *data;
+    uint32_t key_hash;
+    int key_length;
+    int data_length;
+    bool in_block;
+    NodeString key;
+    NodeString data;
     struct Node_t *next;
 };
 
-Node nodeCreate();
-void nodeDestroy(Node node);
+Node nodeCreate(const Allocator *allocator);
+Node nodeCreateBlock(const Allocator *allocator, int count);
+void nodeDestroyBlock(Node block, const Allocator *allocator);
+void nodeDestroy(Node node, const Allocator *allocator);
 char *nodeGet(Node node, const char *key);
-Node nodeCopy(Node node);
+Node nodeCopy(Node node, const Allocator *allocator);
 int nodeGetSize(Node node);
-NodeResult nodePut(Node node, const char *key, const char *data);
+NodeResult nodePut(Node node, const char *key, const char *data, const Allocator *allocator);
+NodeResult nodePutAfter(Node node, Node new_node, const char *key, const char *data,
+                        const Allocator *allocator);
 bool nodeContains(Node node, const char *kay);
-NodeResult nodeClear(Node node);
-NodeResult nodeRemove(Node node, const char *key);
-static bool allocString(const char *str, char **returnStr);
+NodeResult nodeClear(Node node, const Allocator *allocator);
+NodeResult nodeRemove(Node node, const char *key, const Allocator *allocator);
 Node getNodeByKey(Node node, const char *key);
-static bool allocAndInsertNode(Node node, const char *key, const char *data);
-static Node createNewNode(const char *key, const char *data);
+static bool allocAndInsertNode(Node node, const char *key, const char *data, const Allocator *allocator);
+static Node createNewNode(const char *key, const char *data, const Allocator *allocator);
 static Node getForemerNodeByKey(Node node, const char *key);
+static bool isNodeKey(Node node, const char *key, int length, uint32_t hash);
+static uint32_t hashKey(const char *key, int *length);
 static void NodeSwap(Node node1, Node node2);
-static void nodeElementsDelete(Node node);
+static void nodeElementsDelete(Node node, const Allocator *allocator);
 char* nodeGetKey(Node node);
 char* nodeGetData(Node node);
 Node nodeGetNext(Node node);
-void nodeSetKey(Node node,char* key);
-void nodeSetData(Node node,char *data);
 void nodeSetNext(Node node, Node next);
-static void destroyString(char *str);
+static char *getString(NodeString *string, int length);
+static bool setString(NodeString *string, int *length, const char *str, StatsAllocSite site,
+                      const Allocator *allocator);
+static void destroyString(NodeString *string, int *length, const Allocator *allocator);
 
 
-Node nodeCreate() //create the first Node
+Node nodeCreate(const Allocator *allocator) //create the first Node
 {
-    Node new_node = malloc(sizeof(*new_node));
+    Node new_node = allocatorAllocate(allocator, sizeof(*new_node));
     if (new_node == NULL)
     {
         return NULL;
     }
-    new_node->key = NULL;
-    new_node->data = NULL;
+    STATS_ALLOC(STATS_SITE_CREATE_NEW_NODE, sizeof(*new_node));
+    new_node->key_length = NO_STRING;
+    new_node->data_length = NO_STRING;
     new_node->next = NULL;
+    new_node->in_block = false;
     return new_node;
 }
+
+Node nodeCreateBlock(const Allocator *allocator, int count)
+{
+    assert(count > 0);
+    Node block = allocatorAllocate(allocator, count * sizeof(*block));
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    STATS_ALLOC(STATS_SITE_CREATE_NEW_NODE, count * sizeof(*block));
+    for (int i = 0; i < count; i++)
+    {
+        block[i].key_length = NO_STRING;
+        block[i].data_length = NO_STRING;
+        block[i].next = i + 1 < count ? &block[i + 1] : NULL;
+        block[i].in_block = true;
+    }
+    return block;
+}
+
+void nodeDestroyBlock(Node block, const Allocator *allocator)
+{
+    if (block != NULL)
+    {
+        allocatorDeallocate(allocator, block);
+        STATS_FREE();
+    }
+}
 /*
 get a pointer to a node and free all the list
 */
-void nodeDestroy(Node node) 
+void nodeDestroy(Node node, const Allocator *allocator)
 {
     while (node != NULL)
     {
         Node toDelete = node;
-        nodeElementsDelete(toDelete);
+        nodeElementsDelete(toDelete, allocator);
         node = node->next;
-        free(toDelete);
+        if (!toDelete->in_block)
+        {
+            allocatorDeallocate(allocator, toDelete);
+            STATS_FREE();
+        }
     }
 }
 /*
-get a pointer to a node and free all of the node varibels, afterwards set them to NULL
+get a pointer to a node and free all of the node varibels, afterwards the node is empty
 */
-static void nodeElementsDelete(Node node)
+static void nodeElementsDelete(Node node, const Allocator *allocator)
 {
     assert(node != NULL);
-    destroyString(node->key);
-    destroyString(node->data);
-    node->key=NULL;
-    node->data=NULL;
+    destroyString(&node->key, &node->key_length, allocator);
+    destroyString(&node->data, &node->data_length, allocator);
 }
 
-Node nodeCopy(Node node) 
+Node nodeCopy(Node node, const Allocator *allocator)
 {
     if (node != NULL) //if node exists
     {
-        if (node->key != NULL) //if node is not empty
+        if (node->key_length != NO_STRING) //if node is not empty
         {
-            Node new_node = createNewNode((const char *)(node->key), (const char *)(node->data));
+            Node new_node = createNewNode(nodeGetKey(node), nodeGetData(node), allocator);
             if (new_node == NULL) //creat first node failed
             {
                 return NULL;
@@ -88,10 +153,10 @@ Node nodeCopy(Node node)
             Node node_to_return = new_node; //ptr to the first node of the new node
             while (node != NULL)
             {
-                new_node->next = createNewNode((const char *)(node->key), (const char *)(node->data));
+                new_node->next = createNewNode(nodeGetKey(node), nodeGetData(node), allocator);
                 if (new_node->next == NULL) //creating a node failed
                 {
-                    nodeDestroy(node_to_return);
+                    nodeDestroy(node_to_return, allocator);
                     return NULL;
                 }
                 node = node->next;
@@ -99,7 +164,7 @@ Node nodeCopy(Node node)
             }
             return node_to_return;
         }
-        return nodeCreate(); //return empty node 
+        return nodeCreate(allocator); //return empty node 
     }
     return NULL; //node does not exist
 }
@@ -107,7 +172,7 @@ Node nodeCopy(Node node)
 int nodeGetSize(Node node)
 {
     int node_count = 0;
-    while (node != NULL && node->key != NULL) //node may be empty, yet not null
+    while (node != NULL && node->key_length != NO_STRING) //node may be empty, yet not null
     {
         node_count++;
         node = node->next;
@@ -125,12 +190,12 @@ bool nodeContains(Node node, const char *key)
     return true;
 }
 
-NodeResult nodePut(Node node, const char *key, const char *data)
+NodeResult nodePut(Node node, const char *key, const char *data, const Allocator *allocator)
 {
     assert(node!=NULL);
-    if (node->key == NULL) //node exsits but empty, need to allocate  the node, key and data
+    if (node->key_length == NO_STRING) //node exsits but empty, need to allocate  the node, key and data
     {
-        if (!allocAndInsertNode(node, key, data))
+        if (!allocAndInsertNode(node, key, data, allocator))
         {
             return NODE_OUT_OF_MEMORY;
         }
@@ -139,10 +204,15 @@ NodeResult nodePut(Node node, const char *key, const char *data)
     Node node_node_to_put = getNodeByKey(node, key); //if returned null node does not exists
     if (node_node_to_put != NULL)           //we found node matching the key so we want to overwrite its data
     {
-        destroyString(node_node_to_put->data);
-        char* str_return=malloc(strlen(data)+1);
-        strcpy(str_return, data);//copy by value data
-        node_node_to_put->data = str_return;
+        NodeString new_data;
+        int new_data_length;
+        if (!setString(&new_data, &new_data_length, data, STATS_SITE_MAP_PUT, allocator))//copy by value data
+        {
+            return NODE_OUT_OF_MEMORY;
+        }
+        destroyString(&node_node_to_put->data, &node_node_to_put->data_length, allocator);
+        node_node_to_put->data = new_data;
+        node_node_to_put->data_length = new_data_length;
     }
     else //the node does not exits in the node, we want to creata a new one at the end
     {
@@ -150,7 +220,7 @@ NodeResult nodePut(Node node, const char *key, const char *data)
         {
             node = node->next;
         }
-        node->next = createNewNode(key, data);
+        node->next = createNewNode(key, data, allocator);
         if (node->next == NULL)//creating the new node failed
         {
             return NODE_OUT_OF_MEMORY;
@@ -159,6 +229,19 @@ NodeResult nodePut(Node node, const char *key, const char *data)
     return NODE_SUCCESS;
 }
 
+NodeResult nodePutAfter(Node node, Node new_node, const char *key, const char *data,
+                        const Allocator *allocator)
+{
+    assert(node != NULL && new_node != NULL && new_node->key_length == NO_STRING);
+    if (!allocAndInsertNode(new_node, key, data, allocator))
+    {
+        return NODE_OUT_OF_MEMORY;
+    }
+    new_node->next = node->next;
+    node->next = new_node;
+    return NODE_SUCCESS;
+}
+
 char* nodeGet(Node node, const char *key)
 {
     assert(key != NULL);
@@ -171,10 +254,10 @@ char* nodeGet(Node node, const char *key)
     {
         return NULL;
     }
-    return node_to_return_data->data;
+    return nodeGetData(node_to_return_data);
 }
 
-NodeResult nodeRemove(Node node, const char *key)
+NodeResult nodeRemove(Node node, const char *key, const Allocator *allocator)
 {
     assert(key!=NULL);
     if (node == NULL)
@@ -188,7 +271,7 @@ NodeResult nodeRemove(Node node, const char *key)
     }
     if (node->next == NULL) //node has only one node, it is the elemet we want to remove
     {
-        nodeElementsDelete(node); //delete the node elements the node but does not delete it
+        nodeElementsDelete(node, allocator); //delete the node elements the node but does not delete it
         return NODE_SUCCESS;
     }
     Node former_node = getForemerNodeByKey(node, key); //node has more than on node
@@ -203,32 +286,41 @@ NodeResult nodeRemove(Node node, const char *key)
         former_node->next = node_to_remove->next;//set the former node to point to the next node of the node we delete
     }
     node_to_remove->next = NULL;//make sure the node we delete not points to the list
-    nodeDestroy(node_to_remove);
+    nodeDestroy(node_to_remove, allocator);
     return NODE_SUCCESS;
 }
 
-NodeResult nodeClear(Node node)
+NodeResult nodeClear(Node node, const Allocator *allocator)
 {
     assert(node!=NULL);
-    while (node != NULL && node->key != NULL)
+    while (node != NULL && node->key_length != NO_STRING)
     {
         Node toRemove = node;
-        nodeRemove(toRemove, (const char *)(toRemove->key));
+        nodeRemove(toRemove, nodeGetKey(toRemove), allocator);
     }
     return NODE_SUCCESS;
 }
 /*
-gets two nodes and replace the pointers of key and data
+gets two nodes and replace their keys and data
 */
 static void NodeSwap(Node node1, Node node2)
 {
     assert(node1 != NULL && node2 != NULL);
-    char *tmp = node1->key;
+    NodeString tmp = node1->key;
     node1->key = node2->key;
     node2->key = tmp;
     tmp = node1->data;
     node1->data = node2->data;
     node2->data = tmp;
+    uint32_t tmp_hash = node1->key_hash;
+    node1->key_hash = node2->key_hash;
+    node2->key_hash = tmp_hash;
+    int tmp_length = node1->key_length;
+    node1->key_length = node2->key_length;
+    node2->key_length = tmp_length;
+    tmp_length = node1->data_length;
+    node1->data_length = node2->data_length;
+    node2->data_length = tmp_length;
 }
 
 /*
@@ -238,13 +330,15 @@ return NULL if the key mathch with the first node or no node has this key
 static Node getForemerNodeByKey(Node node, const char *key)
 {
     assert(node != NULL);
-    if (!strcmp((const char *)(node->key), key))//the first node is the node with the key we were looking
+    int length;
+    uint32_t hash = hashKey(key, &length);
+    if (isNodeKey(node, key, length, hash))//the first node is the node with the key we were looking
     {
         return NULL;// therefore there is no former node
     }
     while (node->next != NULL)
     {
-        if (!strcmp((const char *)(node->next->key), key))
+        if (isNodeKey(node->next, key, length, hash))
         {
             return node;
         }
@@ -257,9 +351,11 @@ static Node getForemerNodeByKey(Node node, const char *key)
 Node getNodeByKey(Node node, const char *key)
 {
     assert(key != NULL);
-    while (node != NULL && node->key != NULL)//node may be null or empty
+    int length;
+    uint32_t hash = hashKey(key, &length);//hashed once for the whole list
+    while (node != NULL && node->key_length != NO_STRING)//node may be null or empty
     {
-        if (!strcmp((const char *)(node->key), key))
+        if (isNodeKey(node, key, length, hash))
         {
             return node;
         }
@@ -270,49 +366,35 @@ Node getNodeByKey(Node node, const char *key)
 
 /*
 gets a pointer to node key and data, create a copy (by value) to key and data and insert them to node
-return false if allocation failed and destroy the node.
+return false if allocation failed, the node is left empty in that case.
 */
-static bool allocAndInsertNode(Node node, const char *key, const char *data)
+static bool allocAndInsertNode(Node node, const char *key, const char *data, const Allocator *allocator)
 {
     assert(key != NULL && data != NULL);
-    free(node->key);
-    free(node->data);
-    if ((!allocString(key, &node->key)) || (!allocString(data, &node->data)))//if one of the allocations faild
-    {
-        nodeDestroy(node);
-        return false;
-    }
-    strcpy(node->key, key);
-    strcpy(node->data, data);
-    return true;
-}
-/*get a string and a pointer to string, copy(by value) the string
-return false i allocarion failed
-*/
-static bool allocString(const char *str, char **str_return)
-{
-    assert(str != NULL);
-    *str_return = malloc(strlen(str) + 1);
-    if (*str_return == NULL)
+    nodeElementsDelete(node, allocator);
+    if (!setString(&node->key, &node->key_length, key, STATS_SITE_ALLOC_STRING, allocator) ||
+        !setString(&node->data, &node->data_length, data, STATS_SITE_ALLOC_STRING, allocator))//if one of the allocations faild
     {
+        nodeElementsDelete(node, allocator);
         return false;
     }
+    node->key_hash = hashKey(key, &node->key_length);
     return true;
 }
 
 /*
 gets a key and data and create a new node, if create went well returns a poiner to this node else NULL
 */
-static Node createNewNode(const char *key, const char *data)
+static Node createNewNode(const char *key, const char *data, const Allocator *allocator)
 {
-    Node new_node = nodeCreate();
+    Node new_node = nodeCreate(allocator);
     if (new_node == NULL)
     {
         return NULL;
     }
-    if (!allocAndInsertNode(new_node, key, data))
+    if (!allocAndInsertNode(new_node, key, data, allocator))
     {
-        nodeDestroy(new_node);
+        nodeDestroy(new_node, allocator);
         return NULL;
     }
     return new_node;
@@ -325,7 +407,7 @@ char* nodeGetKey(Node node)
     {
         return NULL;
     }
-    return node->key;
+    return getString(&node->key, node->key_length);
 }
 
 char* nodeGetData(Node node)
@@ -334,7 +416,7 @@ char* nodeGetData(Node node)
     {
         return NULL;
     }
-    return node->data;
+    return getString(&node->data, node->data_length);
 }
 
 Node nodeGetNext(Node node)
@@ -346,34 +428,86 @@ Node nodeGetNext(Node node)
     return node->next;
 }
 
-void nodeSetKey(Node node,char* key)
+void nodeSetNext(Node node, Node next)
 {
     if(node!=NULL)
     {
-        node->key=key;
+        node->next=next;
     }
 }
-    
-void nodeSetData(Node node,char *data)
+
+/*
+return true if the node has the given key, the length and the hash are compared first
+so the key of the node is only read if it is likely the same
+*/
+static bool isNodeKey(Node node, const char *key, int length, uint32_t hash)
+{
+    return node->key_hash == hash && node->key_length == length &&
+           memcmp(getString(&node->key, node->key_length), key, length) == 0;
+}
+
+/*
+return the FNV-1a hash of the key and set length to its length, in one pass over the key
+*/
+static uint32_t hashKey(const char *key, int *length)
 {
-    if(node!=NULL)
+    uint32_t hash = FNV_OFFSET_BASIS;
+    const char *c = key;
+    for (; *c != '\0'; c++)
     {
-        node->data=data;
+        hash = (hash ^ (unsigned char)*c) * FNV_PRIME;
     }
+    *length = c - key;
+    return hash;
 }
 
-void nodeSetNext(Node node, Node next)
+/*
+return the chars of the string, NULL if there is no string
+*/
+static char *getString(NodeString *string, int length)
 {
-    if(node!=NULL)
+    if (length == NO_STRING)
     {
-        node->next=next;
+        return NULL;
     }
+    return length <= INLINE_STRING_LENGTH ? string->chars : string->allocated;
 }
-static void destroyString(char *str)
+
+/*
+copies (by value) str to the string, only a string longer than INLINE_STRING_LENGTH is allocated
+return false if allocation failed, the string is left without a string in that case
+*/
+static bool setString(NodeString *string, int *length, const char *str, StatsAllocSite site,
+                      const Allocator *allocator)
+{
+    assert(str != NULL);
+    int str_length = strlen(str);
+    char *chars = string->chars;
+    if (str_length > INLINE_STRING_LENGTH)
+    {
+        chars = allocatorAllocate(allocator, str_length + 1);
+        if (chars == NULL)
+        {
+            *length = NO_STRING;
+            return false;
+        }
+        STATS_ALLOC(site, str_length + 1);
+        string->allocated = chars;
+    }
+    memcpy(chars, str, str_length + 1);
+    *length = str_length;
+    return true;
+}
+
+/*
+deallocates the string if it was allocated, afterwards there is no string
+*/
+static void destroyString(NodeString *string, int *length, const Allocator *allocator)
 {
-    if (str != NULL)
+    if (*length > INLINE_STRING_LENGTH)
     {
-        free(str);
-        str=NULL;
+        allocatorDeallocate(allocator, string->allocated);
+        STATS_FREE();
     }
+    *length = NO_STRING;
 }
\ No newline at end of file
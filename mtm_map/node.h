@@ -3,23 +3,31 @@
 
 #include <stdbool.h>
 #include <string.h>
+#include "../allocator.h"
 /**
 * Node Container
 *
 * Implements a node container type.
 * The type of the key and the value is string (char *)
+* Short keys and values are kept inside the node, so the pointers returned by
+* nodeGetKey, nodeGetData and nodeGet are valid until the node is changed.
+* Every function that allocates or deallocates gets the allocator of the map the node
+* belongs to, all the nodes of one list must use the same allocator.
 * The node has an internal iterator for external use. For all functions
 * where the state of the iterator after calling that function is not stated,
 * it is undefined. That is you cannot assume anything about it.
 *
 * The following functions are available:
 *   nodeCreate		- Creates a new empty node
+*   nodeCreateBlock	- Creates a chain of empty nodes in one allocation
+*   nodeDestroyBlock	- Deallocates a block created by nodeCreateBlock
 *   nodeDestroy		- Deletes an existing node and frees all resources
 *   nodeCopy		- Copies an existing node
 *   nodeGetSize		- Returns the size of a given node
 *   nodeContains	- returns weather or not a key exists inside the node.
 *   nodePut		    - Gives a specific key a given value.
 *   				  If the key exists, the value is overridden.
+*   nodePutAfter	- Fills an empty node and links it after a given node.
 *   nodeGet  	    - Returns the data paired to a key which matches the given key.
 *					  Iterator status unchanged
 *   nodeRemove		- Removes a pair of (key,data) elements for which the key
@@ -47,13 +55,33 @@ typedef enum NodeResult_t {
 } NodeResult;
 
 /**
-* nodeCreate: Allocates a new empty node.
+* nodeCreate: Allocates a new empty node with the given allocator.
 *
 * @return
 * 	NULL - if allocations failed.
 * 	A new Node in case of success.
 */
-Node nodeCreate();
+Node nodeCreate(const Allocator* allocator);
+
+/**
+* nodeCreateBlock: Allocates count empty nodes in one allocation, each node points to
+* the one after it and the last one points to NULL.
+* The nodes of the block can be used anywhere a node is used, destroying them
+* deallocates their elements but not the nodes, the nodes are deallocated by
+* nodeDestroyBlock once none of them is used.
+*
+* @return
+* 	NULL - if allocations failed.
+* 	The first node of the block in case of success.
+*/
+Node nodeCreateBlock(const Allocator* allocator, int count);
+
+/**
+* nodeDestroyBlock: Deallocates a block created by nodeCreateBlock.
+*
+* @param block - The first node of the block. If block is NULL nothing will be done
+*/
+void nodeDestroyBlock(Node block, const Allocator* allocator);
 
 /**
 * nodeDestroy: Deallocates an existing node. Clears all elements.
@@ -61,7 +89,7 @@ Node nodeCreate();
 * @param node - Target node to be deallocated. If node is NULL nothing will be
 * 		done
 */
-void nodeDestroy(Node node);
+void nodeDestroy(Node node, const Allocator* allocator);
 
 /**
 * nodeCopy: Creates a copy of target node.
@@ -72,7 +100,7 @@ void nodeDestroy(Node node);
 * 	NULL if a NULL was sent or a memory allocation failed.
 * 	A Node containing the same elements as node otherwise.
 */
-Node nodeCopy(Node node);
+Node nodeCopy(Node node, const Allocator* allocator);
 
 /**
 * nodeGetSize: Returns the number of elements in a node
@@ -111,7 +139,20 @@ bool nodeContains(Node node, const char* key);
 * 	an element failed)
 * 	NODE_SUCCESS the paired elements had been inserted successfully
 */
-NodeResult nodePut(Node node, const char* key, const char* data);
+NodeResult nodePut(Node node, const char* key, const char* data, const Allocator* allocator);
+
+/**
+*	nodePutAfter: Inserts a copy of key and data to an empty node and links it
+*  right after the given node. The key is not searched, the caller knows it is new.
+*
+* @param node - The node to link after
+* @param new_node - An empty node which is not linked to any list
+* @return
+* 	NODE_OUT_OF_MEMORY if an allocation failed, new_node is left empty and not linked
+* 	NODE_SUCCESS the paired elements had been inserted successfully
+*/
+NodeResult nodePutAfter(Node node, Node new_node, const char* key, const char* data,
+                        const Allocator* allocator);
 
 /**
 *	nodeGet: Returns the data associated with a specific key in the node(not a copy).
@@ -142,7 +183,7 @@ char* nodeGet(Node node, const char* key);
 *  NODE_ITEM_DOES_NOT_EXIST if an equal key item does not already exists in the node
 * 	NODE_SUCCESS the paired elements had been removed successfully
 */
-NodeResult nodeRemove(Node node, const char* key);
+NodeResult nodeRemove(Node node, const char* key, const Allocator* allocator);
 
 /*
 looks for a node in the list by a given key
@@ -159,7 +200,7 @@ Node getNodeByKey(Node node, const char *key);
 * 	NODE_NULL_ARGUMENT - if a NULL pointer was sent.
 * 	NODE_SUCCESS - Otherwise.
 */
-NodeResult nodeClear(Node node);
+NodeResult nodeClear(Node node, const Allocator* allocator);
 /*
 gets a node and return a pointer to key
 */
@@ -173,14 +214,6 @@ gets a node and return a pointer to next node
 */
 Node nodeGetNext(Node node);
 /*
-set the given key to the node
-*/
-void nodeSetKey(Node node,char* key);
-/*
-set the given data to the node
-*/
-void nodeSetData(Node node,char *data);
-/*
 set the given pointer to the next node to the current node
 */
 void nodeSetNext(Node node, Node next);
@@ -0,0 +1,134 @@
+#include "pool.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CACHE_LINE_SIZE 64
+#define SLAB_SIZE 4096
+#define OBJECT_ALIGNMENT 16
+
+/*
+a free object keeps the pointer to the next free object in its first bytes
+*/
+struct free_object_t
+{
+    struct free_object_t* next;
+};
+
+/*
+the header of a slab takes its first cache line, block is the pointer the allocator returned,
+the slab starts at the first cache line inside it
+*/
+struct slab_t
+{
+    struct slab_t* next;
+    void* block;
+};
+
+struct pool_t
+{
+    const Allocator* allocator;
+    size_t object_size;
+    int objects_per_slab;
+    struct slab_t* slabs;
+    struct free_object_t* free_objects;
+};
+
+Pool poolCreate(const Allocator* allocator, size_t object_size);
+void poolDestroy(Pool pool);
+void* poolAllocate(Pool pool);
+void poolDeallocate(Pool pool, void* object);
+static bool addSlab(Pool pool);
+
+Pool poolCreate(const Allocator* allocator, size_t object_size)
+{
+    assert(allocator != NULL && object_size > 0);
+    Pool pool = allocatorAllocate(allocator, sizeof(*pool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    if (object_size < sizeof(struct free_object_t))
+    {
+        object_size = sizeof(struct free_object_t);
+    }
+    pool->allocator = allocator;
+    pool->object_size = (object_size + OBJECT_ALIGNMENT - 1) / OBJECT_ALIGNMENT * OBJECT_ALIGNMENT;
+    pool->objects_per_slab = (SLAB_SIZE - CACHE_LINE_SIZE) / pool->object_size;
+    if (pool->objects_per_slab < 1)//objects bigger than a slab get a slab each
+    {
+        pool->objects_per_slab = 1;
+    }
+    pool->slabs = NULL;
+    pool->free_objects = NULL;
+    return pool;
+}
+
+void poolDestroy(Pool pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    while (pool->slabs != NULL)
+    {
+        struct slab_t* slab = pool->slabs;
+        pool->slabs = slab->next;
+        allocatorDeallocate(pool->allocator, slab->block);
+    }
+    allocatorDeallocate(pool->allocator, pool);
+}
+
+void* poolAllocate(Pool pool)
+{
+    assert(pool != NULL);
+    if (pool->free_objects == NULL && !addSlab(pool))
+    {
+        return NULL;
+    }
+    struct free_object_t* object = pool->free_objects;
+    pool->free_objects = object->next;
+    return object;
+}
+
+void poolDeallocate(Pool pool, void* object)
+{
+    assert(pool != NULL);
+    if (object == NULL)
+    {
+        return;
+    }
+    struct free_object_t* free_object = object;
+    free_object->next = pool->free_objects;//the last object freed is the first reused, it is likely in cache
+    pool->free_objects = free_object;
+}
+
+/*
+allocates a slab aligned to a cache line and puts all its objects in the free list
+return false if allocation failed
+*/
+static bool addSlab(Pool pool)
+{
+    size_t slab_size = CACHE_LINE_SIZE + pool->objects_per_slab * pool->object_size;
+    void* block = allocatorAllocate(pool->allocator, slab_size + CACHE_LINE_SIZE - 1);
+    if (block == NULL)
+    {
+        return false;
+    }
+    uintptr_t start = ((uintptr_t)block + CACHE_LINE_SIZE - 1) & ~(uintptr_t)(CACHE_LINE_SIZE - 1);
+    struct slab_t* slab = (struct slab_t*)start;
+    slab->block = block;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    char* objects = (char*)start + CACHE_LINE_SIZE;
+    for (int i = pool->objects_per_slab - 1; i >= 0; i--)//the first object of the slab is taken first
+    {
+        struct free_object_t* object = (struct free_object_t*)(objects + i * pool->object_size);
+        object->next = pool->free_objects;
+        pool->free_objects = object;
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef MTM_POOL_H
+#define MTM_POOL_H
+
+#include "allocator.h"
+#include <stddef.h>
+/**
+* Pool
+* Implements a pool of objects of one fixed size.
+* The objects are carved from slabs that start on a cache line, and a deallocated object goes
+* to a free list that the next allocation takes it from, so creating and destroying objects
+* again and again doesn't go to the allocator after the pool has grown to its peak.
+* The slabs are only given back to the allocator when the pool is destroyed.
+**/
+
+/** Type for defining a Pool */
+typedef struct pool_t* Pool;
+
+/*
+*poolCreate: Allocates a new empty pool of objects of the given size, the slabs are allocated
+*with the given allocator
+*@return
+* 	NULL - if allocations failed.
+* 	A new Pool in case of success.
+*/
+Pool poolCreate(const Allocator* allocator, size_t object_size);
+/*
+*poolDestroy: Deallocates the pool with all its slabs, the objects allocated from it are not
+*valid after it. If pool is NULL nothing will be done
+*/
+void poolDestroy(Pool pool);
+/*
+*poolAllocate: return an object of the pool, allocates a new slab if the free list is empty
+*@return NULL if allocation failed
+*/
+void* poolAllocate(Pool pool);
+/*
+*poolDeallocate: gives the object back to the pool. If object is NULL nothing will be done
+*/
+void poolDeallocate(Pool pool, void* object);
+
+#endif //MTM_POOL_H
@@ -0,0 +1,259 @@
+#include "region.h"
+#include "mtm_map/map_ext.h"
+#include "assist.h"
+#include "tribe.h"
+#include "idmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+
+#define INITIAL_CAPACITY 4
+#define GROWTH_FACTOR 2
+
+/*
+position is the index of the region in the array of the set
+*/
+struct region_t
+{
+    int id;
+    int areas;
+    int position;
+    Tribe totals;
+};
+
+/*
+index maps the region ids to the regions, regions is an array of the regions so they are visited
+without going over the index. totals is the table of totals of all the areas, the totals of new
+regions are copied from it since the tables of the areas are sparse
+*/
+struct region_set_t
+{
+    const Allocator* allocator;
+    Tribe totals;
+    IdMap index;
+    struct region_t** regions;
+    int size;
+    int capacity;
+};
+
+RegionSet regionSetCreate(const Allocator* allocator, Tribe totals);
+void regionSetDestroy(RegionSet regions);
+RegionResult regionSetAddArea(RegionSet regions, int region_id, Tribe area_tribe);
+void regionSetRemoveArea(RegionSet regions, int region_id, Tribe area_tribe);
+void regionSetAddVotes(RegionSet regions, int region_id, int tribe_id, int64_t change);
+RegionResult regionSetAddTribe(RegionSet regions, int tribe_id, const char* tribe_name);
+void regionSetRemoveTribes(RegionSet regions, const int* sorted_ids, int count);
+RegionResult regionSetMerge(RegionSet merged, RegionSet regions);
+Tribe regionSetGetTotals(RegionSet regions, int region_id);
+Map regionSetComputeMapping(RegionSet regions);
+static struct region_t* createRegion(RegionSet regions, int region_id);
+static void destroyRegion(RegionSet regions, struct region_t* region);
+
+RegionSet regionSetCreate(const Allocator* allocator, Tribe totals)
+{
+    assert(totals != NULL);
+    RegionSet regions = allocatorAllocate(allocator, sizeof(*regions));
+    if (regions == NULL)
+    {
+        return NULL;
+    }
+    regions->index = idMapCreate(allocator);
+    if (regions->index == NULL)
+    {
+        allocatorDeallocate(allocator, regions);
+        return NULL;
+    }
+    regions->allocator = allocator;
+    regions->totals = totals;
+    regions->regions = NULL;
+    regions->size = 0;
+    regions->capacity = 0;
+    return regions;
+}
+
+void regionSetDestroy(RegionSet regions)
+{
+    if (regions == NULL)
+    {
+        return;
+    }
+    for (int i = 0; i < regions->size; i++)
+    {
+        tribeDestroy(regions->regions[i]->totals);
+        allocatorDeallocate(regions->allocator, regions->regions[i]);
+    }
+    allocatorDeallocate(regions->allocator, regions->regions);
+    idMapDestroy(regions->index);
+    allocatorDeallocate(regions->allocator, regions);
+}
+
+RegionResult regionSetAddArea(RegionSet regions, int region_id, Tribe area_tribe)
+{
+    assert(regions != NULL && region_id >= 0 && area_tribe != NULL);
+    struct region_t* region = idMapGet(regions->index, region_id);
+    if (region == NULL)
+    {
+        region = createRegion(regions, region_id);
+        if (region == NULL)
+        {
+            return REGION_OUT_OF_MEMORY;
+        }
+    }
+    tribeAddAllVotes(region->totals, area_tribe, 1);
+    region->areas++;
+    return REGION_SUCCESS;
+}
+
+void regionSetRemoveArea(RegionSet regions, int region_id, Tribe area_tribe)
+{
+    assert(regions != NULL && area_tribe != NULL);
+    struct region_t* region = idMapGet(regions->index, region_id);
+    assert(region != NULL && region->areas > 0);
+    tribeAddAllVotes(region->totals, area_tribe, -1);
+    region->areas--;
+    if (region->areas == 0)
+    {
+        destroyRegion(regions, region);
+    }
+}
+
+void regionSetAddVotes(RegionSet regions, int region_id, int tribe_id, int64_t change)
+{
+    assert(regions != NULL);
+    struct region_t* region = idMapGet(regions->index, region_id);
+    assert(region != NULL);
+    tribeAddToVotes(region->totals, tribe_id, change);
+}
+
+RegionResult regionSetAddTribe(RegionSet regions, int tribe_id, const char* tribe_name)
+{
+    assert(regions != NULL && tribe_name != NULL);
+    for (int i = 0; i < regions->size; i++)
+    {
+        if (tribeAppend(regions->regions[i]->totals, tribe_id, tribe_name) != TRIBE_SUCCESS)
+        {
+            for (int j = 0; j < i; j++)//all the regions keep the same tribes
+            {
+                tribeRemove(regions->regions[j]->totals, tribe_id);
+            }
+            return REGION_OUT_OF_MEMORY;
+        }
+    }
+    return REGION_SUCCESS;
+}
+
+void regionSetRemoveTribes(RegionSet regions, const int* sorted_ids, int count)
+{
+    assert(regions != NULL && sorted_ids != NULL);
+    for (int i = 0; i < regions->size; i++)
+    {
+        tribeRemoveSorted(regions->regions[i]->totals, sorted_ids, count);
+    }
+}
+
+RegionResult regionSetMerge(RegionSet merged, RegionSet regions)
+{
+    assert(merged != NULL && regions != NULL && merged != regions);
+    for (int i = 0; i < regions->size; i++)
+    {
+        struct region_t* region = regions->regions[i];
+        struct region_t* merged_region = idMapGet(merged->index, region->id);
+        if (merged_region == NULL)
+        {
+            merged_region = createRegion(merged, region->id);
+            if (merged_region == NULL)
+            {
+                return REGION_OUT_OF_MEMORY;
+            }
+        }
+        tribeMergeTotals(merged_region->totals, region->totals);
+        merged_region->areas += region->areas;
+    }
+    return REGION_SUCCESS;
+}
+
+Tribe regionSetGetTotals(RegionSet regions, int region_id)
+{
+    assert(regions != NULL);
+    struct region_t* region = idMapGet(regions->index, region_id);
+    return region == NULL ? NULL : region->totals;
+}
+
+Map regionSetComputeMapping(RegionSet regions)
+{
+    char string_region_id[INT_STRING_SIZE], string_tribe_id[INT_STRING_SIZE];
+    assert(regions != NULL);
+    if (regions->size == 0 || tribeGetMaxVotesForArea(regions->regions[0]->totals) < 0)//no regions or no tribes
+    {
+        return mapCreateWithAllocator(regions->allocator);
+    }
+    Map map_of_max = mapCreateWithCapacity(regions->allocator, regions->size);
+    if (map_of_max == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < regions->size; i++)//the totals are up to date so no area is visited
+    {
+        writeIntToString(regions->regions[i]->id, string_region_id);
+        writeIntToString(tribeGetMaxVotesForArea(regions->regions[i]->totals), string_tribe_id);
+        if (mapAppend(map_of_max, string_region_id, string_tribe_id) != MAP_SUCCESS)//region ids are unique
+        {
+            mapDestroy(map_of_max);
+            return NULL;
+        }
+    }
+    return map_of_max;
+}
+
+/*
+creates a region without areas whose totals have all the tribes of the set
+return NULL if allocation failed, the set is unchanged in that case
+*/
+static struct region_t* createRegion(RegionSet regions, int region_id)
+{
+    if (regions->size == regions->capacity)
+    {
+        int new_capacity = regions->capacity == 0 ? INITIAL_CAPACITY : regions->capacity * GROWTH_FACTOR;
+        struct region_t** new_regions = allocatorReallocate(regions->allocator, regions->regions,
+                                                            new_capacity * sizeof(*new_regions));
+        if (new_regions == NULL)
+        {
+            return NULL;
+        }
+        regions->regions = new_regions;
+        regions->capacity = new_capacity;
+    }
+    struct region_t* region = allocatorAllocate(regions->allocator, sizeof(*region));
+    if (region == NULL)
+    {
+        return NULL;
+    }
+    region->totals = tribeCopyWithZeroVotes(regions->totals);
+    if (region->totals == NULL || idMapPut(regions->index, region_id, region) != ID_MAP_SUCCESS)
+    {
+        tribeDestroy(region->totals);
+        allocatorDeallocate(regions->allocator, region);
+        return NULL;
+    }
+    region->id = region_id;
+    region->areas = 0;
+    region->position = regions->size;
+    regions->regions[regions->size] = region;
+    regions->size++;
+    return region;
+}
+
+/*
+removes the region from the set and deallocates it
+*/
+static void destroyRegion(RegionSet regions, struct region_t* region)
+{
+    idMapRemove(regions->index, region->id);
+    regions->size--;
+    struct region_t* moved = regions->regions[regions->size];//the order of the regions doesn't matter
+    regions->regions[region->position] = moved;
+    moved->position = region->position;
+    tribeDestroy(region->totals);
+    allocatorDeallocate(regions->allocator, region);
+}
@@ -0,0 +1,93 @@
+#ifndef MTM_REGION_H
+#define MTM_REGION_H
+
+#include "mtm_map/map.h"
+#include "allocator.h"
+#include "tribe.h"
+#include <stdbool.h>
+/**
+* RegionSet
+* Implements the regions of the areas of an election.
+* Every region keeps the number of its areas and a tribe table with the total votes its areas
+* gave every tribe. The totals are changed with every change of the votes of an area, so the
+* winner of a region is found without going over its areas.
+* The tables of the totals are of the same schema as the tables of the areas, so they have the
+* same tribes in the same order.
+* A region exists while it has at least one area.
+**/
+
+/** Type for defining a RegionSet */
+typedef struct region_set_t* RegionSet;
+
+/** Type used for returning error codes from region functions */
+typedef enum RegionResult_t
+{
+    REGION_SUCCESS,
+    REGION_OUT_OF_MEMORY
+} RegionResult;
+
+/*
+*regionSetCreate: Allocates a new set without regions, allocated with the given allocator. the totals
+*of the regions are copied from the given table of totals, which has to outlive the set
+*@return
+* 	NULL - if allocations failed.
+* 	A new RegionSet in case of success.
+*/
+RegionSet regionSetCreate(const Allocator* allocator, Tribe totals);
+/*
+*regionSetDestroy: Deallocates the set with all its regions. If regions is NULL nothing will be done
+*/
+void regionSetDestroy(RegionSet regions);
+/*
+*regionSetAddArea: adds the votes of the given table of an area to the totals of the region with the
+*given id, the region is created if it doesn't exist
+*@return
+*REGION_OUT_OF_MEMORY if creating the region failed, nothing is changed in that case
+*REGION_SUCCESS otherwise
+*/
+RegionResult regionSetAddArea(RegionSet regions, int region_id, Tribe area_tribe);
+/*
+*regionSetRemoveArea: subtracts the votes of the given table of an area from the totals of the region
+*with the given id, the region is destroyed if it was its last area
+*/
+void regionSetRemoveArea(RegionSet regions, int region_id, Tribe area_tribe);
+/*
+*regionSetAddVotes: adds the given change of the votes of an area of the region to the total of the tribe
+*/
+void regionSetAddVotes(RegionSet regions, int region_id, int tribe_id, int64_t change);
+/*
+*regionSetAddTribe: adds the given tribe with zero votes to the totals of every region, which no region
+*has yet
+*@return
+*REGION_OUT_OF_MEMORY if allocation failed, no region has the tribe in that case
+*REGION_SUCCESS otherwise
+*/
+RegionResult regionSetAddTribe(RegionSet regions, int tribe_id, const char* tribe_name);
+/*
+*regionSetRemoveTribes: removes the tribes with the given ids, sorted in ascending order,
+*from the totals of every region
+*/
+void regionSetRemoveTribes(RegionSet regions, const int* sorted_ids, int count);
+/*
+*regionSetMerge: adds the areas and the totals of every region of regions to the region with the same id
+*in merged, creating the regions merged doesn't have. the sets have the same tribes, their tables may be
+*of different schemas, see tribeMergeTotals
+*@return
+*REGION_OUT_OF_MEMORY if creating a region failed, the regions before it were merged in that case
+*REGION_SUCCESS otherwise
+*/
+RegionResult regionSetMerge(RegionSet merged, RegionSet regions);
+/*
+*regionSetGetTotals: return the table of the total votes of the region with the given id, NULL if the
+*region has no areas
+*/
+Tribe regionSetGetTotals(RegionSet regions, int region_id);
+/*
+*regionSetComputeMapping: return a map from the id of every region to the id of the tribe with most
+*votes in it, the lower tribe id in case of a tie. the map is empty if there are no regions or no tribes
+*the map is allocated with the allocator of the set
+*@return NULL if allocation failed
+*/
+Map regionSetComputeMapping(RegionSet regions);
+
+#endif //MTM_REGION_H
@@ -0,0 +1,121 @@
+#include "election.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#define DEFAULT_AREAS 100000
+#define DEFAULT_TRIBES 10
+#define ROUNDS 5
+#define MAX_VOTES 1000
+#define NANOSECONDS_IN_MILLISECOND 1e6
+
+int main(int argc, char** argv);
+static bool parseCount(const char* value, int* count);
+static Election createElection(int areas, int tribes);
+static bool isOddArea(int area_id);
+static bool isAnyArea(int area_id);
+
+/*
+times electionRemoveAreas on an election of many areas with votes: removing every other area and then
+removing the rest. the best of a few rounds is printed, every round on a new election
+*/
+int main(int argc, char** argv)
+{
+    int areas = DEFAULT_AREAS;
+    int tribes = DEFAULT_TRIBES;
+    if (argc > 3 || (argc > 1 && !parseCount(argv[1], &areas)) || (argc > 2 && !parseCount(argv[2], &tribes)))
+    {
+        fprintf(stderr, "usage: %s [areas] [tribes]\n"
+                "       the defaults are %d areas and %d tribes\n", argv[0], DEFAULT_AREAS, DEFAULT_TRIBES);
+        return EXIT_FAILURE;
+    }
+    long long best_half = -1;
+    long long best_rest = -1;
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        Election election = createElection(areas, tribes);
+        if (election == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+        long long started = statsNow();
+        ElectionResult half_result = electionRemoveAreas(election, isOddArea);
+        long long half = statsNow() - started;
+        started = statsNow();
+        ElectionResult rest_result = electionRemoveAreas(election, isAnyArea);
+        long long rest = statsNow() - started;
+        electionDestroy(election);
+        if (half_result != ELECTION_SUCCESS || rest_result != ELECTION_SUCCESS)
+        {
+            fprintf(stderr, "out of memory\n");
+            return EXIT_FAILURE;
+        }
+        best_half = best_half < 0 || half < best_half ? half : best_half;
+        best_rest = best_rest < 0 || rest < best_rest ? rest : best_rest;
+    }
+    printf("%d areas, %d tribes, best of %d rounds\n", areas, tribes, ROUNDS);
+    printf("removing every other area: %.3f ms\n", best_half / NANOSECONDS_IN_MILLISECOND);
+    printf("removing the rest:         %.3f ms\n", best_rest / NANOSECONDS_IN_MILLISECOND);
+    return EXIT_SUCCESS;
+}
+
+/*
+sets count to the positive number in value, return false if value isn't one
+*/
+static bool parseCount(const char* value, int* count)
+{
+    char* end;
+    long parsed = strtol(value, &end, 10);
+    if (*value == '\0' || *end != '\0' || parsed <= 0 || parsed > INT_MAX)
+    {
+        return false;
+    }
+    *count = (int)parsed;
+    return true;
+}
+
+/*
+return an election of the given number of areas and tribes where every tribe got votes in every area,
+NULL if memory allocation failed
+*/
+static Election createElection(int areas, int tribes)
+{
+    Election election = electionCreate();
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    bool created = true;
+    for (int tribe_id = 0; tribe_id < tribes && created; tribe_id++)
+    {
+        created = electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS;
+    }
+    for (int area_id = 0; area_id < areas && created; area_id++)
+    {
+        created = electionAddArea(election, area_id, "area") == ELECTION_SUCCESS;
+        for (int tribe_id = 0; tribe_id < tribes && created; tribe_id++)
+        {
+            int votes = (area_id * 31 + tribe_id * 17) % MAX_VOTES + 1;
+            created = electionAddVote(election, area_id, tribe_id, votes) == ELECTION_SUCCESS;
+        }
+    }
+    if (!created)
+    {
+        electionDestroy(election);
+        return NULL;
+    }
+    return election;
+}
+
+static bool isOddArea(int area_id)
+{
+    return area_id % 2 == 1;
+}
+
+static bool isAnyArea(int area_id)
+{
+    return true;
+}
@@ -0,0 +1,226 @@
+#define _POSIX_C_SOURCE 199309L
+#include "election.h"
+#include "mtm_map/map.h"
+#include "trace.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#define NANOSECONDS_IN_SECOND 1000000000LL
+
+/*
+the ids of the areas the current electionRemoveAreas removes, sorted, the condition function gets only
+an area id so they can't be passed to it
+*/
+static int* removed_area_ids;
+static int removed_count;
+
+/*
+the calls replayed so far, mismatches counts the calls whose result isn't the recorded one
+*/
+typedef struct Replay_t
+{
+    Election election;
+    bool paced;
+    long long start;
+    long long calls;
+    long long mismatches;
+    StatsHistogram latency[TRACE_OPERATIONS];
+} Replay;
+
+int main(int argc, char** argv);
+static TraceResult replayTrace(Replay* replay, TraceReader reader);
+static int replayCall(Replay* replay, const TraceRecord* record);
+static bool prepareRemovedAreas(const TraceRecord* record);
+static bool isRemovedArea(int area_id);
+static int compareIds(const void* first, const void* second);
+static void waitUntil(long long time);
+static void printReport(const Replay* replay, long long elapsed, FILE* stream);
+
+int main(int argc, char** argv)
+{
+    Replay replay;
+    memset(&replay, 0, sizeof(replay));
+    int argument = 1;
+    if (argument < argc && strcmp(argv[argument], "-p") == 0)
+    {
+        replay.paced = true;
+        argument++;
+    }
+    if (argument + 1 != argc)
+    {
+        fprintf(stderr, "usage: %s [-p] trace file\n"
+                "       -p replays the calls at the pace they were recorded, not as fast as possible\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    FILE* trace_file = fopen(argv[argument], "rb");
+    TraceReader reader = traceReaderCreate(trace_file, NULL);
+    if (reader == NULL)
+    {
+        fprintf(stderr, "%s isn't a trace\n", argv[argument]);
+        if (trace_file != NULL)
+        {
+            fclose(trace_file);
+        }
+        return EXIT_FAILURE;
+    }
+    replay.election = electionCreate();
+    if (replay.election == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    replay.start = statsNow();
+    TraceResult result = replayTrace(&replay, reader);
+    long long elapsed = statsNow() - replay.start;
+    printReport(&replay, elapsed, stdout);
+    electionDestroy(replay.election);
+    free(removed_area_ids);
+    traceReaderDestroy(reader);
+    fclose(trace_file);
+    if (result != TRACE_END)
+    {
+        fprintf(stderr, result == TRACE_OUT_OF_MEMORY ? "out of memory\n" : "the trace is cut or corrupt\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*
+replays the records of the trace one after the other and times them
+return TRACE_END if all the records were replayed, or the error that stopped the replay
+*/
+static TraceResult replayTrace(Replay* replay, TraceReader reader)
+{
+    TraceRecord record;
+    TraceResult result;
+    while ((result = traceRead(reader, &record)) == TRACE_SUCCESS)
+    {
+        if (record.operation == TRACE_REMOVE_AREAS && !prepareRemovedAreas(&record))
+        {
+            return TRACE_OUT_OF_MEMORY;
+        }
+        if (replay->paced)
+        {
+            waitUntil(replay->start + record.timestamp_ns);
+        }
+        long long started = statsNow();
+        int call_result = replayCall(replay, &record);
+        statsAddLatency(&replay->latency[record.operation], statsNow() - started);
+        replay->calls++;
+        if (call_result != record.result)
+        {
+            replay->mismatches++;
+        }
+    }
+    return result;
+}
+
+/*
+makes the call of the record on the election of the replay
+return the result of the call as it is recorded
+*/
+static int replayCall(Replay* replay, const TraceRecord* record)
+{
+    Election election = replay->election;
+    switch (record->operation)
+    {
+    case TRACE_ADD_TRIBE:
+        return electionAddTribe(election, record->tribe_id, record->name);
+    case TRACE_ADD_AREA:
+        return electionAddArea(election, record->area_id, record->name);
+    case TRACE_GET_TRIBE_NAME:
+    {
+        char* name = electionGetTribeName(election, record->tribe_id);
+        free(name);
+        return name != NULL ? ELECTION_SUCCESS : ELECTION_TRIBE_NOT_EXIST;
+    }
+    case TRACE_ADD_VOTE:
+        return electionAddVote(election, record->area_id, record->tribe_id, record->num_of_votes);
+    case TRACE_REMOVE_VOTE:
+        return electionRemoveVote(election, record->area_id, record->tribe_id, record->num_of_votes);
+    case TRACE_SET_TRIBE_NAME:
+        return electionSetTribeName(election, record->tribe_id, record->name);
+    case TRACE_REMOVE_TRIBE:
+        return electionRemoveTribe(election, record->tribe_id);
+    case TRACE_REMOVE_AREAS:
+        return electionRemoveAreas(election, isRemovedArea);
+    case TRACE_COMPUTE_MAPPING:
+    {
+        Map map = electionComputeAreasToTribesMapping(election);
+        mapDestroy(map);
+        return map != NULL ? ELECTION_SUCCESS : ELECTION_OUT_OF_MEMORY;
+    }
+    default:
+        return record->result;
+    }
+}
+
+/*
+copies the ids of the areas the record removed and sorts them for isRemovedArea
+return false if allocation failed
+*/
+static bool prepareRemovedAreas(const TraceRecord* record)
+{
+    int* ids = realloc(removed_area_ids, (record->area_count > 0 ? record->area_count : 1) * sizeof(*ids));
+    if (ids == NULL)
+    {
+        return false;
+    }
+    removed_area_ids = ids;
+    removed_count = record->area_count;
+    if (removed_count > 0)
+    {
+        memcpy(removed_area_ids, record->area_ids, removed_count * sizeof(*removed_area_ids));
+    }
+    qsort(removed_area_ids, removed_count, sizeof(*removed_area_ids), compareIds);
+    return true;
+}
+
+/*
+the condition of a replayed electionRemoveAreas, true for the areas it removed when it was recorded
+*/
+static bool isRemovedArea(int area_id)
+{
+    return bsearch(&area_id, removed_area_ids, removed_count, sizeof(*removed_area_ids), compareIds) != NULL;
+}
+
+/*
+orders ids for qsort and bsearch
+*/
+static int compareIds(const void* first, const void* second)
+{
+    int first_id = *(const int*)first, second_id = *(const int*)second;
+    return (first_id > second_id) - (first_id < second_id);
+}
+
+/*
+sleeps until the given time of statsNow
+*/
+static void waitUntil(long long time)
+{
+    long long left = time - statsNow();
+    while (left > 0)
+    {
+        struct timespec wait = {left / NANOSECONDS_IN_SECOND, left % NANOSECONDS_IN_SECOND};
+        nanosleep(&wait, NULL);
+        left = time - statsNow();
+    }
+}
+
+/*
+writes the number of calls, how many returned another result than the recorded one, the throughput
+and the latencies of every operation as one JSON object
+*/
+static void printReport(const Replay* replay, long long elapsed, FILE* stream)
+{
+    double seconds = (double)elapsed / NANOSECONDS_IN_SECOND;
+    fprintf(stream, "{\"paced\":%s,\"calls\":%lld,\"mismatches\":%lld,\"seconds\":%.6f,\"calls_per_second\":%.0f,",
+            replay->paced ? "true" : "false", replay->calls, replay->mismatches, seconds,
+            seconds > 0 ? replay->calls / seconds : 0);
+    tracePrintLatencyJson(replay->latency, stream);
+    fprintf(stream, "}\n");
+}
@@ -0,0 +1,344 @@
+#define _POSIX_C_SOURCE 200809L
+#include "scheduler.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define CACHE_LINE_SIZE 64
+#define DEQUE_SIZE 64
+#define RANDOM_SEED 0x9e3779b97f4a7c15ULL
+#define PACK_RANGE(begin, end) (((uint64_t)(uint32_t)(begin) << 32) | (uint32_t)(end))
+#define RANGE_BEGIN(range) ((int)((range) >> 32))
+#define RANGE_END(range) ((int)((range) & UINT32_MAX))
+
+/*
+a Chase-Lev deque of ranges, its thread pushes and takes at bottom and the other threads steal at top.
+a range is packed into one uint64_t so it is read and written at once. a thread only pushes when its
+deque is empty (see runRange), so it has at most one range, DEQUE_SIZE is only a bound.
+top and bottom are on different cache lines so stealing doesn't slow down the thread
+*/
+struct deque_t
+{
+    int64_t top;
+    char top_line[CACHE_LINE_SIZE];
+    int64_t bottom;
+    uint64_t ranges[DEQUE_SIZE];
+    char bottom_line[CACHE_LINE_SIZE];
+};
+
+/*
+the thread with index 0 is the caller of schedulerFor, the others are started by schedulerCreate.
+seen is the last round the thread worked on, random picks the threads to steal from
+*/
+struct scheduler_thread_t
+{
+    Scheduler scheduler;
+    int index;
+    unsigned long seen;
+    uint64_t random;
+    pthread_t thread;
+    struct deque_t deque;
+};
+
+/*
+round counts the calls to schedulerFor that use the threads, remaining is the number of iterations of
+the loop that didn't run yet and busy the number of started threads that didn't finish the round.
+lock guards round, busy and stopping, call_lock is held by the caller of schedulerFor
+*/
+struct scheduler_t
+{
+    const Allocator* allocator;
+    struct scheduler_thread_t* threads;
+    int size;
+    SchedulerBody body;
+    void* argument;
+    int grain;
+    int remaining;
+    unsigned long round;
+    int busy;
+    bool stopping;
+    pthread_mutex_t call_lock;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+};
+
+Scheduler schedulerCreate(int threads, const Allocator* allocator);
+void schedulerDestroy(Scheduler scheduler);
+void schedulerFor(Scheduler scheduler, int size, int grain, SchedulerBody body, void* argument);
+static void* runThread(void* argument);
+static void stopThreads(Scheduler scheduler, int started);
+static void work(struct scheduler_thread_t* thread);
+static void runRange(struct scheduler_thread_t* thread, int begin, int end);
+static bool stealAny(struct scheduler_thread_t* thread, uint64_t* range);
+static void push(struct deque_t* deque, uint64_t range);
+static bool take(struct deque_t* deque, uint64_t* range);
+static bool steal(struct deque_t* deque, uint64_t* range);
+static bool isEmpty(struct deque_t* deque);
+
+Scheduler schedulerCreate(int threads, const Allocator* allocator)
+{
+    assert(threads > 0 && allocator != NULL);
+    Scheduler scheduler = allocatorAllocate(allocator, sizeof(*scheduler));
+    if (scheduler == NULL)
+    {
+        return NULL;
+    }
+    scheduler->threads = allocatorAllocate(allocator, threads * sizeof(*scheduler->threads));
+    if (scheduler->threads == NULL)
+    {
+        allocatorDeallocate(allocator, scheduler);
+        return NULL;
+    }
+    scheduler->allocator = allocator;
+    scheduler->size = threads;
+    scheduler->body = NULL;
+    scheduler->argument = NULL;
+    scheduler->grain = 1;
+    scheduler->remaining = 0;
+    scheduler->round = 0;
+    scheduler->busy = 0;
+    scheduler->stopping = false;
+    pthread_mutex_init(&scheduler->call_lock, NULL);
+    pthread_mutex_init(&scheduler->lock, NULL);
+    pthread_cond_init(&scheduler->work, NULL);
+    pthread_cond_init(&scheduler->done, NULL);
+    for (int i = 0; i < threads; i++)
+    {
+        struct scheduler_thread_t* thread = &scheduler->threads[i];
+        thread->scheduler = scheduler;
+        thread->index = i;
+        thread->seen = 0;
+        thread->random = RANDOM_SEED * (i + 1);
+        thread->deque.top = 0;
+        thread->deque.bottom = 0;
+        if (i > 0 && pthread_create(&thread->thread, NULL, runThread, thread) != 0)
+        {
+            stopThreads(scheduler, i);
+            return NULL;
+        }
+    }
+    return scheduler;
+}
+
+void schedulerDestroy(Scheduler scheduler)
+{
+    if (scheduler == NULL)
+    {
+        return;
+    }
+    stopThreads(scheduler, scheduler->size);
+}
+
+void schedulerFor(Scheduler scheduler, int size, int grain, SchedulerBody body, void* argument)
+{
+    assert(size >= 0 && grain > 0 && body != NULL);
+    if (scheduler == NULL || scheduler->size == 1 || size <= grain ||
+        pthread_mutex_trylock(&scheduler->call_lock) != 0)
+    {
+        if (size > 0)
+        {
+            body(0, size, argument);
+        }
+        return;
+    }
+    scheduler->body = body;
+    scheduler->argument = argument;
+    scheduler->grain = grain;
+    __atomic_store_n(&scheduler->remaining, size, __ATOMIC_SEQ_CST);
+    push(&scheduler->threads[0].deque, PACK_RANGE(0, size));//stolen from the caller by the first idle threads
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->round++;
+    scheduler->busy = scheduler->size - 1;
+    pthread_cond_broadcast(&scheduler->work);
+    pthread_mutex_unlock(&scheduler->lock);
+    work(&scheduler->threads[0]);
+    pthread_mutex_lock(&scheduler->lock);
+    while (scheduler->busy > 0)//no thread looks at the deques of this call after it returns
+    {
+        pthread_cond_wait(&scheduler->done, &scheduler->lock);
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+    pthread_mutex_unlock(&scheduler->call_lock);
+}
+
+/*
+the loop of a started thread, works on every round until the scheduler stops
+*/
+static void* runThread(void* argument)
+{
+    struct scheduler_thread_t* thread = argument;
+    Scheduler scheduler = thread->scheduler;
+    pthread_mutex_lock(&scheduler->lock);
+    while (!scheduler->stopping)
+    {
+        if (thread->seen == scheduler->round)
+        {
+            pthread_cond_wait(&scheduler->work, &scheduler->lock);
+            continue;
+        }
+        thread->seen = scheduler->round;
+        pthread_mutex_unlock(&scheduler->lock);
+        work(thread);
+        pthread_mutex_lock(&scheduler->lock);
+        scheduler->busy--;
+        if (scheduler->busy == 0)
+        {
+            pthread_cond_signal(&scheduler->done);
+        }
+    }
+    pthread_mutex_unlock(&scheduler->lock);
+    return NULL;
+}
+
+/*
+stops and joins the given number of threads that were started, counting the caller as the first one,
+and deallocates the scheduler
+*/
+static void stopThreads(Scheduler scheduler, int started)
+{
+    pthread_mutex_lock(&scheduler->lock);
+    scheduler->stopping = true;
+    pthread_cond_broadcast(&scheduler->work);
+    pthread_mutex_unlock(&scheduler->lock);
+    for (int i = 1; i < started; i++)
+    {
+        pthread_join(scheduler->threads[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&scheduler->call_lock);
+    pthread_mutex_destroy(&scheduler->lock);
+    pthread_cond_destroy(&scheduler->work);
+    pthread_cond_destroy(&scheduler->done);
+    allocatorDeallocate(scheduler->allocator, scheduler->threads);
+    allocatorDeallocate(scheduler->allocator, scheduler);
+}
+
+/*
+runs the ranges of the deque of the thread and steals from the other threads until all the iterations
+of the loop ran
+*/
+static void work(struct scheduler_thread_t* thread)
+{
+    Scheduler scheduler = thread->scheduler;
+    uint64_t range;
+    while (__atomic_load_n(&scheduler->remaining, __ATOMIC_ACQUIRE) > 0)
+    {
+        if (take(&thread->deque, &range) || stealAny(thread, &range))
+        {
+            runRange(thread, RANGE_BEGIN(range), RANGE_END(range));
+        }
+        else
+        {
+            sched_yield();//the last ranges run on other threads
+        }
+    }
+}
+
+/*
+runs the range grain iterations at a time, the upper half of what is left is pushed to the deque of the
+thread whenever it is empty, so it can be stolen
+*/
+static void runRange(struct scheduler_thread_t* thread, int begin, int end)
+{
+    Scheduler scheduler = thread->scheduler;
+    while (begin < end)
+    {
+        if (end - begin > scheduler->grain && isEmpty(&thread->deque))
+        {
+            int middle = begin + (end - begin) / 2;
+            push(&thread->deque, PACK_RANGE(middle, end));
+            end = middle;
+        }
+        int stop = end - begin > scheduler->grain ? begin + scheduler->grain : end;
+        scheduler->body(begin, stop, scheduler->argument);
+        __atomic_sub_fetch(&scheduler->remaining, stop - begin, __ATOMIC_RELEASE);
+        begin = stop;
+    }
+}
+
+/*
+tries to steal a range from every other thread once, starting from a random one
+return false if there was nothing to steal
+*/
+static bool stealAny(struct scheduler_thread_t* thread, uint64_t* range)
+{
+    Scheduler scheduler = thread->scheduler;
+    thread->random ^= thread->random << 13;
+    thread->random ^= thread->random >> 7;
+    thread->random ^= thread->random << 17;
+    int first = (int)(thread->random % scheduler->size);
+    for (int i = 0; i < scheduler->size; i++)
+    {
+        int victim = (first + i) % scheduler->size;
+        if (victim != thread->index && steal(&scheduler->threads[victim].deque, range))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+pushes the range at the bottom of the deque, only its thread pushes
+*/
+static void push(struct deque_t* deque, uint64_t range)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->ranges[bottom & (DEQUE_SIZE - 1)], range, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);//a thief that sees the new bottom sees the range
+}
+
+/*
+takes the range at the bottom of the deque, only its thread takes
+return false if the deque is empty or a thief stole its last range
+*/
+static bool take(struct deque_t* deque, uint64_t* range)
+{
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_SEQ_CST);//ordered before reading top, against steal
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_SEQ_CST);
+    if (top > bottom)
+    {
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    *range = __atomic_load_n(&deque->ranges[bottom & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (top < bottom)
+    {
+        return true;
+    }
+    //the last range, the thread and the thieves race for it on top
+    bool taken = __atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST,
+                                             __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return taken;
+}
+
+/*
+steals the range at the top of the deque of another thread
+return false if the deque is empty or another thread took the range first
+*/
+static bool steal(struct deque_t* deque, uint64_t* range)
+{
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_SEQ_CST);
+    if (top >= bottom)
+    {
+        return false;
+    }
+    *range = __atomic_load_n(&deque->ranges[top & (DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    return __atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/*
+return true if the deque has no range, only its thread asks since thieves only make it emptier
+*/
+static bool isEmpty(struct deque_t* deque)
+{
+    return __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) <= __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+}
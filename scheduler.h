@@ -0,0 +1,40 @@
+#ifndef MTM_SCHEDULER_H
+#define MTM_SCHEDULER_H
+
+#include "allocator.h"
+/**
+* Scheduler
+* Implements a work stealing pool of threads for loops over the areas of a list.
+* Every thread has a Chase-Lev deque of ranges of the loop. A thread runs its range a few iterations
+* at a time and splits off the upper half of what is left whenever its deque is empty, so ranges are
+* only split while other threads are idle and steal them, and an area that takes long doesn't hold
+* up the ones after it.
+* The thread that calls schedulerFor works on the loop too, so a scheduler of n threads starts n - 1.
+**/
+
+/** Type for defining a Scheduler */
+typedef struct scheduler_t* Scheduler;
+
+/** Type of the body of a loop, runs the iterations in [begin, end) */
+typedef void (*SchedulerBody)(int begin, int end, void* argument);
+
+/*
+*schedulerCreate: creates a scheduler of the given number of threads, allocated with the given allocator
+*@return
+*NULL if memory allocation failed or a thread couldn't start
+*/
+Scheduler schedulerCreate(int threads, const Allocator* allocator);
+/*
+*schedulerDestroy: stops the threads and deallocates the scheduler. If scheduler is NULL nothing will
+*be done
+*/
+void schedulerDestroy(Scheduler scheduler);
+/*
+*schedulerFor: runs the iterations [0, size) of the loop with the given body, grain iterations at a time,
+*and return when all of them ran. the iterations of one call may run at once on different threads, in
+*any order. if scheduler is NULL, has one thread, size is at most grain or another schedulerFor of the
+*scheduler is running, the body runs on [0, size) on the calling thread
+*/
+void schedulerFor(Scheduler scheduler, int size, int grain, SchedulerBody body, void* argument);
+
+#endif //MTM_SCHEDULER_H
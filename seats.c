@@ -0,0 +1,315 @@
+#include "seats.h"
+#include "mtm_map/map_ext.h"
+#include "assist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+the quotient of a tribe is numerator / denominator, index is the position of the tribe in the table
+*/
+struct quotient_t
+{
+    int64_t numerator;
+    int64_t denominator;
+    int id;
+    int index;
+};
+
+Map seatsAllocate(const Allocator* allocator, Tribe totals, ElectionSeatMethod method, int seats,
+                  double threshold);
+static void allocateByAverages(struct quotient_t* heap, int size, int* won, int seats, int step);
+static void allocateByRemainders(struct quotient_t* heap, int size, int* won, int seats,
+                                 int64_t eligible_votes);
+static int64_t sumEligibleVotes(struct quotient_t* heap, int size);
+static void divideProduct(int64_t votes, int seats, int64_t total, int64_t* quotient, int64_t* remainder);
+static bool isHigher(const struct quotient_t* first, const struct quotient_t* second);
+static int compareFractions(int64_t first_numerator, int64_t first_denominator, int64_t second_numerator,
+                            int64_t second_denominator);
+static void heapify(struct quotient_t* heap, int size);
+static void siftDown(struct quotient_t* heap, int size, int position);
+static Map createSeatsMap(const Allocator* allocator, const int* ids, const int* won, int count);
+
+Map seatsAllocate(const Allocator* allocator, Tribe totals, ElectionSeatMethod method, int seats,
+                  double threshold)
+{
+    const int* ids;
+    const int64_t* votes;
+    assert(totals != NULL && seats >= 0 && threshold >= 0 && threshold <= 1);
+    int count = tribeGetTable(totals, &ids, &votes);
+    if (count == 0)
+    {
+        return mapCreateWithAllocator(allocator);
+    }
+    int* won = allocatorAllocate(allocator, count * sizeof(*won));
+    struct quotient_t* heap = allocatorAllocate(allocator, count * sizeof(*heap));
+    if (won == NULL || heap == NULL)
+    {
+        allocatorDeallocate(allocator, won);
+        allocatorDeallocate(allocator, heap);
+        return NULL;
+    }
+    memset(won, 0, count * sizeof(*won));
+    double all_votes = 0;//only compared with the threshold, so it doesn't have to be exact
+    for (int i = 0; i < count; i++)
+    {
+        all_votes += (double)votes[i];
+    }
+    int size = 0;
+    for (int i = 0; i < count; i++)//only the tribes that passed the threshold are in the queue
+    {
+        if (votes[i] > 0 && (double)votes[i] >= threshold * all_votes)
+        {
+            heap[size].numerator = votes[i];
+            heap[size].denominator = 1;
+            heap[size].id = ids[i];
+            heap[size].index = i;
+            size++;
+        }
+    }
+    if (size > 0 && seats > 0)
+    {
+        switch (method)
+        {
+        case ELECTION_DHONDT:
+            allocateByAverages(heap, size, won, seats, 1);//divisors 1, 2, 3...
+            break;
+        case ELECTION_SAINTE_LAGUE:
+            allocateByAverages(heap, size, won, seats, 2);//divisors 1, 3, 5...
+            break;
+        case ELECTION_LARGEST_REMAINDER:
+            allocateByRemainders(heap, size, won, seats, sumEligibleVotes(heap, size));
+            break;
+        }
+    }
+    Map map_of_seats = createSeatsMap(allocator, ids, won, count);
+    allocatorDeallocate(allocator, won);
+    allocatorDeallocate(allocator, heap);
+    return map_of_seats;
+}
+
+/*
+gives every seat to the tribe with the highest votes / divisor, the divisor of a tribe grows by step
+with every seat it gets
+*/
+static void allocateByAverages(struct quotient_t* heap, int size, int* won, int seats, int step)
+{
+    heapify(heap, size);
+    for (int seat = 0; seat < seats; seat++)
+    {
+        won[heap[0].index]++;
+        heap[0].denominator += step;
+        siftDown(heap, size, 0);
+    }
+}
+
+/*
+gives every tribe the whole part of votes * seats / eligible_votes and the seats left, one each,
+to the tribes with the highest remainders. there are less seats left than tribes
+*/
+static void allocateByRemainders(struct quotient_t* heap, int size, int* won, int seats,
+                                 int64_t eligible_votes)
+{
+    int seats_left = seats;
+    for (int i = 0; i < size; i++)
+    {
+        int64_t whole;
+        divideProduct(heap[i].numerator, seats, eligible_votes, &whole, &heap[i].numerator);
+        won[heap[i].index] = (int)whole;//all the remainders have the same denominator
+        seats_left -= won[heap[i].index];
+    }
+    assert(seats_left >= 0 && seats_left < size);
+    heapify(heap, size);
+    for (; seats_left > 0; seats_left--)
+    {
+        won[heap[0].index]++;
+        size--;
+        heap[0] = heap[size];
+        siftDown(heap, size, 0);
+    }
+}
+
+/*
+return the sum of the votes in the queue. when it doesn't fit in 64 bits all the votes are halved until
+it does, so only elections of more than INT64_MAX votes in all are rounded
+*/
+static int64_t sumEligibleVotes(struct quotient_t* heap, int size)
+{
+    while (true)
+    {
+        int64_t sum = 0;
+        bool overflow = false;
+        for (int i = 0; i < size && !overflow; i++)
+        {
+            overflow = __builtin_add_overflow(sum, heap[i].numerator, &sum);
+        }
+        if (!overflow)
+        {
+            return sum;
+        }
+        for (int i = 0; i < size; i++)
+        {
+            heap[i].numerator /= 2;
+        }
+    }
+}
+
+/*
+sets quotient and remainder to the whole part and the remainder of votes * seats / total, where
+votes isn't more than total. when the product doesn't fit in 64 bits it is built from the bits of
+seats, doubling the partial remainder so nothing is ever bigger than total
+*/
+static void divideProduct(int64_t votes, int seats, int64_t total, int64_t* quotient, int64_t* remainder)
+{
+    int64_t product;
+    if (!__builtin_mul_overflow(votes, seats, &product))
+    {
+        *quotient = product / total;
+        *remainder = product % total;
+        return;
+    }
+    *quotient = 0;
+    *remainder = 0;
+    for (int bit = (int)sizeof(seats) * 8 - 2; bit >= 0; bit--)
+    {
+        *quotient *= 2;
+        if (*remainder >= total - *remainder)
+        {
+            *remainder -= total - *remainder;
+            (*quotient)++;
+        }
+        else
+        {
+            *remainder *= 2;
+        }
+        if (seats >> bit & 1)
+        {
+            if (*remainder >= total - votes)
+            {
+                *remainder -= total - votes;
+                (*quotient)++;
+            }
+            else
+            {
+                *remainder += votes;
+            }
+        }
+    }
+}
+
+/*
+return true if the quotient of first is higher than the quotient of second, or they are equal and
+first has the lower tribe id
+*/
+static bool isHigher(const struct quotient_t* first, const struct quotient_t* second)
+{
+    int64_t first_cross, second_cross;
+    int compared;
+    if (!__builtin_mul_overflow(first->numerator, second->denominator, &first_cross) &&
+        !__builtin_mul_overflow(second->numerator, first->denominator, &second_cross))
+    {
+        compared = (first_cross > second_cross) - (first_cross < second_cross);
+    }
+    else
+    {
+        compared = compareFractions(first->numerator, first->denominator, second->numerator,
+                                    second->denominator);
+    }
+    if (compared != 0)
+    {
+        return compared > 0;
+    }
+    return first->id < second->id;
+}
+
+/*
+compares two non negative fractions with positive denominators without multiplying, by their whole
+parts and then by the inverses of what is left, like the steps of Euclid's algorithm
+return a positive number if the first is higher, a negative number if it is lower and 0 if they are equal
+*/
+static int compareFractions(int64_t first_numerator, int64_t first_denominator, int64_t second_numerator,
+                            int64_t second_denominator)
+{
+    while (true)
+    {
+        int64_t first_whole = first_numerator / first_denominator;
+        int64_t second_whole = second_numerator / second_denominator;
+        if (first_whole != second_whole)
+        {
+            return first_whole > second_whole ? 1 : -1;
+        }
+        first_numerator %= first_denominator;
+        second_numerator %= second_denominator;
+        if (first_numerator == 0 || second_numerator == 0)
+        {
+            return (first_numerator != 0) - (second_numerator != 0);
+        }
+        //a / b is higher than c / d when both are below 1 exactly when d / c is higher than b / a
+        int64_t numerator = first_numerator, denominator = first_denominator;
+        first_numerator = second_denominator;
+        first_denominator = second_numerator;
+        second_numerator = denominator;
+        second_denominator = numerator;
+    }
+}
+
+/*
+orders the array as a binary heap with the highest quotient first
+*/
+static void heapify(struct quotient_t* heap, int size)
+{
+    for (int position = size / 2 - 1; position >= 0; position--)
+    {
+        siftDown(heap, size, position);
+    }
+}
+
+/*
+moves the quotient at the given position down until it isn't lower than its children
+*/
+static void siftDown(struct quotient_t* heap, int size, int position)
+{
+    struct quotient_t moved = heap[position];
+    while (2 * position + 1 < size)
+    {
+        int child = 2 * position + 1;
+        if (child + 1 < size && isHigher(&heap[child + 1], &heap[child]))
+        {
+            child++;
+        }
+        if (!isHigher(&heap[child], &moved))
+        {
+            break;
+        }
+        heap[position] = heap[child];
+        position = child;
+    }
+    heap[position] = moved;
+}
+
+/*
+return a map from every tribe id to its seats, NULL if allocation failed
+*/
+static Map createSeatsMap(const Allocator* allocator, const int* ids, const int* won, int count)
+{
+    char string_tribe_id[INT_STRING_SIZE], string_seats[INT_STRING_SIZE];
+    Map map_of_seats = mapCreateWithCapacity(allocator, count);
+    if (map_of_seats == NULL)
+    {
+        return NULL;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        writeIntToString(ids[i], string_tribe_id);
+        writeIntToString(won[i], string_seats);
+        if (mapAppend(map_of_seats, string_tribe_id, string_seats) != MAP_SUCCESS)//tribe ids are unique
+        {
+            mapDestroy(map_of_seats);
+            return NULL;
+        }
+    }
+    return map_of_seats;
+}
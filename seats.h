@@ -0,0 +1,29 @@
+#ifndef MTM_SEATS_H
+#define MTM_SEATS_H
+
+#include "mtm_map/map.h"
+#include "election_ext.h"
+#include "allocator.h"
+#include "tribe.h"
+/**
+* Seats
+* Allocates the seats of a house between tribes, proportionally to a table of their votes.
+* The highest averages methods (D'Hondt and Sainte-Lague) keep a priority queue of the quotient
+* of every tribe and give the next seat to the highest quotient, so S seats between T tribes
+* take O(T + S log T). The largest remainder method gives every tribe the whole part of its
+* quota and the seats left to the highest remainders, which takes O(T + T log T) at most.
+* Quotients and remainders are compared exactly with integers, a tie goes to the lower tribe id.
+**/
+
+/*
+*seatsAllocate: return a map from the id of every tribe of the given table to the number of seats it
+*got, out of the given number of seats, by the given method. tribes with no votes or with less than
+*threshold (a fraction between 0 and 1) of all the votes of the table get no seats, and no seat is
+*given if no tribe passes it. the map is empty if the table has no tribes
+*the map is allocated with the given allocator
+*@return NULL if allocation failed
+*/
+Map seatsAllocate(const Allocator* allocator, Tribe totals, ElectionSeatMethod method, int seats,
+                  double threshold);
+
+#endif //MTM_SEATS_H
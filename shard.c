@@ -0,0 +1,480 @@
+#define _GNU_SOURCE
+#include "shard.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#define NODE_CPU_LIST "/sys/devices/system/node/node%d/cpulist"
+#define NODE_PATH_SIZE 64
+#define HEAP_CHUNK_SIZE (4 << 20)
+#define HEAP_CLASSES 17
+#define HEAP_HEADER 16
+#define HEAP_LARGE -1
+#define CLASS_SIZE(class) ((size_t)HEAP_HEADER << (class))
+#define NODE_MASK_WORDS 16
+#define NODE_MASK_BITS (NODE_MASK_WORDS * sizeof(unsigned long) * CHAR_BIT)
+
+/*
+the worker of one shard, seen is the last round it ran
+*/
+struct shard_worker_t
+{
+    ShardPool pool;
+    int shard;
+    unsigned long seen;
+    pthread_t thread;
+};
+
+/*
+round counts the calls to shardPoolRun, a worker runs the task once for every round. pending is the
+number of workers that didn't finish the task of the round yet. lock guards all of them.
+nodes is the number of NUMA nodes, read once when the pool is created
+*/
+struct shard_pool_t
+{
+    const Allocator* allocator;
+    struct shard_worker_t* workers;
+    int size;
+    int nodes;
+    ShardTask task;
+    void* argument;
+    unsigned long round;
+    int pending;
+    bool stopping;
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    pthread_cond_t done;
+};
+
+/*
+the header before every block of a heap, class is the size class of the block or HEAP_LARGE for a block
+with pages of its own, size is the length of those pages. it is HEAP_HEADER bytes, so blocks keep the
+alignment of the pages
+*/
+typedef struct HeapHeader_t
+{
+    long long class;
+    long long size;
+} HeapHeader;
+
+/*
+the blocks of class i are CLASS_SIZE(i) bytes with their header, free_lists[i] links the deallocated
+ones through their first bytes. next and end are the part of the last chunk that wasn't carved yet, chunks
+links the chunks through their first bytes so they are unmapped with the heap. lock guards all of them,
+the threads of the scheduler allocate from the lists of the areas too
+*/
+struct shard_heap_t
+{
+    Allocator allocator;
+    const Allocator* underlying;
+    int node;
+    pthread_mutex_t lock;
+    void* free_lists[HEAP_CLASSES];
+    char* next;
+    char* end;
+    void* chunks;
+};
+
+ShardPool shardPoolCreate(int shards, const Allocator* allocator);
+void shardPoolDestroy(ShardPool pool);
+void shardPoolRun(ShardPool pool, ShardTask task, void* argument);
+int shardNodeCount();
+ShardHeap shardHeapCreate(int node, const Allocator* allocator);
+void shardHeapDestroy(ShardHeap heap);
+const Allocator* shardHeapAllocator(ShardHeap heap);
+int shardNodeOf(const void* address);
+static void* heapAllocate(void* context, size_t size);
+static void* heapReallocate(void* context, void* pointer, size_t size);
+static void heapDeallocate(void* context, void* pointer);
+static void* carveBlock(ShardHeap heap, int class);
+static void* mapNodePages(int node, size_t size);
+static void* runWorker(void* argument);
+static void stopWorkers(ShardPool pool, int started);
+static void pinToNode(int node, int nodes);
+static bool readNodeCpus(int node, cpu_set_t* cpus);
+
+ShardPool shardPoolCreate(int shards, const Allocator* allocator)
+{
+    assert(shards > 0 && allocator != NULL);
+    ShardPool pool = allocatorAllocate(allocator, sizeof(*pool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    pool->workers = allocatorAllocate(allocator, shards * sizeof(*pool->workers));
+    if (pool->workers == NULL)
+    {
+        allocatorDeallocate(allocator, pool);
+        return NULL;
+    }
+    pool->allocator = allocator;
+    pool->size = shards;
+    pool->nodes = shardNodeCount();//before the workers start, they all read it
+    pool->task = NULL;
+    pool->argument = NULL;
+    pool->round = 0;
+    pool->pending = 0;
+    pool->stopping = false;
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    for (int i = 0; i < shards; i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].shard = i;
+        pool->workers[i].seen = 0;
+        if (pthread_create(&pool->workers[i].thread, NULL, runWorker, &pool->workers[i]) != 0)
+        {
+            stopWorkers(pool, i);
+            return NULL;
+        }
+    }
+    return pool;
+}
+
+void shardPoolDestroy(ShardPool pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    stopWorkers(pool, pool->size);
+}
+
+void shardPoolRun(ShardPool pool, ShardTask task, void* argument)
+{
+    assert(pool != NULL && task != NULL);
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->argument = argument;
+    pool->pending = pool->size;
+    pool->round++;
+    pthread_cond_broadcast(&pool->work);
+    while (pool->pending > 0)
+    {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+int shardNodeCount()
+{
+    int nodes = 0;
+    char path[NODE_PATH_SIZE];
+    for (;; nodes++)//the nodes are numbered from 0 without gaps on the machines we run on
+    {
+        snprintf(path, sizeof(path), NODE_CPU_LIST, nodes);
+        FILE* file = fopen(path, "r");
+        if (file == NULL)
+        {
+            break;
+        }
+        fclose(file);
+    }
+    return nodes > 0 ? nodes : 1;
+}
+
+ShardHeap shardHeapCreate(int node, const Allocator* allocator)
+{
+    assert(node >= 0 && allocator != NULL);
+    ShardHeap heap = allocatorAllocate(allocator, sizeof(*heap));
+    if (heap == NULL)
+    {
+        return NULL;
+    }
+    heap->allocator.allocate = heapAllocate;
+    heap->allocator.reallocate = heapReallocate;
+    heap->allocator.deallocate = heapDeallocate;
+    heap->allocator.context = heap;
+    heap->underlying = allocator;
+    heap->node = node;
+    pthread_mutex_init(&heap->lock, NULL);
+    memset(heap->free_lists, 0, sizeof(heap->free_lists));
+    heap->next = NULL;
+    heap->end = NULL;
+    heap->chunks = NULL;
+    return heap;
+}
+
+void shardHeapDestroy(ShardHeap heap)
+{
+    if (heap == NULL)
+    {
+        return;
+    }
+    while (heap->chunks != NULL)
+    {
+        void* chunk = heap->chunks;
+        heap->chunks = *(void**)chunk;
+        munmap(chunk, HEAP_CHUNK_SIZE);
+    }
+    pthread_mutex_destroy(&heap->lock);
+    allocatorDeallocate(heap->underlying, heap);
+}
+
+const Allocator* shardHeapAllocator(ShardHeap heap)
+{
+    assert(heap != NULL);
+    return &heap->allocator;
+}
+
+int shardNodeOf(const void* address)
+{
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, address, MPOL_F_NODE | MPOL_F_ADDR) != 0)
+    {
+        return -1;
+    }
+    return node;
+}
+
+/*
+the allocate function of a heap, a block of the smallest class it fits in or pages of its own
+*/
+static void* heapAllocate(void* context, size_t size)
+{
+    ShardHeap heap = context;
+    if (size > CLASS_SIZE(HEAP_CLASSES - 1) - HEAP_HEADER)
+    {
+        size_t page = sysconf(_SC_PAGESIZE);
+        size_t length = (size + HEAP_HEADER + page - 1) / page * page;
+        HeapHeader* header = mapNodePages(heap->node, length);
+        if (header == NULL)
+        {
+            return NULL;
+        }
+        header->class = HEAP_LARGE;
+        header->size = length;
+        return (char*)header + HEAP_HEADER;
+    }
+    int class = 0;
+    while (CLASS_SIZE(class) - HEAP_HEADER < size)
+    {
+        class++;
+    }
+    pthread_mutex_lock(&heap->lock);
+    HeapHeader* header = heap->free_lists[class];
+    if (header != NULL)
+    {
+        heap->free_lists[class] = *(void**)header;
+    }
+    else
+    {
+        header = carveBlock(heap, class);
+    }
+    pthread_mutex_unlock(&heap->lock);
+    if (header == NULL)
+    {
+        return NULL;
+    }
+    header->class = class;
+    return (char*)header + HEAP_HEADER;
+}
+
+/*
+the reallocate function of a heap, a block that has room for the new size stays where it is
+*/
+static void* heapReallocate(void* context, void* pointer, size_t size)
+{
+    if (pointer == NULL)
+    {
+        return heapAllocate(context, size);
+    }
+    HeapHeader* header = (HeapHeader*)((char*)pointer - HEAP_HEADER);
+    size_t room = (header->class == HEAP_LARGE ? (size_t)header->size : CLASS_SIZE(header->class)) - HEAP_HEADER;
+    if (size <= room)
+    {
+        return pointer;
+    }
+    void* block = heapAllocate(context, size);
+    if (block != NULL)
+    {
+        memcpy(block, pointer, room);
+        heapDeallocate(context, pointer);
+    }
+    return block;
+}
+
+/*
+the deallocate function of a heap, a block goes to the free list of its class and pages of its own are unmapped
+*/
+static void heapDeallocate(void* context, void* pointer)
+{
+    ShardHeap heap = context;
+    HeapHeader* header = (HeapHeader*)((char*)pointer - HEAP_HEADER);
+    if (header->class == HEAP_LARGE)
+    {
+        munmap(header, header->size);
+        return;
+    }
+    int class = header->class;//the link to the next free block takes the place of the header
+    pthread_mutex_lock(&heap->lock);
+    *(void**)header = heap->free_lists[class];
+    heap->free_lists[class] = header;
+    pthread_mutex_unlock(&heap->lock);
+}
+
+/*
+return a new block of the given class from the last chunk, a new chunk is mapped when it doesn't fit and
+the rest of the last one goes to the free lists in the largest blocks it has room for.
+return NULL if mapping failed. the lock of the heap is held
+*/
+static void* carveBlock(ShardHeap heap, int class)
+{
+    if (heap->end - heap->next < (ptrdiff_t)CLASS_SIZE(class))
+    {
+        char* chunk = mapNodePages(heap->node, HEAP_CHUNK_SIZE);
+        if (chunk == NULL)
+        {
+            return NULL;
+        }
+        for (int rest = HEAP_CLASSES - 1; rest >= 0; rest--)
+        {
+            while (heap->end - heap->next >= (ptrdiff_t)CLASS_SIZE(rest))
+            {
+                *(void**)heap->next = heap->free_lists[rest];
+                heap->free_lists[rest] = heap->next;
+                heap->next += CLASS_SIZE(rest);
+            }
+        }
+        *(void**)chunk = heap->chunks;
+        heap->chunks = chunk;
+        heap->next = chunk + HEAP_HEADER;//the link to the next chunk
+        heap->end = chunk + HEAP_CHUNK_SIZE;
+    }
+    void* block = heap->next;
+    heap->next += CLASS_SIZE(class);
+    return block;
+}
+
+/*
+return pages of the given length that are placed on the given node when they are touched, or NULL if
+mapping failed. the pages are placed wherever the kernel puts them if the node can't be bound
+*/
+static void* mapNodePages(int node, size_t size)
+{
+    void* pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages == MAP_FAILED)
+    {
+        return NULL;
+    }
+    unsigned long mask[NODE_MASK_WORDS] = {0};
+    if (node < NODE_MASK_BITS)
+    {
+        mask[node / (sizeof(unsigned long) * CHAR_BIT)] = 1UL << (node % (sizeof(unsigned long) * CHAR_BIT));
+        syscall(SYS_mbind, pages, size, MPOL_PREFERRED, mask, NODE_MASK_BITS + 1, 0);
+    }
+    return pages;
+}
+
+/*
+the loop of a worker, pins the thread to the node of its shard and runs the task of every round until
+the pool stops
+*/
+static void* runWorker(void* argument)
+{
+    struct shard_worker_t* worker = argument;
+    ShardPool pool = worker->pool;
+    pinToNode(worker->shard % pool->nodes, pool->nodes);
+    pthread_mutex_lock(&pool->lock);
+    while (!pool->stopping)
+    {
+        if (worker->seen == pool->round)
+        {
+            pthread_cond_wait(&pool->work, &pool->lock);
+            continue;
+        }
+        worker->seen = pool->round;
+        ShardTask task = pool->task;
+        void* task_argument = pool->argument;
+        pthread_mutex_unlock(&pool->lock);
+        task(worker->shard, task_argument);
+        pthread_mutex_lock(&pool->lock);
+        pool->pending--;
+        if (pool->pending == 0)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/*
+stops and joins the given number of workers that were started and deallocates the pool
+*/
+static void stopWorkers(ShardPool pool, int started)
+{
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < started; i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->work);
+    pthread_cond_destroy(&pool->done);
+    allocatorDeallocate(pool->allocator, pool->workers);
+    allocatorDeallocate(pool->allocator, pool);
+}
+
+/*
+pins the calling thread to the CPUs of the given node out of the given number of nodes, the thread isn't
+pinned if they can't be read
+*/
+static void pinToNode(int node, int nodes)
+{
+    cpu_set_t cpus;
+    if (nodes > 1 && readNodeCpus(node, &cpus))//on one node there is no remote memory to avoid
+    {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+}
+
+/*
+reads the list of the CPUs of the node, ranges like "0-7,16-23", into the given set
+return false if the list can't be read or is empty
+*/
+static bool readNodeCpus(int node, cpu_set_t* cpus)
+{
+    char path[NODE_PATH_SIZE];
+    snprintf(path, sizeof(path), NODE_CPU_LIST, node);
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        return false;
+    }
+    CPU_ZERO(cpus);
+    int first, last, count = 0;
+    while (fscanf(file, "%d", &first) == 1)
+    {
+        last = first;
+        int separator = fgetc(file);
+        if (separator == '-' && fscanf(file, "%d", &last) == 1)
+        {
+            separator = fgetc(file);
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++, count++)
+        {
+            CPU_SET(cpu, cpus);
+        }
+        if (separator != ',')
+        {
+            break;
+        }
+    }
+    fclose(file);
+    return count > 0;
+}
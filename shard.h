@@ -0,0 +1,73 @@
+#ifndef MTM_SHARD_H
+#define MTM_SHARD_H
+
+#include "allocator.h"
+/**
+* ShardPool
+* Implements the worker threads of a sharded election, one for every shard.
+* The worker of shard i is pinned to the CPUs of NUMA node i modulo the number of nodes, so the work
+* on the areas of a shard runs on the node their memory is in when the shard is allocated there.
+* The nodes and their CPUs are read from /sys/devices/system/node, on a machine without it there is
+* one node and the workers aren't pinned.
+* shardPoolRun runs one task on all the shards at once and waits for all of them, it is called by
+* one thread at a time.
+* A ShardHeap is an allocator of the memory of one node, for the areas of a shard that is given no
+* allocator of its own. It takes chunks of pages from mmap and binds them to the node with mbind, so
+* the pages are placed on the node whichever thread touches them first, and carves the blocks out of
+* them in size classes of powers of two. Blocks larger than the largest class get pages of their own.
+**/
+
+/** Type for defining a ShardPool */
+typedef struct shard_pool_t* ShardPool;
+
+/** Type for defining a ShardHeap */
+typedef struct shard_heap_t* ShardHeap;
+
+/** Type of a task that a worker runs for its shard */
+typedef void (*ShardTask)(int shard, void* argument);
+
+/*
+*shardPoolCreate: starts a worker for every one of the given number of shards, the pool is allocated
+*with the given allocator
+*@return
+*NULL if memory allocation failed or a thread couldn't start
+*/
+ShardPool shardPoolCreate(int shards, const Allocator* allocator);
+/*
+*shardPoolDestroy: stops the workers and deallocates the pool. If pool is NULL nothing will be done
+*/
+void shardPoolDestroy(ShardPool pool);
+/*
+*shardPoolRun: calls task(shard, argument) on the worker of every shard and return when all the calls
+*returned
+*/
+void shardPoolRun(ShardPool pool, ShardTask task, void* argument);
+/*
+*shardNodeCount: return the number of NUMA nodes of the machine, 1 if they can't be read. every call reads
+*the node directories again, a pool reads them once when it is created
+*/
+int shardNodeCount();
+/*
+*shardHeapCreate: creates an empty heap of the memory of the given node, the heap itself is allocated
+*with the given allocator. the blocks of the heap can be allocated and deallocated from any thread
+*@return
+*NULL if memory allocation failed
+*/
+ShardHeap shardHeapCreate(int node, const Allocator* allocator);
+/*
+*shardHeapDestroy: gives all the memory of the heap back, the blocks allocated from it are not valid
+*after it. If heap is NULL nothing will be done
+*/
+void shardHeapDestroy(ShardHeap heap);
+/*
+*shardHeapAllocator: return the allocator of the blocks of the heap, valid until the heap is destroyed
+*/
+const Allocator* shardHeapAllocator(ShardHeap heap);
+/*
+*shardNodeOf: return the node of the memory the given address is in, the page is touched if it wasn't yet
+*@return
+*-1 if the node can't be read
+*/
+int shardNodeOf(const void* address);
+
+#endif //MTM_SHARD_H
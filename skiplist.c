@@ -0,0 +1,276 @@
+#include "skiplist.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MAX_HEIGHT 24
+#define LEVEL_BITS 2
+#define LEVEL_MASK ((1u << LEVEL_BITS) - 1)
+#define RANDOM_SEED 2463534242u
+
+/*
+next has height pointers, next[i] is the next node that is at least i + 1 high
+*/
+struct skip_node_t
+{
+    long long key;
+    void* value;
+    int height;
+    struct skip_node_t* next[];
+};
+
+/*
+head is a node of MAX_HEIGHT without a key, height is the height of the highest node
+random is the state of the generator of the heights, it is seeded the same for every list
+so the lists are deterministic
+*/
+struct skip_list_t
+{
+    const Allocator* allocator;
+    int size;
+    int height;
+    uint32_t random;
+    struct skip_node_t* head;
+};
+
+SkipList skipListCreate(const Allocator* allocator);
+void skipListDestroy(SkipList skip_list);
+SkipListResult skipListPut(SkipList skip_list, long long key, void* value);
+SkipListResult skipListSet(SkipList skip_list, long long key, void* value);
+void* skipListGet(SkipList skip_list, long long key);
+SkipListResult skipListRemove(SkipList skip_list, long long key);
+void skipListClear(SkipList skip_list);
+int skipListGetSize(SkipList skip_list);
+SkipListCursor skipListFirst(SkipList skip_list);
+SkipListCursor skipListLowerBound(SkipList skip_list, long long key);
+SkipListCursor skipListNext(SkipListCursor cursor);
+long long skipListCursorKey(SkipListCursor cursor);
+void* skipListCursorValue(SkipListCursor cursor);
+static struct skip_node_t* createNode(SkipList skip_list, int height);
+static struct skip_node_t* findLowerBound(SkipList skip_list, long long key,
+                                          struct skip_node_t* before[MAX_HEIGHT]);
+static int randomHeight(SkipList skip_list);
+
+SkipList skipListCreate(const Allocator* allocator)
+{
+    SkipList skip_list = allocatorAllocate(allocator, sizeof(*skip_list));
+    if (skip_list == NULL)
+    {
+        return NULL;
+    }
+    skip_list->allocator = allocator;
+    skip_list->head = createNode(skip_list, MAX_HEIGHT);
+    if (skip_list->head == NULL)
+    {
+        allocatorDeallocate(allocator, skip_list);
+        return NULL;
+    }
+    skip_list->size = 0;
+    skip_list->height = 1;
+    skip_list->random = RANDOM_SEED;
+    return skip_list;
+}
+
+void skipListDestroy(SkipList skip_list)
+{
+    if (skip_list != NULL)
+    {
+        skipListClear(skip_list);
+        allocatorDeallocate(skip_list->allocator, skip_list->head);
+        allocatorDeallocate(skip_list->allocator, skip_list);
+    }
+}
+
+SkipListResult skipListPut(SkipList skip_list, long long key, void* value)
+{
+    assert(skip_list != NULL);
+    struct skip_node_t* before[MAX_HEIGHT];
+    struct skip_node_t* node = findLowerBound(skip_list, key, before);
+    if (node != NULL && node->key == key)
+    {
+        return SKIP_LIST_ITEM_ALREADY_EXISTS;
+    }
+    int height = randomHeight(skip_list);
+    struct skip_node_t* new_node = createNode(skip_list, height);
+    if (new_node == NULL)
+    {
+        return SKIP_LIST_OUT_OF_MEMORY;
+    }
+    new_node->key = key;
+    new_node->value = value;
+    for (int level = skip_list->height; level < height; level++)//the levels above the list start at the head
+    {
+        before[level] = skip_list->head;
+    }
+    if (height > skip_list->height)
+    {
+        skip_list->height = height;
+    }
+    for (int level = 0; level < height; level++)
+    {
+        new_node->next[level] = before[level]->next[level];
+        before[level]->next[level] = new_node;
+    }
+    skip_list->size++;
+    return SKIP_LIST_SUCCESS;
+}
+
+SkipListResult skipListSet(SkipList skip_list, long long key, void* value)
+{
+    assert(skip_list != NULL);
+    struct skip_node_t* node = skipListLowerBound(skip_list, key);
+    if (node != NULL && node->key == key)
+    {
+        node->value = value;
+        return SKIP_LIST_SUCCESS;
+    }
+    return skipListPut(skip_list, key, value);
+}
+
+void* skipListGet(SkipList skip_list, long long key)
+{
+    struct skip_node_t* node = skipListLowerBound(skip_list, key);
+    if (node == NULL || node->key != key)
+    {
+        return NULL;
+    }
+    return node->value;
+}
+
+SkipListResult skipListRemove(SkipList skip_list, long long key)
+{
+    assert(skip_list != NULL);
+    struct skip_node_t* before[MAX_HEIGHT];
+    struct skip_node_t* node = findLowerBound(skip_list, key, before);
+    if (node == NULL || node->key != key)
+    {
+        return SKIP_LIST_ITEM_DOES_NOT_EXIST;
+    }
+    for (int level = 0; level < node->height; level++)
+    {
+        before[level]->next[level] = node->next[level];
+    }
+    while (skip_list->height > 1 && skip_list->head->next[skip_list->height - 1] == NULL)
+    {
+        skip_list->height--;
+    }
+    allocatorDeallocate(skip_list->allocator, node);
+    skip_list->size--;
+    return SKIP_LIST_SUCCESS;
+}
+
+void skipListClear(SkipList skip_list)
+{
+    assert(skip_list != NULL);
+    struct skip_node_t* node = skip_list->head->next[0];
+    while (node != NULL)
+    {
+        struct skip_node_t* to_delete = node;
+        node = node->next[0];
+        allocatorDeallocate(skip_list->allocator, to_delete);
+    }
+    for (int level = 0; level < MAX_HEIGHT; level++)
+    {
+        skip_list->head->next[level] = NULL;
+    }
+    skip_list->size = 0;
+    skip_list->height = 1;
+}
+
+int skipListGetSize(SkipList skip_list)
+{
+    assert(skip_list != NULL);
+    return skip_list->size;
+}
+
+SkipListCursor skipListFirst(SkipList skip_list)
+{
+    assert(skip_list != NULL);
+    return skip_list->head->next[0];
+}
+
+SkipListCursor skipListLowerBound(SkipList skip_list, long long key)
+{
+    assert(skip_list != NULL);
+    struct skip_node_t* before[MAX_HEIGHT];
+    return findLowerBound(skip_list, key, before);
+}
+
+SkipListCursor skipListNext(SkipListCursor cursor)
+{
+    assert(cursor != NULL);
+    return cursor->next[0];
+}
+
+long long skipListCursorKey(SkipListCursor cursor)
+{
+    assert(cursor != NULL);
+    return cursor->key;
+}
+
+void* skipListCursorValue(SkipListCursor cursor)
+{
+    assert(cursor != NULL);
+    return cursor->value;
+}
+
+/*
+allocates a node with height next pointers, all of them NULL
+return NULL if allocation failed
+*/
+static struct skip_node_t* createNode(SkipList skip_list, int height)
+{
+    struct skip_node_t* node = allocatorAllocate(skip_list->allocator,
+                                                 sizeof(*node) + height * sizeof(struct skip_node_t*));
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->height = height;
+    for (int level = 0; level < height; level++)
+    {
+        node->next[level] = NULL;
+    }
+    return node;
+}
+
+/*
+return the first node whose key is not lower than the given key or NULL, before[i] is set to the
+last node of level i before it, for the levels of the list
+*/
+static struct skip_node_t* findLowerBound(SkipList skip_list, long long key,
+                                          struct skip_node_t* before[MAX_HEIGHT])
+{
+    struct skip_node_t* node = skip_list->head;
+    for (int level = skip_list->height - 1; level >= 0; level--)
+    {
+        while (node->next[level] != NULL && node->next[level]->key < key)
+        {
+            node = node->next[level];
+        }
+        before[level] = node;
+    }
+    return node->next[0];
+}
+
+/*
+return a height for a new node, every level is a quarter as likely as the one below it
+*/
+static int randomHeight(SkipList skip_list)
+{
+    uint32_t random = skip_list->random;//xorshift32
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    skip_list->random = random;
+    int height = 1;
+    while ((random & LEVEL_MASK) == 0 && height < MAX_HEIGHT)
+    {
+        height++;
+        random >>= LEVEL_BITS;
+    }
+    return height;
+}
@@ -0,0 +1,99 @@
+#ifndef MTM_SKIPLIST_H
+#define MTM_SKIPLIST_H
+
+#include "allocator.h"
+#include <stdbool.h>
+/**
+* SkipList
+* Implements an ordered table from a number to a pointer.
+* The table is a skip list, so finding, adding and removing a key and finding the first key that
+* is not lower than a given key are O(log n) on average, and the keys are visited in ascending
+* order with a cursor.
+* The table does not own the pointers it keeps, destroying the table does not deallocate them.
+**/
+
+/** Type for defining a SkipList */
+typedef struct skip_list_t* SkipList;
+
+/** Type for a position in a SkipList, NULL is the position after the last key */
+typedef struct skip_node_t* SkipListCursor;
+
+/** Type used for returning error codes from skip list functions */
+typedef enum SkipListResult_t
+{
+    SKIP_LIST_SUCCESS,
+    SKIP_LIST_OUT_OF_MEMORY,
+    SKIP_LIST_ITEM_ALREADY_EXISTS,
+    SKIP_LIST_ITEM_DOES_NOT_EXIST
+} SkipListResult;
+
+/*
+*skipListCreate: Allocates a new empty skip list, its keys are allocated with the given allocator
+*@return
+* 	NULL - if allocations failed.
+* 	A new SkipList in case of success.
+*/
+SkipList skipListCreate(const Allocator* allocator);
+/*
+*skipListDestroy: Deallocates an existing skip list. If skip_list is NULL nothing will be done
+*/
+void skipListDestroy(SkipList skip_list);
+/*
+*skipListPut: maps the given key to the given value
+*@return
+*SKIP_LIST_ITEM_ALREADY_EXISTS if the key is already mapped, the value is not changed
+*SKIP_LIST_OUT_OF_MEMORY if allocation failed
+*SKIP_LIST_SUCCESS otherwise
+*/
+SkipListResult skipListPut(SkipList skip_list, long long key, void* value);
+/*
+*skipListSet: maps the given key to the given value, overriding the value if the key is mapped,
+*which doesn't allocate
+*@return
+*SKIP_LIST_OUT_OF_MEMORY if allocation failed
+*SKIP_LIST_SUCCESS otherwise
+*/
+SkipListResult skipListSet(SkipList skip_list, long long key, void* value);
+/*
+*skipListGet: return the value mapped to the given key or NULL if the key isn't mapped
+*/
+void* skipListGet(SkipList skip_list, long long key);
+/*
+*skipListRemove: removes the given key from the skip list
+*@return
+*SKIP_LIST_ITEM_DOES_NOT_EXIST if the key isn't mapped
+*SKIP_LIST_SUCCESS otherwise
+*/
+SkipListResult skipListRemove(SkipList skip_list, long long key);
+/*
+*skipListClear: removes all the keys from the skip list
+*/
+void skipListClear(SkipList skip_list);
+/*
+*skipListGetSize: return the number of keys in the skip list
+*/
+int skipListGetSize(SkipList skip_list);
+/*
+*skipListFirst: return the position of the lowest key, NULL if the skip list is empty
+*/
+SkipListCursor skipListFirst(SkipList skip_list);
+/*
+*skipListLowerBound: return the position of the lowest key that is not lower than the given key,
+*NULL if there is no such key
+*/
+SkipListCursor skipListLowerBound(SkipList skip_list, long long key);
+/*
+*skipListNext: return the position of the next key in ascending order, NULL after the last key
+*a cursor is valid until its key is removed
+*/
+SkipListCursor skipListNext(SkipListCursor cursor);
+/*
+*skipListCursorKey: return the key at the given position, which isn't NULL
+*/
+long long skipListCursorKey(SkipListCursor cursor);
+/*
+*skipListCursorValue: return the value at the given position, which isn't NULL
+*/
+void* skipListCursorValue(SkipListCursor cursor);
+
+#endif //MTM_SKIPLIST_H
@@ -0,0 +1,219 @@
+#define _POSIX_C_SOURCE 199309L
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define NANOSECONDS_IN_SECOND 1000000000LL
+#define PERCENT 100.0
+#define LAST_BIT 63
+
+/*
+the stats are counted by every thread that calls the library, the readers of an election too, so
+they are changed and read with atomic operations. relaxed ones are enough, each counter stands alone
+*/
+static ElectionStats library_stats;
+
+static const char* const site_names[STATS_ALLOC_SITES] = {
+    "createString", "allocString", "createNewNode", "mapPut"
+};
+static const char* const operation_names[STATS_OPERATIONS] = {
+    "electionAddVote", "electionAddArea", "electionAddTribe", "electionRemoveAreas",
+    "electionComputeAreasToTribesMapping"
+};
+
+void statsCountAlloc(StatsAllocSite site, long long bytes);
+void statsCountFree();
+long long statsNow();
+void statsRecordLatency(StatsOperation operation, long long latency_ns);
+void statsAddLatency(StatsHistogram* histogram, long long latency_ns);
+void statsGet(ElectionStats* stats);
+void statsReset();
+long long statsPercentile(const StatsHistogram* histogram, double percentile);
+void statsPrintJson(const ElectionStats* stats, FILE* stream);
+void statsPrintHistogramJson(const char* name, const StatsHistogram* histogram, FILE* stream);
+static int getBucket(long long value);
+static long long getBucketHighestValue(int bucket);
+static void copyCounters(long long* to, long long* from, int count);
+static void copyHistogram(StatsHistogram* to, StatsHistogram* from);
+
+void statsCountAlloc(StatsAllocSite site, long long bytes)
+{
+    assert(site >= 0 && site < STATS_ALLOC_SITES);
+    __atomic_fetch_add(&library_stats.allocations[site], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&library_stats.allocated_bytes[site], bytes, __ATOMIC_RELAXED);
+}
+
+void statsCountFree()
+{
+    __atomic_fetch_add(&library_stats.frees, 1, __ATOMIC_RELAXED);
+}
+
+long long statsNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * NANOSECONDS_IN_SECOND + now.tv_nsec;
+}
+
+void statsRecordLatency(StatsOperation operation, long long latency_ns)
+{
+    assert(operation >= 0 && operation < STATS_OPERATIONS);
+    statsAddLatency(&library_stats.latency[operation], latency_ns);
+}
+
+void statsAddLatency(StatsHistogram* histogram, long long latency_ns)
+{
+    assert(histogram != NULL);
+    if (latency_ns < 0)
+    {
+        latency_ns = 0;
+    }
+    __atomic_fetch_add(&histogram->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->total_ns, latency_ns, __ATOMIC_RELAXED);
+    long long max_ns = __atomic_load_n(&histogram->max_ns, __ATOMIC_RELAXED);
+    while (latency_ns > max_ns)//a failed exchange loads the max that another thread set
+    {
+        if (__atomic_compare_exchange_n(&histogram->max_ns, &max_ns, latency_ns, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+    __atomic_fetch_add(&histogram->buckets[getBucket(latency_ns)], 1, __ATOMIC_RELAXED);
+}
+
+void statsGet(ElectionStats* stats)
+{
+    assert(stats != NULL);
+    copyCounters(stats->allocations, library_stats.allocations, STATS_ALLOC_SITES);
+    copyCounters(stats->allocated_bytes, library_stats.allocated_bytes, STATS_ALLOC_SITES);
+    copyCounters(&stats->frees, &library_stats.frees, 1);
+    for (int i = 0; i < STATS_OPERATIONS; i++)
+    {
+        copyHistogram(&stats->latency[i], &library_stats.latency[i]);
+    }
+}
+
+void statsReset()
+{
+    ElectionStats zero;
+    memset(&zero, 0, sizeof(zero));
+    for (int i = 0; i < STATS_ALLOC_SITES; i++)
+    {
+        __atomic_store_n(&library_stats.allocations[i], 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&library_stats.allocated_bytes[i], 0, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&library_stats.frees, 0, __ATOMIC_RELAXED);
+    for (int i = 0; i < STATS_OPERATIONS; i++)
+    {
+        copyHistogram(&library_stats.latency[i], &zero.latency[i]);
+    }
+}
+
+long long statsPercentile(const StatsHistogram* histogram, double percentile)
+{
+    assert(histogram != NULL);
+    if (histogram->count == 0)
+    {
+        return 0;
+    }
+    long long rank = (long long)(percentile / PERCENT * histogram->count + 0.5), seen = 0;
+    if (rank < 1)
+    {
+        rank = 1;
+    }
+    for (int i = 0; i < STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        seen += histogram->buckets[i];
+        if (seen >= rank)
+        {
+            long long highest = getBucketHighestValue(i);
+            return highest < histogram->max_ns ? highest : histogram->max_ns;
+        }
+    }
+    return histogram->max_ns;
+}
+
+void statsPrintJson(const ElectionStats* stats, FILE* stream)
+{
+    assert(stats != NULL && stream != NULL);
+    fprintf(stream, "{\"allocations\":{");
+    for (int i = 0; i < STATS_ALLOC_SITES; i++)
+    {
+        fprintf(stream, "%s\"%s\":{\"count\":%lld,\"bytes\":%lld}", i > 0 ? "," : "", site_names[i],
+                stats->allocations[i], stats->allocated_bytes[i]);
+    }
+    fprintf(stream, "},\"frees\":%lld,\"latency_ns\":{", stats->frees);
+    for (int i = 0; i < STATS_OPERATIONS; i++)
+    {
+        fprintf(stream, "%s", i > 0 ? "," : "");
+        statsPrintHistogramJson(operation_names[i], &stats->latency[i], stream);
+    }
+    fprintf(stream, "}}\n");
+}
+
+void statsPrintHistogramJson(const char* name, const StatsHistogram* histogram, FILE* stream)
+{
+    assert(name != NULL && histogram != NULL && stream != NULL);
+    fprintf(stream, "\"%s\":{\"count\":%lld,\"mean\":%lld,\"p50\":%lld,\"p90\":%lld,\"p99\":%lld,"
+            "\"p999\":%lld,\"max\":%lld}", name, histogram->count,
+            histogram->count > 0 ? histogram->total_ns / histogram->count : 0,
+            statsPercentile(histogram, 50), statsPercentile(histogram, 90),
+            statsPercentile(histogram, 99), statsPercentile(histogram, 99.9), histogram->max_ns);
+}
+
+/*
+values lower than STATS_SUB_BUCKETS have a bucket each, a higher value goes to the sub bucket
+of its highest bit that its next STATS_SUB_BUCKET_BITS bits select
+*/
+static int getBucket(long long value)
+{
+    if (value < STATS_SUB_BUCKETS)
+    {
+        return (int)value;
+    }
+    int highest_bit = LAST_BIT - __builtin_clzll((unsigned long long)value);
+    int shift = highest_bit - STATS_SUB_BUCKET_BITS;
+    int sub_bucket = (int)((value >> shift) & (STATS_SUB_BUCKETS - 1));
+    return (shift + 1) * STATS_SUB_BUCKETS + sub_bucket;
+}
+
+/*
+return the highest value that goes to the given bucket
+*/
+static long long getBucketHighestValue(int bucket)
+{
+    if (bucket < STATS_SUB_BUCKETS)
+    {
+        return bucket;
+    }
+    int shift = bucket / STATS_SUB_BUCKETS - 1;
+    long long lowest = (long long)(STATS_SUB_BUCKETS + bucket % STATS_SUB_BUCKETS) << shift;
+    return lowest + (1LL << shift) - 1;
+}
+
+/*
+copies the given number of counters one at a time, the copy of each is a value it had
+*/
+static void copyCounters(long long* to, long long* from, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        __atomic_store_n(&to[i], __atomic_load_n(&from[i], __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    }
+}
+
+/*
+copies the counters of the histogram, see copyCounters
+*/
+static void copyHistogram(StatsHistogram* to, StatsHistogram* from)
+{
+    copyCounters(&to->count, &from->count, 1);
+    copyCounters(&to->total_ns, &from->total_ns, 1);
+    copyCounters(&to->max_ns, &from->max_ns, 1);
+    copyCounters(to->buckets, from->buckets, STATS_HISTOGRAM_BUCKETS);
+}
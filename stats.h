@@ -0,0 +1,113 @@
+#ifndef MTM_STATS_H
+#define MTM_STATS_H
+
+#include <stdio.h>
+/**
+* Stats
+* Allocation counters and latency histograms of the library.
+* The counters are only collected when the library is compiled with ELECTION_STATS defined,
+* otherwise the STATS_ macros expand to nothing and the stats are always zero.
+* The stats are of the whole library, not of one election, and any thread may count them.
+* The latency histograms keep STATS_SUB_BUCKETS buckets for every power of two nanoseconds,
+* so every recorded latency is kept with a relative error of at most 1/STATS_SUB_BUCKETS.
+**/
+
+#define STATS_SUB_BUCKET_BITS 3
+#define STATS_SUB_BUCKETS (1 << STATS_SUB_BUCKET_BITS)
+#define STATS_HISTOGRAM_BUCKETS ((64 - STATS_SUB_BUCKET_BITS + 1) * STATS_SUB_BUCKETS)
+
+/** The places in the library that allocate memory and are counted */
+typedef enum StatsAllocSite_t
+{
+    STATS_SITE_CREATE_STRING,
+    STATS_SITE_ALLOC_STRING,
+    STATS_SITE_CREATE_NEW_NODE,
+    STATS_SITE_MAP_PUT,
+    STATS_ALLOC_SITES
+} StatsAllocSite;
+
+/** The operations of the library that are timed */
+typedef enum StatsOperation_t
+{
+    STATS_ADD_VOTE,
+    STATS_ADD_AREA,
+    STATS_ADD_TRIBE,
+    STATS_REMOVE_AREAS,
+    STATS_COMPUTE_MAPPING,
+    STATS_OPERATIONS
+} StatsOperation;
+
+/** Type for the latencies of one operation */
+typedef struct StatsHistogram_t
+{
+    long long count;
+    long long total_ns;
+    long long max_ns;
+    long long buckets[STATS_HISTOGRAM_BUCKETS];
+} StatsHistogram;
+
+/** Type for all the stats of the library */
+typedef struct ElectionStats_t
+{
+    long long allocations[STATS_ALLOC_SITES];
+    long long allocated_bytes[STATS_ALLOC_SITES];
+    long long frees;
+    StatsHistogram latency[STATS_OPERATIONS];
+} ElectionStats;
+
+#ifdef ELECTION_STATS
+#define STATS_ALLOC(site, bytes) statsCountAlloc((site), (bytes))
+#define STATS_FREE() statsCountFree()
+#define STATS_TIMER_START(timer) long long timer = statsNow()
+#define STATS_TIMER_STOP(operation, timer) statsRecordLatency((operation), statsNow() - (timer))
+#else
+#define STATS_ALLOC(site, bytes) ((void)0)
+#define STATS_FREE() ((void)0)
+#define STATS_TIMER_START(timer)
+#define STATS_TIMER_STOP(operation, timer)
+#endif
+
+/*
+statsCountAlloc: counts one allocation of the given number of bytes at the given site
+*/
+void statsCountAlloc(StatsAllocSite site, long long bytes);
+/*
+statsCountFree: counts one deallocation
+*/
+void statsCountFree();
+/*
+statsNow: return the time in nanoseconds from an arbitrary point, for measuring latencies
+*/
+long long statsNow();
+/*
+statsRecordLatency: adds the given latency to the histogram of the given operation
+*/
+void statsRecordLatency(StatsOperation operation, long long latency_ns);
+/*
+statsAddLatency: adds the given latency to the given histogram, for timing operations outside the library
+*/
+void statsAddLatency(StatsHistogram* histogram, long long latency_ns);
+/*
+statsGet: copies the stats of the library to the given stats
+*/
+void statsGet(ElectionStats* stats);
+/*
+statsReset: sets all the stats of the library to zero
+*/
+void statsReset();
+/*
+statsPercentile: return the latency in nanoseconds that the given percentage (0 to 100)
+of the latencies in the histogram are lower or equal to, 0 if the histogram is empty
+*/
+long long statsPercentile(const StatsHistogram* histogram, double percentile);
+/*
+statsPrintJson: writes the given stats as one JSON object to the given stream
+*/
+void statsPrintJson(const ElectionStats* stats, FILE* stream);
+/*
+statsPrintHistogramJson: writes the count, mean, percentiles and max of the given histogram as the member
+with the given name of a JSON object to the given stream
+*/
+void statsPrintHistogramJson(const char* name, const StatsHistogram* histogram, FILE* stream);
+
+#endif //MTM_STATS_H
@@ -0,0 +1,358 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../allocator.h"
+#include "../pool.h"
+#include "../test_utilities.h"
+#include "testHelpers.h"
+
+#define OOM_TRIBES 3
+#define OOM_AREAS 4
+#define OOM_NEW_ID 10
+#define POOL_OBJECT_SIZE 40
+#define POOL_OBJECTS 1000
+#define POOL_ALIGNMENT 16
+
+/*
+an allocator over malloc that counts the blocks that were allocated and not deallocated yet
+*/
+typedef struct TrackingAllocator_t
+{
+    Allocator allocator;
+    long long live_blocks;
+} TrackingAllocator;
+
+/*
+one call on the election whose allocations the sweep fails one by one
+*/
+typedef ElectionResult (*OomCall)(Election election);
+
+static void* trackingAllocate(void* context, size_t size);
+static void* trackingReallocate(void* context, void* pointer, size_t size);
+static void trackingDeallocate(void* context, void* pointer);
+static void trackingAllocatorInit(TrackingAllocator* tracking);
+static Election createOomElection(const Allocator* allocator);
+static bool sweepCall(OomCall call);
+static ElectionResult addOomTribe(Election election);
+static ElectionResult addOomArea(Election election);
+static ElectionResult addOomVote(Election election);
+static ElectionResult removeOomVote(Election election);
+static ElectionResult removeOomAreas(Election election);
+static ElectionResult removeOomTribe(Election election);
+static ElectionResult computeOomMapping(Election election);
+static bool isOddArea(int area_id);
+
+static void* trackingAllocate(void* context, size_t size)
+{
+    TrackingAllocator* tracking = context;
+    void* block = malloc(size);
+    if (block != NULL)
+    {
+        tracking->live_blocks++;
+    }
+    return block;
+}
+
+static void* trackingReallocate(void* context, void* pointer, size_t size)
+{
+    TrackingAllocator* tracking = context;
+    void* block = realloc(pointer, size);
+    if (block != NULL && pointer == NULL)
+    {
+        tracking->live_blocks++;
+    }
+    return block;
+}
+
+static void trackingDeallocate(void* context, void* pointer)
+{
+    TrackingAllocator* tracking = context;
+    if (pointer != NULL)
+    {
+        tracking->live_blocks--;
+    }
+    free(pointer);
+}
+
+/*
+initializes a tracking allocator with no live blocks, &tracking->allocator is the allocator to pass
+*/
+static void trackingAllocatorInit(TrackingAllocator* tracking)
+{
+    tracking->allocator.allocate = trackingAllocate;
+    tracking->allocator.reallocate = trackingReallocate;
+    tracking->allocator.deallocate = trackingDeallocate;
+    tracking->allocator.context = tracking;
+    tracking->live_blocks = 0;
+}
+
+/*
+return an election of a few tribes and areas with votes for some of the tribes in every area,
+NULL if memory allocation failed
+*/
+static Election createOomElection(const Allocator* allocator)
+{
+    Election election = createTestElection(allocator, OOM_TRIBES, OOM_AREAS, 1);
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    bool created = true;
+    for (int area_id = 1; area_id <= OOM_AREAS; area_id++)
+    {
+        created = created && electionAddVote(election, area_id, area_id % OOM_TRIBES + 1, area_id) ==
+                             ELECTION_SUCCESS;
+    }
+    if (!created)
+    {
+        electionDestroy(election);
+        return NULL;
+    }
+    return election;
+}
+
+/*
+fails the first allocation of the call, then the second and so on until the call allocates less.
+every failed call has to return ELECTION_OUT_OF_MEMORY and leave the election as it was, so calling
+it again gives the election of a call that didn't fail, and destroying the election has to leave
+no block allocated
+*/
+static bool sweepCall(OomCall call)
+{
+    Election expected = createOomElection(NULL);
+    ASSERT_TEST(expected != NULL);
+    ASSERT_TEST(call(expected) == ELECTION_SUCCESS);
+    bool failed = true;
+    for (long long fail_at = 1; failed; fail_at++)
+    {
+        TrackingAllocator tracking;
+        trackingAllocatorInit(&tracking);
+        CountingAllocator counting;
+        countingAllocatorInit(&counting, &tracking.allocator);
+        Election election = createOomElection(&counting.allocator);
+        ASSERT_TEST(election != NULL);
+        countingAllocatorFailAt(&counting, fail_at);
+        ElectionResult result = call(election);
+        failed = counting.failures > 0;
+        countingAllocatorFailAt(&counting, 0);
+        if (failed)
+        {
+            ASSERT_TEST(result == ELECTION_OUT_OF_MEMORY);
+            ASSERT_TEST(call(election) == ELECTION_SUCCESS);
+        }
+        ASSERT_TEST(result == ELECTION_OUT_OF_MEMORY || result == ELECTION_SUCCESS);
+        ASSERT_TEST(sameMap(electionComputeAreasToTribesMapping(election), electionComputeAreasToTribesMapping(expected)));
+        electionDestroy(election);
+        ASSERT_TEST(tracking.live_blocks == 0);
+    }
+    electionDestroy(expected);
+    return true;
+}
+
+static ElectionResult addOomTribe(Election election)
+{
+    return electionAddTribe(election, OOM_NEW_ID, "new tribe");
+}
+
+static ElectionResult addOomArea(Election election)
+{
+    return electionAddArea(election, OOM_NEW_ID, "new area");
+}
+
+/*
+a vote for a tribe that has no votes in the area yet, so its table grows
+*/
+static ElectionResult addOomVote(Election election)
+{
+    return electionAddVote(election, 1, 1, OOM_NEW_ID);
+}
+
+static ElectionResult removeOomVote(Election election)
+{
+    return electionRemoveVote(election, 1, 2, 1);
+}
+
+static ElectionResult removeOomAreas(Election election)
+{
+    return electionRemoveAreas(election, isOddArea);
+}
+
+static ElectionResult removeOomTribe(Election election)
+{
+    return electionRemoveTribe(election, 2);
+}
+
+static ElectionResult computeOomMapping(Election election)
+{
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    if (mapping == NULL)
+    {
+        return ELECTION_OUT_OF_MEMORY;
+    }
+    mapDestroy(mapping);
+    return ELECTION_SUCCESS;
+}
+
+static bool isOddArea(int area_id)
+{
+    return area_id % 2 == 1;
+}
+
+bool testOomCreate()
+{
+    bool failed = true;
+    for (long long fail_at = 1; failed; fail_at++)
+    {
+        TrackingAllocator tracking;
+        trackingAllocatorInit(&tracking);
+        CountingAllocator counting;
+        countingAllocatorInit(&counting, &tracking.allocator);
+        countingAllocatorFailAt(&counting, fail_at);
+        Election election = electionCreateWithAllocator(&counting.allocator);
+        failed = counting.failures > 0;
+        countingAllocatorFailAt(&counting, 0);
+        ASSERT_TEST(failed == (election == NULL));
+        electionDestroy(election);
+        ASSERT_TEST(tracking.live_blocks == 0);
+    }
+    return true;
+}
+
+bool testOomAddTribe()
+{
+    return sweepCall(addOomTribe);
+}
+
+bool testOomAddArea()
+{
+    return sweepCall(addOomArea);
+}
+
+bool testOomAddVote()
+{
+    return sweepCall(addOomVote);
+}
+
+bool testOomRemoveVote()
+{
+    return sweepCall(removeOomVote);
+}
+
+bool testOomRemoveAreas()
+{
+    return sweepCall(removeOomAreas);
+}
+
+bool testOomRemoveTribe()
+{
+    return sweepCall(removeOomTribe);
+}
+
+bool testOomComputeMapping()
+{
+    return sweepCall(computeOomMapping);
+}
+
+bool testPoolReusesObjects()
+{
+    TrackingAllocator tracking;
+    trackingAllocatorInit(&tracking);
+    CountingAllocator counting;
+    countingAllocatorInit(&counting, &tracking.allocator);
+    Pool pool = poolCreate(&counting.allocator, POOL_OBJECT_SIZE);
+    ASSERT_TEST(pool != NULL);
+    static unsigned char* objects[POOL_OBJECTS];
+    for (int i = 0; i < POOL_OBJECTS; i++)
+    {
+        objects[i] = poolAllocate(pool);
+        ASSERT_TEST(objects[i] != NULL && (uintptr_t)objects[i] % POOL_ALIGNMENT == 0);
+        memset(objects[i], i, POOL_OBJECT_SIZE);
+    }
+    for (int i = 0; i < POOL_OBJECTS; i++)
+    {
+        for (int byte = 0; byte < POOL_OBJECT_SIZE; byte++)
+        {
+            ASSERT_TEST(objects[i][byte] == (unsigned char)i);
+        }
+    }
+    long long allocations = counting.allocations;
+    ASSERT_TEST(allocations > 1 && allocations < POOL_OBJECTS / 2);
+    for (int i = 0; i < POOL_OBJECTS; i++)
+    {
+        poolDeallocate(pool, objects[i]);
+    }
+    poolDeallocate(pool, NULL);
+    for (int i = 0; i < POOL_OBJECTS; i++)
+    {
+        ASSERT_TEST(poolAllocate(pool) != NULL);
+    }
+    ASSERT_TEST(counting.allocations == allocations);
+    countingAllocatorFailAt(&counting, 1);
+    bool failed = false;
+    for (int i = 0; i < POOL_OBJECTS && !failed; i++)
+    {
+        failed = poolAllocate(pool) == NULL;
+    }
+    ASSERT_TEST(failed && counting.failures == 1);
+    ASSERT_TEST(poolAllocate(pool) != NULL);
+    poolDestroy(pool);
+    ASSERT_TEST(tracking.live_blocks == 0);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testOomCreate,
+        testOomAddTribe,
+        testOomAddArea,
+        testOomAddVote,
+        testOomRemoveVote,
+        testOomRemoveAreas,
+        testOomRemoveTribe,
+        testOomComputeMapping,
+        testPoolReusesObjects
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testOomCreate",
+        "testOomAddTribe",
+        "testOomAddArea",
+        "testOomAddVote",
+        "testOomRemoveVote",
+        "testOomRemoveAreas",
+        "testOomRemoveTribe",
+        "testOomComputeMapping",
+        "testPoolReusesObjects"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: allocatorTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
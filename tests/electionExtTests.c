@@ -0,0 +1,649 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../mtm_map/map_ext.h"
+#include "../test_utilities.h"
+#include "testHelpers.h"
+
+#define REMOVE_AREAS 1000
+#define NAME_LENGTH 70
+#define DUPLICATE_IDS 1000
+#define ORDER_AREAS 10000
+#define SIZE_HEADER 16
+#define SPARSE_AREAS 1000
+#define SPARSE_TRIBES 1000
+#define BYTES_PER_ENTRY 64
+
+/*
+an allocator that keeps the size of every block in the SIZE_HEADER bytes before it, which keeps the
+alignment of malloc, to count the bytes the election holds
+*/
+typedef struct SizeAllocator_t
+{
+    Allocator allocator;
+    long long live_bytes;
+} SizeAllocator;
+
+static bool isOddOrFirstArea(int area_id);
+static bool isNoArea(int area_id);
+static bool isAnyArea(int area_id);
+static int areaIdAt(int position);
+static bool isThirdArea(int area_id);
+static void* sizeAllocate(void* context, size_t size);
+static void* sizeReallocate(void* context, void* pointer, size_t size);
+static void sizeDeallocate(void* context, void* pointer);
+
+bool testAddAreaClonesTribesWithZeroVotes()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 3, "third") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 10, "old") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 10, 2, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 20, "new") == ELECTION_SUCCESS);
+    for (int tribe_id = 1; tribe_id <= 3; tribe_id++)
+    {
+        ASSERT_TEST(hasVotes(election, 20, tribe_id, 0));
+    }
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){10, 2, 20, 1}, 2));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddVote(election, 20, 3, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 10, 3, 0));
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){10, 2, 20, 3}, 2));
+    mapDestroy(mapping);
+    electionDestroy(election);
+    return true;
+}
+
+bool testAddTribeAfterAreas()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddArea(election, 1, "north") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 2, "south") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 5, "five") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 5, 4) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 4, "four") == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 4, 0));
+    ASSERT_TEST(hasVotes(election, 1, 5, 4));
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 5, 2, 4}, 2));
+    mapDestroy(mapping);
+    electionDestroy(election);
+    return true;
+}
+
+/*
+return true for the areas with odd ids, and for area 0 that is first in the election
+*/
+static bool isOddOrFirstArea(int area_id)
+{
+    return area_id % 2 == 1 || area_id == 0;
+}
+
+static bool isNoArea(int area_id)
+{
+    return false;
+}
+
+static bool isAnyArea(int area_id)
+{
+    return true;
+}
+
+bool testRemoveAreasKeepsTheOthers()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    for (int area_id = 0; area_id < REMOVE_AREAS; area_id++)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, area_id % 3 == 0 ? 2 : 1, area_id + 1) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionRemoveAreas(election, isNoArea) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveAreas(election, isOddOrFirstArea) == ELECTION_SUCCESS);
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapping != NULL && mapGetSize(mapping) == REMOVE_AREAS / 2 - 1);
+    mapDestroy(mapping);
+    for (int area_id = 0; area_id < REMOVE_AREAS; area_id++)
+    {
+        int64_t votes;
+        ElectionResult result = electionGetVotes(election, area_id, area_id % 3 == 0 ? 2 : 1, &votes);
+        if (isOddOrFirstArea(area_id))
+        {
+            ASSERT_TEST(result == ELECTION_AREA_NOT_EXIST);
+        }
+        else
+        {
+            ASSERT_TEST(result == ELECTION_SUCCESS && votes == area_id + 1);
+        }
+    }
+    ASSERT_TEST(electionAddArea(election, 1, "back") == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 1, 0));
+    ASSERT_TEST(electionAddArea(election, 2, "again") == ELECTION_AREA_ALREADY_EXIST);
+    ASSERT_TEST(electionRemoveAreas(election, isAnyArea) == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, NULL, 0));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddArea(election, 0, "first again") == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){0, 1}, 1));
+    mapDestroy(mapping);
+    electionDestroy(election);
+    return true;
+}
+
+bool testRemoveTribesAllOrNothing()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    for (int tribe_id = 1; tribe_id <= 4; tribe_id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionAddArea(election, 1, "area") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 2, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 4, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribes(election, (int[]){2, 7}, 2) == ELECTION_TRIBE_NOT_EXIST);
+    ASSERT_TEST(electionRemoveTribes(election, (int[]){2, -1}, 2) == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionRemoveTribes(NULL, (int[]){2}, 1) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(hasVotes(election, 1, 2, 5));
+    ASSERT_TEST(electionRemoveTribes(election, (int[]){2, 1, 2}, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionGetTribeName(election, 1) == NULL);
+    ASSERT_TEST(electionGetTribeName(election, 2) == NULL);
+    int64_t votes;
+    ASSERT_TEST(electionGetVotes(election, 1, 2, &votes) == ELECTION_TRIBE_NOT_EXIST);
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 4}, 1));
+    mapDestroy(mapping);
+    electionDestroy(election);
+    return true;
+}
+
+bool testSetTribeNamesAllOrNothing()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 1, "area") == ELECTION_SUCCESS);
+    TribeNamePair invalid[] = {{1, "one"}, {2, "Two"}};
+    ASSERT_TEST(electionSetTribeNames(election, invalid, 2) == ELECTION_INVALID_NAME);
+    TribeNamePair missing[] = {{1, "one"}, {3, "three"}};
+    ASSERT_TEST(electionSetTribeNames(election, missing, 2) == ELECTION_TRIBE_NOT_EXIST);
+    TribeNamePair null_name[] = {{1, "one"}, {2, NULL}};
+    ASSERT_TEST(electionSetTribeNames(election, null_name, 2) == ELECTION_NULL_ARGUMENT);
+    char* name = electionGetTribeName(election, 1);
+    ASSERT_TEST(name != NULL && strcmp(name, "first") == 0);
+    free(name);
+    TribeNamePair pairs[] = {{2, "two"}, {1, "one"}, {2, "the second"}};
+    ASSERT_TEST(electionSetTribeNames(election, pairs, 3) == ELECTION_SUCCESS);
+    name = electionGetTribeName(election, 1);
+    ASSERT_TEST(name != NULL && strcmp(name, "one") == 0);
+    free(name);
+    name = electionGetTribeName(election, 2);
+    ASSERT_TEST(name != NULL && strcmp(name, "the second") == 0);
+    free(name);
+    electionDestroy(election);
+    return true;
+}
+
+bool testAreasToTribesArrayMatchesMapping()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    int size = -1;
+    AreaTribePair* pairs = electionComputeAreasToTribesArray(election, &size);
+    ASSERT_TEST(pairs != NULL && size == 0);
+    free(pairs);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    for (int area_id = 30; area_id > 0; area_id -= 3)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, area_id % 2 + 1, area_id) == ELECTION_SUCCESS);
+    }
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    pairs = electionComputeAreasToTribesArray(election, &size);
+    ASSERT_TEST(mapping != NULL && pairs != NULL && size == mapGetSize(mapping) && size == 10);
+    int i = 0;
+    MAP_FOREACH(area_id, mapping)
+    {
+        ASSERT_TEST(pairs[i].area_id == atoi(area_id));
+        ASSERT_TEST(pairs[i].tribe_id == atoi(mapGet(mapping, area_id)));
+        ASSERT_TEST(pairs[i].tribe_id == pairs[i].area_id % 2 + 1);
+        i++;
+    }
+    free(pairs);
+    mapDestroy(mapping);
+    ASSERT_TEST(electionComputeAreasToTribesArray(election, NULL) == NULL);
+    electionDestroy(election);
+    return true;
+}
+
+bool testMappingInRange()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    for (int area_id = 95; area_id >= 0; area_id -= 5)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, 2, area_id % 10 + 1) == ELECTION_SUCCESS);
+    }
+    Map range = electionComputeAreasToTribesMappingInRange(election, 12, 31);
+    ASSERT_TEST(mapIs(range, (int[]){15, 2, 20, 2, 25, 2, 30, 2}, 4));
+    ASSERT_TEST(strcmp(mapGetFirst(range), "15") == 0 && strcmp(mapGetNext(range), "20") == 0);
+    ASSERT_TEST(strcmp(mapLowerBound(range, "21"), "25") == 0);
+    mapDestroy(range);
+    ASSERT_TEST(electionAddArea(election, 17, "new") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveAreas(election, isOddOrFirstArea) == ELECTION_SUCCESS);
+    range = electionComputeAreasToTribesMappingInRange(election, 0, 31);
+    ASSERT_TEST(mapIs(range, (int[]){10, 2, 20, 2, 30, 2}, 3));
+    mapDestroy(range);
+    range = electionComputeAreasToTribesMappingInRange(election, 31, 31);
+    ASSERT_TEST(mapIs(range, NULL, 0));
+    mapDestroy(range);
+    ASSERT_TEST(electionComputeAreasToTribesMappingInRange(NULL, 0, 1) == NULL);
+    electionDestroy(election);
+    return true;
+}
+
+bool testVotesBeyondInt()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionSetOverflowPolicy(NULL, ELECTION_OVERFLOW_SATURATE) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionSetOverflowPolicy(election, ELECTION_OVERFLOW_SATURATE) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    for (int area_id = 1; area_id <= 3; area_id++)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, 1, INT_MAX) == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, 2, INT_MAX) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionAddVote(election, 2, 2, INT_MAX) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 2, 2, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 2, 2, 2 * (int64_t)INT_MAX + 2));
+    ASSERT_TEST(electionRemoveVote(election, 2, 2, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 2, 2, 2 * (int64_t)INT_MAX + 1));
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 1, 2, 2, 3, 1}, 3));
+    mapDestroy(mapping);
+    Map seats = electionComputeSeats(election, ELECTION_DHONDT, 7, 0);
+    ASSERT_TEST(mapIs(seats, (int[]){1, 3, 2, 4}, 2));
+    mapDestroy(seats);
+    electionDestroy(election);
+    return true;
+}
+
+bool testNameValidationAtEveryByte()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    const char invalid[] = {'A', 'Z', '`', '{', '@', '_', '1', '\t', (char)0x80, (char)0xff};
+    char name[NAME_LENGTH + 1];
+    int tribe_id = 0;
+    for (int length = 1; length <= NAME_LENGTH; length++)
+    {
+        for (int i = 0; i < length; i++)
+        {
+            name[i] = i % 5 == 4 ? ' ' : 'a' + i % 26;
+        }
+        name[length] = '\0';
+        for (int position = 0; position < length; position++)
+        {
+            char valid = name[position];
+            for (int i = 0; i < sizeof(invalid); i++)
+            {
+                name[position] = invalid[i];
+                ASSERT_TEST(electionAddTribe(election, tribe_id, name) == ELECTION_INVALID_NAME);
+                ASSERT_TEST(electionAddArea(election, tribe_id, name) == ELECTION_INVALID_NAME);
+            }
+            name[position] = valid;
+        }
+        ASSERT_TEST(electionAddTribe(election, tribe_id, name) == ELECTION_SUCCESS);
+        char* added = electionGetTribeName(election, tribe_id);
+        ASSERT_TEST(added != NULL && strcmp(added, name) == 0);
+        free(added);
+        ASSERT_TEST(electionAddArea(election, tribe_id, name) == ELECTION_SUCCESS);
+        tribe_id++;
+    }
+    ASSERT_TEST(electionAddTribe(election, tribe_id, "") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, tribe_id + 1, "a b z") == ELECTION_SUCCESS);
+    electionDestroy(election);
+    return true;
+}
+
+bool testAddErrorsOrder()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    for (int id = 0; id < DUPLICATE_IDS; id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, id, "tribe") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddArea(election, id, "area") == ELECTION_SUCCESS);
+    }
+    for (int id = 0; id < DUPLICATE_IDS; id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, id, "again") == ELECTION_TRIBE_ALREADY_EXIST);
+        ASSERT_TEST(electionAddArea(election, id, "again") == ELECTION_AREA_ALREADY_EXIST);
+    }
+    ASSERT_TEST(electionAddTribe(election, 7, "Bad") == ELECTION_TRIBE_ALREADY_EXIST);
+    ASSERT_TEST(electionAddArea(election, 7, "Bad") == ELECTION_AREA_ALREADY_EXIST);
+    ASSERT_TEST(electionAddTribe(election, DUPLICATE_IDS, "Bad") == ELECTION_INVALID_NAME);
+    ASSERT_TEST(electionAddArea(election, DUPLICATE_IDS, "Bad") == ELECTION_INVALID_NAME);
+    ASSERT_TEST(electionAddTribe(election, -1, "Bad") == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionAddArea(election, -1, "Bad") == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionAddTribe(election, -1, NULL) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionSetTribeName(election, DUPLICATE_IDS, "Bad") == ELECTION_TRIBE_NOT_EXIST);
+    ASSERT_TEST(electionSetTribeName(election, 7, "Bad") == ELECTION_INVALID_NAME);
+    ASSERT_TEST(electionSetTribeName(election, 7, "good") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetTribeName(election, 7, "good") == ELECTION_TRIBE_NOT_EXIST);
+    ASSERT_TEST(electionAddTribe(election, 7, "Bad") == ELECTION_INVALID_NAME);
+    ASSERT_TEST(electionAddTribe(election, 7, "back") == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, DUPLICATE_IDS - 1, 7, 0));
+    electionDestroy(election);
+    return true;
+}
+
+/*
+return the id of the area added at the given position, all the ids below ORDER_AREAS in a mixed order
+*/
+static int areaIdAt(int position)
+{
+    return (int)((position * 7919LL) % ORDER_AREAS);
+}
+
+static bool isThirdArea(int area_id)
+{
+    return area_id % 3 == 0;
+}
+
+bool testAreaArrayKeepsOrder()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    for (int tribe_id = 1; tribe_id <= 3; tribe_id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS);
+    }
+    for (int i = 0; i < ORDER_AREAS; i++)
+    {
+        int area_id = areaIdAt(i);
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, area_id % 3 + 1, area_id + 1) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionRemoveAreas(election, isThirdArea) == ELECTION_SUCCESS);
+    for (int area_id = 0; area_id < ORDER_AREAS; area_id += 3 * 100)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "back") == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionAddTribe(election, 4, "late") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 2) == ELECTION_SUCCESS);
+    int size = 0;
+    AreaTribePair* pairs = electionComputeAreasToTribesArray(election, &size);
+    ASSERT_TEST(pairs != NULL);
+    int position = 0;
+    for (int i = 0; i < ORDER_AREAS; i++)
+    {
+        int area_id = areaIdAt(i);
+        if (isThirdArea(area_id))
+        {
+            continue;
+        }
+        ASSERT_TEST(position < size && pairs[position].area_id == area_id);
+        ASSERT_TEST(pairs[position].tribe_id == (area_id % 3 == 1 ? 1 : 3));
+        ASSERT_TEST(hasVotes(election, area_id, 4, 0));
+        position++;
+    }
+    for (int area_id = 0; area_id < ORDER_AREAS; area_id += 3 * 100)
+    {
+        ASSERT_TEST(position < size && pairs[position].area_id == area_id && pairs[position].tribe_id == 1);
+        ASSERT_TEST(hasVotes(election, area_id, 3, 0));
+        position++;
+    }
+    ASSERT_TEST(position == size);
+    free(pairs);
+    ASSERT_TEST(electionAddArea(election, 1, "again") == ELECTION_AREA_ALREADY_EXIST);
+    ASSERT_TEST(electionAddVote(election, 3, 1, 1) == ELECTION_AREA_NOT_EXIST);
+    ASSERT_TEST(electionRemoveAreas(election, isAnyArea) == ELECTION_SUCCESS);
+    pairs = electionComputeAreasToTribesArray(election, &size);
+    ASSERT_TEST(pairs != NULL && size == 0);
+    free(pairs);
+    electionDestroy(election);
+    return true;
+}
+
+/*
+allocates the block with its size before it and adds the size to the live bytes
+*/
+static void* sizeAllocate(void* context, size_t size)
+{
+    size_t* block = malloc(SIZE_HEADER + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    *block = size;
+    ((SizeAllocator*)context)->live_bytes += size;
+    return (char*)block + SIZE_HEADER;
+}
+
+/*
+like realloc, changes the live bytes by the change of the size
+*/
+static void* sizeReallocate(void* context, void* pointer, size_t size)
+{
+    if (pointer == NULL)
+    {
+        return sizeAllocate(context, size);
+    }
+    size_t* block = realloc((char*)pointer - SIZE_HEADER, SIZE_HEADER + size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    ((SizeAllocator*)context)->live_bytes += (long long)size - (long long)*block;
+    *block = size;
+    return (char*)block + SIZE_HEADER;
+}
+
+/*
+frees the block and takes its size from the live bytes
+*/
+static void sizeDeallocate(void* context, void* pointer)
+{
+    if (pointer != NULL)
+    {
+        size_t* block = (size_t*)((char*)pointer - SIZE_HEADER);
+        ((SizeAllocator*)context)->live_bytes -= *block;
+        free(block);
+    }
+}
+
+bool testUnvotedAreasGoToLowestTribe()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddArea(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 2, "second") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 5, "five") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 3, "three") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 8, "eight") == ELECTION_SUCCESS);
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 3, 2, 3}, 2));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddVote(election, 2, 8, 4) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 8, 0) && hasVotes(election, 2, 5, 0) && hasVotes(election, 2, 8, 4));
+    int64_t votes = 0;
+    ASSERT_TEST(electionGetVotes(election, 1, 4, &votes) == ELECTION_TRIBE_NOT_EXIST);
+    ASSERT_TEST(electionRemoveTribe(election, 3) == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 5, 2, 8}, 2));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddTribe(election, 0, "zero") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveVote(election, 2, 8, 10) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 3, "third") == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 0, 2, 0, 3, 0}, 3));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddVote(election, 3, 5, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 0) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 5) == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 8, 2, 8, 3, 8}, 3));
+    mapDestroy(mapping);
+    electionDestroy(election);
+    return true;
+}
+
+bool testMemoryFollowsVotedTribes()
+{
+    SizeAllocator sizes = {{sizeAllocate, sizeReallocate, sizeDeallocate, &sizes}, 0};
+    Election election = electionCreateWithAllocator(&sizes.allocator);
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 0, "tribe") == ELECTION_SUCCESS);
+    for (int area_id = 0; area_id < SPARSE_AREAS; area_id++)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+    }
+    long long one_tribe = sizes.live_bytes;
+    for (int tribe_id = 1; tribe_id < SPARSE_TRIBES; tribe_id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS);
+    }
+    long long all_tribes = sizes.live_bytes;
+    ASSERT_TEST(all_tribes - one_tribe < SPARSE_TRIBES * BYTES_PER_ENTRY);
+    for (int area_id = 0; area_id < SPARSE_AREAS; area_id++)
+    {
+        ASSERT_TEST(electionAddVote(election, area_id, area_id % SPARSE_TRIBES, 1) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(sizes.live_bytes - all_tribes < SPARSE_AREAS * BYTES_PER_ENTRY);
+    electionDestroy(election);
+    ASSERT_TEST(sizes.live_bytes == 0);
+    return true;
+}
+
+bool testFrozenAreasKeepTheirResults()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    for (int id = 1; id <= 4; id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, id, "tribe") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddArea(election, id, "area") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionSetAreaRegion(election, id, id % 2) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionAddVote(election, 1, 3, INT_MAX) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 2, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 2, 4, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 2, 1, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 4, 4, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 5) == ELECTION_AREA_NOT_EXIST);
+    ASSERT_TEST(electionFreezeArea(election, -1) == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionFreezeArea(NULL, 1) == ELECTION_NULL_ARGUMENT);
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){1, 3, 2, 1, 3, 1, 4, 4}, 4));
+    mapDestroy(mapping);
+    ASSERT_TEST(hasVotes(election, 1, 3, INT_MAX) && hasVotes(election, 1, 2, 1) && hasVotes(election, 1, 4, 0));
+    Map regions = electionComputeRegionsToTribesMapping(election);
+    ASSERT_TEST(mapIs(regions, (int[]){1, 3, 0, 4}, 2));
+    mapDestroy(regions);
+    ASSERT_TEST(electionAddVote(election, 1, 2, 1) == ELECTION_INVALID_VOTES);
+    ASSERT_TEST(electionRemoveVote(election, 2, 1, 1) == ELECTION_INVALID_VOTES);
+    ASSERT_TEST(electionAddVote(election, 4, 2, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 2, 1) && hasVotes(election, 2, 1, 5));
+    ASSERT_TEST(electionRemoveTribe(election, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 0, "zero") == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 0, 0));
+    ASSERT_TEST(electionRemoveAreas(election, isOddOrFirstArea) == ELECTION_SUCCESS);
+    mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapIs(mapping, (int[]){2, 1, 4, 2}, 2));
+    mapDestroy(mapping);
+    ASSERT_TEST(electionAddArea(election, 1, "again") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 2, 1) == ELECTION_SUCCESS);
+    electionDestroy(election);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testAddAreaClonesTribesWithZeroVotes,
+        testAddTribeAfterAreas,
+        testRemoveAreasKeepsTheOthers,
+        testRemoveTribesAllOrNothing,
+        testSetTribeNamesAllOrNothing,
+        testAreasToTribesArrayMatchesMapping,
+        testMappingInRange,
+        testVotesBeyondInt,
+        testNameValidationAtEveryByte,
+        testAddErrorsOrder,
+        testAreaArrayKeepsOrder,
+        testUnvotedAreasGoToLowestTribe,
+        testMemoryFollowsVotedTribes,
+        testFrozenAreasKeepTheirResults
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testAddAreaClonesTribesWithZeroVotes",
+        "testAddTribeAfterAreas",
+        "testRemoveAreasKeepsTheOthers",
+        "testRemoveTribesAllOrNothing",
+        "testSetTribeNamesAllOrNothing",
+        "testAreasToTribesArrayMatchesMapping",
+        "testMappingInRange",
+        "testVotesBeyondInt",
+        "testNameValidationAtEveryByte",
+        "testAddErrorsOrder",
+        "testAreaArrayKeepsOrder",
+        "testUnvotedAreasGoToLowestTribe",
+        "testMemoryFollowsVotedTribes",
+        "testFrozenAreasKeepTheirResults"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: electionExtTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../test_utilities.h"
+
+#define EXPORT_SIZE 512
+#define VISITED 3
+#define MANY_AREAS 5000
+#define LINE_LENGTH 80
+
+/*
+the results a visitor got, until it got stop_after of them
+*/
+typedef struct Visited_t
+{
+    ElectionAreaResult results[VISITED];
+    char names[VISITED][2][EXPORT_SIZE];
+    int count;
+    int stop_after;
+} Visited;
+
+static Election createExportElection();
+static bool visitResult(const ElectionAreaResult* result, void* context);
+static bool exportIs(Election election, ElectionExportFormat format, const char* expected, size_t size);
+
+/*
+creates an election of two tribes and three areas: tribe 2 wins area 10 with 300 votes, tribe 1 wins
+area 20 with 7 votes and area 5 without votes
+*/
+static Election createExportElection()
+{
+    Election election = electionCreate();
+    if (election == NULL || electionAddTribe(election, 2, "blue") != ELECTION_SUCCESS ||
+        electionAddTribe(election, 1, "red") != ELECTION_SUCCESS ||
+        electionAddArea(election, 10, "north") != ELECTION_SUCCESS ||
+        electionAddArea(election, 20, "south") != ELECTION_SUCCESS ||
+        electionAddArea(election, 5, "mid") != ELECTION_SUCCESS ||
+        electionAddVote(election, 10, 2, 300) != ELECTION_SUCCESS ||
+        electionAddVote(election, 20, 1, 7) != ELECTION_SUCCESS)
+    {
+        electionDestroy(election);
+        return NULL;
+    }
+    return election;
+}
+
+/*
+keeps the result and its names in the Visited context, return false once it has stop_after results
+*/
+static bool visitResult(const ElectionAreaResult* result, void* context)
+{
+    Visited* visited = context;
+    visited->results[visited->count] = *result;
+    strcpy(visited->names[visited->count][0], result->area_name);
+    strcpy(visited->names[visited->count][1], result->tribe_name);
+    visited->count++;
+    return visited->count < visited->stop_after;
+}
+
+/*
+return true if exporting the election in the format writes exactly the given size bytes
+*/
+static bool exportIs(Election election, ElectionExportFormat format, const char* expected, size_t size)
+{
+    FILE* stream = tmpfile();
+    if (stream == NULL)
+    {
+        return false;
+    }
+    char buffer[EXPORT_SIZE];
+    bool same = electionExportResults(election, format, stream) == ELECTION_EXPORT_SUCCESS;
+    rewind(stream);
+    same = same && fread(buffer, 1, sizeof(buffer), stream) == size && memcmp(buffer, expected, size) == 0;
+    fclose(stream);
+    return same;
+}
+
+bool testVisitResultsInArrayOrder()
+{
+    Election election = createExportElection();
+    ASSERT_TEST(election != NULL);
+    Visited visited = {.count = 0, .stop_after = VISITED};
+    ASSERT_TEST(electionVisitResults(election, NULL, &visited) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionVisitResults(NULL, visitResult, &visited) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionVisitResults(election, visitResult, &visited) == ELECTION_SUCCESS);
+    ASSERT_TEST(visited.count == VISITED);
+    const int expected[VISITED][3] = {{10, 2, 300}, {20, 1, 7}, {5, 1, 0}};
+    const char* names[VISITED][2] = {{"north", "blue"}, {"south", "red"}, {"mid", "red"}};
+    for (int i = 0; i < VISITED; i++)
+    {
+        ASSERT_TEST(visited.results[i].area_id == expected[i][0] && visited.results[i].tribe_id == expected[i][1]);
+        ASSERT_TEST(visited.results[i].votes == expected[i][2]);
+        ASSERT_TEST(strcmp(visited.names[i][0], names[i][0]) == 0 && strcmp(visited.names[i][1], names[i][1]) == 0);
+    }
+    visited.count = 0;
+    visited.stop_after = 1;
+    ASSERT_TEST(electionVisitResults(election, visitResult, &visited) == ELECTION_SUCCESS);
+    ASSERT_TEST(visited.count == 1 && visited.results[0].area_id == 10);
+    ASSERT_TEST(electionRemoveTribe(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 2) == ELECTION_SUCCESS);
+    visited.count = 0;
+    ASSERT_TEST(electionVisitResults(election, visitResult, &visited) == ELECTION_SUCCESS);
+    ASSERT_TEST(visited.count == 0);
+    electionDestroy(election);
+    return true;
+}
+
+bool testExportFormats()
+{
+    Election election = createExportElection();
+    ASSERT_TEST(election != NULL);
+    const char csv[] = "area_id,area_name,tribe_id,tribe_name,votes\n"
+                       "10,north,2,blue,300\n"
+                       "20,south,1,red,7\n"
+                       "5,mid,1,red,0\n";
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_CSV, csv, sizeof(csv) - 1));
+    const char json[] = "[\n"
+                        "{\"area_id\":10,\"area_name\":\"north\",\"tribe_id\":2,\"tribe_name\":\"blue\",\"votes\":300},\n"
+                        "{\"area_id\":20,\"area_name\":\"south\",\"tribe_id\":1,\"tribe_name\":\"red\",\"votes\":7},\n"
+                        "{\"area_id\":5,\"area_name\":\"mid\",\"tribe_id\":1,\"tribe_name\":\"red\",\"votes\":0}\n"
+                        "]\n";
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_JSON, json, sizeof(json) - 1));
+    const char binary[] = "ELRESLT\x01"
+                          "\x0a\x05north\x02\x04" "blue\xac\x02"
+                          "\x14\x05south\x01\x03red\x07"
+                          "\x05\x03mid\x01\x03red\x00";
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_BINARY, binary, sizeof(binary) - 1));
+    FILE* stream = tmpfile();
+    ASSERT_TEST(stream != NULL);
+    ASSERT_TEST(electionExportResults(election, (ElectionExportFormat)(ELECTION_EXPORT_BINARY + 1), stream) ==
+                ELECTION_EXPORT_INVALID_FORMAT);
+    ASSERT_TEST(electionExportResults(election, (ElectionExportFormat)-1, stream) == ELECTION_EXPORT_INVALID_FORMAT);
+    ASSERT_TEST(ftell(stream) == 0);
+    fclose(stream);
+    ASSERT_TEST(electionExportResults(election, ELECTION_EXPORT_CSV, NULL) == ELECTION_EXPORT_NULL_ARGUMENT);
+    ASSERT_TEST(electionExportResults(NULL, ELECTION_EXPORT_CSV, stdout) == ELECTION_EXPORT_NULL_ARGUMENT);
+    FILE* read_only = fopen("/dev/null", "r");
+    ASSERT_TEST(read_only != NULL);
+    ASSERT_TEST(electionExportResults(election, ELECTION_EXPORT_CSV, read_only) == ELECTION_EXPORT_WRITE_FAILED);
+    fclose(read_only);
+    ASSERT_TEST(electionRemoveTribe(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_CSV, csv, strlen("area_id,area_name,tribe_id,tribe_name,votes\n")));
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_JSON, "[\n]\n", 4));
+    ASSERT_TEST(exportIs(election, ELECTION_EXPORT_BINARY, binary, 8));
+    electionDestroy(election);
+    return true;
+}
+
+bool testExportBeyondTheBuffer()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 0, "the only tribe") == ELECTION_SUCCESS);
+    for (int area_id = 0; area_id < MANY_AREAS; area_id++)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "an area with a long name") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddVote(election, area_id, 0, area_id + 1) == ELECTION_SUCCESS);
+    }
+    FILE* stream = tmpfile();
+    ASSERT_TEST(stream != NULL);
+    ASSERT_TEST(electionExportResults(election, ELECTION_EXPORT_CSV, stream) == ELECTION_EXPORT_SUCCESS);
+    rewind(stream);
+    char line[LINE_LENGTH];
+    char expected[LINE_LENGTH];
+    ASSERT_TEST(fgets(line, sizeof(line), stream) != NULL);
+    for (int area_id = 0; area_id < MANY_AREAS; area_id++)
+    {
+        sprintf(expected, "%d,an area with a long name,0,the only tribe,%d\n", area_id, area_id + 1);
+        ASSERT_TEST(fgets(line, sizeof(line), stream) != NULL && strcmp(line, expected) == 0);
+    }
+    ASSERT_TEST(fgets(line, sizeof(line), stream) == NULL);
+    fclose(stream);
+    electionDestroy(election);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testVisitResultsInArrayOrder,
+        testExportFormats,
+        testExportBeyondTheBuffer
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testVisitResultsInArrayOrder",
+        "testExportFormats",
+        "testExportBeyondTheBuffer"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: exportTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../ingest.h"
+#include "../votebuffer.h"
+#include "../test_utilities.h"
+#include "testHelpers.h"
+
+#define PRODUCERS 4
+#define PUSHES 5000
+#define AREAS 8
+#define TRIBES 4
+#define CAPACITY 64
+#define SMALL_CAPACITY 4
+#define BUFFER_THRESHOLD 16
+
+/*
+a thread that pushes votes to the queue, every push adds one vote to an area and a tribe by its number
+*/
+typedef struct Producer_t
+{
+    Ingest ingest;
+    int number;
+    bool pushed;
+} Producer;
+
+static void* produceVotes(void* argument);
+
+/*
+pushes PUSHES votes, push i to area i % AREAS and tribe the number of the producer, and pushes again
+while the queue is full
+*/
+static void* produceVotes(void* argument)
+{
+    Producer* producer = argument;
+    producer->pushed = true;
+    for (int i = 0; i < PUSHES && producer->pushed; i++)
+    {
+        IngestResult result;
+        do
+        {
+            result = ingestAddVote(producer->ingest, i % AREAS, producer->number, 1);
+        } while (result == INGEST_QUEUE_FULL);
+        producer->pushed = result == INGEST_SUCCESS;
+    }
+    return NULL;
+}
+
+bool testIngestFromManyProducers()
+{
+    Election election = createTestElection(NULL, TRIBES, AREAS, 0);
+    ASSERT_TEST(election != NULL);
+    Ingest ingest = ingestCreate(election, CAPACITY, NULL);
+    ASSERT_TEST(ingest != NULL);
+    Producer producers[PRODUCERS];
+    pthread_t threads[PRODUCERS];
+    for (int i = 0; i < PRODUCERS; i++)
+    {
+        producers[i].ingest = ingest;
+        producers[i].number = i;
+        ASSERT_TEST(pthread_create(&threads[i], NULL, produceVotes, &producers[i]) == 0);
+    }
+    for (int i = 0; i < PRODUCERS; i++)
+    {
+        pthread_join(threads[i], NULL);
+        ASSERT_TEST(producers[i].pushed);
+    }
+    int rejected = -1;
+    ASSERT_TEST(ingestFlush(ingest, &rejected) == INGEST_SUCCESS && rejected == 0);
+    ingestLockElection(ingest);
+    for (int area_id = 0; area_id < AREAS; area_id++)
+    {
+        for (int tribe_id = 0; tribe_id < TRIBES; tribe_id++)
+        {
+            ASSERT_TEST(hasVotes(election, area_id, tribe_id, tribe_id < PRODUCERS ? PUSHES / AREAS : 0));
+        }
+    }
+    ingestUnlockElection(ingest);
+    ingestDestroy(ingest);
+    electionDestroy(election);
+    return true;
+}
+
+bool testIngestKeepsVotesAboveZero()
+{
+    Election election = createTestElection(NULL, TRIBES, AREAS, 0);
+    ASSERT_TEST(election != NULL);
+    Ingest ingest = ingestCreate(election, CAPACITY, NULL);
+    ASSERT_TEST(ingest != NULL);
+    ASSERT_TEST(ingestAddVote(ingest, 1, 1, 5) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestRemoveVote(ingest, 1, 1, 10) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestAddVote(ingest, 1, 1, 3) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestAddVote(ingest, 2, 2, 4) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestRemoveVote(ingest, 2, 2, 1) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestAddVote(ingest, AREAS, 1, 1) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestAddVote(ingest, 1, TRIBES, 1) == INGEST_SUCCESS);
+    int rejected = -1;
+    ASSERT_TEST(ingestFlush(ingest, &rejected) == INGEST_SUCCESS && rejected == 2);
+    ASSERT_TEST(ingestFlush(ingest, &rejected) == INGEST_SUCCESS && rejected == 0);
+    ingestLockElection(ingest);
+    ASSERT_TEST(hasVotes(election, 1, 1, 3));
+    ASSERT_TEST(hasVotes(election, 2, 2, 3));
+    ingestUnlockElection(ingest);
+    ASSERT_TEST(ingestAddVote(ingest, -1, 1, 1) == INGEST_INVALID_ID);
+    ASSERT_TEST(ingestRemoveVote(ingest, 1, -1, 1) == INGEST_INVALID_ID);
+    ASSERT_TEST(ingestAddVote(ingest, 1, 1, 0) == INGEST_INVALID_VOTES);
+    ASSERT_TEST(ingestAddVote(NULL, 1, 1, 1) == INGEST_NULL_ARGUMENT);
+    ASSERT_TEST(ingestFlush(NULL, NULL) == INGEST_NULL_ARGUMENT);
+    ingestDestroy(ingest);
+    electionDestroy(election);
+    return true;
+}
+
+bool testIngestQueueFull()
+{
+    Election election = createTestElection(NULL, TRIBES, AREAS, 0);
+    ASSERT_TEST(election != NULL);
+    Ingest ingest = ingestCreate(election, SMALL_CAPACITY, NULL);
+    ASSERT_TEST(ingest != NULL);
+    ingestLockElection(ingest);
+    int pushed = 0;
+    while (ingestAddVote(ingest, 0, 0, 1) == INGEST_SUCCESS)
+    {
+        pushed++;
+        ASSERT_TEST(pushed <= CAPACITY);
+    }
+    ASSERT_TEST(pushed >= SMALL_CAPACITY);
+    ASSERT_TEST(ingestAddVote(ingest, 0, 0, 1) == INGEST_QUEUE_FULL);
+    ingestUnlockElection(ingest);
+    ASSERT_TEST(ingestFlush(ingest, NULL) == INGEST_SUCCESS);
+    ASSERT_TEST(ingestAddVote(ingest, 0, 0, 1) == INGEST_SUCCESS);
+    ingestDestroy(ingest);
+    ASSERT_TEST(hasVotes(election, 0, 0, pushed + 1));
+    ASSERT_TEST(ingestCreate(election, 0, NULL) == NULL);
+    ASSERT_TEST(ingestCreate(NULL, CAPACITY, NULL) == NULL);
+    electionDestroy(election);
+    return true;
+}
+
+bool testVoteBufferMergesLikeSingleVotes()
+{
+    Election election = createTestElection(NULL, TRIBES, AREAS, 0);
+    ASSERT_TEST(election != NULL);
+    VoteBuffer buffer = voteBufferCreate(election, BUFFER_THRESHOLD, NULL);
+    ASSERT_TEST(buffer != NULL);
+    ASSERT_TEST(voteBufferAddVote(buffer, 1, 1, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 1, 1, 10) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 1, 1, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(hasVotes(election, 1, 1, 0));
+    int rejected = -1;
+    ASSERT_TEST(voteBufferFlush(buffer, &rejected) == ELECTION_SUCCESS && rejected == 0);
+    ASSERT_TEST(hasVotes(election, 1, 1, 3));
+    ASSERT_TEST(electionAddVote(election, 2, 2, 10) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 2, 2, 30) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 2, 2, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferFlush(buffer, &rejected) == ELECTION_SUCCESS && rejected == 0);
+    ASSERT_TEST(hasVotes(election, 2, 2, 7));
+    for (int pair = 0; pair < BUFFER_THRESHOLD; pair++)
+    {
+        ASSERT_TEST(voteBufferAddVote(buffer, pair % AREAS, pair / AREAS, 1) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(hasVotes(election, 0, 0, 1));
+    ASSERT_TEST(voteBufferAddVote(buffer, 3, 3, 4) == ELECTION_SUCCESS);
+    voteBufferDestroy(buffer);
+    ASSERT_TEST(hasVotes(election, 3, 3, 4));
+    electionDestroy(election);
+    return true;
+}
+
+bool testVoteBufferRejectsWholeUpdates()
+{
+    Election election = createTestElection(NULL, TRIBES, AREAS, 0);
+    ASSERT_TEST(election != NULL);
+    VoteBuffer buffer = voteBufferCreate(election, BUFFER_THRESHOLD, NULL);
+    ASSERT_TEST(buffer != NULL);
+    ASSERT_TEST(voteBufferAddVote(buffer, AREAS, 1, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, AREAS, 1, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 1, TRIBES, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 1, TRIBES, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 1, 1, 4) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 1, 1, 4) == ELECTION_SUCCESS);
+    int rejected = -1;
+    ASSERT_TEST(voteBufferFlush(buffer, &rejected) == ELECTION_SUCCESS && rejected == 2);
+    ASSERT_TEST(hasVotes(election, 1, 1, 0));
+    ASSERT_TEST(electionAddVote(election, 1, 1, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionFreezeArea(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 1, 1, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 1, 1, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferAddVote(buffer, 2, 1, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(voteBufferFlush(buffer, &rejected) == ELECTION_SUCCESS && rejected == 1);
+    ASSERT_TEST(hasVotes(election, 1, 1, 7));
+    ASSERT_TEST(hasVotes(election, 2, 1, 1));
+    ASSERT_TEST(voteBufferAddVote(buffer, -1, 1, 1) == ELECTION_INVALID_ID);
+    ASSERT_TEST(voteBufferRemoveVote(buffer, 1, 1, -1) == ELECTION_INVALID_VOTES);
+    ASSERT_TEST(voteBufferAddVote(NULL, 1, 1, 1) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(voteBufferFlush(NULL, NULL) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(voteBufferCreate(election, 0, NULL) == NULL);
+    voteBufferDestroy(buffer);
+    electionDestroy(election);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testIngestFromManyProducers,
+        testIngestKeepsVotesAboveZero,
+        testIngestQueueFull,
+        testVoteBufferMergesLikeSingleVotes,
+        testVoteBufferRejectsWholeUpdates
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testIngestFromManyProducers",
+        "testIngestKeepsVotesAboveZero",
+        "testIngestQueueFull",
+        "testVoteBufferMergesLikeSingleVotes",
+        "testVoteBufferRejectsWholeUpdates"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: ingestTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
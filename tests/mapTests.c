@@ -0,0 +1,227 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../mtm_map/map.h"
+#include "../mtm_map/map_ext.h"
+#include "../test_utilities.h"
+
+#define ID_LENGTH 12
+#define CAPACITY 4
+#define APPENDED 10
+#define INLINE_LENGTH 23
+#define LONG_STRING 64
+#define RANGE_KEYS 100
+
+static bool keysAre(Map map, const char* const* keys, int count);
+static void fillString(char* string, int length, char letter);
+
+/*
+return true if iterating the map gives exactly the given keys in the given order
+*/
+static bool keysAre(Map map, const char* const* keys, int count)
+{
+    int i = 0;
+    MAP_FOREACH(key, map)
+    {
+        if (i == count || strcmp(key, keys[i]) != 0)
+        {
+            return false;
+        }
+        i++;
+    }
+    return i == count && mapGetSize(map) == count;
+}
+
+bool testAppendKeepsOrder()
+{
+    Map map = mapCreateWithCapacity(NULL, CAPACITY);
+    ASSERT_TEST(map != NULL);
+    const char* keys[APPENDED];
+    char names[APPENDED][ID_LENGTH];
+    for (int i = 0; i < APPENDED; i++)
+    {
+        sprintf(names[i], "%d", APPENDED - i);
+        keys[i] = names[i];
+        ASSERT_TEST(mapAppend(map, keys[i], keys[i]) == MAP_SUCCESS);
+    }
+    ASSERT_TEST(keysAre(map, keys, APPENDED));
+    ASSERT_TEST(mapPut(map, "3", "three") == MAP_SUCCESS);
+    ASSERT_TEST(strcmp(mapGet(map, "3"), "three") == 0);
+    ASSERT_TEST(mapRemove(map, "9") == MAP_SUCCESS);
+    ASSERT_TEST(mapAppend(map, "9", "nine") == MAP_SUCCESS);
+    const char* moved[APPENDED] = {"10", "8", "7", "6", "5", "4", "3", "2", "1", "9"};
+    ASSERT_TEST(keysAre(map, moved, APPENDED));
+    Map copy = mapCopy(map);
+    ASSERT_TEST(copy != NULL && keysAre(copy, moved, APPENDED));
+    ASSERT_TEST(strcmp(mapGet(copy, "9"), "nine") == 0);
+    mapDestroy(copy);
+    ASSERT_TEST(mapAppend(map, NULL, "none") == MAP_NULL_ARGUMENT);
+    ASSERT_TEST(mapClear(map) == MAP_SUCCESS);
+    ASSERT_TEST(mapAppend(map, "1", "one") == MAP_SUCCESS);
+    ASSERT_TEST(keysAre(map, (const char*[]){"1"}, 1));
+    mapDestroy(map);
+    return true;
+}
+
+bool testCreateWithoutCapacity()
+{
+    Map map = mapCreateWithCapacity(NULL, 0);
+    ASSERT_TEST(map != NULL);
+    ASSERT_TEST(mapAppend(map, "2", "two") == MAP_SUCCESS);
+    ASSERT_TEST(mapPut(map, "1", "one") == MAP_SUCCESS);
+    ASSERT_TEST(keysAre(map, (const char*[]){"2", "1"}, 2));
+    mapDestroy(map);
+    return true;
+}
+
+/*
+sets string to length copies of the given letter
+*/
+static void fillString(char* string, int length, char letter)
+{
+    memset(string, letter, length);
+    string[length] = '\0';
+}
+
+bool testStringsAroundInlineLength()
+{
+    Map map = mapCreate();
+    ASSERT_TEST(map != NULL);
+    char key[LONG_STRING + 1];
+    char data[LONG_STRING + 1];
+    for (int length = 0; length <= LONG_STRING; length++)
+    {
+        fillString(key, length, 'k');
+        fillString(data, LONG_STRING - length, 'd');
+        ASSERT_TEST(mapPut(map, key, data) == MAP_SUCCESS);
+    }
+    ASSERT_TEST(mapGetSize(map) == LONG_STRING + 1);
+    for (int length = LONG_STRING; length >= 0; length--)
+    {
+        fillString(key, length, 'k');
+        fillString(data, LONG_STRING - length, 'd');
+        ASSERT_TEST(mapContains(map, key));
+        ASSERT_TEST(strcmp(mapGet(map, key), data) == 0);
+    }
+    fillString(key, INLINE_LENGTH, 'k');
+    fillString(data, LONG_STRING, 'x');
+    ASSERT_TEST(mapPut(map, key, data) == MAP_SUCCESS);
+    ASSERT_TEST(strcmp(mapGet(map, key), data) == 0);
+    ASSERT_TEST(mapPut(map, key, "short") == MAP_SUCCESS);
+    ASSERT_TEST(strcmp(mapGet(map, key), "short") == 0);
+    Map copy = mapCopy(map);
+    ASSERT_TEST(copy != NULL && mapGetSize(copy) == LONG_STRING + 1);
+    fillString(key, INLINE_LENGTH + 1, 'k');
+    fillString(data, LONG_STRING - INLINE_LENGTH - 1, 'd');
+    ASSERT_TEST(strcmp(mapGet(copy, key), data) == 0);
+    ASSERT_TEST(mapRemove(map, key) == MAP_SUCCESS);
+    ASSERT_TEST(!mapContains(map, key) && mapContains(copy, key));
+    fillString(key, INLINE_LENGTH + 2, 'k');
+    ASSERT_TEST(mapContains(map, key));
+    key[INLINE_LENGTH + 1] = 'j';
+    ASSERT_TEST(!mapContains(map, key) && mapGet(map, key) == NULL);
+    mapDestroy(copy);
+    mapDestroy(map);
+    return true;
+}
+
+bool testOrderedMapIteratesByNumber()
+{
+    Map map = mapCreateOrdered(NULL);
+    ASSERT_TEST(map != NULL);
+    const char* keys[] = {"30", "4", "100", "0", "9", "55"};
+    for (int i = 0; i < sizeof(keys) / sizeof(keys[0]); i++)
+    {
+        ASSERT_TEST(mapPut(map, keys[i], keys[i]) == MAP_SUCCESS);
+    }
+    ASSERT_TEST(mapAppend(map, "7", "seven") == MAP_SUCCESS);
+    ASSERT_TEST(mapPut(map, "abc", "letters") == MAP_ERROR);
+    ASSERT_TEST(mapPut(map, "07", "leading zero") == MAP_ERROR);
+    ASSERT_TEST(keysAre(map, (const char*[]){"0", "4", "7", "9", "30", "55", "100"}, 7));
+    ASSERT_TEST(mapRemove(map, "9") == MAP_SUCCESS);
+    ASSERT_TEST(mapPut(map, "4", "four") == MAP_SUCCESS);
+    ASSERT_TEST(strcmp(mapGet(map, "4"), "four") == 0);
+    Map copy = mapCopy(map);
+    ASSERT_TEST(copy != NULL && keysAre(copy, (const char*[]){"0", "4", "7", "30", "55", "100"}, 6));
+    ASSERT_TEST(strcmp(mapLowerBound(copy, "31"), "55") == 0);
+    mapDestroy(copy);
+    mapDestroy(map);
+    return true;
+}
+
+bool testLowerBoundRange()
+{
+    Map map = mapCreateOrdered(NULL);
+    ASSERT_TEST(map != NULL);
+    ASSERT_TEST(mapLowerBound(map, "1") == NULL);
+    char key[ID_LENGTH];
+    for (int id = 0; id < RANGE_KEYS; id += 5)
+    {
+        sprintf(key, "%d", id);
+        ASSERT_TEST(mapPut(map, key, key) == MAP_SUCCESS);
+    }
+    ASSERT_TEST(strcmp(mapLowerBound(map, "0"), "0") == 0);
+    ASSERT_TEST(strcmp(mapLowerBound(map, "11"), "15") == 0);
+    ASSERT_TEST(strcmp(mapLowerBound(map, "15"), "15") == 0);
+    ASSERT_TEST(mapLowerBound(map, "1000") == NULL);
+    ASSERT_TEST(mapLowerBound(map, "x") == NULL);
+    int count = 0;
+    for (char* id = mapLowerBound(map, "12"); id != NULL && atoi(id) < 43; id = mapGetNext(map))
+    {
+        ASSERT_TEST(atoi(id) == 15 + 5 * count);
+        count++;
+    }
+    ASSERT_TEST(count == 6);
+    Map unordered = mapCreate();
+    ASSERT_TEST(unordered != NULL && mapPut(unordered, "1", "1") == MAP_SUCCESS);
+    ASSERT_TEST(mapLowerBound(unordered, "0") == NULL);
+    mapDestroy(unordered);
+    mapDestroy(map);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testAppendKeepsOrder,
+        testCreateWithoutCapacity,
+        testStringsAroundInlineLength,
+        testOrderedMapIteratesByNumber,
+        testLowerBoundRange
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testAppendKeepsOrder",
+        "testCreateWithoutCapacity",
+        "testStringsAroundInlineLength",
+        "testOrderedMapIteratesByNumber",
+        "testLowerBoundRange"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: mapTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
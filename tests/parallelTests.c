@@ -0,0 +1,429 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../scheduler.h"
+#include "../shard.h"
+#include "../test_utilities.h"
+#include "testHelpers.h"
+
+#define PARALLEL_AREAS 3000
+#define PARALLEL_TRIBES 40
+#define PARALLEL_VOTES 20000
+#define REGIONS 7
+#define SEATS 25
+#define THRESHOLD 0.02
+#define SHARDS 3
+#define THREADS 4
+#define SCHEDULED_ITERATIONS 10000
+#define STABLE_AREAS 500
+#define CHURNED_AREAS 100
+#define WRITER_ROUNDS 200
+#define ID_LENGTH 12
+#define LARGE_BLOCK (3 << 20)
+
+/*
+a thread that reads an election with its reader while the test changes it
+*/
+typedef struct ReaderThread_t
+{
+    ElectionReader reader;
+    int stop;
+    int reads;
+    bool valid;
+} ReaderThread;
+
+static bool sameResults(Election election, Election expected);
+static bool sameSeats(Election election, Election expected, int region_id, ElectionSeatMethod method);
+static bool runOperations(Election election);
+static bool isRemovedArea(int area_id);
+static void countIterations(int begin, int end, void* argument);
+static void* readElection(void* argument);
+static bool isChurnedArea(int area_id);
+
+/*
+return true if the seats of the elections, of all their areas or of the given region, are the same
+*/
+static bool sameSeats(Election election, Election expected, int region_id, ElectionSeatMethod method)
+{
+    if (region_id == ELECTION_NO_REGION)
+    {
+        return sameMap(electionComputeSeats(election, method, SEATS, THRESHOLD),
+                       electionComputeSeats(expected, method, SEATS, THRESHOLD));
+    }
+    return sameMap(electionComputeRegionSeats(election, region_id, method, SEATS, THRESHOLD),
+                   electionComputeRegionSeats(expected, region_id, method, SEATS, THRESHOLD));
+}
+
+/*
+return true if the elections have the same winners of the areas and the regions, the same seats
+and the same votes of every tribe in every area
+*/
+static bool sameResults(Election election, Election expected)
+{
+    if (!sameMap(electionComputeAreasToTribesMapping(election), electionComputeAreasToTribesMapping(expected)) ||
+        !sameMap(electionComputeAreasToTribesMappingInRange(election, PARALLEL_AREAS / 3, PARALLEL_AREAS / 2),
+                 electionComputeAreasToTribesMappingInRange(expected, PARALLEL_AREAS / 3, PARALLEL_AREAS / 2)) ||
+        !sameMap(electionComputeRegionsToTribesMapping(election), electionComputeRegionsToTribesMapping(expected)))
+    {
+        return false;
+    }
+    ElectionSeatMethod methods[] = {ELECTION_DHONDT, ELECTION_SAINTE_LAGUE, ELECTION_LARGEST_REMAINDER};
+    for (int i = 0; i < sizeof(methods) / sizeof(methods[0]); i++)
+    {
+        for (int region_id = ELECTION_NO_REGION; region_id < REGIONS; region_id++)
+        {
+            if (!sameSeats(election, expected, region_id, methods[i]))
+            {
+                return false;
+            }
+        }
+    }
+    for (int area_id = 0; area_id < PARALLEL_AREAS; area_id += PARALLEL_AREAS / 100)
+    {
+        for (int tribe_id = 0; tribe_id < PARALLEL_TRIBES; tribe_id++)
+        {
+            int64_t votes = -1;
+            int64_t expected_votes = -1;
+            if (electionGetVotes(election, area_id, tribe_id, &votes) !=
+                electionGetVotes(expected, area_id, tribe_id, &expected_votes) || votes != expected_votes)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool isRemovedArea(int area_id)
+{
+    return area_id % 5 == 2;
+}
+
+/*
+adds the tribes and the areas, votes with a fixed pseudo random sequence, puts the areas in regions,
+freezes, removes areas and tribes and adds some back. return false if a call didn't give the result it
+gives in an election without shards and threads
+*/
+static bool runOperations(Election election)
+{
+    unsigned int random = 1;
+    for (int tribe_id = PARALLEL_TRIBES - 1; tribe_id >= 0; tribe_id--)
+    {
+        if (electionAddTribe(election, tribe_id, "tribe") != ELECTION_SUCCESS)
+        {
+            return false;
+        }
+    }
+    for (int area_id = 0; area_id < PARALLEL_AREAS; area_id++)
+    {
+        if (electionAddArea(election, area_id, "area") != ELECTION_SUCCESS ||
+            electionSetAreaRegion(election, area_id, area_id % (REGIONS + 1) - 1) != ELECTION_SUCCESS)
+        {
+            return false;
+        }
+    }
+    for (int i = 0; i < PARALLEL_VOTES; i++)
+    {
+        random = random * 1103515245 + 12345;
+        int area_id = (random >> 8) % PARALLEL_AREAS;
+        int tribe_id = (random >> 4) % PARALLEL_TRIBES;
+        ElectionResult result = i % 4 == 3 ? electionRemoveVote(election, area_id, tribe_id, random % 50 + 1) :
+                                electionAddVote(election, area_id, tribe_id, random % 100 + 1);
+        if (result != ELECTION_SUCCESS)
+        {
+            return false;
+        }
+    }
+    for (int area_id = 0; area_id < PARALLEL_AREAS; area_id += 11)
+    {
+        if (electionFreezeArea(election, area_id) != ELECTION_SUCCESS)
+        {
+            return false;
+        }
+    }
+    if (electionRemoveAreas(election, isRemovedArea) != ELECTION_SUCCESS ||
+        electionRemoveTribe(election, 0) != ELECTION_SUCCESS || electionRemoveTribe(election, 17) != ELECTION_SUCCESS ||
+        electionAddArea(election, 2, "back") != ELECTION_SUCCESS || electionAddVote(election, 2, 5, 1) != ELECTION_SUCCESS ||
+        electionAddTribe(election, 17, "back") != ELECTION_SUCCESS || electionAddVote(election, 1, 17, 1) != ELECTION_SUCCESS ||
+        electionSetAreaRegion(election, 1, ELECTION_NO_REGION) != ELECTION_SUCCESS)
+    {
+        return false;
+    }
+    return electionAddVote(election, 0, 1, 1) == ELECTION_INVALID_VOTES &&
+           electionAddVote(election, 7, 1, 1) == ELECTION_AREA_NOT_EXIST;
+}
+
+bool testShardedElectionGivesSameResults()
+{
+    ASSERT_TEST(electionCreateSharded(0, NULL) == NULL);
+    Election expected = electionCreate();
+    ASSERT_TEST(expected != NULL && runOperations(expected));
+    for (int shards = 1; shards <= SHARDS; shards++)
+    {
+        Election election = electionCreateSharded(shards, NULL);
+        ASSERT_TEST(election != NULL && runOperations(election));
+        ASSERT_TEST(sameResults(election, expected));
+        int size = 0, expected_size = 0;
+        AreaTribePair* pairs = electionComputeAreasToTribesArray(election, &size);
+        AreaTribePair* expected_pairs = electionComputeAreasToTribesArray(expected, &expected_size);
+        ASSERT_TEST(pairs != NULL && expected_pairs != NULL && size == expected_size);
+        for (int i = 1; i < size; i++)
+        {
+            ASSERT_TEST(pairs[i].area_id % shards >= pairs[i - 1].area_id % shards);
+        }
+        free(pairs);
+        free(expected_pairs);
+        electionDestroy(election);
+    }
+    electionDestroy(expected);
+    return true;
+}
+
+/*
+adds one to the count of every iteration of the range, the counts are shared by the threads
+*/
+static void countIterations(int begin, int end, void* argument)
+{
+    int* counts = argument;
+    for (int i = begin; i < end; i++)
+    {
+        __atomic_fetch_add(&counts[i], 1, __ATOMIC_RELAXED);
+    }
+}
+
+bool testSchedulerRunsEveryIterationOnce()
+{
+    static int counts[SCHEDULED_ITERATIONS];
+    Scheduler scheduler = schedulerCreate(THREADS, allocatorDefault());
+    ASSERT_TEST(scheduler != NULL);
+    for (int size = 0; size <= SCHEDULED_ITERATIONS; size += SCHEDULED_ITERATIONS / 8 + 1)
+    {
+        for (int grain = 1; grain <= SCHEDULED_ITERATIONS; grain *= 16)
+        {
+            memset(counts, 0, sizeof(counts));
+            schedulerFor(scheduler, size, grain, countIterations, counts);
+            for (int i = 0; i < SCHEDULED_ITERATIONS; i++)
+            {
+                ASSERT_TEST(counts[i] == (i < size ? 1 : 0));
+            }
+        }
+    }
+    memset(counts, 0, sizeof(counts));
+    schedulerFor(NULL, SCHEDULED_ITERATIONS, 1, countIterations, counts);
+    ASSERT_TEST(counts[0] == 1 && counts[SCHEDULED_ITERATIONS - 1] == 1);
+    schedulerDestroy(scheduler);
+    schedulerDestroy(NULL);
+    return true;
+}
+
+bool testThreadsGiveSameResults()
+{
+    Election expected = electionCreate();
+    ASSERT_TEST(expected != NULL && runOperations(expected));
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionSetThreads(election, THREADS) == ELECTION_SUCCESS);
+    ASSERT_TEST(runOperations(election) && sameResults(election, expected));
+    ASSERT_TEST(electionSetThreads(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(sameResults(election, expected));
+    electionDestroy(election);
+    election = electionCreateSharded(SHARDS, NULL);
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionSetThreads(election, THREADS) == ELECTION_SUCCESS);
+    ASSERT_TEST(runOperations(election) && sameResults(election, expected));
+    electionDestroy(election);
+    electionDestroy(expected);
+    return true;
+}
+
+/*
+reads the election with the reader until told to stop, and checks that every mapping has the stable
+areas with their tribes and that the name of tribe 1 is one of its names
+*/
+static void* readElection(void* argument)
+{
+    ReaderThread* thread = argument;
+    while (!__atomic_load_n(&thread->stop, __ATOMIC_ACQUIRE))
+    {
+        Map mapping = electionReaderComputeAreasToTribesMapping(thread->reader);
+        char* name = electionReaderGetTribeName(thread->reader, 1);
+        bool valid = mapping != NULL && name != NULL && (strcmp(name, "alpha") == 0 || strcmp(name, "beta") == 0);
+        for (int area_id = 0; valid && area_id < STABLE_AREAS; area_id++)
+        {
+            char key[ID_LENGTH];
+            sprintf(key, "%d", area_id);
+            char* tribe_id = mapGet(mapping, key);
+            valid = tribe_id != NULL && atoi(tribe_id) == area_id % PARALLEL_TRIBES;
+        }
+        MAP_FOREACH(key, mapping)
+        {
+            valid = valid && atoi(key) < STABLE_AREAS + CHURNED_AREAS && atoi(mapGet(mapping, key)) < PARALLEL_TRIBES;
+        }
+        thread->valid = thread->valid && valid;
+        free(name);
+        mapDestroy(mapping);
+        __atomic_fetch_add(&thread->reads, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static bool isChurnedArea(int area_id)
+{
+    return area_id >= STABLE_AREAS;
+}
+
+bool testReaderSeesTheElection()
+{
+    ASSERT_TEST(electionReaderCreate(NULL) == NULL);
+    ASSERT_TEST(electionReaderComputeAreasToTribesMapping(NULL) == NULL);
+    ASSERT_TEST(electionReaderGetTribeName(NULL, 1) == NULL);
+    electionReaderDestroy(NULL);
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL && runOperations(election));
+    ElectionReader reader = electionReaderCreate(election);
+    ASSERT_TEST(reader != NULL);
+    ASSERT_TEST(sameMap(electionReaderComputeAreasToTribesMapping(reader), electionComputeAreasToTribesMapping(election)));
+    ASSERT_TEST(electionSetTribeName(election, 3, "renamed") == ELECTION_SUCCESS);
+    char* name = electionReaderGetTribeName(reader, 3);
+    ASSERT_TEST(name != NULL && strcmp(name, "renamed") == 0);
+    free(name);
+    ASSERT_TEST(electionReaderGetTribeName(reader, 0) == NULL && electionReaderGetTribeName(reader, -1) == NULL);
+    ASSERT_TEST(electionRemoveAreas(election, isChurnedArea) == ELECTION_SUCCESS);
+    ASSERT_TEST(sameMap(electionReaderComputeAreasToTribesMapping(reader), electionComputeAreasToTribesMapping(election)));
+    electionReaderDestroy(reader);
+    electionDestroy(election);
+    return true;
+}
+
+bool testReaderWhileWriting()
+{
+    for (int shards = 1; shards <= SHARDS; shards += SHARDS - 1)
+    {
+        Election election = electionCreateSharded(shards, NULL);
+        ASSERT_TEST(election != NULL);
+        for (int tribe_id = 0; tribe_id < PARALLEL_TRIBES; tribe_id++)
+        {
+            ASSERT_TEST(electionAddTribe(election, tribe_id, tribe_id == 1 ? "alpha" : "tribe") == ELECTION_SUCCESS);
+        }
+        for (int area_id = 0; area_id < STABLE_AREAS; area_id++)
+        {
+            ASSERT_TEST(electionAddArea(election, area_id, "stable") == ELECTION_SUCCESS);
+            ASSERT_TEST(electionAddVote(election, area_id, area_id % PARALLEL_TRIBES, 1) == ELECTION_SUCCESS);
+        }
+        ReaderThread thread = {electionReaderCreate(election), 0, 0, true};
+        ASSERT_TEST(thread.reader != NULL);
+        pthread_t reader_thread;
+        ASSERT_TEST(pthread_create(&reader_thread, NULL, readElection, &thread) == 0);
+        for (int round = 0; round < WRITER_ROUNDS || __atomic_load_n(&thread.reads, __ATOMIC_ACQUIRE) < WRITER_ROUNDS;
+             round++)
+        {
+            for (int area_id = STABLE_AREAS; area_id < STABLE_AREAS + CHURNED_AREAS; area_id++)
+            {
+                ASSERT_TEST(electionAddArea(election, area_id, "churned") == ELECTION_SUCCESS);
+                ASSERT_TEST(electionAddVote(election, area_id, (area_id + round) % PARALLEL_TRIBES, 1) ==
+                            ELECTION_SUCCESS);
+            }
+            ASSERT_TEST(electionSetTribeName(election, 1, round % 2 == 0 ? "beta" : "alpha") == ELECTION_SUCCESS);
+            ASSERT_TEST(electionAddTribe(election, PARALLEL_TRIBES + round, "churned") == ELECTION_SUCCESS);
+            if (round > 0)
+            {//the slots of the schema are put again while the reader probes them
+                ASSERT_TEST(electionRemoveTribe(election, PARALLEL_TRIBES + round - 1) == ELECTION_SUCCESS);
+            }
+            ASSERT_TEST(electionAddVote(election, round % STABLE_AREAS, round % STABLE_AREAS % PARALLEL_TRIBES, 1) ==
+                        ELECTION_SUCCESS);
+            ASSERT_TEST(electionRemoveAreas(election, isChurnedArea) == ELECTION_SUCCESS);
+        }
+        __atomic_store_n(&thread.stop, 1, __ATOMIC_RELEASE);
+        ASSERT_TEST(pthread_join(reader_thread, NULL) == 0);
+        ASSERT_TEST(thread.valid);
+        electionReaderDestroy(thread.reader);
+        electionDestroy(election);
+    }
+    return true;
+}
+
+bool testShardHeapKeepsBlocksOnItsNode()
+{
+    const size_t sizes[] = {1, 100, 5000, LARGE_BLOCK};
+    const int count = sizeof(sizes) / sizeof(sizes[0]);
+    for (int node = 0; node < shardNodeCount(); node++)
+    {
+        ShardHeap heap = shardHeapCreate(node, allocatorDefault());
+        ASSERT_TEST(heap != NULL);
+        const Allocator* allocator = shardHeapAllocator(heap);
+        char* blocks[sizeof(sizes) / sizeof(sizes[0])];
+        for (int i = 0; i < count; i++)
+        {
+            blocks[i] = allocatorAllocate(allocator, sizes[i]);
+            ASSERT_TEST(blocks[i] != NULL && (uintptr_t)blocks[i] % sizeof(int64_t) == 0);
+            memset(blocks[i], i, sizes[i]);
+            ASSERT_TEST(shardNodeOf(blocks[i]) == node && shardNodeOf(blocks[i] + sizes[i] - 1) == node);
+        }
+        char* grown = allocatorReallocate(allocator, blocks[1], sizes[2]);
+        ASSERT_TEST(grown != NULL && grown[sizes[1] - 1] == 1 && shardNodeOf(grown + sizes[2] - 1) == node);
+        blocks[1] = grown;
+        char* first = blocks[0];
+        allocatorDeallocate(allocator, blocks[0]);
+        blocks[0] = allocatorAllocate(allocator, sizes[0]);
+        ASSERT_TEST(blocks[0] == first);
+        ASSERT_TEST(blocks[2][sizes[2] - 1] == 2 && blocks[3][sizes[3] - 1] == 3);
+        for (int i = 0; i < count; i++)
+        {
+            allocatorDeallocate(allocator, blocks[i]);
+        }
+        shardHeapDestroy(heap);
+    }
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testShardedElectionGivesSameResults,
+        testSchedulerRunsEveryIterationOnce,
+        testThreadsGiveSameResults,
+        testReaderSeesTheElection,
+        testReaderWhileWriting,
+        testShardHeapKeepsBlocksOnItsNode
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testShardedElectionGivesSameResults",
+        "testSchedulerRunsEveryIterationOnce",
+        "testThreadsGiveSameResults",
+        "testReaderSeesTheElection",
+        "testReaderWhileWriting",
+        "testShardHeapKeepsBlocksOnItsNode"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: parallelTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
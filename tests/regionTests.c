@@ -0,0 +1,232 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../test_utilities.h"
+#include "testHelpers.h"
+
+
+static bool regionsAre(Election election, const int* pairs, int count);
+static bool isFirstArea(int area_id);
+static Election createSeatsElection();
+static bool seatsAre(Election election, ElectionSeatMethod method, int seats, double threshold,
+                     const int* pairs, int count);
+
+/*
+return true if electionComputeRegionsToTribesMapping gives exactly the given (region, tribe) pairs
+*/
+static bool regionsAre(Election election, const int* pairs, int count)
+{
+    Map regions = electionComputeRegionsToTribesMapping(election);
+    bool same = mapIs(regions, pairs, count);
+    mapDestroy(regions);
+    return same;
+}
+
+static bool isFirstArea(int area_id)
+{
+    return area_id == 1;
+}
+
+bool testRegionTotalsFollowVotes()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddTribe(election, 1, "first") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 2, "second") == ELECTION_SUCCESS);
+    for (int area_id = 1; area_id <= 4; area_id++)
+    {
+        ASSERT_TEST(electionAddArea(election, area_id, "area") == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(regionsAre(election, NULL, 0));
+    ASSERT_TEST(electionAddVote(election, 1, 1, 10) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 2, 2, 6) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 3, 2, 6) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(election, 1, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(election, 2, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(election, 3, 7) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(election, 4, 8) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){7, 2, 8, 1}, 2));
+    ASSERT_TEST(electionRemoveVote(election, 3, 2, 4) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){7, 1, 8, 1}, 2));
+    ASSERT_TEST(electionAddVote(election, 4, 2, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(election, 3, 8) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){7, 1, 8, 2}, 2));
+    ASSERT_TEST(electionRemoveAreas(election, isFirstArea) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){7, 2, 8, 2}, 2));
+    ASSERT_TEST(electionSetAreaRegion(election, 2, ELECTION_NO_REGION) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){8, 2}, 1));
+    ASSERT_TEST(electionRemoveTribe(election, 2) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){8, 1}, 1));
+    electionDestroy(election);
+    return true;
+}
+
+bool testSetAreaRegionErrors()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionAddArea(election, 1, "area") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetAreaRegion(NULL, 1, 1) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionSetAreaRegion(election, -1, 1) == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionSetAreaRegion(election, 1, -2) == ELECTION_INVALID_ID);
+    ASSERT_TEST(electionSetAreaRegion(election, 2, 1) == ELECTION_AREA_NOT_EXIST);
+    ASSERT_TEST(electionSetAreaRegion(election, 1, 3) == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, NULL, 0));
+    ASSERT_TEST(electionAddTribe(election, 5, "five") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 4, "four") == ELECTION_SUCCESS);
+    ASSERT_TEST(regionsAre(election, (int[]){3, 4}, 1));
+    ASSERT_TEST(electionComputeRegionsToTribesMapping(NULL) == NULL);
+    electionDestroy(election);
+    return true;
+}
+
+/*
+return an election of four tribes with 100000, 80000, 30000 and 20000 votes, split between two areas of
+region 1, and a third area of region 2 where only tribe 4 got votes
+*/
+static Election createSeatsElection()
+{
+    Election election = createTestElection(NULL, 4, 3, 1);
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    const int votes[] = {100000, 80000, 30000, 20000};
+    bool created = true;
+    for (int area_id = 1; area_id <= 3; area_id++)
+    {
+        created = created && electionSetAreaRegion(election, area_id, area_id == 3 ? 2 : 1) == ELECTION_SUCCESS;
+    }
+    for (int tribe_id = 1; tribe_id <= 4; tribe_id++)
+    {
+        int half = votes[tribe_id - 1] / 2;
+        created = created && electionAddVote(election, 1, tribe_id, half) == ELECTION_SUCCESS &&
+                  electionAddVote(election, 2, tribe_id, votes[tribe_id - 1] - half) == ELECTION_SUCCESS;
+    }
+    created = created && electionAddVote(election, 3, 4, 5) == ELECTION_SUCCESS;
+    if (!created)
+    {
+        electionDestroy(election);
+        return NULL;
+    }
+    return election;
+}
+
+/*
+return true if electionComputeSeats gives exactly the given (tribe, seats) pairs
+*/
+static bool seatsAre(Election election, ElectionSeatMethod method, int seats, double threshold,
+                     const int* pairs, int count)
+{
+    Map result = electionComputeSeats(election, method, seats, threshold);
+    bool same = mapIs(result, pairs, count);
+    mapDestroy(result);
+    return same;
+}
+
+bool testSeatMethods()
+{
+    Election election = createSeatsElection();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionRemoveVote(election, 3, 4, 5) == ELECTION_SUCCESS);
+    ASSERT_TEST(seatsAre(election, ELECTION_DHONDT, 8, 0, (int[]){1, 4, 2, 3, 3, 1, 4, 0}, 4));
+    ASSERT_TEST(seatsAre(election, ELECTION_SAINTE_LAGUE, 8, 0, (int[]){1, 3, 2, 3, 3, 1, 4, 1}, 4));
+    ASSERT_TEST(seatsAre(election, ELECTION_LARGEST_REMAINDER, 8, 0, (int[]){1, 3, 2, 3, 3, 1, 4, 1}, 4));
+    ASSERT_TEST(seatsAre(election, ELECTION_SAINTE_LAGUE, 8, 0.1, (int[]){1, 4, 2, 3, 3, 1, 4, 0}, 4));
+    ASSERT_TEST(seatsAre(election, ELECTION_DHONDT, 0, 0, (int[]){1, 0, 2, 0, 3, 0, 4, 0}, 4));
+    ASSERT_TEST(electionRemoveTribe(election, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(seatsAre(election, ELECTION_DHONDT, 1, 0, (int[]){2, 1, 3, 0, 4, 0}, 3));
+    electionDestroy(election);
+    return true;
+}
+
+bool testSeatTiesAndErrors()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(seatsAre(election, ELECTION_DHONDT, 3, 0, NULL, 0));
+    ASSERT_TEST(electionAddArea(election, 1, "area") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 9, "nine") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddTribe(election, 3, "three") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 9, 50) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 3, 50) == ELECTION_SUCCESS);
+    for (ElectionSeatMethod method = ELECTION_DHONDT; method <= ELECTION_LARGEST_REMAINDER; method++)
+    {
+        ASSERT_TEST(seatsAre(election, method, 1, 0, (int[]){3, 1, 9, 0}, 2));
+        ASSERT_TEST(seatsAre(election, method, 3, 0, (int[]){3, 2, 9, 1}, 2));
+    }
+    ASSERT_TEST(electionComputeSeats(NULL, ELECTION_DHONDT, 1, 0) == NULL);
+    ASSERT_TEST(electionComputeSeats(election, ELECTION_DHONDT, -1, 0) == NULL);
+    ASSERT_TEST(electionComputeSeats(election, ELECTION_DHONDT, 1, 1.5) == NULL);
+    ASSERT_TEST(electionComputeSeats(election, ELECTION_DHONDT, 1, -0.1) == NULL);
+    ASSERT_TEST(electionComputeSeats(election, (ElectionSeatMethod)(ELECTION_LARGEST_REMAINDER + 1), 1, 0) ==
+                NULL);
+    ASSERT_TEST(electionComputeRegionSeats(election, -1, ELECTION_DHONDT, 1, 0) == NULL);
+    electionDestroy(election);
+    return true;
+}
+
+bool testRegionSeats()
+{
+    Election election = createSeatsElection();
+    ASSERT_TEST(election != NULL);
+    Map seats = electionComputeRegionSeats(election, 1, ELECTION_DHONDT, 8, 0);
+    ASSERT_TEST(mapIs(seats, (int[]){1, 4, 2, 3, 3, 1, 4, 0}, 4));
+    mapDestroy(seats);
+    seats = electionComputeRegionSeats(election, 2, ELECTION_SAINTE_LAGUE, 2, 0.5);
+    ASSERT_TEST(mapIs(seats, (int[]){1, 0, 2, 0, 3, 0, 4, 2}, 4));
+    mapDestroy(seats);
+    seats = electionComputeRegionSeats(election, 3, ELECTION_DHONDT, 2, 0);
+    ASSERT_TEST(mapIs(seats, NULL, 0));
+    mapDestroy(seats);
+    electionDestroy(election);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testRegionTotalsFollowVotes,
+        testSetAreaRegionErrors,
+        testSeatMethods,
+        testSeatTiesAndErrors,
+        testRegionSeats
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testRegionTotalsFollowVotes",
+        "testSetAreaRegionErrors",
+        "testSeatMethods",
+        "testSeatTiesAndErrors",
+        "testRegionSeats"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: regionTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../stats.h"
+#include "../test_utilities.h"
+
+#define LATENCIES 1000
+#define VOTES 25
+#define STATS_THREADS 4
+
+static void* addLatencies(void* histogram);
+
+bool testPercentileWithinBucketError()
+{
+    StatsHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    ASSERT_TEST(statsPercentile(&histogram, 50) == 0);
+    for (long long latency = 1; latency <= LATENCIES; latency++)
+    {
+        statsAddLatency(&histogram, latency);
+    }
+    statsAddLatency(&histogram, -5);
+    ASSERT_TEST(histogram.count == LATENCIES + 1);
+    ASSERT_TEST(histogram.total_ns == LATENCIES * (LATENCIES + 1) / 2);
+    ASSERT_TEST(histogram.max_ns == LATENCIES);
+    ASSERT_TEST(statsPercentile(&histogram, 0) == 0);
+    ASSERT_TEST(statsPercentile(&histogram, 100) == LATENCIES);
+    long long median = statsPercentile(&histogram, 50);
+    ASSERT_TEST(median >= LATENCIES / 2 && median <= LATENCIES / 2 + LATENCIES / 2 / STATS_SUB_BUCKETS);
+    long long high = statsPercentile(&histogram, 99);
+    ASSERT_TEST(high >= 990 && high <= LATENCIES);
+    return true;
+}
+
+bool testElectionStats()
+{
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ElectionStats stats;
+    ASSERT_TEST(electionGetStats(NULL, &stats) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionGetStats(election, NULL) == ELECTION_NULL_ARGUMENT);
+    statsReset();
+    ASSERT_TEST(electionAddTribe(election, 1, "tribe") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddArea(election, 1, "area") == ELECTION_SUCCESS);
+    for (int i = 0; i < VOTES; i++)
+    {
+        ASSERT_TEST(electionAddVote(election, 1, 1, 1) == ELECTION_SUCCESS);
+    }
+    Map mapping = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(mapping != NULL);
+    mapDestroy(mapping);
+    ASSERT_TEST(electionGetStats(election, &stats) == ELECTION_SUCCESS);
+#ifdef ELECTION_STATS
+    ASSERT_TEST(stats.latency[STATS_ADD_VOTE].count == VOTES);
+    ASSERT_TEST(stats.latency[STATS_ADD_AREA].count == 1);
+    ASSERT_TEST(stats.latency[STATS_ADD_TRIBE].count == 1);
+    ASSERT_TEST(stats.latency[STATS_COMPUTE_MAPPING].count == 1);
+    ASSERT_TEST(stats.latency[STATS_REMOVE_AREAS].count == 0);
+#else
+    ElectionStats zero;
+    memset(&zero, 0, sizeof(zero));
+    ASSERT_TEST(memcmp(&stats, &zero, sizeof(stats)) == 0);
+#endif
+    statsReset();
+    ASSERT_TEST(electionGetStats(election, &stats) == ELECTION_SUCCESS);
+    ASSERT_TEST(stats.latency[STATS_ADD_VOTE].count == 0 && stats.frees == 0);
+    electionDestroy(election);
+    return true;
+}
+
+/*
+adds the latencies 1 to LATENCIES to the shared histogram
+*/
+static void* addLatencies(void* histogram)
+{
+    for (long long latency = 1; latency <= LATENCIES; latency++)
+    {
+        statsAddLatency(histogram, latency);
+    }
+    return NULL;
+}
+
+bool testLatenciesFromManyThreads()
+{
+    StatsHistogram histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    pthread_t threads[STATS_THREADS];
+    for (int i = 0; i < STATS_THREADS; i++)
+    {
+        ASSERT_TEST(pthread_create(&threads[i], NULL, addLatencies, &histogram) == 0);
+    }
+    for (int i = 0; i < STATS_THREADS; i++)
+    {
+        ASSERT_TEST(pthread_join(threads[i], NULL) == 0);
+    }
+    ASSERT_TEST(histogram.count == STATS_THREADS * LATENCIES);
+    ASSERT_TEST(histogram.total_ns == STATS_THREADS * (LATENCIES * (LATENCIES + 1) / 2));
+    ASSERT_TEST(histogram.max_ns == LATENCIES);
+    long long bucketed = 0;
+    for (int i = 0; i < STATS_HISTOGRAM_BUCKETS; i++)
+    {
+        bucketed += histogram.buckets[i];
+    }
+    ASSERT_TEST(bucketed == STATS_THREADS * LATENCIES);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testPercentileWithinBucketError,
+        testElectionStats,
+        testLatenciesFromManyThreads
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testPercentileWithinBucketError",
+        "testElectionStats",
+        "testLatenciesFromManyThreads"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: statsTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <string.h>
+#include "testHelpers.h"
+
+#define ID_LENGTH 12
+
+Election createTestElection(const Allocator* allocator, int tribes, int areas, int first_id);
+bool mapIs(Map map, const int* pairs, int count);
+bool sameMap(Map map, Map expected);
+bool hasVotes(Election election, int area_id, int tribe_id, int64_t expected);
+
+Election createTestElection(const Allocator* allocator, int tribes, int areas, int first_id)
+{
+    Election election = electionCreateWithAllocator(allocator);
+    if (election == NULL)
+    {
+        return NULL;
+    }
+    bool created = true;
+    for (int tribe_id = first_id; tribe_id < first_id + tribes; tribe_id++)
+    {
+        created = created && electionAddTribe(election, tribe_id, "tribe") == ELECTION_SUCCESS;
+    }
+    for (int area_id = first_id; area_id < first_id + areas; area_id++)
+    {
+        created = created && electionAddArea(election, area_id, "area") == ELECTION_SUCCESS;
+    }
+    if (!created)
+    {
+        electionDestroy(election);
+        return NULL;
+    }
+    return election;
+}
+
+bool mapIs(Map map, const int* pairs, int count)
+{
+    if (map == NULL || mapGetSize(map) != count)
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        char key[ID_LENGTH];
+        char value[ID_LENGTH];
+        sprintf(key, "%d", pairs[2 * i]);
+        sprintf(value, "%d", pairs[2 * i + 1]);
+        char* data = mapGet(map, key);
+        if (data == NULL || strcmp(data, value) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool sameMap(Map map, Map expected)
+{
+    bool same = map != NULL && expected != NULL && mapGetSize(map) == mapGetSize(expected);
+    if (same)
+    {
+        MAP_FOREACH(key, expected)
+        {
+            char* data = mapGet(map, key);
+            if (data == NULL || strcmp(data, mapGet(expected, key)) != 0)
+            {
+                same = false;
+                break;
+            }
+        }
+    }
+    mapDestroy(map);
+    mapDestroy(expected);
+    return same;
+}
+
+bool hasVotes(Election election, int area_id, int tribe_id, int64_t expected)
+{
+    int64_t votes = -1;
+    return electionGetVotes(election, area_id, tribe_id, &votes) == ELECTION_SUCCESS && votes == expected;
+}
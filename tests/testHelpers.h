@@ -0,0 +1,37 @@
+#ifndef MTM_TEST_HELPERS_H
+#define MTM_TEST_HELPERS_H
+
+#include "../election.h"
+#include "../election_ext.h"
+#include "../allocator.h"
+#include <stdbool.h>
+#include <stdint.h>
+/**
+* Test helpers
+* Checks and fixtures shared by the tests under tests/, each test keeps the fixtures of its own
+* request in its file.
+**/
+
+/*
+*createTestElection: creates an election with the given allocator (NULL for the default one) with the
+*given count of tribes named "tribe" and then the given count of areas named "area", the ids of both
+*start at first_id and have no votes
+*@return
+*NULL if memory allocation failed
+*/
+Election createTestElection(const Allocator* allocator, int tribes, int areas, int first_id);
+/*
+*mapIs: return true if the map has exactly the given count of (key, value) pairs of ids, pairs holds
+*the key of every pair and then its value
+*/
+bool mapIs(Map map, const int* pairs, int count);
+/*
+*sameMap: return true if both maps have the same keys with the same data, and destroys them
+*/
+bool sameMap(Map map, Map expected);
+/*
+*hasVotes: return true if the tribe got the expected votes in the area
+*/
+bool hasVotes(Election election, int area_id, int tribe_id, int64_t expected);
+
+#endif //MTM_TEST_HELPERS_H
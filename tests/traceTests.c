@@ -0,0 +1,290 @@
+#include <stdlib.h>
+#include <string.h>
+#include "../election.h"
+#include "../election_ext.h"
+#include "../trace.h"
+#include "../test_utilities.h"
+
+#define WORKLOAD_AREAS 50
+#define FIRST_TRACE "workloadTest1.trace"
+#define SECOND_TRACE "workloadTest2.trace"
+#define WORKLOAD_COMMAND "./workload -a 50 -t 8 -n 5000 -s 11 -d 5 -c 400 -q 700 -o "
+
+static const int* replayed_area_ids;//the areas the record that is replayed removed, a condition gets only an id
+static int replayed_area_count;
+
+static bool sameRecord(const TraceRecord* record, const TraceRecord* other);
+static bool sameName(const char* name, const char* other);
+static int replayRecord(Election election, const TraceRecord* record);
+static bool isReplayedArea(int area_id);
+static bool isEvenArea(int area_id);
+
+/*
+return true if both records are of the same call with the same arguments and result, at any time
+*/
+static bool sameRecord(const TraceRecord* record, const TraceRecord* other)
+{
+    if (record->operation != other->operation || record->result != other->result ||
+        record->area_id != other->area_id || record->tribe_id != other->tribe_id ||
+        record->num_of_votes != other->num_of_votes || !sameName(record->name, other->name))
+    {
+        return false;
+    }
+    if (record->operation != TRACE_REMOVE_AREAS)
+    {
+        return true;
+    }
+    return record->area_count == other->area_count &&
+           (record->area_count == 0 ||
+            memcmp(record->area_ids, other->area_ids, record->area_count * sizeof(*record->area_ids)) == 0);
+}
+
+/*
+return true if both names are NULL or equal
+*/
+static bool sameName(const char* name, const char* other)
+{
+    return name == other || (name != NULL && other != NULL && strcmp(name, other) == 0);
+}
+
+bool testWorkloadIsDeterministic()
+{
+    ASSERT_TEST(system(WORKLOAD_COMMAND FIRST_TRACE " > /dev/null") == 0);
+    ASSERT_TEST(system(WORKLOAD_COMMAND SECOND_TRACE " > /dev/null") == 0);
+    FILE* first_file = fopen(FIRST_TRACE, "rb");
+    FILE* second_file = fopen(SECOND_TRACE, "rb");
+    TraceReader first = traceReaderCreate(first_file, NULL);
+    TraceReader second = traceReaderCreate(second_file, NULL);
+    ASSERT_TEST(first != NULL && second != NULL);
+    TraceRecord record;
+    TraceRecord other;
+    TraceResult result;
+    int records = 0;
+    int churned_areas = 0;
+    int areas_added_back = 0;
+    while ((result = traceRead(first, &record)) == TRACE_SUCCESS)
+    {
+        ASSERT_TEST(traceRead(second, &other) == TRACE_SUCCESS);
+        ASSERT_TEST(sameRecord(&record, &other));
+        churned_areas += record.operation == TRACE_REMOVE_AREAS && record.area_count == 1;
+        areas_added_back += record.operation == TRACE_ADD_AREA && records > WORKLOAD_AREAS;
+        records++;
+    }
+    ASSERT_TEST(result == TRACE_END && traceRead(second, &other) == TRACE_END);
+    ASSERT_TEST(records > WORKLOAD_AREAS && churned_areas > 0 && areas_added_back > 0);
+    traceReaderDestroy(first);
+    traceReaderDestroy(second);
+    fclose(first_file);
+    fclose(second_file);
+    remove(FIRST_TRACE);
+    remove(SECOND_TRACE);
+    return true;
+}
+
+bool testTraceRoundTrip()
+{
+    FILE* stream = tmpfile();
+    ASSERT_TEST(stream != NULL);
+    TraceWriter writer = traceWriterCreate(stream, NULL);
+    ASSERT_TEST(writer != NULL);
+    const int removed[] = {4, 8, 1000000};
+    TraceRecord records[] = {
+            {TRACE_ADD_TRIBE, ELECTION_SUCCESS, 10, 0, 7, 0, "tribe name", NULL, 0},
+            {TRACE_ADD_VOTE, ELECTION_INVALID_VOTES, 5, 3, 7, -2, NULL, NULL, 0},
+            {TRACE_REMOVE_AREAS, ELECTION_SUCCESS, 2000000000000LL, 0, 0, 0, NULL, removed, 3},
+            {TRACE_COMPUTE_MAPPING, ELECTION_OUT_OF_MEMORY, 2000000000001LL, 0, 0, 0, NULL, NULL, 0}
+    };
+    int count = sizeof(records) / sizeof(records[0]);
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_TEST(traceWrite(writer, &records[i]) == TRACE_SUCCESS);
+    }
+    ASSERT_TEST(traceWrite(writer, NULL) == TRACE_NULL_ARGUMENT);
+    traceWriterDestroy(writer);
+    long size = ftell(stream);
+    rewind(stream);
+    TraceReader reader = traceReaderCreate(stream, NULL);
+    ASSERT_TEST(reader != NULL);
+    TraceRecord record;
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_TEST(traceRead(reader, &record) == TRACE_SUCCESS);
+        ASSERT_TEST(sameRecord(&record, &records[i]));
+        ASSERT_TEST(record.timestamp_ns == (i == 1 ? records[0].timestamp_ns : records[i].timestamp_ns));
+    }
+    ASSERT_TEST(traceRead(reader, &record) == TRACE_END);
+    traceReaderDestroy(reader);
+    FILE* cut = tmpfile();
+    ASSERT_TEST(cut != NULL);
+    rewind(stream);
+    for (long i = 0; i < size - 1; i++)
+    {
+        fputc(fgetc(stream), cut);
+    }
+    rewind(cut);
+    reader = traceReaderCreate(cut, NULL);
+    ASSERT_TEST(reader != NULL);
+    TraceResult result;
+    while ((result = traceRead(reader, &record)) == TRACE_SUCCESS)
+    {
+    }
+    ASSERT_TEST(result == TRACE_INVALID_FORMAT);
+    traceReaderDestroy(reader);
+    rewind(cut);
+    fputs("not a trace", cut);
+    rewind(cut);
+    ASSERT_TEST(traceReaderCreate(cut, NULL) == NULL);
+    fclose(cut);
+    fclose(stream);
+    return true;
+}
+
+/*
+calls the election function of the record with its arguments, return the result like it is traced
+*/
+static int replayRecord(Election election, const TraceRecord* record)
+{
+    switch (record->operation)
+    {
+        case TRACE_ADD_TRIBE:
+            return electionAddTribe(election, record->tribe_id, record->name);
+        case TRACE_ADD_AREA:
+            return electionAddArea(election, record->area_id, record->name);
+        case TRACE_ADD_VOTE:
+            return electionAddVote(election, record->area_id, record->tribe_id, record->num_of_votes);
+        case TRACE_REMOVE_VOTE:
+            return electionRemoveVote(election, record->area_id, record->tribe_id, record->num_of_votes);
+        case TRACE_SET_TRIBE_NAME:
+            return electionSetTribeName(election, record->tribe_id, record->name);
+        case TRACE_REMOVE_TRIBE:
+            return electionRemoveTribe(election, record->tribe_id);
+        case TRACE_REMOVE_AREAS:
+            replayed_area_ids = record->area_ids;
+            replayed_area_count = record->area_count;
+            return electionRemoveAreas(election, isReplayedArea);
+        default:
+            return -1;
+    }
+}
+
+/*
+return true for the areas the record that is replayed removed
+*/
+static bool isReplayedArea(int area_id)
+{
+    for (int i = 0; i < replayed_area_count; i++)
+    {
+        if (replayed_area_ids[i] == area_id)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool isEvenArea(int area_id)
+{
+    return area_id % 2 == 0;
+}
+
+bool testElectionTraceReplays()
+{
+    FILE* stream = tmpfile();
+    ASSERT_TEST(stream != NULL);
+    Election election = electionCreate();
+    ASSERT_TEST(election != NULL);
+    ASSERT_TEST(electionStartTrace(election, NULL) == ELECTION_NULL_ARGUMENT);
+    ASSERT_TEST(electionStartTrace(election, stream) == ELECTION_SUCCESS);
+    for (int id = 1; id <= 6; id++)
+    {
+        ASSERT_TEST(electionAddTribe(election, id, "tribe") == ELECTION_SUCCESS);
+        ASSERT_TEST(electionAddArea(election, id, "area") == ELECTION_SUCCESS);
+    }
+    for (int id = 1; id <= 6; id++)
+    {
+        ASSERT_TEST(electionAddVote(election, id, 7 - id, id) == ELECTION_SUCCESS);
+    }
+    ASSERT_TEST(electionAddVote(election, 9, 1, 1) == ELECTION_AREA_NOT_EXIST);
+    ASSERT_TEST(electionRemoveVote(election, 2, 5, 1) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionSetTribeName(election, 3, "renamed") == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveTribe(election, 4) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionRemoveAreas(election, isEvenArea) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionStopTrace(election) == ELECTION_SUCCESS);
+    ASSERT_TEST(electionAddVote(election, 1, 1, 100) == ELECTION_SUCCESS);
+    Map expected = electionComputeAreasToTribesMapping(election);
+    ASSERT_TEST(expected != NULL);
+    rewind(stream);
+    TraceReader reader = traceReaderCreate(stream, NULL);
+    ASSERT_TEST(reader != NULL);
+    Election replayed = electionCreate();
+    ASSERT_TEST(replayed != NULL);
+    TraceRecord record;
+    TraceResult result;
+    int records = 0;
+    while ((result = traceRead(reader, &record)) == TRACE_SUCCESS)
+    {
+        ASSERT_TEST(replayRecord(replayed, &record) == record.result);
+        records++;
+    }
+    ASSERT_TEST(result == TRACE_END && records == 23);
+    ASSERT_TEST(electionAddVote(replayed, 1, 1, 100) == ELECTION_SUCCESS);
+    Map mapping = electionComputeAreasToTribesMapping(replayed);
+    ASSERT_TEST(mapping != NULL && mapGetSize(mapping) == mapGetSize(expected) && mapGetSize(mapping) == 3);
+    MAP_FOREACH(area_id, expected)
+    {
+        ASSERT_TEST(strcmp(mapGet(mapping, area_id), mapGet(expected, area_id)) == 0);
+    }
+    char* name = electionGetTribeName(replayed, 3);
+    ASSERT_TEST(name != NULL && strcmp(name, "renamed") == 0);
+    free(name);
+    mapDestroy(mapping);
+    mapDestroy(expected);
+    traceReaderDestroy(reader);
+    electionDestroy(replayed);
+    electionDestroy(election);
+    fclose(stream);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testWorkloadIsDeterministic,
+        testTraceRoundTrip,
+        testElectionTraceReplays
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testWorkloadIsDeterministic",
+        "testTraceRoundTrip",
+        "testElectionTraceReplays"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: traceTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
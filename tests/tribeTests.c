@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../tribe.h"
+#include "../assist.h"
+#include "../allocator.h"
+#include "../test_utilities.h"
+
+#define HEADROOM 5
+#define VOTES 10
+#define SCAN_TRIBES 67
+#define SPARSE_TRIBES 300
+#define SPARSE_UPDATES 20000
+#define NAMED_TRIBES 1500
+#define NAME_STRIDE 7
+#define NAME_LENGTH 32
+
+static int tribeIdAt(int position, int count);
+static bool votesAre(Tribe table, const int64_t* expected, int count);
+
+bool testTotalsOverflowPolicy()
+{
+    Tribe totals = tribeCreate(allocatorDefault());
+    ASSERT_TEST(totals != NULL);
+    ASSERT_TEST(tribeAdd(totals, 1, "tribe") == TRIBE_SUCCESS);
+    Tribe area = tribeCopyEmpty(totals);
+    ASSERT_TEST(area != NULL);
+    tribeAddToVotes(totals, 1, INT64_MAX - HEADROOM);
+    int64_t change = -1;
+    ASSERT_TEST(tribeUpdateVote(area, totals, 1, VOTES, addVotes, false, &change) == TRIBE_VOTES_OVERFLOW);
+    ASSERT_TEST(tribeGetVotes(area, 1) == 0 && tribeGetVotes(totals, 1) == INT64_MAX - HEADROOM);
+    ASSERT_TEST(tribeUpdateVote(area, totals, 1, VOTES, addVotes, true, &change) == TRIBE_SUCCESS);
+    ASSERT_TEST(change == HEADROOM);
+    ASSERT_TEST(tribeGetVotes(area, 1) == HEADROOM && tribeGetVotes(totals, 1) == INT64_MAX);
+    ASSERT_TEST(tribeUpdateVote(area, totals, 1, VOTES, removeVotes, false, &change) == TRIBE_SUCCESS);
+    ASSERT_TEST(change == -HEADROOM);
+    ASSERT_TEST(tribeGetVotes(area, 1) == 0 && tribeGetVotes(totals, 1) == INT64_MAX - HEADROOM);
+    tribeDestroy(area);
+    tribeDestroy(totals);
+    return true;
+}
+
+bool testInt64Strings()
+{
+    char buffer[INT64_STRING_SIZE];
+    writeInt64ToString(INT64_MIN, buffer);
+    ASSERT_TEST(strcmp(buffer, "-9223372036854775808") == 0);
+    writeInt64ToString(INT64_MAX, buffer);
+    ASSERT_TEST(strcmp(buffer, "9223372036854775807") == 0);
+    ASSERT_TEST(stringToInt("9223372036854775807") == INT64_MAX);
+    ASSERT_TEST(stringToInt("99999999999999999999") == INT64_MAX);
+    ASSERT_TEST(stringToInt("4294967296") == 4294967296LL);
+    int64_t result = -1;
+    ASSERT_TEST(!addVotes(INT64_MAX, 1, &result));
+    ASSERT_TEST(addVotes(INT64_MAX - 1, 1, &result) && result == INT64_MAX);
+    ASSERT_TEST(removeVotes(3, VOTES, &result) && result == 0);
+    return true;
+}
+
+/*
+return the id of the tribe added at the given position of count tribes, odd ids in a mixed order,
+71 is a prime above SCAN_TRIBES so every id is added once
+*/
+static int tribeIdAt(int position, int count)
+{
+    return (position * 71) % count * 2 + 1;
+}
+
+bool testWinnerIsLowestIdOfTies()
+{
+    for (int count = 1; count <= SCAN_TRIBES; count++)
+    {
+        Tribe schema = tribeCreate(allocatorDefault());
+        ASSERT_TEST(schema != NULL);
+        for (int i = 0; i < count; i++)
+        {
+            ASSERT_TEST(tribeAdd(schema, tribeIdAt(i, count), "tribe") == TRIBE_SUCCESS);
+        }
+        Tribe area = tribeCopyWithZeroVotes(schema);
+        Tribe totals = tribeCopyWithZeroVotes(schema);
+        ASSERT_TEST(area != NULL && totals != NULL);
+        ASSERT_TEST(tribeGetMaxVotesForArea(area) == 1 && tribeReadWinner(area) == 1);
+        int expected = -1;
+        int64_t most = 0;
+        for (int i = 0; i < count; i++)
+        {
+            int tribe_id = tribeIdAt(i, count);
+            int64_t votes = (i * 7) % 4 * (INT64_MAX / 4);
+            tribeAddToVotes(area, tribe_id, votes);
+            if (votes > most || (votes == most && votes > 0 && tribe_id < expected))
+            {
+                most = votes;
+                expected = tribe_id;
+            }
+        }
+        ASSERT_TEST(tribeGetMaxVotesForArea(area) == (most > 0 ? expected : 1));
+        ASSERT_TEST(tribeReadWinner(area) == tribeGetMaxVotesForArea(area));
+        tribeAddAllVotes(totals, area, 1);
+        for (int i = 0; i < count; i++)
+        {
+            int tribe_id = tribeIdAt(i, count);
+            ASSERT_TEST(tribeGetVotes(totals, tribe_id) == tribeGetVotes(area, tribe_id));
+        }
+        tribeAddAllVotes(totals, area, -1);
+        ASSERT_TEST(tribeGetMaxVotesForArea(totals) == 1);
+        tribeDestroy(totals);
+        tribeDestroy(area);
+        tribeDestroy(schema);
+    }
+    return true;
+}
+
+/*
+return true if the votes of every tribe of the table are the expected votes
+*/
+static bool votesAre(Tribe table, const int64_t* expected, int count)
+{
+    for (int tribe_id = 0; tribe_id < count; tribe_id++)
+    {
+        if (tribeGetVotes(table, tribe_id) != expected[tribe_id] ||
+            tribeContains(table, tribe_id) != (expected[tribe_id] > 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool testSparseTableFindsTribesInAnyOrder()
+{
+    Tribe totals = tribeCreate(allocatorDefault());
+    ASSERT_TEST(totals != NULL);
+    for (int tribe_id = 0; tribe_id < SPARSE_TRIBES; tribe_id++)
+    {
+        ASSERT_TEST(tribeAdd(totals, tribe_id, "tribe") == TRIBE_SUCCESS);
+    }
+    Tribe area = tribeCopyEmpty(totals);
+    ASSERT_TEST(area != NULL);
+    int64_t expected[SPARSE_TRIBES] = {0};
+    unsigned int random = 7;
+    for (int i = 0; i < SPARSE_UPDATES; i++)
+    {
+        random = random * 1103515245 + 12345;
+        int tribe_id = (random >> 8) % SPARSE_TRIBES;
+        int votes = (random >> 4) % VOTES + 1;
+        bool add = (random >> 20) % 3 != 0;
+        ASSERT_TEST(tribeUpdateVote(area, totals, tribe_id, votes, add ? addVotes : removeVotes, false, NULL) ==
+                    TRIBE_SUCCESS);
+        expected[tribe_id] = add ? expected[tribe_id] + votes : (expected[tribe_id] > votes ? expected[tribe_id] - votes : 0);
+        ASSERT_TEST(tribeGetVotes(area, tribe_id) == expected[tribe_id]);
+        if (i % (SPARSE_UPDATES / 10) == 0)
+        {
+            ASSERT_TEST(votesAre(area, expected, SPARSE_TRIBES));
+        }
+    }
+    ASSERT_TEST(votesAre(area, expected, SPARSE_TRIBES));
+    const int removed[] = {1, 2, 3, 50, SPARSE_TRIBES - 1};
+    int removed_count = sizeof(removed) / sizeof(removed[0]);
+    tribeRemoveSortedEntries(area, removed, removed_count);
+    for (int i = 0; i < removed_count; i++)
+    {
+        expected[removed[i]] = 0;
+    }
+    ASSERT_TEST(votesAre(area, expected, SPARSE_TRIBES));
+    Tribe copy = tribeCopy(area);
+    ASSERT_TEST(copy != NULL && votesAre(copy, expected, SPARSE_TRIBES));
+    ASSERT_TEST(tribeUpdateVote(copy, totals, 50, VOTES, addVotes, false, NULL) == TRIBE_SUCCESS);
+    ASSERT_TEST(tribeGetVotes(copy, 50) == VOTES && tribeGetVotes(area, 50) == 0);
+    tribeDestroy(copy);
+    tribeDestroy(area);
+    tribeDestroy(totals);
+    return true;
+}
+
+bool testReaderFindsNamesOfManyTribes()
+{
+    Tribe totals = tribeCreate(allocatorDefault());
+    ASSERT_TEST(totals != NULL);
+    char name[NAME_LENGTH];
+    for (int tribe_id = 0; tribe_id < NAMED_TRIBES; tribe_id++)
+    {
+        sprintf(name, "tribe %d", tribe_id);
+        ASSERT_TEST(tribeAdd(totals, tribe_id * NAME_STRIDE, name) == TRIBE_SUCCESS);
+    }
+    for (int tribe_id = 0; tribe_id < NAMED_TRIBES; tribe_id += 3)
+    {
+        ASSERT_TEST(tribeRemove(totals, tribe_id * NAME_STRIDE) == TRIBE_SUCCESS);
+    }
+    for (int tribe_id = 0; tribe_id < NAMED_TRIBES; tribe_id++)
+    {
+        char* read = tribeReadName(totals, tribe_id * NAME_STRIDE);
+        sprintf(name, "tribe %d", tribe_id);
+        ASSERT_TEST(tribe_id % 3 == 0 ? read == NULL : read != NULL && strcmp(read, name) == 0);
+        ASSERT_TEST(tribeSchemaContains(totals, tribe_id * NAME_STRIDE) == (tribe_id % 3 != 0));
+        free(read);
+        ASSERT_TEST(tribeReadName(totals, tribe_id * NAME_STRIDE + 1) == NULL);
+    }
+    tribeDestroy(totals);
+    return true;
+}
+
+/*The functions for the tests should be added here*/
+bool (*tests[]) (void) = {
+        testTotalsOverflowPolicy,
+        testInt64Strings,
+        testWinnerIsLowestIdOfTies,
+        testSparseTableFindsTribesInAnyOrder,
+        testReaderFindsNamesOfManyTribes
+};
+
+/*The names of the test functions should be added here*/
+const char* testNames[] = {
+        "testTotalsOverflowPolicy",
+        "testInt64Strings",
+        "testWinnerIsLowestIdOfTies",
+        "testSparseTableFindsTribesInAnyOrder",
+        "testReaderFindsNamesOfManyTribes"
+};
+
+#define NUMBER_TESTS ((int)(sizeof(tests) / sizeof(tests[0])))
+
+int main(int argc, char *argv[])
+{
+    if (argc == 1)
+    {
+        for (int test_idx = 0; test_idx < NUMBER_TESTS; test_idx++)
+        {
+            RUN_TEST(tests[test_idx], testNames[test_idx]);
+        }
+        return 0;
+    }
+    if (argc != 2)
+    {
+        fprintf(stdout, "Usage: tribeTests <test index>\n");
+        return 0;
+    }
+
+    int test_idx = strtol(argv[1], NULL, 10);
+    if (test_idx < 1 || test_idx > NUMBER_TESTS)
+    {
+        fprintf(stderr, "Invalid test index %d\n", test_idx);
+        return 0;
+    }
+
+    RUN_TEST(tests[test_idx - 1], testNames[test_idx - 1]);
+    return 0;
+}
@@ -0,0 +1,477 @@
+#include "trace.h"
+#include "allocator.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+
+#define TRACE_MAGIC "ELTRACE"
+#define TRACE_VERSION 1
+#define HEADER_SIZE 8
+#define MAX_VARINT_SIZE 10
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
+#define VARINT_MASK 0x7f
+#define NO_NAME 0
+
+static const char* const operation_names[TRACE_OPERATIONS] = {
+    "electionAddTribe", "electionAddArea", "electionGetTribeName", "electionAddVote",
+    "electionRemoveVote", "electionSetTribeName", "electionRemoveTribe", "electionRemoveAreas",
+    "electionComputeAreasToTribesMapping"
+};
+
+/*
+previous_timestamp is the timestamp of the last record, the records keep the time from it
+*/
+struct trace_writer_t
+{
+    const Allocator* allocator;
+    FILE* stream;
+    long long previous_timestamp;
+};
+
+/*
+name and area_ids are the buffers of the last record that was read, of the given capacities
+*/
+struct trace_reader_t
+{
+    const Allocator* allocator;
+    FILE* stream;
+    long long previous_timestamp;
+    char* name;
+    int name_capacity;
+    int* area_ids;
+    int area_ids_capacity;
+};
+
+TraceWriter traceWriterCreate(FILE* stream, const Allocator* allocator);
+void traceWriterDestroy(TraceWriter writer);
+TraceResult traceWrite(TraceWriter writer, const TraceRecord* record);
+TraceReader traceReaderCreate(FILE* stream, const Allocator* allocator);
+void traceReaderDestroy(TraceReader reader);
+TraceResult traceRead(TraceReader reader, TraceRecord* record);
+const char* traceOperationName(TraceOperation operation);
+void tracePrintLatencyJson(const StatsHistogram* latency, FILE* stream);
+static int encodeVarint(uint64_t value, unsigned char* buffer);
+static int encodeInt(int value, unsigned char* buffer);
+static TraceResult writeName(TraceWriter writer, const char* name);
+static TraceResult readVarint(TraceReader reader, uint64_t* value);
+static TraceResult readInt(TraceReader reader, int* value);
+static TraceResult readName(TraceReader reader, const char** name);
+static TraceResult readAreaIds(TraceReader reader, TraceRecord* record);
+static bool growBuffer(const Allocator* allocator, void** buffer, int* capacity, int size, size_t element_size);
+
+TraceWriter traceWriterCreate(FILE* stream, const Allocator* allocator)
+{
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    TraceWriter writer = allocatorAllocate(allocator, sizeof(*writer));
+    if (writer == NULL)
+    {
+        return NULL;
+    }
+    unsigned char header[HEADER_SIZE];
+    memcpy(header, TRACE_MAGIC, HEADER_SIZE - 1);
+    header[HEADER_SIZE - 1] = TRACE_VERSION;
+    if (fwrite(header, 1, HEADER_SIZE, stream) != HEADER_SIZE)
+    {
+        allocatorDeallocate(allocator, writer);
+        return NULL;
+    }
+    writer->allocator = allocator;
+    writer->stream = stream;
+    writer->previous_timestamp = 0;
+    return writer;
+}
+
+void traceWriterDestroy(TraceWriter writer)
+{
+    if (writer == NULL)
+    {
+        return;
+    }
+    fflush(writer->stream);
+    allocatorDeallocate(writer->allocator, writer);
+}
+
+TraceResult traceWrite(TraceWriter writer, const TraceRecord* record)
+{
+    if (writer == NULL || record == NULL)
+    {
+        return TRACE_NULL_ARGUMENT;
+    }
+    assert(record->operation >= 0 && record->operation < TRACE_OPERATIONS);
+    unsigned char buffer[5 * MAX_VARINT_SIZE + 1];//the operation and at most five numbers
+    int size = 0;
+    long long timestamp = record->timestamp_ns;
+    if (timestamp < writer->previous_timestamp)
+    {
+        timestamp = writer->previous_timestamp;
+    }
+    buffer[size++] = (unsigned char)record->operation;
+    size += encodeInt(record->result, buffer + size);
+    size += encodeVarint((uint64_t)(timestamp - writer->previous_timestamp), buffer + size);
+    writer->previous_timestamp = timestamp;
+    switch (record->operation)
+    {
+    case TRACE_ADD_VOTE:
+    case TRACE_REMOVE_VOTE:
+        size += encodeInt(record->area_id, buffer + size);
+        size += encodeInt(record->tribe_id, buffer + size);
+        size += encodeInt(record->num_of_votes, buffer + size);
+        break;
+    case TRACE_ADD_AREA:
+        size += encodeInt(record->area_id, buffer + size);
+        break;
+    case TRACE_ADD_TRIBE:
+    case TRACE_SET_TRIBE_NAME:
+    case TRACE_GET_TRIBE_NAME:
+    case TRACE_REMOVE_TRIBE:
+        size += encodeInt(record->tribe_id, buffer + size);
+        break;
+    case TRACE_REMOVE_AREAS:
+        assert(record->area_count >= 0 && (record->area_count == 0 || record->area_ids != NULL));
+        size += encodeVarint((uint64_t)record->area_count, buffer + size);
+        break;
+    default:
+        break;
+    }
+    if (fwrite(buffer, 1, size, writer->stream) != (size_t)size)
+    {
+        return TRACE_IO_ERROR;
+    }
+    switch (record->operation)
+    {
+    case TRACE_ADD_TRIBE:
+    case TRACE_SET_TRIBE_NAME:
+    case TRACE_ADD_AREA:
+        return writeName(writer, record->name);
+    case TRACE_REMOVE_AREAS:
+        for (int i = 0; i < record->area_count; i++)
+        {
+            size = encodeInt(record->area_ids[i], buffer);
+            if (fwrite(buffer, 1, size, writer->stream) != (size_t)size)
+            {
+                return TRACE_IO_ERROR;
+            }
+        }
+        return TRACE_SUCCESS;
+    default:
+        return TRACE_SUCCESS;
+    }
+}
+
+TraceReader traceReaderCreate(FILE* stream, const Allocator* allocator)
+{
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    unsigned char header[HEADER_SIZE];
+    if (fread(header, 1, HEADER_SIZE, stream) != HEADER_SIZE ||
+        memcmp(header, TRACE_MAGIC, HEADER_SIZE - 1) != 0 || header[HEADER_SIZE - 1] != TRACE_VERSION)
+    {
+        return NULL;
+    }
+    TraceReader reader = allocatorAllocate(allocator, sizeof(*reader));
+    if (reader == NULL)
+    {
+        return NULL;
+    }
+    reader->allocator = allocator;
+    reader->stream = stream;
+    reader->previous_timestamp = 0;
+    reader->name = NULL;
+    reader->name_capacity = 0;
+    reader->area_ids = NULL;
+    reader->area_ids_capacity = 0;
+    return reader;
+}
+
+void traceReaderDestroy(TraceReader reader)
+{
+    if (reader == NULL)
+    {
+        return;
+    }
+    allocatorDeallocate(reader->allocator, reader->name);
+    allocatorDeallocate(reader->allocator, reader->area_ids);
+    allocatorDeallocate(reader->allocator, reader);
+}
+
+TraceResult traceRead(TraceReader reader, TraceRecord* record)
+{
+    if (reader == NULL || record == NULL)
+    {
+        return TRACE_NULL_ARGUMENT;
+    }
+    int operation = fgetc(reader->stream);
+    if (operation == EOF)
+    {
+        return TRACE_END;
+    }
+    if (operation >= TRACE_OPERATIONS)
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    memset(record, 0, sizeof(*record));
+    record->operation = operation;
+    uint64_t time_passed;
+    TraceResult result = readInt(reader, &record->result);
+    if (result == TRACE_SUCCESS)
+    {
+        result = readVarint(reader, &time_passed);
+    }
+    if (result != TRACE_SUCCESS)
+    {
+        return result;
+    }
+    if (time_passed > (uint64_t)(LLONG_MAX - reader->previous_timestamp))
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    reader->previous_timestamp += (long long)time_passed;
+    record->timestamp_ns = reader->previous_timestamp;
+    switch (record->operation)
+    {
+    case TRACE_ADD_VOTE:
+    case TRACE_REMOVE_VOTE:
+        result = readInt(reader, &record->area_id);
+        if (result == TRACE_SUCCESS)
+        {
+            result = readInt(reader, &record->tribe_id);
+        }
+        if (result == TRACE_SUCCESS)
+        {
+            result = readInt(reader, &record->num_of_votes);
+        }
+        return result;
+    case TRACE_ADD_AREA:
+        result = readInt(reader, &record->area_id);
+        return result == TRACE_SUCCESS ? readName(reader, &record->name) : result;
+    case TRACE_ADD_TRIBE:
+    case TRACE_SET_TRIBE_NAME:
+        result = readInt(reader, &record->tribe_id);
+        return result == TRACE_SUCCESS ? readName(reader, &record->name) : result;
+    case TRACE_GET_TRIBE_NAME:
+    case TRACE_REMOVE_TRIBE:
+        return readInt(reader, &record->tribe_id);
+    case TRACE_REMOVE_AREAS:
+        return readAreaIds(reader, record);
+    default:
+        return TRACE_SUCCESS;
+    }
+}
+
+const char* traceOperationName(TraceOperation operation)
+{
+    assert(operation >= 0 && operation < TRACE_OPERATIONS);
+    return operation_names[operation];
+}
+
+void tracePrintLatencyJson(const StatsHistogram* latency, FILE* stream)
+{
+    assert(latency != NULL && stream != NULL);
+    bool first = true;
+    fprintf(stream, "\"latency_ns\":{");
+    for (int i = 0; i < TRACE_OPERATIONS; i++)
+    {
+        if (latency[i].count > 0)
+        {
+            fprintf(stream, "%s", first ? "" : ",");
+            statsPrintHistogramJson(operation_names[i], &latency[i], stream);
+            first = false;
+        }
+    }
+    fprintf(stream, "}");
+}
+
+/*
+writes the value to the buffer seven bits at a time, the lowest first, with the highest bit of every
+byte but the last set
+return the number of bytes written
+*/
+static int encodeVarint(uint64_t value, unsigned char* buffer)
+{
+    int size = 0;
+    while (value > VARINT_MASK)
+    {
+        buffer[size++] = (unsigned char)(value & VARINT_MASK) | VARINT_MORE;
+        value >>= VARINT_BITS;
+    }
+    buffer[size++] = (unsigned char)value;
+    return size;
+}
+
+/*
+writes an int as a varint of its zigzag encoding, so small negative values are short too
+*/
+static int encodeInt(int value, unsigned char* buffer)
+{
+    uint32_t zigzag = ((uint32_t)value << 1) ^ (uint32_t)(value < 0 ? -1 : 0);
+    return encodeVarint(zigzag, buffer);
+}
+
+/*
+writes the length of the name plus one and its characters, or NO_NAME if it is NULL
+*/
+static TraceResult writeName(TraceWriter writer, const char* name)
+{
+    unsigned char buffer[MAX_VARINT_SIZE];
+    size_t length = name == NULL ? 0 : strlen(name);
+    int size = encodeVarint(name == NULL ? NO_NAME : (uint64_t)length + 1, buffer);
+    if (fwrite(buffer, 1, size, writer->stream) != (size_t)size ||
+        (length > 0 && fwrite(name, 1, length, writer->stream) != length))
+    {
+        return TRACE_IO_ERROR;
+    }
+    return TRACE_SUCCESS;
+}
+
+/*
+reads a varint that encodeVarint wrote
+*/
+static TraceResult readVarint(TraceReader reader, uint64_t* value)
+{
+    *value = 0;
+    for (int shift = 0; shift < MAX_VARINT_SIZE * VARINT_BITS; shift += VARINT_BITS)
+    {
+        int byte = fgetc(reader->stream);
+        if (byte == EOF)
+        {
+            return TRACE_INVALID_FORMAT;
+        }
+        *value |= (uint64_t)(byte & VARINT_MASK) << shift;
+        if (!(byte & VARINT_MORE))
+        {
+            return TRACE_SUCCESS;
+        }
+    }
+    return TRACE_INVALID_FORMAT;
+}
+
+/*
+reads an int that encodeInt wrote
+*/
+static TraceResult readInt(TraceReader reader, int* value)
+{
+    uint64_t zigzag;
+    TraceResult result = readVarint(reader, &zigzag);
+    if (result != TRACE_SUCCESS)
+    {
+        return result;
+    }
+    if (zigzag > UINT32_MAX)
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    uint32_t bits = (uint32_t)(zigzag >> 1) ^ (uint32_t)-(int64_t)(zigzag & 1);
+    *value = bits > INT_MAX ? -(int)(~bits) - 1 : (int)bits;
+    return TRACE_SUCCESS;
+}
+
+/*
+reads a name that writeName wrote into the buffer of the reader, name is set to NULL if it was NULL
+*/
+static TraceResult readName(TraceReader reader, const char** name)
+{
+    uint64_t size;
+    TraceResult result = readVarint(reader, &size);
+    if (result != TRACE_SUCCESS)
+    {
+        return result;
+    }
+    if (size == NO_NAME)
+    {
+        *name = NULL;
+        return TRACE_SUCCESS;
+    }
+    if (size > INT_MAX)
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    if (!growBuffer(reader->allocator, (void**)&reader->name, &reader->name_capacity, (int)size,
+                    sizeof(char)))
+    {
+        return TRACE_OUT_OF_MEMORY;
+    }
+    if (fread(reader->name, 1, size - 1, reader->stream) != size - 1)
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    reader->name[size - 1] = '\0';
+    *name = reader->name;
+    return TRACE_SUCCESS;
+}
+
+/*
+reads the ids of the areas that electionRemoveAreas removed into the buffer of the reader
+*/
+static TraceResult readAreaIds(TraceReader reader, TraceRecord* record)
+{
+    uint64_t count;
+    TraceResult result = readVarint(reader, &count);
+    if (result != TRACE_SUCCESS)
+    {
+        return result;
+    }
+    if (count > INT_MAX)
+    {
+        return TRACE_INVALID_FORMAT;
+    }
+    if (!growBuffer(reader->allocator, (void**)&reader->area_ids, &reader->area_ids_capacity, (int)count,
+                    sizeof(int)))
+    {
+        return TRACE_OUT_OF_MEMORY;
+    }
+    for (int i = 0; i < (int)count; i++)
+    {
+        result = readInt(reader, &reader->area_ids[i]);
+        if (result != TRACE_SUCCESS)
+        {
+            return result;
+        }
+    }
+    record->area_ids = reader->area_ids;
+    record->area_count = (int)count;
+    return TRACE_SUCCESS;
+}
+
+/*
+makes the buffer hold at least size elements, doubling its capacity
+return false if allocation failed, the buffer is unchanged in that case
+*/
+static bool growBuffer(const Allocator* allocator, void** buffer, int* capacity, int size, size_t element_size)
+{
+    if (size <= *capacity)
+    {
+        return true;
+    }
+    int new_capacity = *capacity > 0 ? *capacity : 1;
+    while (new_capacity < size)
+    {
+        new_capacity = new_capacity > INT_MAX / 2 ? size : 2 * new_capacity;
+    }
+    void* new_buffer = allocatorReallocate(allocator, *buffer, (size_t)new_capacity * element_size);
+    if (new_buffer == NULL)
+    {
+        return false;
+    }
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+    return true;
+}
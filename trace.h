@@ -0,0 +1,122 @@
+#ifndef MTM_TRACE_H
+#define MTM_TRACE_H
+
+#include "allocator.h"
+#include "stats.h"
+#include <stdio.h>
+/**
+* Trace
+* Implements a compact binary file of calls to the election functions, for replaying the same
+* calls again when profiling.
+* Every record keeps the call, its arguments, the result it returned and the time it was called,
+* in nanoseconds from the start of the trace. Numbers are written as variable length integers, so most
+* records are a few bytes long.
+* electionRemoveAreas is kept as the ids of the areas it removed, since the condition function
+* can't be written to a file.
+**/
+
+/** Type for defining a TraceWriter */
+typedef struct trace_writer_t* TraceWriter;
+
+/** Type for defining a TraceReader */
+typedef struct trace_reader_t* TraceReader;
+
+/** Type used for returning error codes from trace functions */
+typedef enum TraceResult_t
+{
+    TRACE_SUCCESS,
+    TRACE_NULL_ARGUMENT,
+    TRACE_OUT_OF_MEMORY,
+    TRACE_IO_ERROR,
+    TRACE_INVALID_FORMAT,
+    TRACE_END
+} TraceResult;
+
+/** The election functions that are traced */
+typedef enum TraceOperation_t
+{
+    TRACE_ADD_TRIBE,
+    TRACE_ADD_AREA,
+    TRACE_GET_TRIBE_NAME,
+    TRACE_ADD_VOTE,
+    TRACE_REMOVE_VOTE,
+    TRACE_SET_TRIBE_NAME,
+    TRACE_REMOVE_TRIBE,
+    TRACE_REMOVE_AREAS,
+    TRACE_COMPUTE_MAPPING,
+    TRACE_OPERATIONS
+} TraceOperation;
+
+/*
+one call, result is the ElectionResult it returned, or for functions that return a pointer ELECTION_SUCCESS
+if it wasn't NULL. only the arguments of its operation are used:
+tribe_id and name for adding a tribe and setting its name, tribe_id for getting its name and removing it,
+area_id and name for adding an area, area_id, tribe_id and num_of_votes for adding and removing votes,
+area_ids and area_count for removing areas. name may be NULL
+*/
+typedef struct TraceRecord_t
+{
+    TraceOperation operation;
+    int result;
+    long long timestamp_ns;
+    int area_id;
+    int tribe_id;
+    int num_of_votes;
+    const char* name;
+    const int* area_ids;
+    int area_count;
+} TraceRecord;
+
+/*
+*traceWriterCreate: creates a writer that writes a new trace to the given stream, which it doesn't
+*close. the writer is allocated with the given allocator, or with the default allocator if it is NULL
+*@return
+*NULL if stream is NULL, memory allocation failed or the header couldn't be written
+*/
+TraceWriter traceWriterCreate(FILE* stream, const Allocator* allocator);
+/*
+*traceWriterDestroy: flushes the stream and deallocates the writer. If writer is NULL nothing will be done
+*/
+void traceWriterDestroy(TraceWriter writer);
+/*
+*traceWrite: writes the given record after the records that were written before it. timestamps
+*lower than the timestamp of the previous record are written as that timestamp
+*@return
+*TRACE_NULL_ARGUMENT if writer or record is NULL
+*TRACE_IO_ERROR if the stream couldn't be written
+*TRACE_SUCCESS otherwise
+*/
+TraceResult traceWrite(TraceWriter writer, const TraceRecord* record);
+/*
+*traceReaderCreate: creates a reader of the trace in the given stream, which it doesn't close.
+*the reader is allocated with the given allocator, or with the default allocator if it is NULL
+*@return
+*NULL if stream is NULL, memory allocation failed or the stream doesn't start with a trace header
+*/
+TraceReader traceReaderCreate(FILE* stream, const Allocator* allocator);
+/*
+*traceReaderDestroy: deallocates the reader. If reader is NULL nothing will be done
+*/
+void traceReaderDestroy(TraceReader reader);
+/*
+*traceRead: reads the next record into the given record. its name and area ids belong to the reader
+*and stay valid until the next call
+*@return
+*TRACE_NULL_ARGUMENT if reader or record is NULL
+*TRACE_END if all the records were read
+*TRACE_INVALID_FORMAT if the stream ends in the middle of a record or has a record that isn't valid
+*TRACE_OUT_OF_MEMORY if memory allocation failed
+*TRACE_SUCCESS otherwise
+*/
+TraceResult traceRead(TraceReader reader, TraceRecord* record);
+/*
+*traceOperationName: return the name of the election function of the given operation
+*/
+const char* traceOperationName(TraceOperation operation);
+/*
+*tracePrintLatencyJson: writes the histograms of the operations that have latencies as the member
+*"latency_ns" of a JSON object to the given stream, latency has a histogram for every operation
+*/
+void tracePrintLatencyJson(const StatsHistogram* latency, FILE* stream);
+
+#endif //MTM_TRACE_H
@@ -1,42 +1,158 @@
+
 #define _CRT_SECURE_NO_WARNINGS
-#include "mtm_map/map.h"
 #include "assist.h"
 #include "tribe.h"
+#include "pool.h"
+#include "epoch.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
 
-#define SEPERATOR '$'
-#define BASE_TEN 10
-
-#define SEPERATOR '$'
-#define BASE_TEN 10
+#define INITIAL_CAPACITY 4
+#define GROWTH_FACTOR 2
+#define NOT_FOUND -1
+#define BLOCK_SIZE(capacity) ((capacity) * (sizeof(int64_t) + sizeof(int)) + slotCount(capacity) * sizeof(int))
+#define HASH_MIN_CAPACITY 16
+#define EMPTY_SLOT 0
+#define HASH_MULTIPLIER 0x9E3779B1u
+#define FROZEN -1
+#define FROZEN_WINNER 0
+#define FROZEN_LENGTH 1
+#define FROZEN_HEADER 2
+#define VARINT_BITS 7
+#define VARINT_MORE 0x80
 
+/*
+the names of the tribes, shared by all the tribes copied from the same tribe,
+all the tables of the schema are allocated with its allocator, and their tribe_t records
+come from its pool. the ids are kept in the order they were added, like in the tables that have all
+the tribes, so the position of a tribe in the schema is its position in those tables. the block of the
+ids has slotsFor(capacity) slots after them, an open addressed hash of the ids like the slots of a table,
+so the writer and the readers find the position of an id in one probe. lowest is the lowest id of the schema,
+the winner of a table without votes.
+epoch is NULL unless other threads read the tables of the schema (see tribeSetEpoch), then the blocks and
+names the tables and the schema stop using are retired to it, and sequence guards ids, names, capacity and
+the slots. like the fields of the tables, the size, capacity, ids, slots, names and lowest are stored and
+read by the readers atomically
+*/
+struct tribe_schema_t
+{
+    const Allocator* allocator;
+    Pool tribes;
+    int size;
+    int capacity;
+    int* ids;
+    char** names;
+    int lowest;
+    int references;
+    Epoch epoch;
+    unsigned sequence;
+};
 
+/*
+votes and ids are two parallel arrays in one block, the votes first so they are aligned,
+ids starts after capacity votes. a table of totals has all the tribes of its schema in the order
+of the schema, a sparse table (see tribeCopyEmpty) only has the tribes with votes, in any order.
+a table with a capacity of HASH_MIN_CAPACITY or more has slotCount(capacity) slots after the ids, an open
+addressed hash of its ids with linear probing, every slot is EMPTY_SLOT or the index of an id plus one.
+so a tribe is found in one probe in any order of the table, smaller tables are scanned. only the writer
+uses the slots, the readers scan the ids and the votes.
+a frozen table (see tribeFreeze) has capacity FROZEN and no votes, its ids point to one block of
+FROZEN_HEADER ints, the winner and the length of the entries, and then the entries: for every tribe
+in ascending order of ids the difference from the previous id and the votes, as varints.
+sequence guards the block and the order of the entries, a new entry is added after the others.
+readers of the epoch scan the size, ids, votes and winner of a table while the writer changes them, so the
+writer stores them with atomic stores once the table may be read, and the readers load them with atomic loads,
+inside a change of the sequence the stores are release stores and the loads of a reader are acquire loads
+*/
 struct tribe_t
 {
-    Map tribe_map;
+    struct tribe_schema_t* schema;
+    int size;
+    int capacity;
+    int* ids;
+    int64_t* votes;
+    unsigned sequence;
 };
 
-Tribe tribeCreate();
+/*
+a tribe of a table that is being frozen
+*/
+struct frozen_entry_t
+{
+    int id;
+    int64_t votes;
+};
+
+Tribe tribeCreate(const Allocator* allocator);
 void tribeDestroy(Tribe tribe);
 TribeResult tribeAdd(Tribe tribe, int tribe_id, const char* tribe_name);
+TribeResult tribeAppend(Tribe tribe, int tribe_id, const char* tribe_name);
 TribeResult tribeSetName(Tribe tribe, int tribe_id, const char* tribe_name);
 TribeResult tribeRemove(Tribe tribe, int tribe_id);
+void tribeRemoveSorted(Tribe tribe, const int* sorted_ids, int count);
+void tribeRemoveSortedEntries(Tribe tribe, const int* sorted_ids, int count);
 Tribe tribeCopy(Tribe tribe);
-static char* combineStringsWithSperation(const char* str1, const char* str2);
-static char* createStringOfTribeNameAndVotes(const char* tribe_name, int num_of_votes);
+Tribe tribeCopyWithZeroVotes(Tribe tribe);
+Tribe tribeCopyEmpty(Tribe tribe);
 char* tribeGetName(Tribe tribe, int tribe_id);
-static int getIntAfterSperator(const char* str);
-static char* getStringBeforeSperator(const char* str);
-static int getVotesFromTribeById(Tribe tribe, int tribe_id);
-TribeResult tribeUpdateVote(Tribe tribe, int tribe_id, int num_of_votes, UpdateVotesCondition condition);
-static TribeResult handleMapResult(MapResult result);
-char* tribeGetMaxVotesForArea(Tribe tribe);
+TribeResult tribeUpdateVote(Tribe tribe, Tribe totals, int tribe_id, int num_of_votes,
+                            UpdateVotesCondition condition, bool saturate, int64_t* change);
+void tribeAddToVotes(Tribe tribe, int tribe_id, int64_t change);
+void tribeAddAllVotes(Tribe totals, Tribe tribe, int sign);
+void tribeMergeTotals(Tribe totals, Tribe tribe);
+int tribeGetMaxVotesForArea(Tribe tribe);
+int tribeGetTable(Tribe tribe, const int** ids, const int64_t** votes);
 bool tribeContains(Tribe tribe, int tribe_id);
+bool tribeSchemaContains(Tribe tribe, int tribe_id);
+void tribePrefetch(Tribe tribe);
+void tribePrefetchVotes(Tribe tribe);
+void tribeSetAllVotesToZero(Tribe tribe);
+TribeResult tribeFreeze(Tribe tribe);
+void tribeSetEpoch(Tribe tribe, Epoch epoch);
+int tribeReadWinner(Tribe tribe);
+char* tribeReadName(Tribe tribe, int tribe_id);
+int64_t tribeGetVotes(Tribe tribe, int tribe_id);
+const char* tribeFindName(Tribe tribe, int tribe_id);
+static struct tribe_schema_t* schemaCreate(const Allocator* allocator);
+static void schemaRelease(struct tribe_schema_t* schema);
+static int schemaFind(struct tribe_schema_t* schema, int tribe_id);
+static TribeResult schemaAdd(struct tribe_schema_t* schema, int tribe_id, const char* tribe_name);
+static void schemaRemove(struct tribe_schema_t* schema, int tribe_id);
+static char* copyName(const Allocator* allocator, const char* name);
+static int findTribe(Tribe tribe, int tribe_id);
+static bool growTable(Tribe tribe);
+static void removeEntry(Tribe tribe, int index);
+static int slotCount(int capacity);
+static int slotsFor(int capacity);
+static int* tableSlots(Tribe tribe);
+static int firstSlot(int tribe_id, int slot_count);
+static void slotsPut(Tribe tribe, int index);
+static void slotsRemove(Tribe tribe, int tribe_id);
+static void slotsSet(Tribe tribe, int tribe_id, int index);
+static void slotsRebuild(Tribe tribe);
+static int indexFind(const int* ids, int capacity, int size, int tribe_id);
+static void indexPut(int* ids, int capacity, int position);
+static void indexRebuild(int* ids, int capacity, int size);
+static int findWinner(const int* ids, const int64_t* votes, int size);
+static int readWinner(const int* ids, const int64_t* votes, int size);
+static uint8_t* frozenEntries(Tribe tribe);
+static int readEntry(const uint8_t* entries, int offset, int* tribe_id, int64_t* votes);
+static int frozenWinner(Tribe tribe);
+static void removeFrozenSorted(Tribe tribe, const int* sorted_ids, int count);
+static int varintSize(uint64_t value);
+static int writeVarint(uint8_t* bytes, int offset, uint64_t value);
+static int readVarint(const uint8_t* bytes, int offset, uint64_t* value);
+static int compareEntries(const void* entry1, const void* entry2);
+static Tribe copyTable(Tribe tribe, bool copy_votes);
+static int compareIds(const void* id1, const void* id2);
+static void releaseTable(void* context, void* tribe);
+static void releaseName(void* allocator, void* name);
 
 bool tribeContains(Tribe tribe, int tribe_id)
 {
@@ -44,24 +160,37 @@ bool tribeContains(Tribe tribe, int tribe_id)
     {
         return false;
     }
-    char* string_id = intToString(tribe_id);
-    bool result = mapContains(tribe->tribe_map, string_id);
-    destroyString(string_id);
-    return result;
+    return findTribe(tribe, tribe_id) != NOT_FOUND;
 }
-Tribe tribeCreate()
+
+bool tribeSchemaContains(Tribe tribe, int tribe_id)
 {
-    Tribe tribe = malloc(sizeof(*tribe));
     if (tribe == NULL)
+    {
+        return false;
+    }
+    return schemaFind(tribe->schema, tribe_id) != NOT_FOUND;
+}
+
+Tribe tribeCreate(const Allocator* allocator)
+{
+    struct tribe_schema_t* schema = schemaCreate(allocator);
+    if (schema == NULL)
     {
         return NULL;
     }
-    tribe->tribe_map = mapCreate();
-    if (tribe->tribe_map == NULL) //allocation failed
+    Tribe tribe = poolAllocate(schema->tribes);
+    if (tribe == NULL) //allocation failed
     {
-        free(tribe);
+        schemaRelease(schema);
         return NULL;
     }
+    tribe->schema = schema;
+    tribe->size = 0;
+    tribe->capacity = 0;
+    tribe->ids = NULL;
+    tribe->votes = NULL;
+    tribe->sequence = 0;
     return tribe;
 }
 
@@ -69,298 +198,1129 @@ void tribeDestroy(Tribe tribe)
 {
     if (tribe != NULL)
     {
-        mapDestroy(tribe->tribe_map);
-        free(tribe);
+        epochRetire(tribe->schema->epoch, releaseTable, NULL, tribe);//right away unless the table may be read
     }
 }
 
 TribeResult tribeAdd(Tribe tribe, int tribe_id, const char* tribe_name)
 {
-    assert(tribe != NULL);
-    char* tribe_id_in_string = intToString(tribe_id);
-    if (mapContains(tribe->tribe_map, tribe_id_in_string))
+    assert(tribe != NULL && tribe_name != NULL);
+    if (findTribe(tribe, tribe_id) != NOT_FOUND)
     {
-        free(tribe_id_in_string);
         return TRIBE_ITEM_ALREADY_EXISTS;
     }
-    if (tribe_id_in_string == NULL)
+    return tribeAppend(tribe, tribe_id, tribe_name);
+}
+
+TribeResult tribeAppend(Tribe tribe, int tribe_id, const char* tribe_name)
+{
+    assert(tribe != NULL && tribe_name != NULL && tribe->capacity != FROZEN);
+    if (tribe->size == tribe->capacity && !growTable(tribe)) //grown first so a failure leaves no name behind
     {
         return TRIBE_OUT_OF_MEMORY;
-    }                                                                           //the tribe is new
-    char* combined_votes_name = createStringOfTribeNameAndVotes(tribe_name, 0); //initial value of votes 0
-    if (combined_votes_name == NULL)
+    }
+    if (schemaFind(tribe->schema, tribe_id) == NOT_FOUND) //the first table to get this tribe adds its name
     {
-        destroyString(tribe_id_in_string);
-        return TRIBE_OUT_OF_MEMORY;
+        TribeResult result = schemaAdd(tribe->schema, tribe_id, tribe_name);
+        if (result != TRIBE_SUCCESS)
+        {
+            return result;
+        }
     }
-    MapResult result = mapPut(tribe->tribe_map, (const char*)tribe_id_in_string, (const char*)combined_votes_name);
-    free(tribe_id_in_string);
-    free(combined_votes_name);
-    return handleMapResult(result);
+    tribe->ids[tribe->size] = tribe_id;
+    tribe->votes[tribe->size] = 0; //initial value of votes 0
+    slotsPut(tribe, tribe->size);
+    tribe->size++;
+    return TRIBE_SUCCESS;
 }
 
 char* tribeGetName(Tribe tribe, int tribe_id)
 {
     assert(tribe != NULL);
-    const char* tribe_id_in_string = intToString(tribe_id);
-    if (tribe_id_in_string == NULL)
-    {
-        return NULL;
-    }
-    if (!mapContains(tribe->tribe_map, tribe_id_in_string))
+    if (findTribe(tribe, tribe_id) == NOT_FOUND)
     {
-        destroyString((char*)tribe_id_in_string);
         return NULL;
     }
-    char* string_name_and_votes = mapGet(tribe->tribe_map, tribe_id_in_string);
-    destroyString((char*)tribe_id_in_string);
-    return getStringBeforeSperator(string_name_and_votes);//sperate the name from the string and return it
+    int index = schemaFind(tribe->schema, tribe_id);
+    assert(index != NOT_FOUND);
+    return copyName(allocatorDefault(), tribe->schema->names[index]); //the caller frees the name with free
 }
 
 TribeResult tribeSetName(Tribe tribe, int tribe_id, const char* tribe_name)
 {
-    assert(tribe != NULL);
-    char* id_str = intToString(tribe_id);
-    if (id_str == NULL)
+    assert(tribe != NULL && tribe_name != NULL);
+    struct tribe_schema_t* schema = tribe->schema;
+    int index = schemaFind(schema, tribe_id);//the name is of the schema, so it is found without the table
+    if (index == NOT_FOUND)
     {
-        return TRIBE_OUT_OF_MEMORY;
+        return TRIBE_ITEM_DOES_NOT_EXIST;
     }
-    if (!mapContains(tribe->tribe_map, id_str))
+    if (strcmp(schema->names[index], tribe_name) == 0) //already renamed through another tribe of the schema
     {
-        destroyString(id_str);
-        return TRIBE_ITEM_DOES_NOT_EXIST;
+        return TRIBE_SUCCESS;
     }
-    int votes = getVotesFromTribeById(tribe, tribe_id);
-    char* combined_votes_and_new_name = createStringOfTribeNameAndVotes(tribe_name, votes);
-    if (combined_votes_and_new_name == NULL)
+    char* new_name = copyName(schema->allocator, tribe_name);
+    if (new_name == NULL)
     {
         return TRIBE_OUT_OF_MEMORY;
     }
-    MapResult result = mapPut(tribe->tribe_map, id_str, combined_votes_and_new_name);
-    destroyString(id_str);
-    destroyString(combined_votes_and_new_name);
-    return handleMapResult(result);
+    char* old_name = schema->names[index];
+    __atomic_store_n(&schema->names[index], new_name, __ATOMIC_RELEASE);
+    epochRetire(schema->epoch, releaseName, (void*)schema->allocator, old_name);
+    return TRIBE_SUCCESS;
 }
 
 TribeResult tribeRemove(Tribe tribe, int tribe_id)
 {
     assert(tribe != NULL);
-    char* id_str = intToString(tribe_id);
-    if (id_str == NULL)
+    int index = findTribe(tribe, tribe_id);
+    if (index == NOT_FOUND)
     {
-        return TRIBE_OUT_OF_MEMORY;
+        return TRIBE_ITEM_DOES_NOT_EXIST;
     }
-    MapResult result = mapRemove(tribe->tribe_map, id_str);
-    destroyString(id_str);
-    return handleMapResult(result);
+    int to_move = tribe->size - index - 1; //keep the order of the rest of the tribes
+    memmove(tribe->ids + index, tribe->ids + index + 1, to_move * sizeof(int));
+    memmove(tribe->votes + index, tribe->votes + index + 1, to_move * sizeof(int64_t));
+    tribe->size--;
+    slotsRebuild(tribe);//the tribes after it moved
+    schemaRemove(tribe->schema, tribe_id); //does nothing if another tribe of the schema removed it
+    return TRIBE_SUCCESS;
 }
 
-TribeResult tribeUpdateVote(Tribe tribe, int tribe_id, int num_of_votes, UpdateVotesCondition condition)
+void tribeRemoveSorted(Tribe tribe, const int* sorted_ids, int count)
 {
-    assert(tribe_id >= 0 && num_of_votes >= 0 && tribe != NULL);
-    int previeous_votes, updated_votes;
-    char* id_str = intToString(tribe_id);
-    if (id_str == NULL)
+    tribeRemoveSortedEntries(tribe, sorted_ids, count);
+    for (int i = 0; i < count; i++)
     {
-        return TRIBE_OUT_OF_MEMORY;
+        schemaRemove(tribe->schema, sorted_ids[i]); //does nothing if another tribe of the schema removed it
     }
-    if (!mapContains(tribe->tribe_map, id_str))
+}
+
+void tribeRemoveSortedEntries(Tribe tribe, const int* sorted_ids, int count)
+{
+    assert(tribe != NULL && sorted_ids != NULL);
+    epochBeginChange(&tribe->sequence);
+    if (tribe->capacity == FROZEN)
+    {
+        removeFrozenSorted(tribe, sorted_ids, count);
+    }
+    else
+    {
+        int kept = 0;
+        for (int i = 0; i < tribe->size; i++)//compact the table once, keeping the order
+        {
+            if (bsearch(&tribe->ids[i], sorted_ids, count, sizeof(int), compareIds) == NULL)
+            {
+                __atomic_store_n(&tribe->ids[kept], tribe->ids[i], __ATOMIC_RELEASE);
+                __atomic_store_n(&tribe->votes[kept], tribe->votes[i], __ATOMIC_RELEASE);
+                kept++;
+            }
+        }
+        __atomic_store_n(&tribe->size, kept, __ATOMIC_RELEASE);
+        slotsRebuild(tribe);
+    }
+    epochEndChange(&tribe->sequence);
+}
+
+TribeResult tribeUpdateVote(Tribe tribe, Tribe totals, int tribe_id, int num_of_votes,
+                            UpdateVotesCondition condition, bool saturate, int64_t* change)
+{
+    assert(tribe_id >= 0 && num_of_votes >= 0 && tribe != NULL && totals != NULL);
+    int total_index = findTribe(totals, tribe_id);//totals has all the tribes, the sparse table may not
+    if (total_index == NOT_FOUND)
     {
-        destroyString(id_str);
         return TRIBE_ITEM_DOES_NOT_EXIST;
     }
-    char* name = tribeGetName(tribe, tribe_id);
-    if (name == NULL)
+    int64_t votes_to_update = num_of_votes, new_total;
+    if (!condition(totals->votes[total_index], votes_to_update, &new_total))
     {
-        return TRIBE_OUT_OF_MEMORY;
+        if (!saturate)
+        {
+            return TRIBE_VOTES_OVERFLOW;
+        }
+        votes_to_update = new_total - totals->votes[total_index];//only adding overflows, up to the saturated total
+    }
+    if (tribe->capacity == FROZEN)
+    {
+        return TRIBE_FROZEN;
+    }
+    int index = findTribe(tribe, tribe_id);
+    int64_t old_votes = index == NOT_FOUND ? 0 : tribe->votes[index], new_votes;
+    condition(old_votes, votes_to_update, &new_votes);//can't overflow, the total didn't
+    if (index == NOT_FOUND && new_votes != 0)//the first votes of the tribe in this table
+    {
+        if (tribe->size == tribe->capacity && !growTable(tribe))//grown first so a failure changes nothing
+        {
+            return TRIBE_OUT_OF_MEMORY;
+        }
+        index = tribe->size;
+        __atomic_store_n(&tribe->ids[index], tribe_id, __ATOMIC_RELAXED);
+        __atomic_store_n(&tribe->votes[index], new_votes, __ATOMIC_RELAXED);
+        slotsPut(tribe, index);
+        __atomic_store_n(&tribe->size, index + 1, __ATOMIC_RELEASE);//a reader that sees the entry sees all of it
+    }
+    if (index != NOT_FOUND)
+    {
+        __atomic_store_n(&tribe->votes[index], new_votes, __ATOMIC_RELAXED);
+        if (new_votes == 0)
+        {
+            removeEntry(tribe, index);//a tribe without votes isn't kept, it counts as zero votes
+        }
+    }
+    totals->votes[total_index] += new_votes - old_votes;
+    if (change != NULL)
+    {
+        *change = new_votes - old_votes;
+    }
+    return TRIBE_SUCCESS;
+}
+
+void tribeAddToVotes(Tribe tribe, int tribe_id, int64_t change)
+{
+    assert(tribe != NULL);
+    int index = findTribe(tribe, tribe_id);
+    assert(index != NOT_FOUND);
+    tribe->votes[index] += change;
+}
+
+void tribeAddAllVotes(Tribe totals, Tribe tribe, int sign)
+{
+    assert(totals != NULL && tribe != NULL && totals != tribe && totals->schema == tribe->schema);
+    if (tribe->capacity == FROZEN)
+    {
+        const uint8_t* entries = frozenEntries(tribe);
+        int tribe_id = 0;
+        int64_t votes;
+        for (int i = 0, offset = 0; i < tribe->size; i++)
+        {
+            offset = readEntry(entries, offset, &tribe_id, &votes);
+            int index = findTribe(totals, tribe_id);
+            assert(index != NOT_FOUND);
+            totals->votes[index] += sign * votes;
+        }
+        return;
+    }
+    for (int i = 0; i < tribe->size; i++)//only the tribes the table has, every one is found in one probe
+    {
+        int index = findTribe(totals, tribe->ids[i]);
+        assert(index != NOT_FOUND);
+        totals->votes[index] += sign * tribe->votes[i];
+    }
+}
+
+void tribeMergeTotals(Tribe totals, Tribe tribe)
+{
+    assert(totals != NULL && tribe != NULL && totals != tribe && totals->size == tribe->size);
+    assert(totals->capacity != FROZEN && tribe->capacity != FROZEN);
+    for (int i = 0; i < tribe->size; i++)//same order, so every tribe is found in its first probe
+    {
+        int index = findTribe(totals, tribe->ids[i]);
+        assert(index != NOT_FOUND);
+        int64_t votes = totals->votes[index];//totals aren't negative
+        totals->votes[index] = tribe->votes[i] > INT64_MAX - votes ? INT64_MAX : votes + tribe->votes[i];
     }
-    previeous_votes = getVotesFromTribeById(tribe, tribe_id);
-    updated_votes = condition(previeous_votes, num_of_votes);
-    char* combined_updated_votes_name = createStringOfTribeNameAndVotes((const char*)name, updated_votes);
-    destroyString(tribeGetName(tribe, tribe_id));
-    MapResult result = mapPut(tribe->tribe_map, id_str, combined_updated_votes_name);
-    destroyString(id_str);
-    destroyString(name);
-    destroyString(combined_updated_votes_name);
-    return handleMapResult(result);
 }
 
 Tribe tribeCopy(Tribe tribe)
 {
-    Tribe tribe_copy = tribeCreate();
-    if (tribe_copy == NULL)
+    return copyTable(tribe, true);
+}
+
+Tribe tribeCopyWithZeroVotes(Tribe tribe)
+{
+    return copyTable(tribe, false);
+}
+
+Tribe tribeCopyEmpty(Tribe tribe)
+{
+    assert(tribe != NULL);
+    Tribe empty = poolAllocate(tribe->schema->tribes);
+    if (empty == NULL)
     {
         return NULL;
     }
-    Map tribe_map_copy = mapCopy(tribe->tribe_map);
-    if (tribe_map_copy == NULL)
+    empty->schema = tribe->schema;
+    empty->size = 0;
+    empty->capacity = 0;
+    empty->ids = NULL;
+    empty->votes = NULL;
+    empty->sequence = 0;
+    tribe->schema->references++;
+    return empty;
+}
+
+int tribeGetMaxVotesForArea(Tribe tribe)
+{
+    if (tribe == NULL)
     {
+        return NOT_FOUND;
+    }
+    int winner = tribe->capacity == FROZEN ? tribe->ids[FROZEN_WINNER] : findWinner(tribe->ids, tribe->votes, tribe->size);
+    if (winner == NOT_FOUND)//no tribe has votes, so all of them tie, with the tribes the table doesn't have too
+    {
+        return tribe->schema->lowest;
+    }
+    return winner;
+}
 
-        tribeDestroy(tribe_copy);
-        return NULL;
+int64_t tribeGetVotes(Tribe tribe, int tribe_id)
+{
+    assert(tribe != NULL);
+    if (tribe->capacity != FROZEN)
+    {
+        int index = findTribe(tribe, tribe_id);
+        return index == NOT_FOUND ? 0 : tribe->votes[index];
     }
-    mapDestroy(tribe_copy->tribe_map);
-    tribe_copy->tribe_map = tribe_map_copy;
-    return tribe_copy;
+    const uint8_t* entries = frozenEntries(tribe);
+    int entry_id = 0;
+    int64_t votes;
+    for (int i = 0, offset = 0; i < tribe->size; i++)
+    {
+        offset = readEntry(entries, offset, &entry_id, &votes);
+        if (entry_id >= tribe_id)//the ids are ascending, so the rest are higher
+        {
+            return entry_id == tribe_id ? votes : 0;
+        }
+    }
+    return 0;
+}
+
+const char* tribeFindName(Tribe tribe, int tribe_id)
+{
+    assert(tribe != NULL);
+    int index = schemaFind(tribe->schema, tribe_id);
+    return index == NOT_FOUND ? NULL : tribe->schema->names[index];
+}
+
+int tribeGetTable(Tribe tribe, const int** ids, const int64_t** votes)
+{
+    assert(tribe != NULL && ids != NULL && votes != NULL && tribe->capacity != FROZEN);
+    *ids = tribe->ids;
+    *votes = tribe->votes;
+    return tribe->size;
+}
+
+void tribePrefetch(Tribe tribe)
+{
+    __builtin_prefetch(tribe);
 }
 
-char* tribeGetMaxVotesForArea(Tribe tribe)
+void tribePrefetchVotes(Tribe tribe)
 {
-    if (tribe == NULL || tribe->tribe_map == NULL)
+    assert(tribe != NULL);
+    __builtin_prefetch(tribe->votes);//a prefetch of NULL doesn't fault, an empty table has no block
+    __builtin_prefetch(tribe->ids);//the same line as the votes in small tables
+}
+
+void tribeSetAllVotesToZero(Tribe tribe)
+{
+    assert(tribe != NULL && tribe->capacity != FROZEN);
+    if (tribe->size > 0)
     {
-        return NULL;
+        memset(tribe->votes, 0, tribe->size * sizeof(int64_t));
+    }
+}
+
+TribeResult tribeFreeze(Tribe tribe)
+{
+    assert(tribe != NULL);
+    if (tribe->capacity == FROZEN)
+    {
+        return TRIBE_SUCCESS;
     }
-    int max_votes = 0, current_tribe_votes;
-    char* max_id;
-    Map tribe_map_copy = tribe->tribe_map;
-    if (tribe_map_copy == NULL)
+    const Allocator* allocator = tribe->schema->allocator;
+    struct frozen_entry_t* entries = allocatorAllocate(allocator, tribe->size * sizeof(*entries) + 1);//+1 so no entries is not a NULL
+    if (entries == NULL)
+    {
+        return TRIBE_OUT_OF_MEMORY;
+    }
+    int length = 0, previous_id = 0;
+    for (int i = 0; i < tribe->size; i++)
+    {
+        entries[i].id = tribe->ids[i];
+        entries[i].votes = tribe->votes[i];
+    }
+    qsort(entries, tribe->size, sizeof(*entries), compareEntries);//sorted, so the ids are small differences
+    for (int i = 0; i < tribe->size; i++)
+    {
+        length += varintSize((uint64_t)(entries[i].id - previous_id)) + varintSize((uint64_t)entries[i].votes);
+        previous_id = entries[i].id;
+    }
+    int* block = allocatorAllocate(allocator, FROZEN_HEADER * sizeof(int) + length);
+    if (block == NULL)
+    {
+        allocatorDeallocate(allocator, entries);
+        return TRIBE_OUT_OF_MEMORY;
+    }
+    block[FROZEN_WINNER] = findWinner(tribe->ids, tribe->votes, tribe->size);
+    block[FROZEN_LENGTH] = length;
+    uint8_t* bytes = (uint8_t*)(block + FROZEN_HEADER);
+    int offset = 0;
+    previous_id = 0;
+    for (int i = 0; i < tribe->size; i++)
+    {
+        offset = writeVarint(bytes, offset, (uint64_t)(entries[i].id - previous_id));
+        offset = writeVarint(bytes, offset, (uint64_t)entries[i].votes);
+        previous_id = entries[i].id;
+    }
+    allocatorDeallocate(allocator, entries);
+    int64_t* old_block = tribe->votes;
+    epochBeginChange(&tribe->sequence);
+    __atomic_store_n(&tribe->ids, block, __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->votes, NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->capacity, FROZEN, __ATOMIC_RELEASE);
+    epochEndChange(&tribe->sequence);
+    epochRetireBlock(tribe->schema->epoch, allocator, old_block);
+    return TRIBE_SUCCESS;
+}
+
+void tribeSetEpoch(Tribe tribe, Epoch epoch)
+{
+    assert(tribe != NULL);
+    tribe->schema->epoch = epoch;
+}
+
+int tribeReadWinner(Tribe tribe)
+{
+    assert(tribe != NULL);
+    int winner;
+    for (;;)
+    {
+        unsigned start = epochReadBegin(&tribe->sequence);
+        int capacity = __atomic_load_n(&tribe->capacity, __ATOMIC_ACQUIRE);
+        int* ids = __atomic_load_n(&tribe->ids, __ATOMIC_ACQUIRE);
+        int64_t* votes = __atomic_load_n(&tribe->votes, __ATOMIC_ACQUIRE);
+        int size = __atomic_load_n(&tribe->size, __ATOMIC_ACQUIRE);
+        if (epochReadRetry(&tribe->sequence, start))//the block and the size have to match before the scan
+        {
+            continue;
+        }
+        winner = capacity == FROZEN ? __atomic_load_n(&ids[FROZEN_WINNER], __ATOMIC_ACQUIRE) :
+                                      readWinner(ids, votes, size);
+        if (!epochReadRetry(&tribe->sequence, start))//no entry moved during the scan
+        {
+            break;
+        }
+    }
+    return winner == NOT_FOUND ? __atomic_load_n(&tribe->schema->lowest, __ATOMIC_RELAXED) : winner;
+}
+
+char* tribeReadName(Tribe tribe, int tribe_id)
+{
+    assert(tribe != NULL);
+    struct tribe_schema_t* schema = tribe->schema;
+    for (;;)
+    {
+        unsigned start = epochReadBegin(&schema->sequence);
+        int* ids = __atomic_load_n(&schema->ids, __ATOMIC_ACQUIRE);
+        char** names = __atomic_load_n(&schema->names, __ATOMIC_ACQUIRE);
+        int capacity = __atomic_load_n(&schema->capacity, __ATOMIC_ACQUIRE);
+        int size = __atomic_load_n(&schema->size, __ATOMIC_ACQUIRE);
+        if (epochReadRetry(&schema->sequence, start))//the block, its capacity and the size have to match
+        {
+            continue;
+        }
+        int position = indexFind(ids, capacity, size, tribe_id);
+        const char* name = position == NOT_FOUND ? NULL : __atomic_load_n(&names[position], __ATOMIC_ACQUIRE);
+        char* copy = name == NULL ? NULL : copyName(allocatorDefault(), name);//the name is retired, not freed
+        if (!epochReadRetry(&schema->sequence, start))
+        {
+            return copy;
+        }
+        destroyString(allocatorDefault(), copy);
+    }
+}
+
+/*
+allocates an empty schema with one reference
+return NULL if allocation failed
+*/
+static struct tribe_schema_t* schemaCreate(const Allocator* allocator)
+{
+    struct tribe_schema_t* schema = allocatorAllocate(allocator, sizeof(*schema));
+    if (schema == NULL)
     {
         return NULL;
     }
-    char* current_key = mapGetFirst(tribe_map_copy);
-    if (current_key == NULL)
+    schema->tribes = poolCreate(allocator, sizeof(struct tribe_t));
+    if (schema->tribes == NULL)
     {
+        allocatorDeallocate(allocator, schema);
         return NULL;
     }
-    max_id = current_key;
-    max_votes = getVotesFromTribeById(tribe, stringToInt(current_key));
-    while (current_key != NULL)
+    schema->allocator = allocator;
+    schema->size = 0;
+    schema->capacity = 0;
+    schema->ids = NULL;
+    schema->names = NULL;
+    schema->lowest = NOT_FOUND;
+    schema->references = 1;
+    schema->epoch = NULL;
+    schema->sequence = 0;
+    return schema;
+}
+
+/*
+drops one reference to the schema, the last reference deallocates it with all the names
+*/
+static void schemaRelease(struct tribe_schema_t* schema)
+{
+    assert(schema != NULL && schema->references > 0);
+    schema->references--;
+    if (schema->references > 0)
     {
-        current_tribe_votes = getVotesFromTribeById(tribe, stringToInt(current_key));
-        if (current_tribe_votes > max_votes)
+        return;
+    }
+    for (int i = 0; i < schema->size; i++)
+    {
+        destroyString(schema->allocator, schema->names[i]);
+    }
+    allocatorDeallocate(schema->allocator, schema->ids);
+    allocatorDeallocate(schema->allocator, schema->names);
+    poolDestroy(schema->tribes);
+    allocatorDeallocate(schema->allocator, schema);
+}
+
+/*
+return the index of the given id in the schema or NOT_FOUND, one probe of its slots
+*/
+static int schemaFind(struct tribe_schema_t* schema, int tribe_id)
+{
+    return indexFind(schema->ids, schema->capacity, schema->size, tribe_id);
+}
+
+/*
+adds a copy of the given name under the given id to the schema
+*/
+static TribeResult schemaAdd(struct tribe_schema_t* schema, int tribe_id, const char* tribe_name)
+{
+    if (schema->size == schema->capacity)
+    {//with readers the arrays are copied, and the old ones retired once the new ones are in place
+        int new_capacity = schema->capacity == 0 ? INITIAL_CAPACITY : schema->capacity * GROWTH_FACTOR;
+        int* old_ids = schema->ids;
+        char** old_names = schema->names;
+        int* new_ids = epochReallocate(schema->epoch, schema->allocator, old_ids, schema->size * sizeof(int),
+                                       (new_capacity + slotsFor(new_capacity)) * sizeof(int));
+        if (new_ids == NULL)
         {
-            max_votes = getVotesFromTribeById(tribe, stringToInt(current_key));
-            max_id = current_key;
+            return TRIBE_OUT_OF_MEMORY;
         }
-        if (current_tribe_votes == max_votes)//if it has the same amount of votes choose the one with the lower tribe id
+        char** new_names = epochReallocate(schema->epoch, schema->allocator, old_names,
+                                           schema->size * sizeof(char*), new_capacity * sizeof(char*));
+        if (new_names == NULL)
         {
-            if (stringToInt(max_id) > stringToInt(current_key))//found a new max
+            if (schema->epoch != NULL)
             {
-                max_id = current_key;//update the max id
-                max_votes = getVotesFromTribeById(tribe, stringToInt(current_key));// update the max vote
+                allocatorDeallocate(schema->allocator, new_ids);
             }
+            else
+            {
+                schema->ids = new_ids;//reallocated with the old ids and their slots in place, with room for all of them
+            }
+            return TRIBE_OUT_OF_MEMORY;
+        }
+        indexRebuild(new_ids, new_capacity, schema->size);//no reader has the new block yet
+        epochBeginChange(&schema->sequence);
+        __atomic_store_n(&schema->ids, new_ids, __ATOMIC_RELEASE);
+        __atomic_store_n(&schema->names, new_names, __ATOMIC_RELEASE);
+        __atomic_store_n(&schema->capacity, new_capacity, __ATOMIC_RELEASE);
+        epochEndChange(&schema->sequence);
+        if (schema->epoch != NULL)
+        {
+            epochRetireBlock(schema->epoch, schema->allocator, old_ids);
+            epochRetireBlock(schema->epoch, schema->allocator, old_names);
         }
-        current_key = mapGetNext(tribe_map_copy);
     }
+    char* name = copyName(schema->allocator, tribe_name);
+    if (name == NULL)
+    {
+        return TRIBE_OUT_OF_MEMORY;
+    }
+    __atomic_store_n(&schema->ids[schema->size], tribe_id, __ATOMIC_RELAXED);
+    __atomic_store_n(&schema->names[schema->size], name, __ATOMIC_RELEASE);
+    indexPut(schema->ids, schema->capacity, schema->size);
+    __atomic_store_n(&schema->size, schema->size + 1, __ATOMIC_RELEASE);//a reader that sees the tribe sees its name
+    if (schema->lowest == NOT_FOUND || tribe_id < schema->lowest)
+    {
+        __atomic_store_n(&schema->lowest, tribe_id, __ATOMIC_RELAXED);
+    }
+    return TRIBE_SUCCESS;
+}
 
-    return max_id;
+/*
+removes the given id from the schema if it is there, the rest of the ids keep their order
+*/
+static void schemaRemove(struct tribe_schema_t* schema, int tribe_id)
+{
+    int index = schemaFind(schema, tribe_id);
+    if (index == NOT_FOUND)
+    {
+        return;
+    }
+    char* name = schema->names[index];
+    epochBeginChange(&schema->sequence);
+    __atomic_store_n(&schema->size, schema->size - 1, __ATOMIC_RELEASE);
+    for (int i = index; i < schema->size; i++)//moved one at a time, a reader may be reading them
+    {
+        __atomic_store_n(&schema->ids[i], schema->ids[i + 1], __ATOMIC_RELEASE);
+        __atomic_store_n(&schema->names[i], schema->names[i + 1], __ATOMIC_RELEASE);
+    }
+    indexRebuild(schema->ids, schema->capacity, schema->size);//the ids after the removed one moved
+    epochEndChange(&schema->sequence);
+    epochRetire(schema->epoch, releaseName, (void*)schema->allocator, name);
+    if (tribe_id == schema->lowest)
+    {
+        int lowest = schema->size == 0 ? NOT_FOUND : schema->ids[0];
+        for (int i = 1; i < schema->size; i++)
+        {
+            if (schema->ids[i] < lowest)
+            {
+                lowest = schema->ids[i];
+            }
+        }
+        __atomic_store_n(&schema->lowest, lowest, __ATOMIC_RELAXED);
+    }
 }
 
 /*
-gets two strings, return a new string with a char speration between them(see define SPERATOR)
-return NULL if allocation failed
+return a copy (by value) of the given name or NULL if allocation failed
 */
-static char* combineStringsWithSperation(const char* str1, const char* str2)
+static char* copyName(const Allocator* allocator, const char* name)
 {
-    assert(str1 != NULL && str2 != NULL);
-    int new_str_size = strlen(str1) + 1 + strlen(str2); //1 for sperator, 1 for end of string
-    char* new_str = createString(new_str_size);
-    if (new_str == NULL)
+    assert(name != NULL);
+    char* copy = createString(allocator, strlen(name));
+    if (copy == NULL)
     {
         return NULL;
     }
-    strncpy(new_str, (const char*)str1, strlen(str1));                    //copy the name
-    strncpy(new_str + strlen(str1) + 1, (const char*)str2, strlen(str2)); //copy the votes
-    new_str[strlen(str1)] = SEPERATOR;                                     //add sperator
-    return new_str;
+    strcpy(copy, name);
+    return copy;
 }
+
 /*
-get the tribe name and the num of votes to the tribe, create a strig (copy by value) of the two with the
-SPERATOR sign in the middle if the memory allocation failed return NULL
+return the index of the given id in the tribe table or NOT_FOUND. a table with slots finds it in one
+probe of its slots. a small table of totals has the id in its position in the schema, otherwise it is
+looked for in the table, which also finds the ids another table of the schema already removed from it
 */
-static char* createStringOfTribeNameAndVotes(const char* tribe_name, int num_of_votes)
+static int findTribe(Tribe tribe, int tribe_id)
 {
-    assert(tribe_name != NULL);
-    char* votes_str = intToString(num_of_votes);
-    if (votes_str == NULL)
+    assert(tribe->capacity != FROZEN);
+    int* slots = tableSlots(tribe);
+    if (slots != NULL)
     {
-        return NULL;
+        int mask = slotCount(tribe->capacity) - 1;
+        for (int slot = firstSlot(tribe_id, mask + 1); slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+        {
+            if (tribe->ids[slots[slot] - 1] == tribe_id)
+            {
+                return slots[slot] - 1;
+            }
+        }
+        return NOT_FOUND;
     }
-    char* combined_str = combineStringsWithSperation(tribe_name, (const char*)votes_str);
-    if (combined_str == NULL)
+    int position = schemaFind(tribe->schema, tribe_id);
+    if (position != NOT_FOUND && position < tribe->size && tribe->ids[position] == tribe_id)
     {
-        destroyString(votes_str);
-        return NULL;
+        return position;
     }
-    destroyString(votes_str);
-    return combined_str;
+    for (int i = 0; i < tribe->size; i++)
+    {
+        if (tribe->ids[i] == tribe_id)
+        {
+            return i;
+        }
+    }
+    return NOT_FOUND;
 }
+
 /*
-get a string and return the str after the SPERATOR
+grows the block of the tribe table, the ids are moved to their new place after the votes
+return false if allocation failed, the table is unchanged in that case
 */
-static int getIntAfterSperator(const char* str)
+static bool growTable(Tribe tribe)
 {
-    assert(str != NULL);
-    char* sperator_place = strchr(str, SEPERATOR);
-    assert(sperator_place != NULL);
-    return stringToInt((const char*)(sperator_place + 1));
+    Epoch epoch = tribe->schema->epoch;
+    int new_capacity = tribe->capacity == 0 ? INITIAL_CAPACITY : tribe->capacity * GROWTH_FACTOR;
+    int64_t* old_block = tribe->votes;
+    //the votes are copied by epochReallocate, the ids move from after the old capacity to after the new one
+    int64_t* block = epochReallocate(epoch, tribe->schema->allocator, old_block, tribe->size * sizeof(int64_t),
+                                     BLOCK_SIZE(new_capacity));
+    if (block == NULL)
+    {
+        return false;
+    }
+    if (tribe->size > 0)
+    {
+        memmove(block + new_capacity, epoch != NULL ? (void*)tribe->ids : (void*)(block + tribe->capacity),
+                tribe->size * sizeof(int));
+    }
+    epochBeginChange(&tribe->sequence);
+    __atomic_store_n(&tribe->votes, block, __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->ids, (int*)(block + new_capacity), __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->capacity, new_capacity, __ATOMIC_RELEASE);
+    epochEndChange(&tribe->sequence);
+    slotsRebuild(tribe);//the slots are after the ids, they aren't read by the readers
+    if (epoch != NULL)
+    {
+        epochRetireBlock(epoch, tribe->schema->allocator, old_block);
+    }
+    return true;
 }
+
 /*
-get a pointer to a string and return
+removes the tribe in the given index of a sparse table, the last tribe moves to its place
+and its slot is changed to the index
 */
-static char* getStringBeforeSperator(const char* str)
+static void removeEntry(Tribe tribe, int index)
 {
-    assert(str != NULL);
-    char* sperator_place = strchr(str, SEPERATOR);  //return a pointer to the first charachter equals to Sperator
-    char* name = createString((int)(sperator_place - str)); //we dont include sperator so -1
-    if (name == NULL)
+    int last = tribe->size - 1;
+    slotsRemove(tribe, tribe->ids[index]);
+    if (index != last)
     {
-        return NULL;
+        slotsSet(tribe, tribe->ids[last], index);
     }
-    strncpy(name, (const char*)str, sperator_place - str);
-    return name;
+    epochBeginChange(&tribe->sequence);
+    __atomic_store_n(&tribe->size, last, __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->ids[index], tribe->ids[last], __ATOMIC_RELEASE);
+    __atomic_store_n(&tribe->votes[index], tribe->votes[last], __ATOMIC_RELEASE);
+    epochEndChange(&tribe->sequence);
 }
+
 /*
-look for a tribe by the given id and return the number of votes from this tribe
+return the number of slots of a table of the given capacity, a power of two that is at least twice
+the capacity, or 0 for a table that is scanned
 */
-static int getVotesFromTribeById(Tribe tribe, int tribe_id)
+static int slotCount(int capacity)
 {
-    assert(tribe != NULL);
-    char* tribe_id_in_string = intToString(tribe_id);
-    assert(tribe_id_in_string != NULL);
-    char* combined_name_and_votes = mapGet(tribe->tribe_map, (const char*)tribe_id_in_string);
-    assert(combined_name_and_votes != NULL);
-    destroyString(tribe_id_in_string);
-    return getIntAfterSperator(combined_name_and_votes);
+    return capacity < HASH_MIN_CAPACITY ? 0 : slotsFor(capacity);
 }
+
 /*
-handle the results from map
+return the number of slots of a hash of the given capacity, a power of two that is at least twice the capacity
 */
-static TribeResult handleMapResult(MapResult result)
+static int slotsFor(int capacity)
 {
-    switch (result)
+    int count = 1;
+    while (count < 2 * capacity)
     {
-    case MAP_SUCCESS:
-        return TRIBE_SUCCESS;
-    case MAP_OUT_OF_MEMORY:
-        return TRIBE_OUT_OF_MEMORY;
-    case MAP_NULL_ARGUMENT:
-        return TRIBE_NULL_ARGUMENT;
-    case MAP_ITEM_ALREADY_EXISTS:
-        return TRIBE_ITEM_ALREADY_EXISTS;
-    case MAP_ITEM_DOES_NOT_EXIST:
-        return TRIBE_ITEM_DOES_NOT_EXIST;
-    case MAP_ERROR:
-        return TRIBE_ERROR;
-    default:
-        return TRIBE_SUCCESS;
+        count *= 2;
     }
+    return count;
 }
+
 /*
-get a pointer to
+return the slots of the table, or NULL if it has none
 */
-void tribeSetAllVotesToZero(Tribe tribe)
+static int* tableSlots(Tribe tribe)
+{
+    return tribe->capacity >= HASH_MIN_CAPACITY ? tribe->ids + tribe->capacity : NULL;
+}
+
+/*
+return the slot the probe for the given id starts at, the high bits of a multiplicative hash so ids
+that differ in their high bits only don't start in the same slot
+*/
+static int firstSlot(int tribe_id, int slot_count)
+{
+    uint32_t hash = (uint32_t)tribe_id * HASH_MULTIPLIER;
+    return (int)((hash ^ (hash >> 16)) & (uint32_t)(slot_count - 1));
+}
+
+/*
+adds the id in the given index of the table to its slots, the table doesn't have the id in another index
+*/
+static void slotsPut(Tribe tribe, int index)
+{
+    int* slots = tableSlots(tribe);
+    if (slots == NULL)
+    {
+        return;
+    }
+    int mask = slotCount(tribe->capacity) - 1;
+    int slot = firstSlot(tribe->ids[index], mask + 1);
+    while (slots[slot] != EMPTY_SLOT)//the slots are at most half full, so there is an empty one
+    {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = index + 1;
+}
+
+/*
+removes the id from the slots of the table, the slots after it that probed past it move back so no
+probe stops at the slot it leaves empty
+*/
+static void slotsRemove(Tribe tribe, int tribe_id)
+{
+    int* slots = tableSlots(tribe);
+    if (slots == NULL)
+    {
+        return;
+    }
+    int mask = slotCount(tribe->capacity) - 1;
+    int empty = firstSlot(tribe_id, mask + 1);
+    while (tribe->ids[slots[empty] - 1] != tribe_id)//the table has the id
+    {
+        empty = (empty + 1) & mask;
+    }
+    for (int slot = (empty + 1) & mask; slots[slot] != EMPTY_SLOT; slot = (slot + 1) & mask)
+    {
+        int home = firstSlot(tribe->ids[slots[slot] - 1], mask + 1);
+        if (((slot - home) & mask) >= ((slot - empty) & mask))//its probe passes the empty slot
+        {
+            slots[empty] = slots[slot];
+            empty = slot;
+        }
+    }
+    slots[empty] = EMPTY_SLOT;
+}
+
+/*
+changes the index of the slot of the given id of the table, the id is in the slots
+*/
+static void slotsSet(Tribe tribe, int tribe_id, int index)
+{
+    int* slots = tableSlots(tribe);
+    if (slots == NULL)
+    {
+        return;
+    }
+    int mask = slotCount(tribe->capacity) - 1;
+    int slot = firstSlot(tribe_id, mask + 1);
+    while (tribe->ids[slots[slot] - 1] != tribe_id)
+    {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = index + 1;
+}
+
+/*
+puts all the ids of the table in its slots again, after they moved or the block changed
+*/
+static void slotsRebuild(Tribe tribe)
+{
+    int* slots = tableSlots(tribe);
+    if (slots == NULL)
+    {
+        return;
+    }
+    memset(slots, EMPTY_SLOT, slotCount(tribe->capacity) * sizeof(int));
+    for (int i = 0; i < tribe->size; i++)
+    {
+        slotsPut(tribe, i);
+    }
+}
+
+/*
+return the position of the given id in the given block of the ids of a schema of the given capacity and
+size, or NOT_FOUND. the slots are loaded with acquire loads, so a reader of the epoch probes them too, a
+probe of slots that are changing ends after slotsFor(capacity) slots and the reader reads again
+*/
+static int indexFind(const int* ids, int capacity, int size, int tribe_id)
+{
+    if (capacity == 0)
+    {
+        return NOT_FOUND;
+    }
+    const int* slots = ids + capacity;
+    int count = slotsFor(capacity);
+    int slot = firstSlot(tribe_id, count);
+    for (int probe = 0; probe < count; probe++)
+    {
+        int position = __atomic_load_n(&slots[slot], __ATOMIC_ACQUIRE) - 1;
+        if (position < 0)
+        {
+            return NOT_FOUND;
+        }
+        if (position < size && __atomic_load_n(&ids[position], __ATOMIC_ACQUIRE) == tribe_id)
+        {
+            return position;
+        }
+        slot = (slot + 1) & (count - 1);
+    }
+    return NOT_FOUND;
+}
+
+/*
+adds the id in the given position of the block of the ids of a schema to its slots, stored with release
+stores since the readers probe them
+*/
+static void indexPut(int* ids, int capacity, int position)
+{
+    int* slots = ids + capacity;
+    int mask = slotsFor(capacity) - 1;
+    int slot = firstSlot(ids[position], mask + 1);
+    while (slots[slot] != EMPTY_SLOT)//the slots are at most half full, so there is an empty one
+    {
+        slot = (slot + 1) & mask;
+    }
+    __atomic_store_n(&slots[slot], position + 1, __ATOMIC_RELEASE);
+}
+
+/*
+puts the first size ids of the block of the ids of a schema in its slots again, after they moved or the
+block changed
+*/
+static void indexRebuild(int* ids, int capacity, int size)
 {
-    int votes_to_remove, tribe_id;
-    assert(tribe != NULL && tribe->tribe_map != NULL);
-    char* current_key = mapGetFirst(tribe->tribe_map);
-    while (current_key != NULL)
+    int* slots = ids + capacity;
+    int count = slotsFor(capacity);
+    for (int slot = 0; slot < count; slot++)
     {
-        tribe_id = stringToInt(current_key);
-        votes_to_remove = getVotesFromTribeById(tribe, tribe_id);
-        tribeUpdateVote(tribe, tribe_id, votes_to_remove, removeVotes);
-        current_key = mapGetNext(tribe->tribe_map);
+        __atomic_store_n(&slots[slot], EMPTY_SLOT, __ATOMIC_RELEASE);
     }
+    for (int i = 0; i < size; i++)
+    {
+        indexPut(ids, capacity, i);
+    }
+}
+
+/*
+return the id of the tribe with the most votes in the given parallel arrays, the lower id in case of
+a tie, or NOT_FOUND if none of them has votes
+*/
+static int findWinner(const int* ids, const int64_t* votes, int size)
+{
+    if (size == 0)
+    {
+        return NOT_FOUND;
+    }
+    int64_t max_votes = votes[0];
+    for (int i = 1; i < size; i++)//only the votes are read, with no branches so it is vectorised
+    {
+        max_votes = votes[i] > max_votes ? votes[i] : max_votes;
+    }
+    if (max_votes == 0)
+    {
+        return NOT_FOUND;
+    }
+    int64_t max_id = INT_MAX;//as wide as the votes, so both passes use the same vectors
+    for (int i = 0; i < size; i++)
+    {//if more than one tribe has the most votes choose the one with the lower tribe id
+        int64_t candidate = votes[i] == max_votes ? ids[i] : INT_MAX;
+        max_id = candidate < max_id ? candidate : max_id;
+    }
+    return (int)max_id;
+}
+
+/*
+findWinner for a reader of the epoch, every id and vote is loaded with an acquire load since the writer
+may be changing them, so it isn't vectorised. the caller checks the sequence count of the table after it
+*/
+static int readWinner(const int* ids, const int64_t* votes, int size)
+{
+    int winner = NOT_FOUND;
+    int64_t max_votes = 0;
+    for (int i = 0; i < size; i++)
+    {
+        int64_t tribe_votes = __atomic_load_n(&votes[i], __ATOMIC_ACQUIRE);
+        int tribe_id = __atomic_load_n(&ids[i], __ATOMIC_ACQUIRE);
+        if (tribe_votes > max_votes || (tribe_votes == max_votes && winner != NOT_FOUND && tribe_id < winner))
+        {
+            max_votes = tribe_votes;
+            winner = tribe_id;
+        }
+    }
+    return winner;
+}
+
+/*
+return the packed entries of a frozen table, they are after the header of its block
+*/
+static uint8_t* frozenEntries(Tribe tribe)
+{
+    assert(tribe->capacity == FROZEN);
+    return (uint8_t*)(tribe->ids + FROZEN_HEADER);
 }
 
+/*
+reads the entry at the given offset of the packed entries of a frozen table, tribe_id has to be the
+id of the entry before it, or 0 for the first entry
+return the offset of the next entry
+*/
+static int readEntry(const uint8_t* entries, int offset, int* tribe_id, int64_t* votes)
+{
+    uint64_t value;
+    offset = readVarint(entries, offset, &value);
+    *tribe_id += (int)value;
+    offset = readVarint(entries, offset, &value);
+    *votes = (int64_t)value;
+    return offset;
+}
+
+/*
+return the id of the tribe with the most votes in a frozen table, the lower id in case of
+a tie, or NOT_FOUND if none of its tribes has votes
+*/
+static int frozenWinner(Tribe tribe)
+{
+    const uint8_t* entries = frozenEntries(tribe);
+    int tribe_id = 0, winner = NOT_FOUND;
+    int64_t votes, max_votes = 0;
+    for (int i = 0, offset = 0; i < tribe->size; i++)
+    {
+        offset = readEntry(entries, offset, &tribe_id, &votes);
+        if (votes > max_votes)//the ids are ascending, so the first tribe with the most votes has the lowest id
+        {
+            max_votes = votes;
+            winner = tribe_id;
+        }
+    }
+    return winner;
+}
 
+/*
+removes the tribes with the given ids from a frozen table, the entries are packed again in place since
+an entry written is never longer than the entries read for it, and the winner is found again
+*/
+static void removeFrozenSorted(Tribe tribe, const int* sorted_ids, int count)
+{
+    uint8_t* entries = frozenEntries(tribe);
+    int read = 0, written = 0, kept = 0, tribe_id = 0, previous_id = 0;
+    int64_t votes;
+    for (int i = 0; i < tribe->size; i++)
+    {
+        read = readEntry(entries, read, &tribe_id, &votes);
+        if (bsearch(&tribe_id, sorted_ids, count, sizeof(int), compareIds) == NULL)
+        {
+            written = writeVarint(entries, written, (uint64_t)(tribe_id - previous_id));
+            written = writeVarint(entries, written, (uint64_t)votes);
+            previous_id = tribe_id;
+            kept++;
+        }
+    }
+    __atomic_store_n(&tribe->size, kept, __ATOMIC_RELEASE);
+    tribe->ids[FROZEN_LENGTH] = written;
+    __atomic_store_n(&tribe->ids[FROZEN_WINNER], frozenWinner(tribe), __ATOMIC_RELEASE);
+}
+
+/*
+return the number of bytes of the given value as a varint
+*/
+static int varintSize(uint64_t value)
+{
+    int size = 1;
+    while (value >= VARINT_MORE)
+    {
+        value >>= VARINT_BITS;
+        size++;
+    }
+    return size;
+}
+
+/*
+writes the given value as a varint at the given offset of bytes, 7 bits in every byte from the
+lowest, the high bit of every byte but the last is set
+return the offset after it
+*/
+static int writeVarint(uint8_t* bytes, int offset, uint64_t value)
+{
+    while (value >= VARINT_MORE)
+    {
+        bytes[offset++] = (uint8_t)(value | VARINT_MORE);
+        value >>= VARINT_BITS;
+    }
+    bytes[offset++] = (uint8_t)value;
+    return offset;
+}
+
+/*
+reads the varint at the given offset of bytes into value
+return the offset after it
+*/
+static int readVarint(const uint8_t* bytes, int offset, uint64_t* value)
+{
+    uint64_t result = 0;
+    int shift = 0;
+    uint8_t byte;
+    do
+    {
+        byte = bytes[offset++];
+        result |= (uint64_t)(byte & (VARINT_MORE - 1)) << shift;
+        shift += VARINT_BITS;
+    } while (byte & VARINT_MORE);
+    *value = result;
+    return offset;
+}
+
+/*
+creates a tribe with the same ids and schema as the given tribe, the ids and votes
+are allocated as one block in the exact size of the given tribe
+return NULL if allocation failed
+*/
+static Tribe copyTable(Tribe tribe, bool copy_votes)
+{
+    assert(tribe != NULL && tribe->capacity != FROZEN);
+    const Allocator* allocator = tribe->schema->allocator;
+    Tribe tribe_copy = poolAllocate(tribe->schema->tribes);
+    if (tribe_copy == NULL)
+    {
+        return NULL;
+    }
+    tribe_copy->size = tribe->size;
+    tribe_copy->capacity = tribe->size;
+    tribe_copy->ids = NULL;
+    tribe_copy->votes = NULL;
+    tribe_copy->sequence = 0;
+    if (tribe->size > 0)
+    {
+        tribe_copy->votes = allocatorAllocate(allocator, BLOCK_SIZE(tribe->size));
+        if (tribe_copy->votes == NULL)
+        {
+            poolDeallocate(tribe->schema->tribes, tribe_copy);
+            return NULL;
+        }
+        tribe_copy->ids = (int*)(tribe_copy->votes + tribe->size);
+        memcpy(tribe_copy->ids, tribe->ids, tribe->size * sizeof(int));
+        if (copy_votes)
+        {
+            memcpy(tribe_copy->votes, tribe->votes, tribe->size * sizeof(int64_t));
+        }
+        else
+        {
+            memset(tribe_copy->votes, 0, tribe->size * sizeof(int64_t));
+        }
+        slotsRebuild(tribe_copy);
+    }
+    tribe_copy->schema = tribe->schema;
+    tribe->schema->references++;
+    return tribe_copy;
+}
+
+/*
+compare function of two ids for bsearch
+*/
+static int compareIds(const void* id1, const void* id2)
+{
+    int first = *(const int*)id1, second = *(const int*)id2;
+    return (first > second) - (first < second);
+}
+/*
+compareEntries: compare function of the entries of a table being frozen by their ids for qsort
+*/
+static int compareEntries(const void* entry1, const void* entry2)
+{
+    int first = ((const struct frozen_entry_t*)entry1)->id, second = ((const struct frozen_entry_t*)entry2)->id;
+    return (first > second) - (first < second);
+}
+
+/*
+deallocates the block of the given table and gives its record back to the pool of its schema,
+the last table of the schema destroys the pool
+*/
+static void releaseTable(void* context, void* tribe)
+{
+    Tribe table = tribe;
+    struct tribe_schema_t* schema = table->schema;
+    //ids are in the same block, or they are the block of a frozen table
+    allocatorDeallocate(schema->allocator, table->capacity == FROZEN ? (void*)table->ids : (void*)table->votes);
+    poolDeallocate(schema->tribes, table);
+    schemaRelease(schema);
+}
+
+/*
+deallocates a name of the schema with the allocator of the schema
+*/
+static void releaseName(void* allocator, void* name)
+{
+    destroyString(allocator, name);
+}
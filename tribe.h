@@ -2,15 +2,21 @@
 #define MTM_TRIBE_H
 
 #include "assist.h"
+#include "epoch.h"
+#include <stdbool.h>
+#include <stdint.h>
 /**
 * Tribe tribe
 * Implements a Tribe type.
-* The type of tribe_map is a map
-*key is a char* type and the value is the tribe_id (not negative)
-*data is a char* type and the value is tha tribe_name + tribe_votes
-*the data is sperated by a defined sign SPERATOR
+* A tribe is the table of the tribes of one area, it keeps two parallel arrays
+* in one block: the tribe ids and the votes the area gave each of them.
+* The tribe names are not kept in the table, they are kept once in a schema
+* that is shared by all the tables copied from the same table, so copying a table
+* for a new area is one allocation and does not copy any string.
+* A table of totals has every tribe of its schema. The table of an area is sparse, it only
+* has the tribes the area gave votes to, the rest of the tribes have zero votes in it.
 *tribe name consists of lower case letters and spaces
-* tribe_votes is a positive number
+* tribe_votes is a positive number, kept as int64_t
 **/
 
 /** Type for defining a Tribe */
@@ -24,79 +30,192 @@ typedef enum TribeResult_t
     TRIBE_NULL_ARGUMENT,
     TRIBE_ITEM_ALREADY_EXISTS,
     TRIBE_ITEM_DOES_NOT_EXIST,
+    TRIBE_VOTES_OVERFLOW,
+    TRIBE_FROZEN,
     TRIBE_ERROR
 } TribeResult;
 
 /**
-* tribeCreate: Allocates a new empty tribe.
+* tribeCreate: Allocates a new empty tribe with a new empty schema.
+* the tribe, its schema and every tribe copied from it allocate with the given allocator
 * @return
 * 	NULL - if allocations failed.
 * 	A new Tribe in case of success.
 */
-Tribe tribeCreate();
+Tribe tribeCreate(const Allocator* allocator);
 /**
 * tribeDestroy: Deallocates an existing tribe. Clears all elements.
+* the schema is deallocated with the last tribe that shares it.
 * @param tribe - Target tribe to be deallocated. If tribe is NULL nothing will be
 * done
 */
 void tribeDestroy(Tribe tribe);
 /**
-*gets a pointer to tribe map and initilaze it with the given id as key
-*and the data value as one string : "tribe name" SPERATOR "votes"
-*votes initishial value is zero.
+*gets a pointer to tribe and add the given id to it with zero votes,
+*the name is added to the schema if the schema doesn't have this id yet.
 *@return
-return NULL if tribe is NUll or tribe does not exists or memeory allocation failed
+*TRIBE_ITEM_ALREADY_EXISTS if the tribe already has this id
+*TRIBE_OUT_OF_MEMORY if memeory allocation failed
 */
 TribeResult tribeAdd(Tribe tribe, int tribe_id, const char* tribe_name);
+/*
+*like tribeAdd for an id the caller knows the tribe doesn't have, without looking for it
+*@return
+*TRIBE_OUT_OF_MEMORY if memeory allocation failed
+*/
+TribeResult tribeAppend(Tribe tribe, int tribe_id, const char* tribe_name);
 /**
-*gets a pointer to tribe and find the tribe in the tribe map with the given id as key
-* sperate the tribe name from the string sored in data and return a pointer to a copy
-*of the tribe name(by value)
+*gets a pointer to tribe and find the tribe with the given id
+*return a pointer to a copy of the tribe name(by value), the copy is allocated with the
+*default allocator so the caller can free it with free
 *@return
-*TRIBE_NULL_ARGUMENT if one of the given arguments is NULL
-*TRIBE_INVALID_ID if tribe_id is negative
-*TRIBE_INVALID_VOTES if votes is not a posite
+*NULL if the tribe doesn't have this id or memory allocation failed
 */
 char* tribeGetName(Tribe tribe, int tribe_id);
 /**
-*gets a pointer to tribe and find the tribe in the tribe map with the given id as key
-*update votes value in data by the given condition and number
+*gets a pointer to a sparse tribe and find the tribe with the given id
+*update its votes by the given condition and number, and the votes of the tribe in totals by the same
+*change. the tribe is added to the sparse table when it gets votes and removed when it has none left. totals is a table of the same schema whose votes are at least the votes of tribe, so it
+*overflows first: if it would, the votes are only updated up to INT64_MAX of totals when saturate is
+*true and not updated at all otherwise
+*if change isn't NULL it is set to how much the votes changed (negative if they went down)
 *@return
-*return NULL if tribe is NUll or tribe does not exists or memeory allocation failed
+*TRIBE_ITEM_DOES_NOT_EXIST if totals doesn't have this id
+*TRIBE_VOTES_OVERFLOW if totals would overflow and saturate is false
+*TRIBE_OUT_OF_MEMORY if adding the tribe to the sparse table failed, nothing is changed in that case
+*TRIBE_FROZEN if the table is frozen
 */
-TribeResult tribeUpdateVote(Tribe tribe, int tribe_id, int num_of_votes, UpdateVotesCondition condition);
+TribeResult tribeUpdateVote(Tribe tribe, Tribe totals, int tribe_id, int num_of_votes,
+                            UpdateVotesCondition condition, bool saturate, int64_t* change);
 /*
-*get a tribe id to set its name to tribe_name
-*return TRIBE_OUT_MEMORY if name allocation failed
+*adds the given change (which may be negative) to the votes of the tribe with the given id,
+*which the tribe must have. used for tables of totals
+*/
+void tribeAddToVotes(Tribe tribe, int tribe_id, int64_t change);
+/*
+*adds sign (1 or -1) times the votes of every tribe of tribe to the same tribe in totals,
+*both tables must be of the same schema, like the tables of all the areas of one list, tribe may be sparse
+*/
+void tribeAddAllVotes(Tribe totals, Tribe tribe, int sign);
+/*
+*adds the votes of every tribe of tribe to the same tribe in totals, the sums stop at INT64_MAX.
+*both tables are totals with the same tribes in the same order, but they may be of different schemas,
+*like the totals of the lists of the shards of one election
+*/
+void tribeMergeTotals(Tribe totals, Tribe tribe);
+/*
+*get a tribe id to set its name to tribe_name, the name is kept in the schema
+*so it changes for all the tribes that share it
+*return TRIBE_ITEM_DOES_NOT_EXIST if no tribe of the schema has this id
+*TRIBE_OUT_MEMORY if name allocation failed
 *TRIBE_SUCSESS if update went well
 */
 TribeResult tribeSetName(Tribe tribe, int tribe_id, const char* tribe_name);
 /*
-*gets a trie it and remove it from all the tribes,
+*gets a trie it and remove it from the tribe and from the schema,
 *@return TRIBE_ITEM_DOES_NOT_EXIST if the the tribe isn't one of all the tribes
 *TRIBE_SUCSESS if update went well
 */
 TribeResult tribeRemove(Tribe tribe, int tribe_id);
 /*
-gets a pointer to tribe, run on all tribe map and change every vote to 0
+*gets an array of tribe ids sorted in ascending order and remove all of them from the tribe
+*in one pass, and from the schema. ids the tribe doesn't have are ignored
+*/
+void tribeRemoveSorted(Tribe tribe, const int* sorted_ids, int count);
+/*
+*like tribeRemoveSorted but only from the table, the schema is left for tribeRemoveSorted of another table
+*of it, like the totals. tables of one schema can be changed at once from different threads this way
+*/
+void tribeRemoveSortedEntries(Tribe tribe, const int* sorted_ids, int count);
+/*
+gets a pointer to tribe and change every vote to 0
 */
 void tribeSetAllVotesToZero(Tribe tribe);
 /*
-gets a pointer to a tribe adt and return a copy (by value) of the tribe
-*return a copy (by value) of the given tribe
+gets a pointer to a tribe adt and return a copy (by value) of the tribe votes,
+the copy shares the schema of the given tribe
 *@return NULL if memory allocation failed otherwise return a pointer to the copy
 */
 Tribe tribeCopy(Tribe tribe);
 /*
-get a tribe map and return the tribe id of the tribe with the highest amount of votes
-return NULL if tribe is NULL or the tribe map is NULL
+gets a pointer to a tribe adt and return a tribe with the same tribe ids and zero votes,
+the copy shares the schema of the given tribe and its table is one allocation
+*@return NULL if memory allocation failed otherwise return a pointer to the copy
+*/
+Tribe tribeCopyWithZeroVotes(Tribe tribe);
+/*
+gets a pointer to a tribe adt and return a sparse table of the same schema without tribes,
+which means zero votes for all the tribes of the schema. see tribeUpdateVote
+*@return NULL if memory allocation failed otherwise return a pointer to the new table
 */
-char* tribeGetMaxVotesForArea(Tribe tribe);
+Tribe tribeCopyEmpty(Tribe tribe);
+/*
+get a tribe and return the tribe id of the tribe with the highest amount of votes
+in case of a tie the lower tribe id is returned, the tribes a sparse table doesn't have tie with zero votes
+return a negative number if tribe is NULL or its schema has no tribes
+*/
+int tribeGetMaxVotesForArea(Tribe tribe);
+/*
+get a tribe and return the number of its tribes, ids and votes are set to its parallel arrays of the tribe
+ids and votes. the arrays are valid until the tribe is changed
+*/
+int tribeGetTable(Tribe tribe, const int** ids, const int64_t** votes);
+/*
+return the votes of the tribe with the given id in the table, zero if the table doesn't have it.
+a frozen table is read up to the id
+*/
+int64_t tribeGetVotes(Tribe tribe, int tribe_id);
+/*
+return the name of the tribe with the given id in the schema of the table, not a copy, or NULL if the
+schema doesn't have it. the name is valid until the tribe is renamed or removed
+*/
+const char* tribeFindName(Tribe tribe, int tribe_id);
 /*
 gets a tribe map and a id and return true id a tribe with this id exsits otherwise
 retrun false
 */
 bool tribeContains(Tribe tribe, int tribe_id);
+/*
+return true if a tribe of the schema of the given tribe has this id, in one probe of the index of
+the schema. when all the tribes of the schema have the same ids it is tribeContains for any of them
+*/
+bool tribeSchemaContains(Tribe tribe, int tribe_id);
+/*
+hints the cache to fetch the record of the given tribe, which is read by tribePrefetchVotes and by every
+function of the tribe. it doesn't read the tribe so it doesn't wait for it
+*/
+void tribePrefetch(Tribe tribe);
+/*
+hints the cache to fetch the ids and votes of the given tribe, it reads the record of the tribe
+so it is best called some time after tribePrefetch of the same tribe
+*/
+void tribePrefetchVotes(Tribe tribe);
+/*
+packs the tribes of the given sparse table that no votes will be added to into one block of varints,
+sorted by id, with its winner found once. the votes of a frozen table can't be updated, the rest of the
+functions that read it still work and removing tribes still removes them from it. a frozen table
+stays frozen
+*@return
+*TRIBE_OUT_OF_MEMORY if allocation failed, the table isn't changed in that case
+*TRIBE_SUCCESS otherwise, also if the table was already frozen
+*/
+TribeResult tribeFreeze(Tribe tribe);
+/*
+sets the epoch of the schema of the given tribe, for other threads that read its tables with tribeReadWinner
+and tribeReadName while this thread changes them. the blocks, records and names that the tables of the schema
+stop using are retired to the epoch instead of being deallocated. NULL, the default, deallocates them right away
+*/
+void tribeSetEpoch(Tribe tribe, Epoch epoch);
+/*
+like tribeGetMaxVotesForArea of a table that isn't NULL, for a reader of the epoch of the schema (see
+tribeSetEpoch) while another thread changes the table. the winner is of the table at some moment
+during the call
+*/
+int tribeReadWinner(Tribe tribe);
+/*
+like tribeGetName of a table of totals, for a reader of the epoch of the schema while another thread
+changes it. the name is found in one probe of the slots of the schema
+*@return NULL if the schema has no tribe with this id or memory allocation failed, the caller frees the name with free
+*/
+char* tribeReadName(Tribe tribe, int tribe_id);
 #endif //MTM_TRIBE_H
-
-
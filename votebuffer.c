@@ -0,0 +1,244 @@
+#include "votebuffer.h"
+#include "election.h"
+#include "election_ext.h"
+#include "allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <stdint.h>
+
+#define NO_DELTA -1
+
+/*
+the merged votes of one (area, tribe), applying them to votes x gives max(floor, x + change)
+slot is the slot of the table that has its index
+*/
+struct delta_t
+{
+    int area_id;
+    int tribe_id;
+    int slot;
+    long long floor;
+    long long change;
+};
+
+/*
+deltas has the pairs in the order they were first seen, slots is an open addressing table of
+table_size indexes of deltas or NO_DELTA, at least twice the threshold so probes stay short
+rejected counts the updates rejected by flushes since the last flush that was called by the user
+*/
+struct vote_buffer_t
+{
+    const Allocator* allocator;
+    Election election;
+    int threshold;
+    int count;
+    int rejected;
+    int table_size;
+    struct delta_t* deltas;
+    int* slots;
+};
+
+VoteBuffer voteBufferCreate(Election election, int threshold, const Allocator* allocator);
+void voteBufferDestroy(VoteBuffer buffer);
+ElectionResult voteBufferAddVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes);
+ElectionResult voteBufferRemoveVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes);
+ElectionResult voteBufferFlush(VoteBuffer buffer, int* rejected);
+static ElectionResult mergeVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes, int sign);
+static struct delta_t* findDelta(VoteBuffer buffer, int area_id, int tribe_id);
+static void applyDeltas(VoteBuffer buffer);
+static ElectionResult applyChange(Election election, int area_id, int tribe_id, long long change);
+
+VoteBuffer voteBufferCreate(Election election, int threshold, const Allocator* allocator)
+{
+    if (election == NULL || threshold <= 0 || threshold > INT_MAX / 4)
+    {
+        return NULL;
+    }
+    if (allocator == NULL)
+    {
+        allocator = allocatorDefault();
+    }
+    VoteBuffer buffer = allocatorAllocate(allocator, sizeof(*buffer));
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->table_size = 1;
+    while (buffer->table_size < 2 * threshold)//a power of two so a hash is turned into a slot with a mask
+    {
+        buffer->table_size *= 2;
+    }
+    buffer->deltas = allocatorAllocate(allocator, threshold * sizeof(*buffer->deltas));
+    buffer->slots = allocatorAllocate(allocator, buffer->table_size * sizeof(*buffer->slots));
+    if (buffer->deltas == NULL || buffer->slots == NULL)
+    {
+        allocatorDeallocate(allocator, buffer->deltas);
+        allocatorDeallocate(allocator, buffer->slots);
+        allocatorDeallocate(allocator, buffer);
+        return NULL;
+    }
+    for (int i = 0; i < buffer->table_size; i++)
+    {
+        buffer->slots[i] = NO_DELTA;
+    }
+    buffer->allocator = allocator;
+    buffer->election = election;
+    buffer->threshold = threshold;
+    buffer->count = 0;
+    buffer->rejected = 0;
+    return buffer;
+}
+
+void voteBufferDestroy(VoteBuffer buffer)
+{
+    if (buffer == NULL)
+    {
+        return;
+    }
+    applyDeltas(buffer);
+    allocatorDeallocate(buffer->allocator, buffer->deltas);
+    allocatorDeallocate(buffer->allocator, buffer->slots);
+    allocatorDeallocate(buffer->allocator, buffer);
+}
+
+ElectionResult voteBufferAddVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes)
+{
+    return mergeVote(buffer, area_id, tribe_id, num_of_votes, 1);
+}
+
+ElectionResult voteBufferRemoveVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes)
+{
+    return mergeVote(buffer, area_id, tribe_id, num_of_votes, -1);
+}
+
+ElectionResult voteBufferFlush(VoteBuffer buffer, int* rejected)
+{
+    if (buffer == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    applyDeltas(buffer);
+    if (rejected != NULL)
+    {
+        *rejected = buffer->rejected;
+    }
+    buffer->rejected = 0;
+    return ELECTION_SUCCESS;
+}
+
+/*
+validates the vote and merges it with the given sign into the delta of its (area, tribe)
+adding n votes to max(floor, x + change) gives max(floor + n, x + change + n) and removing n votes
+gives max(max(floor - n, 0), x + change - n), since votes never drop below zero
+*/
+static ElectionResult mergeVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes, int sign)
+{
+    if (buffer == NULL)
+    {
+        return ELECTION_NULL_ARGUMENT;
+    }
+    if (area_id < 0 || tribe_id < 0)
+    {
+        return ELECTION_INVALID_ID;
+    }
+    if (num_of_votes <= 0)
+    {
+        return ELECTION_INVALID_VOTES;
+    }
+    struct delta_t* delta = findDelta(buffer, area_id, tribe_id);
+    delta->change += sign * (long long)num_of_votes;
+    delta->floor += sign * (long long)num_of_votes;
+    if (delta->floor < 0)
+    {
+        delta->floor = 0;
+    }
+    if (buffer->count == buffer->threshold)
+    {
+        applyDeltas(buffer);
+    }
+    return ELECTION_SUCCESS;
+}
+
+/*
+return the delta of the given (area, tribe), adding a delta with no votes if there is none
+max(0, x) is x so a new delta has zero floor and change
+*/
+static struct delta_t* findDelta(VoteBuffer buffer, int area_id, int tribe_id)
+{
+    unsigned int hash = (unsigned int)area_id * 2654435761u ^ (unsigned int)tribe_id * 40503u;
+    int slot = hash & (buffer->table_size - 1);
+    while (buffer->slots[slot] != NO_DELTA)
+    {
+        struct delta_t* delta = &buffer->deltas[buffer->slots[slot]];
+        if (delta->area_id == area_id && delta->tribe_id == tribe_id)
+        {
+            return delta;
+        }
+        slot = (slot + 1) & (buffer->table_size - 1);
+    }
+    assert(buffer->count < buffer->threshold);
+    struct delta_t* delta = &buffer->deltas[buffer->count];
+    delta->area_id = area_id;
+    delta->tribe_id = tribe_id;
+    delta->floor = 0;
+    delta->change = 0;
+    delta->slot = slot;
+    buffer->slots[slot] = buffer->count;
+    buffer->count++;
+    return delta;
+}
+
+/*
+applies the deltas to the election in the order their pairs were first seen and empties the buffer.
+the votes x of the pair are read first, which also rejects a pair of an area or tribe that doesn't exist
+when its votes cancel out, and then max(floor, x + change) is applied as one change from x
+*/
+static void applyDeltas(VoteBuffer buffer)
+{
+    for (int i = 0; i < buffer->count; i++)
+    {
+        struct delta_t* delta = &buffer->deltas[i];
+        int64_t votes;
+        ElectionResult result = electionGetVotes(buffer->election, delta->area_id, delta->tribe_id, &votes);
+        if (result == ELECTION_SUCCESS)
+        {//votes aren't negative, so only adding can overflow, it stops at the highest total there can be
+            long long target = delta->change > INT64_MAX - votes ? INT64_MAX : votes + delta->change;
+            if (target < delta->floor)
+            {
+                target = delta->floor;
+            }
+            result = applyChange(buffer->election, delta->area_id, delta->tribe_id, target - votes);
+        }
+        if (result != ELECTION_SUCCESS)
+        {
+            buffer->rejected++;
+        }
+        buffer->slots[delta->slot] = NO_DELTA;//only the slots of the pairs are cleared, not all the table
+    }
+    buffer->count = 0;
+}
+
+/*
+adds or removes the given number of votes, in parts that fit in an int
+*/
+static ElectionResult applyChange(Election election, int area_id, int tribe_id, long long change)
+{
+    ElectionResult result = ELECTION_SUCCESS;
+    while (change != 0 && result == ELECTION_SUCCESS)
+    {
+        int part = change > INT_MAX ? INT_MAX : change < -INT_MAX ? -INT_MAX : (int)change;
+        if (part > 0)
+        {
+            result = electionAddVote(election, area_id, tribe_id, part);
+        }
+        else
+        {
+            result = electionRemoveVote(election, area_id, tribe_id, -part);
+        }
+        change -= part;
+    }
+    return result;
+}
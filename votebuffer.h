@@ -0,0 +1,59 @@
+#ifndef MTM_VOTEBUFFER_H
+#define MTM_VOTEBUFFER_H
+
+#include "election.h"
+#include "allocator.h"
+/**
+* VoteBuffer
+* Implements a write-combining buffer of votes in front of an Election.
+* Votes for the same (area, tribe) are merged in the buffer into one signed update, and the updates
+* are applied to the election together when the buffer is flushed, or when it holds the given number of
+* (area, tribe) pairs. Merging keeps the result of removing votes exactly as if every vote was applied
+* on its own, including votes that never drop below zero.
+* Votes in the buffer are not seen in the election until they are applied.
+**/
+
+/** Type for defining a VoteBuffer */
+typedef struct vote_buffer_t* VoteBuffer;
+
+/*
+*voteBufferCreate: creates an empty buffer for the given election that is flushed when it holds
+*threshold (area, tribe) pairs. the buffer is allocated with the given allocator, or with the default
+*allocator if it is NULL
+*@return
+*NULL if election is NULL, threshold isn't positive or memory allocation failed
+*/
+VoteBuffer voteBufferCreate(Election election, int threshold, const Allocator* allocator);
+/*
+*voteBufferDestroy: applies the votes in the buffer and deallocates it, the election isn't destroyed.
+*If buffer is NULL nothing will be done
+*/
+void voteBufferDestroy(VoteBuffer buffer);
+/*
+*voteBufferAddVote: merges votes to add into the buffer, like electionAddVote. votes of areas or tribes
+*that don't exist when they are applied are rejected
+*@return
+*ELECTION_NULL_ARGUMENT if buffer is NULL
+*ELECTION_INVALID_ID if area_id or tribe_id is negative
+*ELECTION_INVALID_VOTES if num_of_votes isn't positive
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult voteBufferAddVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes);
+/*
+*voteBufferRemoveVote: like voteBufferAddVote but for votes to remove, like electionRemoveVote
+*/
+ElectionResult voteBufferRemoveVote(VoteBuffer buffer, int area_id, int tribe_id, int num_of_votes);
+/*
+*voteBufferFlush: applies all the votes in the buffer to the election and empties it. rejected is set
+*to the number of merged updates the election rejected since the previous flush, if it isn't NULL.
+*an update is rejected if its area or tribe doesn't exist, also when its votes cancel out, or if the
+*election rejects its change. the merged votes of a pair are applied as one change, so a rejected update
+*changes nothing, unless it is of more than INT_MAX votes: those are applied in parts of at most INT_MAX
+*and the parts before the rejected one stay applied
+*@return
+*ELECTION_NULL_ARGUMENT if buffer is NULL
+*ELECTION_SUCCESS otherwise
+*/
+ElectionResult voteBufferFlush(VoteBuffer buffer, int* rejected);
+
+#endif //MTM_VOTEBUFFER_H
@@ -0,0 +1,467 @@
+#include "election.h"
+#include "mtm_map/map.h"
+#include "trace.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define MIN_NAME_LENGTH 4
+#define MAX_NAME_LENGTH 12
+#define LETTERS 26
+#define SPACE_CHANCE 8
+#define PERCENT 100
+#define NANOSECONDS_IN_SECOND 1e9
+
+static int churned_area_id;//the area doAreaChurn removes, a condition of electionRemoveAreas gets only an id
+
+/*
+the parameters of a workload, every option of the command line sets one of them
+*/
+typedef struct WorkloadOptions_t
+{
+    int areas;
+    int tribes;
+    long long operations;
+    unsigned long long seed;
+    double zipf_exponent;
+    int remove_percent;
+    int area_percent;
+    int max_votes;
+    long long churn_interval;
+    long long query_interval;
+    const char* trace_path;
+} WorkloadOptions;
+
+/*
+rank_weights[i] is the sum of the weights of ranks 0 to i, the weight of rank i is 1 / (i + 1)^exponent
+*/
+typedef struct Zipf_t
+{
+    double* rank_weights;
+    int size;
+} Zipf;
+
+/*
+runs one workload on a new election, times every call and writes it to the trace if there is one.
+area_removed tells which areas were removed by the area churn and not added back yet
+*/
+typedef struct Workload_t
+{
+    const WorkloadOptions* options;
+    Election election;
+    TraceWriter trace;
+    uint64_t random_state;
+    Zipf area_ranks;
+    Zipf tribe_ranks;
+    long long start;
+    long long calls;
+    bool renamed_last;
+    bool* area_removed;
+    StatsHistogram latency[TRACE_OPERATIONS];
+} Workload;
+
+int main(int argc, char** argv);
+static bool parseOptions(int argc, char** argv, WorkloadOptions* options);
+static void printUsage(const char* program);
+static bool zipfInit(Zipf* zipf, int size, double exponent);
+static int zipfSample(const Zipf* zipf, Workload* workload);
+static uint64_t nextRandom(Workload* workload);
+static void makeName(Workload* workload, char* name);
+static void runWorkload(Workload* workload);
+static void doVote(Workload* workload);
+static void doChurn(Workload* workload);
+static void doAreaChurn(Workload* workload);
+static bool isChurnedArea(int area_id);
+static void doQuery(Workload* workload);
+static void finishCall(Workload* workload, TraceRecord* record, long long started);
+static void printReport(const Workload* workload, long long elapsed, FILE* stream);
+
+int main(int argc, char** argv)
+{
+    WorkloadOptions options;
+    if (!parseOptions(argc, argv, &options))
+    {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    Workload workload;
+    memset(&workload, 0, sizeof(workload));
+    workload.options = &options;
+    workload.random_state = options.seed * 0x9e3779b97f4a7c15ULL + 1;//never zero, so the generator never sticks
+    FILE* trace_file = NULL;
+    if (options.trace_path != NULL)
+    {
+        trace_file = fopen(options.trace_path, "wb");
+        workload.trace = traceWriterCreate(trace_file, NULL);
+        if (workload.trace == NULL)
+        {
+            fprintf(stderr, "couldn't write the trace to %s\n", options.trace_path);
+            if (trace_file != NULL)
+            {
+                fclose(trace_file);
+            }
+            return EXIT_FAILURE;
+        }
+    }
+    workload.election = electionCreate();
+    workload.area_removed = calloc(options.areas, sizeof(*workload.area_removed));
+    if (workload.election == NULL || workload.area_removed == NULL || !zipfInit(&workload.area_ranks, options.areas, options.zipf_exponent) ||
+        !zipfInit(&workload.tribe_ranks, options.tribes, options.zipf_exponent))
+    {
+        fprintf(stderr, "out of memory\n");
+        return EXIT_FAILURE;
+    }
+    workload.start = statsNow();
+    runWorkload(&workload);
+    long long elapsed = statsNow() - workload.start;
+    printReport(&workload, elapsed, stdout);
+    electionDestroy(workload.election);
+    free(workload.area_ranks.rank_weights);
+    free(workload.tribe_ranks.rank_weights);
+    free(workload.area_removed);
+    traceWriterDestroy(workload.trace);
+    if (trace_file != NULL && fclose(trace_file) != 0)
+    {
+        fprintf(stderr, "couldn't write the trace to %s\n", options.trace_path);
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*
+sets the options to their defaults and then to the values given on the command line
+return false if an option is unknown, has no value or its value isn't valid
+*/
+static bool parseOptions(int argc, char** argv, WorkloadOptions* options)
+{
+    options->areas = 1000;
+    options->tribes = 20;
+    options->operations = 1000000;
+    options->seed = 1;
+    options->zipf_exponent = 1.0;
+    options->remove_percent = 10;
+    options->area_percent = 0;
+    options->max_votes = 100;
+    options->churn_interval = 10000;
+    options->query_interval = 100000;
+    options->trace_path = NULL;
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (argv[i][0] != '-' || strlen(argv[i]) != 2 || i + 1 == argc)
+        {
+            return false;
+        }
+        const char* value = argv[i + 1];
+        char* end;
+        switch (argv[i][1])
+        {
+        case 'a':
+            options->areas = (int)strtol(value, &end, 10);
+            break;
+        case 't':
+            options->tribes = (int)strtol(value, &end, 10);
+            break;
+        case 'n':
+            options->operations = strtoll(value, &end, 10);
+            break;
+        case 's':
+            options->seed = strtoull(value, &end, 10);
+            break;
+        case 'z':
+            options->zipf_exponent = strtod(value, &end);
+            break;
+        case 'r':
+            options->remove_percent = (int)strtol(value, &end, 10);
+            break;
+        case 'd':
+            options->area_percent = (int)strtol(value, &end, 10);
+            break;
+        case 'v':
+            options->max_votes = (int)strtol(value, &end, 10);
+            break;
+        case 'c':
+            options->churn_interval = strtoll(value, &end, 10);
+            break;
+        case 'q':
+            options->query_interval = strtoll(value, &end, 10);
+            break;
+        case 'o':
+            options->trace_path = value;
+            end = "";
+            break;
+        default:
+            return false;
+        }
+        if (*end != '\0' || end == value)
+        {
+            return false;
+        }
+    }
+    return options->areas > 0 && options->tribes > 0 && options->operations >= 0 &&
+           options->zipf_exponent >= 0 && options->remove_percent >= 0 && options->remove_percent <= PERCENT &&
+           options->area_percent >= 0 && options->area_percent <= PERCENT &&
+           options->max_votes > 0 && options->churn_interval >= 0 && options->query_interval >= 0;
+}
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-a areas] [-t tribes] [-n operations] [-s seed] [-z zipf exponent]\n"
+            "       [-r percent of votes that are removed] [-v max votes of a call]\n"
+            "       [-d percent of calls that remove an area or add a removed area back]\n"
+            "       [-c operations between tribe renames and removals, 0 for none]\n"
+            "       [-q operations between mapping queries, 0 for none] [-o trace file]\n", program);
+}
+
+/*
+fills the sums of the weights of the ranks of a Zipf distribution over size ranks
+return false if allocation failed
+*/
+static bool zipfInit(Zipf* zipf, int size, double exponent)
+{
+    zipf->rank_weights = malloc(size * sizeof(*zipf->rank_weights));
+    if (zipf->rank_weights == NULL)
+    {
+        return false;
+    }
+    double sum = 0;
+    for (int i = 0; i < size; i++)
+    {
+        sum += 1 / pow(i + 1, exponent);
+        zipf->rank_weights[i] = sum;
+    }
+    zipf->size = size;
+    return true;
+}
+
+/*
+return a rank, rank 0 is the most likely
+*/
+static int zipfSample(const Zipf* zipf, Workload* workload)
+{
+    double target = (double)(nextRandom(workload) >> 11) / (double)(1ULL << 53) * zipf->rank_weights[zipf->size - 1];
+    int low = 0, high = zipf->size - 1;
+    while (low < high)//the first rank whose sum is higher than the target
+    {
+        int middle = low + (high - low) / 2;
+        if (zipf->rank_weights[middle] > target)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+/*
+xorshift64*, the same seed gives the same numbers on every machine
+*/
+static uint64_t nextRandom(Workload* workload)
+{
+    workload->random_state ^= workload->random_state >> 12;
+    workload->random_state ^= workload->random_state << 25;
+    workload->random_state ^= workload->random_state >> 27;
+    return workload->random_state * 0x2545f4914f6cdd1dULL;
+}
+
+/*
+writes a random valid name of lowercase letters and spaces, name has room for MAX_NAME_LENGTH characters
+*/
+static void makeName(Workload* workload, char* name)
+{
+    int length = MIN_NAME_LENGTH + (int)(nextRandom(workload) % (MAX_NAME_LENGTH - MIN_NAME_LENGTH + 1));
+    for (int i = 0; i < length; i++)
+    {
+        uint64_t random = nextRandom(workload);
+        name[i] = random % SPACE_CHANCE == 0 ? ' ' : (char)('a' + (random >> 8) % LETTERS);
+    }
+    name[length] = '\0';
+}
+
+/*
+adds all the tribes and areas and then makes the given number of calls, a mapping query every
+query_interval calls, a tribe rename or removal every churn_interval calls, and otherwise an area
+removal or addition area_percent of the time and votes the rest of it
+*/
+static void runWorkload(Workload* workload)
+{
+    const WorkloadOptions* options = workload->options;
+    char name[MAX_NAME_LENGTH + 1];
+    for (int i = 0; i < options->tribes; i++)
+    {
+        makeName(workload, name);
+        TraceRecord record = {.operation = TRACE_ADD_TRIBE, .tribe_id = i, .name = name};
+        long long started = statsNow();
+        record.result = electionAddTribe(workload->election, i, name);
+        finishCall(workload, &record, started);
+    }
+    for (int i = 0; i < options->areas; i++)
+    {
+        makeName(workload, name);
+        TraceRecord record = {.operation = TRACE_ADD_AREA, .area_id = i, .name = name};
+        long long started = statsNow();
+        record.result = electionAddArea(workload->election, i, name);
+        finishCall(workload, &record, started);
+    }
+    for (long long i = 1; i <= options->operations; i++)
+    {
+        if (options->query_interval > 0 && i % options->query_interval == 0)
+        {
+            doQuery(workload);
+        }
+        else if (options->churn_interval > 0 && i % options->churn_interval == 0)
+        {
+            doChurn(workload);
+        }
+        else if (options->area_percent > 0 && (int)(nextRandom(workload) % PERCENT) < options->area_percent)
+        {//no random number is drawn without area churn, so the workloads of a seed stay as they were
+            doAreaChurn(workload);
+        }
+        else
+        {
+            doVote(workload);
+        }
+    }
+}
+
+/*
+adds or removes votes of a Zipf area for a Zipf tribe
+*/
+static void doVote(Workload* workload)
+{
+    const WorkloadOptions* options = workload->options;
+    bool remove = (int)(nextRandom(workload) % PERCENT) < options->remove_percent;
+    TraceRecord record = {.operation = remove ? TRACE_REMOVE_VOTE : TRACE_ADD_VOTE};
+    record.area_id = zipfSample(&workload->area_ranks, workload);
+    record.tribe_id = zipfSample(&workload->tribe_ranks, workload);
+    record.num_of_votes = 1 + (int)(nextRandom(workload) % options->max_votes);
+    long long started = statsNow();
+    if (remove)
+    {
+        record.result = electionRemoveVote(workload->election, record.area_id, record.tribe_id,
+                                           record.num_of_votes);
+    }
+    else
+    {
+        record.result = electionAddVote(workload->election, record.area_id, record.tribe_id,
+                                        record.num_of_votes);
+    }
+    finishCall(workload, &record, started);
+}
+
+/*
+renames a Zipf tribe, or removes it and adds it again with a new name so the number of tribes
+stays the same, one after the other
+*/
+static void doChurn(Workload* workload)
+{
+    char name[MAX_NAME_LENGTH + 1];
+    int tribe_id = zipfSample(&workload->tribe_ranks, workload);
+    makeName(workload, name);
+    workload->renamed_last = !workload->renamed_last;
+    if (workload->renamed_last)
+    {
+        TraceRecord record = {.operation = TRACE_SET_TRIBE_NAME, .tribe_id = tribe_id, .name = name};
+        long long started = statsNow();
+        record.result = electionSetTribeName(workload->election, tribe_id, name);
+        finishCall(workload, &record, started);
+        return;
+    }
+    TraceRecord record = {.operation = TRACE_REMOVE_TRIBE, .tribe_id = tribe_id};
+    long long started = statsNow();
+    record.result = electionRemoveTribe(workload->election, tribe_id);
+    finishCall(workload, &record, started);
+    record = (TraceRecord){.operation = TRACE_ADD_TRIBE, .tribe_id = tribe_id, .name = name};
+    started = statsNow();
+    record.result = electionAddTribe(workload->election, tribe_id, name);
+    finishCall(workload, &record, started);
+}
+
+/*
+removes a random area with electionRemoveAreas, or adds it back with a new name if it was removed,
+so about as many areas are removed as are added back. votes for removed areas fail until they are back
+*/
+static void doAreaChurn(Workload* workload)
+{
+    int area_id = (int)(nextRandom(workload) % workload->options->areas);
+    long long started;
+    if (workload->area_removed[area_id])
+    {
+        char name[MAX_NAME_LENGTH + 1];
+        makeName(workload, name);
+        TraceRecord record = {.operation = TRACE_ADD_AREA, .area_id = area_id, .name = name};
+        started = statsNow();
+        record.result = electionAddArea(workload->election, area_id, name);
+        finishCall(workload, &record, started);
+        workload->area_removed[area_id] = record.result != ELECTION_SUCCESS;
+        return;
+    }
+    churned_area_id = area_id;
+    TraceRecord record = {.operation = TRACE_REMOVE_AREAS, .area_ids = &churned_area_id, .area_count = 1};
+    started = statsNow();
+    record.result = electionRemoveAreas(workload->election, isChurnedArea);
+    finishCall(workload, &record, started);
+    workload->area_removed[area_id] = record.result == ELECTION_SUCCESS;
+}
+
+/*
+the condition of the area churn, true only for the area it removes
+*/
+static bool isChurnedArea(int area_id)
+{
+    return area_id == churned_area_id;
+}
+
+/*
+computes the winners of all the areas
+*/
+static void doQuery(Workload* workload)
+{
+    TraceRecord record = {.operation = TRACE_COMPUTE_MAPPING};
+    long long started = statsNow();
+    Map map = electionComputeAreasToTribesMapping(workload->election);
+    record.result = map == NULL ? ELECTION_OUT_OF_MEMORY : ELECTION_SUCCESS;
+    mapDestroy(map);
+    finishCall(workload, &record, started);
+}
+
+/*
+records the latency of a call that started at the given time and writes it to the trace
+*/
+static void finishCall(Workload* workload, TraceRecord* record, long long started)
+{
+    long long now = statsNow();
+    statsAddLatency(&workload->latency[record->operation], now - started);
+    workload->calls++;
+    if (workload->trace != NULL)
+    {
+        record->timestamp_ns = started - workload->start;
+        if (traceWrite(workload->trace, record) != TRACE_SUCCESS)
+        {
+            fprintf(stderr, "couldn't write the trace, it is stopped\n");
+            traceWriterDestroy(workload->trace);
+            workload->trace = NULL;
+        }
+    }
+}
+
+/*
+writes the options, the throughput and the latencies of every operation as one JSON object
+*/
+static void printReport(const Workload* workload, long long elapsed, FILE* stream)
+{
+    const WorkloadOptions* options = workload->options;
+    double seconds = elapsed / NANOSECONDS_IN_SECOND;
+    fprintf(stream, "{\"seed\":%llu,\"areas\":%d,\"tribes\":%d,\"zipf_exponent\":%g,\"calls\":%lld,"
+            "\"seconds\":%.6f,\"calls_per_second\":%.0f,", options->seed, options->areas,
+            options->tribes, options->zipf_exponent, workload->calls, seconds,
+            seconds > 0 ? workload->calls / seconds : 0);
+    tracePrintLatencyJson(workload->latency, stream);
+    fprintf(stream, "}\n");
+}